@@ -0,0 +1,165 @@
+#include "AIScheduler.hpp"
+#include <algorithm>
+#include <limits>
+#include <Components/BsCCamera.h>
+#include <Scene/BsSceneManager.h>
+#include <Scene/BsSceneObject.h>
+#include <Utility/BsTime.h>
+#include <components/Character.hpp>
+#include <components/GameWorld.hpp>
+#include <log/logging.hpp>
+
+namespace REGoth
+{
+  namespace AI
+  {
+    /**
+     * Characters closer than this to the hero or camera are ticked every frame.
+     */
+    constexpr float FULL_UPDATE_RANGE_METERS = 20.0f;
+
+    /**
+     * In how many frames a character of the reduced tier is ticked once.
+     */
+    constexpr bs::UINT64 REDUCED_UPDATE_INTERVAL = 4;
+
+    /**
+     * Number of frames between two logs of the stats.
+     */
+    constexpr bs::UINT64 STATS_LOG_INTERVAL_FRAMES = 600;
+
+    /**
+     * Scrambles the bits of the given spread key, so keys with a fixed stride, like
+     * instance IDs of characters spawned together, still land in different frames.
+     * This is the finalizer of SplitMix64.
+     */
+    static bs::UINT64 hashSpreadKey(bs::UINT64 key)
+    {
+      key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+      key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+      return key ^ (key >> 31);
+    }
+
+    AIScheduler::AIScheduler(HGameWorld world)
+        : mWorld(world)
+    {
+    }
+
+    bool AIScheduler::shouldTick(AIUpdateSlot& slot, bs::UINT64 spreadKey, AIUpdateTier tier,
+                                 float& outDeltaTime)
+    {
+      beginFrameIfNeeded();
+
+      slot.accumulatedDeltaTime += bs::gTime().getFrameDelta();
+
+      bs::UINT64 interval = 1;
+
+      switch (tier)
+      {
+        case AIUpdateTier::Full:
+          mCurrentFrameStats.numCharactersFull++;
+          break;
+
+        case AIUpdateTier::Reduced:
+          mCurrentFrameStats.numCharactersReduced++;
+          interval = REDUCED_UPDATE_INTERVAL;
+          break;
+      }
+
+      if ((mCurrentFrame + hashSpreadKey(spreadKey)) % interval != 0)
+      {
+        mCurrentFrameStats.numTicksSaved++;
+        return false;
+      }
+
+      mCurrentFrameStats.numTicksRun++;
+
+      outDeltaTime              = slot.accumulatedDeltaTime;
+      slot.accumulatedDeltaTime = 0.0f;
+
+      return true;
+    }
+
+    AIUpdateTier AIScheduler::tierOf(const bs::Vector3& position)
+    {
+      beginFrameIfNeeded();
+
+      // Without anything to focus on, there is no way to tell what's important
+      if (mFocusPositions.empty()) return AIUpdateTier::Full;
+
+      float closestDistanceSq = std::numeric_limits<float>::max();
+
+      for (const bs::Vector3& focus : mFocusPositions)
+      {
+        closestDistanceSq = std::min(closestDistanceSq, focus.squaredDistance(position));
+      }
+
+      if (closestDistanceSq < FULL_UPDATE_RANGE_METERS * FULL_UPDATE_RANGE_METERS)
+      {
+        return AIUpdateTier::Full;
+      }
+
+      return AIUpdateTier::Reduced;
+    }
+
+    void AIScheduler::beginFrameIfNeeded()
+    {
+      bs::UINT64 frame = bs::gTime().getFrameIdx();
+
+      if (mHasStartedFrame && frame == mCurrentFrame) return;
+
+      if (mHasStartedFrame)
+      {
+        mLastFrameStats = mCurrentFrameStats;
+
+        mTotalStats.numCharactersFull += mCurrentFrameStats.numCharactersFull;
+        mTotalStats.numCharactersReduced += mCurrentFrameStats.numCharactersReduced;
+        mTotalStats.numTicksRun += mCurrentFrameStats.numTicksRun;
+        mTotalStats.numTicksSaved += mCurrentFrameStats.numTicksSaved;
+
+        if (frame % STATS_LOG_INTERVAL_FRAMES == 0)
+        {
+          logStats();
+        }
+      }
+
+      mCurrentFrameStats = FrameStats();
+      mCurrentFrame      = frame;
+      mHasStartedFrame   = true;
+
+      mFocusPositions.clear();
+
+      HCharacter hero = mWorld->hero();
+
+      if (hero)
+      {
+        mFocusPositions.push_back(hero->SO()->getTransform().pos());
+      }
+
+      const auto& mainCamera = bs::gSceneManager().getMainCamera();
+
+      if (mainCamera)
+      {
+        mFocusPositions.push_back(mainCamera->getTransform().pos());
+      }
+    }
+
+    void AIScheduler::logStats() const
+    {
+      const FrameStats& last = mLastFrameStats;
+
+      bs::UINT64 numTicksTotal = (bs::UINT64)mTotalStats.numTicksRun + mTotalStats.numTicksSaved;
+      bs::UINT64 savedPercent =
+          numTicksTotal == 0 ? 0 : (bs::UINT64)mTotalStats.numTicksSaved * 100 / numTicksTotal;
+
+      REGOTH_LOG(Info, Uncategorized,
+                 "[AIScheduler] Last frame: {0} full, {1} reduced, {2} ticks run, {3} saved",
+                 last.numCharactersFull, last.numCharactersReduced, last.numTicksRun,
+                 last.numTicksSaved);
+
+      REGOTH_LOG(Info, Uncategorized,
+                 "[AIScheduler] In total: {0} ticks run, {1} saved ({2}%)",
+                 mTotalStats.numTicksRun, mTotalStats.numTicksSaved, savedPercent);
+    }
+  }  // namespace AI
+}  // namespace REGoth
@@ -0,0 +1,149 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <Math/BsVector3.h>
+
+namespace REGoth
+{
+  class GameWorld;
+  using HGameWorld = bs::GameObjectHandle<GameWorld>;
+
+  namespace AI
+  {
+    /**
+     * How often the AI-state of a character is ticked, picked by its distance to
+     * the hero and the camera.
+     *
+     * There is no tier for characters even farther away: Beyond the range where
+     * physics are disabled (see CharacterAI), the characters only run the much
+     * lighter ScriptState::doAIStateDuringShrink() anyways.
+     */
+    enum class AIUpdateTier
+    {
+      Full,     ///< Every frame.
+      Reduced,  ///< Every few frames, with the time in between accumulated.
+    };
+
+    /**
+     * Per-character bookkeeping of the AIScheduler. Not saved, as skipping a few
+     * ticks after loading doesn't matter.
+     */
+    struct AIUpdateSlot
+    {
+      /**
+       * Frame time which passed since the character was last ticked.
+       */
+      float accumulatedDeltaTime = 0.0f;
+    };
+
+    /**
+     * Decides which characters get to run their AI-state in the current frame.
+     *
+     * Running the `_LOOP`-function of an AI-state means executing script code,
+     * which adds up quickly with hundreds of characters inside a world. Most of
+     * them are far away from the player, where nobody would notice if they only
+     * ran their state every few frames.
+     *
+     * Each character is put into an AIUpdateTier, depending on how close it is to
+     * the hero or the camera, whichever is nearer. Characters which are not ticked
+     * in a frame accumulate the frame time, which is then passed along with the next
+     * tick, so timers inside the states still run at the correct speed.
+     *
+     * To not have all characters of a tier run in the same frame, each one is ticked
+     * in a different frame of the tiers interval, chosen by a hash of its scene objects ID.
+     * Characters spawned together get IDs with a fixed stride, which would otherwise
+     * all end up in the same frame.
+     *
+     * Only the AI-states are scheduled here. The event queues still process their
+     * messages every frame, since movement and waiting depend on that.
+     *
+     * The counters of the last frame and the totals are logged every few hundred frames.
+     */
+    class AIScheduler
+    {
+    public:
+      /**
+       * Counters of how much work was done inside a single frame.
+       */
+      struct FrameStats
+      {
+        bs::UINT32 numCharactersFull    = 0;
+        bs::UINT32 numCharactersReduced = 0;
+
+        /**
+         * Number of AI-state ticks which were run.
+         */
+        bs::UINT32 numTicksRun = 0;
+
+        /**
+         * Number of AI-state ticks which were skipped compared to ticking every
+         * character every frame.
+         */
+        bs::UINT32 numTicksSaved = 0;
+      };
+
+      AIScheduler(HGameWorld world);
+
+      /**
+       * Decides whether the AI-state of the character owning the given slot should be
+       * ticked in this frame. The frame time is accumulated inside the slot until
+       * it is.
+       *
+       * @param  slot          Bookkeeping of the character to schedule.
+       * @param  spreadKey     Some number which differs between characters, like their
+       *                       scene objects instance ID. Used to spread the ticks of
+       *                       a tier across the frames.
+       * @param  tier          Tier the character is in, see tierOf().
+       * @param  outDeltaTime  Set to the time passed since the last tick, if this
+       *                       returns true.
+       *
+       * @return Whether the AI-state should be ticked now.
+       */
+      bool shouldTick(AIUpdateSlot& slot, bs::UINT64 spreadKey, AIUpdateTier tier,
+                      float& outDeltaTime);
+
+      /**
+       * @return The tier a character at the given position is in during this frame.
+       */
+      AIUpdateTier tierOf(const bs::Vector3& position);
+
+      /**
+       * @return Counters of the last completed frame.
+       */
+      const FrameStats& lastFrameStats() const
+      {
+        return mLastFrameStats;
+      }
+
+      /**
+       * @return Counters summed up over all frames so far.
+       */
+      const FrameStats& totalStats() const
+      {
+        return mTotalStats;
+      }
+
+      /**
+       * Logs lastFrameStats() and totalStats().
+       */
+      void logStats() const;
+
+    private:
+      /**
+       * Rolls the counters over and looks up where hero and camera are, if a new
+       * frame has started since the last call.
+       */
+      void beginFrameIfNeeded();
+
+      HGameWorld mWorld;
+
+      bs::UINT64 mCurrentFrame = 0;
+      bool mHasStartedFrame    = false;
+
+      bs::Vector<bs::Vector3> mFocusPositions;
+
+      FrameStats mCurrentFrameStats;
+      FrameStats mLastFrameStats;
+      FrameStats mTotalStats;
+    };
+  }  // namespace AI
+}  // namespace REGoth
@@ -0,0 +1,90 @@
+#include "AIStateTable.hpp"
+#include <log/logging.hpp>
+#include <scripting/ScriptSymbolStorage.hpp>
+
+namespace REGoth
+{
+  namespace AI
+  {
+    /**
+     * @return Whether the given name ends with the given suffix. If so, `outStart` is set
+     *         to the name without it.
+     */
+    static bool stripSuffix(const bs::String& name, const bs::String& suffix,
+                            bs::String& outStart)
+    {
+      if (name.size() <= suffix.size()) return false;
+
+      if (name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) return false;
+
+      outStart = name.substr(0, name.size() - suffix.size());
+
+      return true;
+    }
+
+    void AIStateTable::build(const Scripting::ScriptSymbolStorage& symbols)
+    {
+      using namespace Scripting;
+
+      mStates.clear();
+
+      bs::Vector<SymbolIndex> functions = symbols.query([](const SymbolBase& s) {
+        return s.type == SymbolType::ScriptFunction && !s.isClassVar;
+      });
+
+      bs::String start;
+
+      for (SymbolIndex function : functions)
+      {
+        const bs::String& name = symbols.getSymbolName(function);
+
+        // Not all states are called ZS_*, so every function is looked at here
+        SymbolIndex AIStateFunctions::*member;
+
+        if (stripSuffix(name, "_LOOP", start))
+        {
+          member = &AIStateFunctions::loop;
+        }
+        else if (stripSuffix(name, "_END", start))
+        {
+          member = &AIStateFunctions::end;
+        }
+        else if (stripSuffix(name, "_INTERRUPT", start))
+        {
+          member = &AIStateFunctions::interrupt;
+        }
+        else
+        {
+          continue;
+        }
+
+        if (!symbols.hasSymbolWithName(start)) continue;
+
+        SymbolIndex startIndex = symbols.findIndexBySymbolName(start);
+
+        if (symbols.getSymbolType(startIndex) != SymbolType::ScriptFunction) continue;
+
+        AIStateFunctions& state = mStates[startIndex];
+        state.start             = startIndex;
+        state.*member           = function;
+      }
+
+      REGOTH_LOG(Info, Uncategorized, "[AIStateTable] Found {0} AI-states", mStates.size());
+    }
+
+    AIStateFunctions AIStateTable::functionsOf(Scripting::SymbolIndex start) const
+    {
+      auto it = mStates.find(start);
+
+      if (it == mStates.end())
+      {
+        AIStateFunctions functions;
+        functions.start = start;
+
+        return functions;
+      }
+
+      return it->second;
+    }
+  }  // namespace AI
+}  // namespace REGoth
@@ -0,0 +1,58 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <scripting/ScriptTypes.hpp>
+
+namespace REGoth
+{
+  namespace Scripting
+  {
+    class ScriptSymbolStorage;
+  }
+
+  namespace AI
+  {
+    /**
+     * Script functions making up a single AI-state, see ScriptState for how
+     * they are used. All but `start` are optional and may be SYMBOL_INDEX_INVALID.
+     */
+    struct AIStateFunctions
+    {
+      Scripting::SymbolIndex start     = Scripting::SYMBOL_INDEX_INVALID;
+      Scripting::SymbolIndex loop      = Scripting::SYMBOL_INDEX_INVALID;
+      Scripting::SymbolIndex end       = Scripting::SYMBOL_INDEX_INVALID;
+      Scripting::SymbolIndex interrupt = Scripting::SYMBOL_INDEX_INVALID;
+    };
+
+    /**
+     * Maps the main-function of each AI-state, like `ZS_TALK`, to the functions with
+     * the `_LOOP`, `_END` and `_INTERRUPT` suffixes belonging to it.
+     *
+     * The original looks those up by name every time a state is started. Since every
+     * NPC in the world switches its routine state at the same time, doing that over
+     * and over gets noticeable. This table is built once after the script symbols have
+     * been loaded, so starting a state doesn't involve any strings.
+     */
+    class AIStateTable
+    {
+    public:
+      /**
+       * Goes through all script functions and registers those with one of the suffixes
+       * for the function with the same name but without the suffix.
+       *
+       * Will drop anything already in the table and thus can be called multiple times.
+       */
+      void build(const Scripting::ScriptSymbolStorage& symbols);
+
+      /**
+       * @param  start  Main-function of the state, e.g. `ZS_TALK`.
+       *
+       * @return The functions of the state with the given main-function. If the function
+       *         has none of the tagged functions, only `start` is set.
+       */
+      AIStateFunctions functionsOf(Scripting::SymbolIndex start) const;
+
+    private:
+      bs::UnorderedMap<Scripting::SymbolIndex, AIStateFunctions> mStates;
+    };
+  }  // namespace AI
+}  // namespace REGoth
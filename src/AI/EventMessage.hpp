@@ -354,9 +354,15 @@ namespace REGoth
       }
 
       /**
-       * Name of the Setupfunction for this state (ZS_...)
+       * Setupfunction for this state (ZS_...). If invalid, the daily routine is continued.
        */
-      bs::String state;
+      Scripting::SymbolIndex state = Scripting::SYMBOL_INDEX_INVALID;
+
+      /**
+       * Name of the state function, as saves from before `state` store it. Only set until
+       * the CharacterEventQueue has looked it up after loading.
+       */
+      bs::String legacyStateName;
 
       /**
        * Whether the old state should be ended properly, or be interrupted and canceled.
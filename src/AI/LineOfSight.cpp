@@ -0,0 +1,315 @@
+#include "LineOfSight.hpp"
+#include <algorithm>
+#include <cmath>
+#include <Physics/BsPhysics.h>
+#include <Utility/BsTime.h>
+#include <log/logging.hpp>
+
+namespace REGoth
+{
+  namespace AI
+  {
+    /**
+     * Number of connections a waypoint can be away from another one to be in its
+     * neighbourhood. Route cleanup only skips over waypoints a few meters apart, so the
+     * waypoints it checks are never far from each other on the waynet.
+     */
+    static constexpr bs::UINT32 NEIGHBOURHOOD_DEPTH = 3;
+
+    /**
+     * Size of the grid positions are snapped to when caching checks between arbitrary
+     * positions, in meters.
+     */
+    static const float POSITION_GRID_SIZE = 0.25f;
+
+    /**
+     * Number of frames results between arbitrary positions are kept.
+     */
+    static constexpr bs::UINT64 POSITION_RESULT_LIFETIME_FRAMES = 10;
+
+    constexpr bs::UINT32 RaycastBatch::NO_WAYPOINT;
+
+    bs::UINT32 RaycastBatch::add(const bs::Vector3& from, const bs::Vector3& to,
+                                 bs::UINT32 fromWaypoint, bs::UINT32 toWaypoint)
+    {
+      Check check;
+      check.from         = from;
+      check.to           = to;
+      check.fromWaypoint = fromWaypoint;
+      check.toWaypoint   = toWaypoint;
+      check.isResolved   = false;
+      check.isClear      = false;
+
+      mChecks.push_back(check);
+
+      return (bs::UINT32)mChecks.size() - 1;
+    }
+
+    void LineOfSightCache::reset(const bs::Vector<bs::UINT32>& edgeOffsets,
+                                 const bs::Vector<bs::UINT32>& neighbours)
+    {
+      mEdgeOffsets = edgeOffsets;
+      mNeighbours  = neighbours;
+
+      mNeighbourhoods.clear();
+      mNeighbourhoods.resize(edgeOffsets.empty() ? 0 : edgeOffsets.size() - 1);
+
+      mPositionResults.clear();
+
+      logStats();
+      mStats = {};
+    }
+
+    void LineOfSightCache::logStats() const
+    {
+      if (mStats.numChecks == 0) return;
+
+      bs::UINT64 numCacheHits = mStats.numWaypointCacheHits + mStats.numPositionCacheHits;
+
+      REGOTH_LOG(Info, Uncategorized,
+                 "[LineOfSightCache] {0} checks, {1}% from cache ({2} waypoint, {3} position "
+                 "hits), {4} raycasts",
+                 mStats.numChecks, numCacheHits * 100 / mStats.numChecks,
+                 mStats.numWaypointCacheHits, mStats.numPositionCacheHits, mStats.numRaycasts);
+    }
+
+    void LineOfSightCache::resolve(RaycastBatch& batch, bs::PhysicsScene& physicsScene)
+    {
+      dropOutdatedPositionResults();
+
+      // First answer whatever the cache knows, so only the remaining checks need rays
+      bs::UINT32 numUnresolved = 0;
+
+      for (RaycastBatch::Check& check : batch.mChecks)
+      {
+        if (check.isResolved) continue;
+
+        mStats.numChecks++;
+
+        Visibility visibility = lookup(check);
+
+        if (visibility == Visibility::Unknown)
+        {
+          numUnresolved++;
+          continue;
+        }
+
+        check.isResolved = true;
+        check.isClear    = visibility == Visibility::Clear;
+      }
+
+      if (numUnresolved == 0) return;
+
+      for (RaycastBatch::Check& check : batch.mChecks)
+      {
+        if (check.isResolved) continue;
+
+        // The same check could be in the batch multiple times, then it's known by now
+        Visibility visibility = lookup(check);
+
+        if (visibility == Visibility::Unknown)
+        {
+          check.isClear = castRay(physicsScene, check.from, check.to);
+          mStats.numRaycasts++;
+
+          store(check, check.isClear);
+        }
+        else
+        {
+          check.isClear = visibility == Visibility::Clear;
+        }
+
+        check.isResolved = true;
+      }
+    }
+
+    bool LineOfSightCache::isClear(const bs::Vector3& from, const bs::Vector3& to,
+                                   bs::PhysicsScene& physicsScene, bs::UINT32 fromWaypoint,
+                                   bs::UINT32 toWaypoint)
+    {
+      RaycastBatch batch;
+      batch.add(from, to, fromWaypoint, toWaypoint);
+
+      resolve(batch, physicsScene);
+
+      return batch.isClear(0);
+    }
+
+    LineOfSightCache::Visibility LineOfSightCache::lookup(const RaycastBatch::Check& check)
+    {
+      bs::UINT32 index = findInNeighbourhood(check.fromWaypoint, check.toWaypoint);
+
+      if (index != RaycastBatch::NO_WAYPOINT)
+      {
+        const Neighbourhood& neighbourhood = mNeighbourhoods[check.fromWaypoint];
+
+        bs::UINT64 bit = 1ULL << (index % 64);
+
+        if (neighbourhood.isKnownBits[index / 64] & bit)
+        {
+          mStats.numWaypointCacheHits++;
+
+          bool isClear = (neighbourhood.isClearBits[index / 64] & bit) != 0;
+
+          return isClear ? Visibility::Clear : Visibility::Blocked;
+        }
+
+        return Visibility::Unknown;
+      }
+
+      auto it = mPositionResults.find(makePositionKey(check.from, check.to));
+
+      if (it == mPositionResults.end()) return Visibility::Unknown;
+
+      mStats.numPositionCacheHits++;
+
+      return it->second ? Visibility::Clear : Visibility::Blocked;
+    }
+
+    void LineOfSightCache::store(const RaycastBatch::Check& check, bool isClear)
+    {
+      bs::UINT32 index = findInNeighbourhood(check.fromWaypoint, check.toWaypoint);
+
+      if (index != RaycastBatch::NO_WAYPOINT)
+      {
+        Neighbourhood& neighbourhood = mNeighbourhoods[check.fromWaypoint];
+
+        bs::UINT64 bit = 1ULL << (index % 64);
+
+        neighbourhood.isKnownBits[index / 64] |= bit;
+
+        if (isClear)
+        {
+          neighbourhood.isClearBits[index / 64] |= bit;
+        }
+
+        return;
+      }
+
+      mPositionResults[makePositionKey(check.from, check.to)] = isClear;
+    }
+
+    bs::UINT32 LineOfSightCache::findInNeighbourhood(bs::UINT32 from, bs::UINT32 to)
+    {
+      if (from >= mNeighbourhoods.size() || to >= mNeighbourhoods.size())
+      {
+        return RaycastBatch::NO_WAYPOINT;
+      }
+
+      if (!mNeighbourhoods[from].isBuilt)
+      {
+        buildNeighbourhood(from);
+      }
+
+      const bs::Vector<bs::UINT32>& waypoints = mNeighbourhoods[from].waypoints;
+
+      auto it = std::lower_bound(waypoints.begin(), waypoints.end(), to);
+
+      if (it == waypoints.end() || *it != to) return RaycastBatch::NO_WAYPOINT;
+
+      return (bs::UINT32)(it - waypoints.begin());
+    }
+
+    void LineOfSightCache::buildNeighbourhood(bs::UINT32 waypoint)
+    {
+      Neighbourhood& neighbourhood      = mNeighbourhoods[waypoint];
+      bs::Vector<bs::UINT32>& waypoints = neighbourhood.waypoints;
+
+      // Breadth first search, one depth at a time. The waypoint itself is included as well,
+      // which doesn't matter.
+      waypoints.push_back(waypoint);
+
+      size_t depthBegin = 0;
+
+      for (bs::UINT32 depth = 0; depth < NEIGHBOURHOOD_DEPTH; depth++)
+      {
+        size_t depthEnd = waypoints.size();
+
+        for (size_t i = depthBegin; i < depthEnd; i++)
+        {
+          bs::UINT32 current = waypoints[i];
+
+          for (bs::UINT32 e = mEdgeOffsets[current]; e < mEdgeOffsets[current + 1]; e++)
+          {
+            bs::UINT32 neighbour = mNeighbours[e];
+
+            if (std::find(waypoints.begin(), waypoints.end(), neighbour) == waypoints.end())
+            {
+              waypoints.push_back(neighbour);
+            }
+          }
+        }
+
+        depthBegin = depthEnd;
+      }
+
+      std::sort(waypoints.begin(), waypoints.end());
+
+      size_t numWords = (waypoints.size() + 63) / 64;
+
+      neighbourhood.isKnownBits.assign(numWords, 0);
+      neighbourhood.isClearBits.assign(numWords, 0);
+      neighbourhood.isBuilt = true;
+    }
+
+    bool LineOfSightCache::PositionKey::operator==(const PositionKey& other) const
+    {
+      return std::equal(std::begin(cells), std::end(cells), std::begin(other.cells));
+    }
+
+    size_t LineOfSightCache::PositionKeyHash::operator()(const PositionKey& key) const
+    {
+      // FNV-1a over the cells
+      bs::UINT64 hash = 0xcbf29ce484222325ULL;
+
+      for (bs::INT32 cell : key.cells)
+      {
+        hash ^= (bs::UINT32)cell;
+        hash *= 0x100000001b3ULL;
+      }
+
+      return (size_t)hash;
+    }
+
+    LineOfSightCache::PositionKey LineOfSightCache::makePositionKey(const bs::Vector3& from,
+                                                                    const bs::Vector3& to)
+    {
+      auto snap = [](float value) { return (bs::INT32)std::floor(value / POSITION_GRID_SIZE); };
+
+      PositionKey key;
+      key.cells[0] = snap(from.x);
+      key.cells[1] = snap(from.y);
+      key.cells[2] = snap(from.z);
+      key.cells[3] = snap(to.x);
+      key.cells[4] = snap(to.y);
+      key.cells[5] = snap(to.z);
+
+      return key;
+    }
+
+    void LineOfSightCache::dropOutdatedPositionResults()
+    {
+      bs::UINT64 frame = bs::gTime().getFrameIdx();
+
+      if (frame < mPositionResultsFrame + POSITION_RESULT_LIFETIME_FRAMES) return;
+
+      mPositionResults.clear();
+      mPositionResultsFrame = frame;
+    }
+
+    bool LineOfSightCache::castRay(bs::PhysicsScene& physicsScene, const bs::Vector3& from,
+                                   const bs::Vector3& to)
+    {
+      bs::Vector3 dir = to - from;
+      float distance  = dir.length();
+
+      if (distance < 0.001f) return true;
+
+      dir /= distance;
+
+      // Only hits in front of the target count, so just don't look any further
+      bs::PhysicsQueryHit hit;
+      return !physicsScene.rayCast(from, dir, hit, BS_ALL_LAYERS, distance);
+    }
+  }  // namespace AI
+}  // namespace REGoth
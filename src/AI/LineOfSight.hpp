@@ -0,0 +1,213 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <Math/BsVector3.h>
+
+namespace bs
+{
+  class PhysicsScene;
+}
+
+namespace REGoth
+{
+  namespace AI
+  {
+    /**
+     * Line-of-sight checks collected to be resolved together, see LineOfSightCache::resolve().
+     *
+     * Collecting the checks first allows answering as many of them as possible from the
+     * cache before casting any rays, and then casting the remaining ones in one go.
+     */
+    class RaycastBatch
+    {
+    public:
+      /**
+       * Passed instead of a waypoint index if a position is not a waypoint.
+       */
+      static constexpr bs::UINT32 NO_WAYPOINT = 0xFFFFFFFF;
+
+      /**
+       * Adds a check whether nothing is blocking the way from `from` to `to`.
+       *
+       * If both positions are the ones of waypoints, their indices should be passed along,
+       * so the result can be cached for every creature walking between them.
+       *
+       * @return Index of the check, to get its result via isClear() once resolved.
+       */
+      bs::UINT32 add(const bs::Vector3& from, const bs::Vector3& to,
+                     bs::UINT32 fromWaypoint = NO_WAYPOINT, bs::UINT32 toWaypoint = NO_WAYPOINT);
+
+      /**
+       * @return Whether the way of the check with the given index is clear. Only valid once
+       *         the batch has been resolved.
+       */
+      bool isClear(bs::UINT32 index) const
+      {
+        return mChecks[index].isClear;
+      }
+
+      bs::UINT32 numChecks() const
+      {
+        return (bs::UINT32)mChecks.size();
+      }
+
+      /**
+       * Removes all checks, so the batch can be reused.
+       */
+      void clear()
+      {
+        mChecks.clear();
+      }
+
+    private:
+      friend class LineOfSightCache;
+
+      struct Check
+      {
+        bs::Vector3 from;
+        bs::Vector3 to;
+        bs::UINT32 fromWaypoint;
+        bs::UINT32 toWaypoint;
+        bool isResolved;
+        bool isClear;
+      };
+
+      bs::Vector<Check> mChecks;
+    };
+
+    /**
+     * Remembers which positions can be seen from each other, so creatures don't need to
+     * cast the same rays over and over again.
+     *
+     * There are two kinds of results stored in here:
+     *
+     *  - Between waypoints: Results are kept for as long as the waynet doesn't change. To
+     *    keep memory in check, only the waypoints near each other on the waynet are stored:
+     *    Each waypoint has a *neighbourhood* made of the waypoints reachable over a few
+     *    connections, which is found once the waypoint is first looked at. The results for
+     *    those are stored as bits, by the index of the other waypoint inside the
+     *    neighbourhood. These are the checks route cleanup does.
+     *
+     *  - Between arbitrary positions: Results are keyed by the positions snapped to a small
+     *    grid and dropped after a few frames, since things are moving. This is for creatures
+     *    following another one, where several of them tend to check similar rays.
+     *
+     * Results are stored per direction, as a ray might hit a surface from one side only.
+     */
+    class LineOfSightCache
+    {
+    public:
+      /**
+       * Counters of how much work the cache saved.
+       */
+      struct Stats
+      {
+        bs::UINT64 numChecks            = 0;
+        bs::UINT64 numWaypointCacheHits = 0;
+        bs::UINT64 numPositionCacheHits = 0;
+        bs::UINT64 numRaycasts          = 0;
+      };
+
+      /**
+       * Drops all results and sets the graph the waypoint neighbourhoods are found in. The
+       * neighbours of the waypoint with index `i` are `neighbours[edgeOffsets[i]]` up to
+       * (excluding) `neighbours[edgeOffsets[i + 1]]`.
+       *
+       * The stats of the previous graph are logged and reset as well.
+       */
+      void reset(const bs::Vector<bs::UINT32>& edgeOffsets,
+                 const bs::Vector<bs::UINT32>& neighbours);
+
+      /**
+       * Resolves all checks of the batch, answering as many as possible from the cache and
+       * casting rays for the rest. Results of cast rays are stored in the cache.
+       */
+      void resolve(RaycastBatch& batch, bs::PhysicsScene& physicsScene);
+
+      /**
+       * Resolves a single check, see RaycastBatch::add().
+       */
+      bool isClear(const bs::Vector3& from, const bs::Vector3& to, bs::PhysicsScene& physicsScene,
+                   bs::UINT32 fromWaypoint = RaycastBatch::NO_WAYPOINT,
+                   bs::UINT32 toWaypoint   = RaycastBatch::NO_WAYPOINT);
+
+      const Stats& stats() const
+      {
+        return mStats;
+      }
+
+      /**
+       * Logs stats(), if any checks have been made.
+       */
+      void logStats() const;
+
+    private:
+      enum class Visibility : bs::UINT8
+      {
+        Unknown,
+        Clear,
+        Blocked,
+      };
+
+      struct Neighbourhood
+      {
+        bool isBuilt = false;
+
+        /**
+         * Waypoints in the neighbourhood, sorted by index.
+         */
+        bs::Vector<bs::UINT32> waypoints;
+
+        /**
+         * One bit per waypoint in `waypoints`, telling whether a result is known and
+         * whether the way to it is clear.
+         */
+        bs::Vector<bs::UINT64> isKnownBits;
+        bs::Vector<bs::UINT64> isClearBits;
+      };
+
+      /**
+       * Positions of a check snapped to the grid, see POSITION_GRID_SIZE.
+       */
+      struct PositionKey
+      {
+        bs::INT32 cells[6];
+
+        bool operator==(const PositionKey& other) const;
+      };
+
+      struct PositionKeyHash
+      {
+        size_t operator()(const PositionKey& key) const;
+      };
+
+      Visibility lookup(const RaycastBatch::Check& check);
+      void store(const RaycastBatch::Check& check, bool isClear);
+
+      /**
+       * @return Index of `to` inside the neighbourhood of `from`, or NO_WAYPOINT if it is
+       *         not in there. Finds the neighbourhood if that has not been done yet.
+       */
+      bs::UINT32 findInNeighbourhood(bs::UINT32 from, bs::UINT32 to);
+      void buildNeighbourhood(bs::UINT32 waypoint);
+
+      static PositionKey makePositionKey(const bs::Vector3& from, const bs::Vector3& to);
+
+      /**
+       * Drops the position results if they have become too old.
+       */
+      void dropOutdatedPositionResults();
+
+      static bool castRay(bs::PhysicsScene& physicsScene, const bs::Vector3& from,
+                          const bs::Vector3& to);
+
+      bs::Vector<bs::UINT32> mEdgeOffsets;
+      bs::Vector<bs::UINT32> mNeighbours;
+      bs::Vector<Neighbourhood> mNeighbourhoods;
+
+      bs::UnorderedMap<PositionKey, bool, PositionKeyHash> mPositionResults;
+      bs::UINT64 mPositionResultsFrame = 0;
+
+      Stats mStats;
+    };
+  }  // namespace AI
+}  // namespace REGoth
@@ -8,12 +8,30 @@
 #include <components/Waynet.hpp>
 #include <components/Waypoint.hpp>
 #include <log/logging.hpp>
+#include <world/NavMesh.hpp>
 
 static const float MAX_SIDE_DIFFERENCE_TO_REACH_POSITION     = 1.0f;  // Meters
 static const float MAX_HEIGHT_DIFFERENCE_TO_REACH_POSITION   = 2.0f;  // Meters
 static const float MAX_TARGET_ENTITY_MOVEMENT_BEFORE_REROUTE = 5.0f;  // Meters
 static const float MAX_POINT_DISTANCE_FOR_CLEANUP            = 5.0f;  // Meters
 
+/**
+ * Number of positions the route should at least have ahead before refining more milestones.
+ * Enough for cleanupRoute() to have something to work with.
+ */
+static const size_t MIN_POSITIONS_AHEAD_ON_ROUTE = 8;
+
+/**
+ * Targets up to this far away are tried to be reached over the navmesh only. Also the
+ * farthest a line of sight is checked on the navmesh instead of by raycast.
+ */
+static const float MAX_NAVMESH_CORRIDOR_DISTANCE = 30.0f;  // Meters
+
+/**
+ * Number of navmesh spans a corridor search may look at, see NavMesh::findCorridor().
+ */
+static const bs::UINT32 MAX_NAVMESH_SEARCHED_SPANS = 4096;
+
 namespace REGoth
 {
   namespace AI
@@ -30,18 +48,28 @@ namespace REGoth
     Pathfinder::MovementReport Pathfinder::checkMoveToLocation(const bs::Vector3& from,
                                                                const bs::Vector3& to) const
     {
-      MovementReport report;
+      MovementReport report = {};
       bs::Vector3 fromGround = from - bs::Vector3(0, mUserConfiguration.height, 0);
       bs::Vector3 toGround   = to - bs::Vector3(0, mUserConfiguration.height, 0);
 
       report.lowerThanStepHeight  = (to.y - from.y) < -mUserConfiguration.stepHeight;
       report.higherThanStepHeight = (to.y - from.y) > mUserConfiguration.stepHeight;
 
-      report.ceilingTooLow = findCeilingHeightAtPosition(toGround) > mUserConfiguration.height;
+      report.ceilingTooLow = findCeilingHeightAtPosition(toGround) < mUserConfiguration.height;
+
+      // The navmesh only connects what can be walked on, which already takes steep slopes
+      // and steps into account. It is baked from the world mesh only though, so vobs in
+      // the way still need a raycast.
+      if (mNavMesh && !mNavMesh->isWalkableLine(fromGround, toGround))
+      {
+        report.hardCollision = true;
+      }
+      else
+      {
+        report.hardCollision = !mWaynet->lineOfSight().isClear(from, to, physicsScene());
+      }
 
-      // TODO: Reimplement using bsf
-      // Physics::RayTestResult hit = m_World.getPhysicsSystem().raytrace(from, to);
-      // report.hardCollision       = hit.hasHit;
+      // TODO: Reimplement the rest using bsf, if the navmesh is not enough
 
       // size_t destGroundTriangle = getGroundTriangleIndexAt(to);
 
@@ -74,6 +102,11 @@ namespace REGoth
 
     float Pathfinder::findCeilingHeightAtPosition(const bs::Vector3& floorposition) const
     {
+      if (mNavMesh)
+      {
+        return mNavMesh->clearanceAt(floorposition);
+      }
+
       return std::numeric_limits<float>::max();
 
       bs::PhysicsQueryHit hit;
@@ -103,7 +136,8 @@ namespace REGoth
       if (!mActiveRoute.targetEntity)
 
         // FIXME: This goes wrong if an npc ever gets stuck or the heights don't match
-        return mActiveRoute.positionsToGo.empty();
+        return !hasPositionsToGo() && mActiveRoute.milestonesToRefine.empty() &&
+               !mActiveRoute.shouldAppendDestination;
 
       return hasTargetEntityBeenReached(positionNow);
     }
@@ -125,12 +159,14 @@ namespace REGoth
 
       if (hasNextRouteTargetBeenReached(positionNow))
       {
-        if (!mActiveRoute.positionsToGo.empty())
+        if (hasPositionsToGo())
         {
-          mActiveRoute.positionsToGo.pop_front();
+          mActiveRoute.nextPositionIndex++;
         }
       }
 
+      refineRouteAhead();
+
       if (hasActiveRouteBeenCompleted(positionNow))
       {
         inst.targetPosition = positionNow;
@@ -145,8 +181,7 @@ namespace REGoth
         }
         else
         {
-          assert(!mActiveRoute.positionsToGo.empty());
-          startNewRouteTo(positionNow, mActiveRoute.positionsToGo.back());
+          startNewRouteTo(positionNow, mActiveRoute.destination);
         }
       }
 
@@ -157,12 +192,12 @@ namespace REGoth
 
     bool Pathfinder::hasNextRouteTargetBeenReached(const bs::Vector3& positionNow) const
     {
-      if (mActiveRoute.positionsToGo.empty())
+      if (!hasPositionsToGo())
       {
         return isTargetAnEntity() && hasTargetEntityBeenReached(positionNow);
       }
 
-      return isTargetReachedByPosition(positionNow, mActiveRoute.positionsToGo.front());
+      return isTargetReachedByPosition(positionNow, nextPositionToGo());
     }
 
     bool Pathfinder::hasTargetEntityBeenReached(const bs::Vector3& positionNow) const
@@ -201,13 +236,13 @@ namespace REGoth
         return targetEntityPosition;
       }
 
-      if (mActiveRoute.positionsToGo.empty())
+      if (!hasPositionsToGo())
       {
         return targetEntityPosition;
       }
       else
       {
-        return mActiveRoute.positionsToGo.front();
+        return nextPositionToGo();
       }
     }
 
@@ -216,14 +251,7 @@ namespace REGoth
       // Must be set for getTargetEntityPosition to work
       mActiveRoute.targetEntity = entity;
 
-      startNewRouteTo(positionNow, getTargetEntityPosition());
-
-      // startNewRouteTo appends the position to go to if it's off the waynet, we can't have that
-      // when the target could be moving
-      if (!mActiveRoute.positionsToGo.empty())
-      {
-        mActiveRoute.positionsToGo.pop_back();
-      }
+      startNewRouteTo(positionNow, getTargetEntityPosition(), true);
 
       mActiveRoute.targetEntity = entity;
 
@@ -232,26 +260,47 @@ namespace REGoth
     }
 
     void Pathfinder::startNewRouteTo(const bs::Vector3& positionNow, const bs::Vector3& position)
+    {
+      startNewRouteTo(positionNow, position, false);
+    }
+
+    void Pathfinder::startNewRouteTo(const bs::Vector3& positionNow, const bs::Vector3& position,
+                                     bool isTargetAnEntity)
     {
       mActiveRoute.positionsToGo.clear();
-      mActiveRoute.lastKnownPosition   = positionNow;
-      mActiveRoute.targetEntity        = {};
-      mActiveRoute.isTargetUnreachable = false;
+      mActiveRoute.waypointsToGo.clear();
+      mActiveRoute.nextPositionIndex = 0;
+      mActiveRoute.milestonesToRefine.clear();
+      mActiveRoute.lastRefinedWaypoint     = {};
+      mActiveRoute.destination             = position;
+      mActiveRoute.hasDestination          = true;
+      mActiveRoute.shouldAppendDestination = false;
+      mActiveRoute.lastKnownPosition       = positionNow;
+      mActiveRoute.targetEntity            = {};
+      mActiveRoute.isTargetUnreachable     = false;
 
       if (isTargetReachedByPosition(positionNow, position)) return;
 
+      if (tryRouteOverNavMesh(positionNow, position, isTargetAnEntity)) return;
+
       if (canDirectlyMovetoLocation(positionNow, position))
       {
-        mActiveRoute.positionsToGo.push_back(position);
+        // Moving targets are walked to directly, see getCurrentTargetPosition()
+        if (!isTargetAnEntity)
+        {
+          pushPositionToGo(position, RaycastBatch::NO_WAYPOINT);
+        }
+
         return;
       }
 
       HWaypoint nearestWpToTarget = mWaynet->findClosestWaypointTo(position).closest;
       HWaypoint nearestWpToStart  = mWaynet->findClosestWaypointTo(positionNow).closest;
 
-      bs::Vector<HWaypoint> path = mWaynet->findWay(nearestWpToStart, nearestWpToTarget);
+      bs::Vector<HWaypoint> milestones =
+          mWaynet->findMilestones(nearestWpToStart, nearestWpToTarget);
 
-      if (path.empty())
+      if (milestones.empty())
       {
         // We already checked whether we can directly move here. So since it's not possible
         // via the waynet, just exit here.
@@ -262,55 +311,235 @@ namespace REGoth
         return;
       }
 
-      for (auto wp : path)
+      mActiveRoute.milestonesToRefine = std::move(milestones);
+
+      // If the last position is off the waynet, add it as explicit position. Can't have that
+      // when the target could be moving.
+      const bs::Vector3& lastWaypointPosition = nearestWpToTarget->SO()->getTransform().pos();
+
+      if (!isTargetAnEntity && !isTargetReachedByPosition(lastWaypointPosition, position))
+      {
+        mActiveRoute.shouldAppendDestination = true;
+      }
+
+      refineRouteAhead();
+    }
+
+    bool Pathfinder::tryRouteOverNavMesh(const bs::Vector3& positionNow,
+                                         const bs::Vector3& target, bool isTargetAnEntity)
+    {
+      if (!mNavMesh) return false;
+
+      if (positionNow.distance(target) > MAX_NAVMESH_CORRIDOR_DISTANCE) return false;
+
+      if (!pushCorridor(positionNow, target))
       {
-        const bs::Vector3& wpPosition = wp->SO()->getTransform().pos();
+        return false;
+      }
 
-        mActiveRoute.positionsToGo.push_back(wpPosition);
+      // Moving targets are walked to directly once the corridor is done, see
+      // getCurrentTargetPosition()
+      if (!isTargetAnEntity)
+      {
+        pushPositionToGo(target, RaycastBatch::NO_WAYPOINT);
       }
 
-      bool isDestinationOffWaynet = false;
+      return true;
+    }
+
+    bool Pathfinder::pushCorridor(const bs::Vector3& from, const bs::Vector3& to)
+    {
+      if (!mNavMesh) return false;
+
+      bs::Vector<bs::Vector3> corridor =
+          mNavMesh->findCorridor(from, to, MAX_NAVMESH_SEARCHED_SPANS);
+
+      if (corridor.empty()) return false;
+
+      // The navmesh is baked from the world mesh only, so check the corridor for vobs in
+      // the way. Its positions are on the floor, so cast the rays at half the creature's
+      // height, which also keeps them clear of anything low enough to step over.
+      const bs::Vector3 rayOffset(0, mUserConfiguration.height * 0.5f, 0);
 
-      if (mActiveRoute.positionsToGo.empty())
+      for (size_t i = 1; i < corridor.size(); i++)
       {
-        isDestinationOffWaynet = true;
+        if (!mWaynet->lineOfSight().isClear(corridor[i - 1] + rayOffset,
+                                            corridor[i] + rayOffset, physicsScene()))
+        {
+          return false;
+        }
       }
 
-      if (!isTargetReachedByPosition(mActiveRoute.positionsToGo.back(), position))
+      for (size_t i = 1; i + 1 < corridor.size(); i++)
       {
-        isDestinationOffWaynet = true;
+        pushPositionToGo(corridor[i], RaycastBatch::NO_WAYPOINT);
       }
 
-      // If the last position is off the waynet, add it as explicit position
-      if (isDestinationOffWaynet)
+      return true;
+    }
+
+    void Pathfinder::refineRouteAhead()
+    {
+      auto& route = mActiveRoute;
+
+      if (route.isTargetUnreachable) return;
+
+      if (numPositionsToGo() >= MIN_POSITIONS_AHEAD_ON_ROUTE) return;
+
+      if (route.milestonesToRefine.empty() && !route.shouldAppendDestination) return;
+
+      dropReachedPositions();
+
+      bool hasAppended = false;
+
+      while (numPositionsToGo() < MIN_POSITIONS_AHEAD_ON_ROUTE)
       {
-        mActiveRoute.positionsToGo.push_back(position);
+        if (route.milestonesToRefine.empty())
+        {
+          if (route.shouldAppendDestination)
+          {
+            // The destination is off the waynet, so find the way over there on the navmesh
+            if (hasPositionsToGo())
+            {
+              pushCorridor(route.positionsToGo.back(), route.destination);
+            }
+
+            pushPositionToGo(route.destination, RaycastBatch::NO_WAYPOINT);
+            route.shouldAppendDestination = false;
+            hasAppended                   = true;
+          }
+
+          break;
+        }
+
+        HWaypoint milestone = route.milestonesToRefine.front();
+        route.milestonesToRefine.erase(route.milestonesToRefine.begin());
+
+        if (!route.lastRefinedWaypoint)
+        {
+          // Very first milestone is where the route starts. The creature might not be on the
+          // waynet yet, so get there over the navmesh.
+          const bs::Vector3& milestonePosition = milestone->SO()->getTransform().pos();
+
+          pushCorridor(route.lastKnownPosition, milestonePosition);
+          pushPositionToGo(milestonePosition, mWaynet->indexOf(milestone));
+          route.lastRefinedWaypoint = milestone;
+          hasAppended               = true;
+          continue;
+        }
+
+        bs::Vector<HWaypoint> path = mWaynet->findWay(route.lastRefinedWaypoint, milestone);
+
+        if (path.empty())
+        {
+          // Milestones are always connected, so this means the waynet changed
+          route.milestonesToRefine.clear();
+          route.shouldAppendDestination = false;
+          route.isTargetUnreachable     = true;
+          break;
+        }
+
+        // First one is the last refined waypoint, which is on the route already
+        for (size_t i = 1; i < path.size(); i++)
+        {
+          pushPositionToGo(path[i]->SO()->getTransform().pos(), mWaynet->indexOf(path[i]));
+        }
+
+        route.lastRefinedWaypoint = milestone;
+        hasAppended               = true;
       }
 
-      cleanupRoute();
+      if (hasAppended)
+      {
+        cleanupRoute();
+      }
     }
 
-    bool Pathfinder::canDirectlyMovetoLocation(const bs::Vector3& from, const bs::Vector3& to) const
+    bool Pathfinder::hasPositionsToGo() const
     {
-      if (isTargetReachedByPosition(from, to)) return true;
+      return mActiveRoute.nextPositionIndex < mActiveRoute.positionsToGo.size();
+    }
 
-      bs::PhysicsQueryHit hit;
+    size_t Pathfinder::numPositionsToGo() const
+    {
+      if (!hasPositionsToGo()) return 0;
 
-      // FIXME: This breaks when the creature should go down a slope but is
-      // standing on the top of it right now
+      return mActiveRoute.positionsToGo.size() - mActiveRoute.nextPositionIndex;
+    }
+
+    const bs::Vector3& Pathfinder::nextPositionToGo() const
+    {
+      assert(hasPositionsToGo());
+
+      return mActiveRoute.positionsToGo[mActiveRoute.nextPositionIndex];
+    }
 
-      bs::Vector3 dir = to - from;
-      float distance  = dir.length();
+    void Pathfinder::pushPositionToGo(const bs::Vector3& position, bs::UINT32 waypoint)
+    {
+      // Routes from older saves don't have waypoints stored
+      mActiveRoute.waypointsToGo.resize(mActiveRoute.positionsToGo.size(),
+                                        RaycastBatch::NO_WAYPOINT);
+
+      mActiveRoute.positionsToGo.push_back(position);
+      mActiveRoute.waypointsToGo.push_back(waypoint);
+    }
+
+    bs::UINT32 Pathfinder::waypointToGoAt(size_t index) const
+    {
+      if (index >= mActiveRoute.waypointsToGo.size()) return RaycastBatch::NO_WAYPOINT;
+
+      return mActiveRoute.waypointsToGo[index];
+    }
+
+    void Pathfinder::dropReachedPositions()
+    {
+      auto& route = mActiveRoute;
 
-      dir /= distance;
+      if (route.nextPositionIndex == 0) return;
 
-      if (!physicsScene().rayCast(from, dir, hit))
+      size_t numReached = std::min((size_t)route.nextPositionIndex, route.positionsToGo.size());
+
+      route.positionsToGo.erase(route.positionsToGo.begin(),
+                                route.positionsToGo.begin() + numReached);
+
+      if (route.waypointsToGo.size() >= numReached)
       {
-        return true;
+        route.waypointsToGo.erase(route.waypointsToGo.begin(),
+                                  route.waypointsToGo.begin() + numReached);
+      }
+      else
+      {
+        route.waypointsToGo.clear();
       }
 
-      // It's okay if the hit is furhter back than our target point
-      return hit.distance > distance;
+      route.nextPositionIndex = 0;
+    }
+
+    bool Pathfinder::canDirectlyMovetoLocation(const bs::Vector3& from, const bs::Vector3& to,
+                                               bs::UINT32 fromWaypoint,
+                                               bs::UINT32 toWaypoint) const
+    {
+      if (isTargetReachedByPosition(from, to)) return true;
+
+      // Between waypoints, cached raycasts are good enough. Elsewhere, the navmesh knows
+      // better where the creature can't walk, if both positions are on it. It doesn't know
+      // about vobs though, so a walkable line still needs the raycast.
+      bool isBetweenWaypoints =
+          fromWaypoint != RaycastBatch::NO_WAYPOINT && toWaypoint != RaycastBatch::NO_WAYPOINT;
+
+      if (mNavMesh && !isBetweenWaypoints && from.distance(to) <= MAX_NAVMESH_CORRIDOR_DISTANCE)
+      {
+        if (mNavMesh->isOnNavMesh(from) && mNavMesh->isOnNavMesh(to) &&
+            !mNavMesh->isWalkableLine(from, to))
+        {
+          return false;
+        }
+      }
+
+      // FIXME: This breaks when the creature should go down a slope but is
+      // standing on the top of it right now
+
+      return mWaynet->lineOfSight().isClear(from, to, physicsScene(), fromWaypoint, toWaypoint);
     }
 
     void Pathfinder::debugDrawRoute(const bs::Vector3& positionNow)
@@ -340,54 +569,117 @@ namespace REGoth
       //          There is also a maximum distance these point can be apart from each other, so NPCs
       //          would still respect paths on the worldmesh.
 
-      if (mActiveRoute.positionsToGo.size() < 3) return;
+      if (numPositionsToGo() < 3) return;
+
+      dropReachedPositions();
+
+      auto& route = mActiveRoute;
+
+      const size_t last           = route.positionsToGo.size() - 1;
+      const float maxDistToPrevSq = MAX_POINT_DISTANCE_FOR_CLEANUP * MAX_POINT_DISTANCE_FOR_CLEANUP;
+
+      // The first and the last position are always kept
+      bs::Vector<size_t> kept;
+      kept.push_back(0);
+
+      // Index of the raycast each position needs to be removed, or noCheck if it doesn't need one
+      const bs::UINT32 noCheck = std::numeric_limits<bs::UINT32>::max();
+
+      RaycastBatch batch;
+      bs::Vector<bs::UINT32> checks;
 
-      bool removed;
+      size_t candidate = 1;
 
-      do
+      while (candidate < last)
       {
-        removed = false;
-        for (auto it = mActiveRoute.positionsToGo.begin(); it != mActiveRoute.positionsToGo.end();
-             it++)
+        const size_t prev = kept.back();
+
+        // Gather all positions which could be skipped when coming from `prev`. Since they have to
+        // be close to it, there are only a few.
+        batch.clear();
+        checks.clear();
+
+        size_t furthestRemovable = 0;
+
+        for (size_t it = candidate; it < last; it++)
         {
-          if (canRoutePositionBeRemoved(it))
+          float distToPrevSq = (route.positionsToGo[it] - route.positionsToGo[prev]).squaredLength();
+
+          // Only remove points which aren't too far appart
+          if (distToPrevSq > maxDistToPrevSq) break;
+
+          // Being redundant doesn't tell anything about the positions between `prev` and `it`,
+          // so only the one right behind `prev` can go without a raycast
+          if (it == candidate && isRoutePositionRedundant(prev, it))
           {
-            it      = mActiveRoute.positionsToGo.erase(it);
-            removed = true;
+            furthestRemovable = it;
+            checks.push_back(noCheck);
+            continue;
           }
+
+          checks.push_back(batch.add(route.positionsToGo[prev], route.positionsToGo[it + 1],
+                                     waypointToGoAt(prev), waypointToGoAt(it + 1)));
         }
-      } while (removed);
-    }
 
-    bool Pathfinder::canRoutePositionBeRemoved(std::list<bs::Vector3>::iterator it)
-    {
-      if (it == mActiveRoute.positionsToGo.begin()) return false;
+        if (batch.numChecks() > 0)
+        {
+          mWaynet->lineOfSight().resolve(batch, physicsScene());
 
-      if (it == mActiveRoute.positionsToGo.end()) return false;
+          for (size_t i = 0; i < checks.size(); i++)
+          {
+            if (checks[i] != noCheck && batch.isClear(checks[i]))
+            {
+              furthestRemovable = std::max(furthestRemovable, candidate + i);
+            }
+          }
+        }
+
+        if (furthestRemovable != 0)
+        {
+          // Going directly from `prev` to the one behind works, so everything in between can go
+          candidate = furthestRemovable + 1;
+        }
+        else
+        {
+          kept.push_back(candidate);
+          candidate++;
+        }
+      }
 
-      if (it == std::prev(mActiveRoute.positionsToGo.end())) return false;
+      kept.push_back(last);
 
-      auto prev = std::prev(it);
-      auto next = std::next(it);
+      if (kept.size() == route.positionsToGo.size()) return;
 
-      float distToPrevSq    = ((*it) - (*prev)).squaredLength();
-      float maxDistToPrevSq = MAX_POINT_DISTANCE_FOR_CLEANUP * MAX_POINT_DISTANCE_FOR_CLEANUP;
+      bs::Vector<bs::Vector3> positions;
+      bs::Vector<bs::UINT32> waypoints;
 
-      // Only remove points which aren't too far appart
-      if (distToPrevSq > maxDistToPrevSq) return false;
+      positions.reserve(kept.size());
+      waypoints.reserve(kept.size());
 
-      const bool samePosition =
-          isTargetReachedByPosition(*prev, *it) || isTargetReachedByPosition(*next, *it);
+      for (size_t index : kept)
+      {
+        positions.push_back(route.positionsToGo[index]);
+        waypoints.push_back(waypointToGoAt(index));
+      }
 
-      if (samePosition) return true;
+      route.positionsToGo = std::move(positions);
+      route.waypointsToGo = std::move(waypoints);
+    }
 
-      const bool detour = isTargetReachedByPosition(*prev, *next);
+    bool Pathfinder::isRoutePositionRedundant(size_t prev, size_t it) const
+    {
+      const auto& positions = mActiveRoute.positionsToGo;
+
+      const size_t next = it + 1;
 
-      if (detour) return true;
+      const bool samePosition = isTargetReachedByPosition(positions[prev], positions[it]) ||
+                                isTargetReachedByPosition(positions[next], positions[it]);
+
+      if (samePosition) return true;
 
-      bool canMoveDirectlytoNext = canDirectlyMovetoLocation(*prev, *next);
+      const bool detour = isTargetReachedByPosition(positions[prev], positions[next]);
 
-      return canMoveDirectlytoNext;
+      return detour;
     }
 
     bool Pathfinder::shouldReRoute(const bs::Vector3& positionNow) const
@@ -410,7 +702,7 @@ namespace REGoth
 
       if (!isTargetAnEntity())
       {
-        if (mActiveRoute.positionsToGo.empty())
+        if (!hasPositionsToGo())
         {
           return false;
         }
@@ -422,7 +714,7 @@ namespace REGoth
         return false;
       }
 
-      if (mActiveRoute.positionsToGo.empty())
+      if (!hasPositionsToGo())
       {
         if (!canDirectlyMovetoLocation(positionNow, getTargetEntityPosition()))
         {
@@ -1,6 +1,7 @@
 #pragma once
 #include <BsCorePrerequisites.h>
 #include <Math/BsVector3.h>
+#include <AI/LineOfSight.hpp>
 #include <RTTI/RTTIUtil.hpp>
 
 namespace bs
@@ -15,6 +16,8 @@ namespace REGoth
   class Waypoint;
   using HWaypoint = bs::GameObjectHandle<Waypoint>;
 
+  class NavMesh;
+
   namespace AI
   {
     /**
@@ -32,19 +35,48 @@ namespace REGoth
         bs::Vector3 targetPosition;
       };
 
+      /**
+       * Size of the creature. Defaults fit a human, which is also what the navmesh of a
+       * world is baked for.
+       */
       struct UserConfiguration
       {
-        float height;
-        float radius;
-        float stepHeight;
-        float maxSlopeAngle;
+        float height        = 1.8f;
+        float radius        = 0.4f;
+        float stepHeight    = 0.5f;
+        float maxSlopeAngle = 0.87f;  // Radians, about 50 degrees
       };
 
       struct Route
       {
         bs::Vector3 lastKnownPosition;
 
-        bs::List<bs::Vector3> positionsToGo;
+        // Positions to walk to, starting at nextPositionIndex. The ones before have already
+        // been reached and are dropped once more positions are added. On long routes, this
+        // does not hold the whole route but is filled up from the milestones as the creature
+        // gets closer to them.
+        bs::Vector<bs::Vector3> positionsToGo;
+        bs::UINT32 nextPositionIndex = 0;
+
+        // Index of the waypoint at each position in positionsToGo, so line of sight checks
+        // between them can be cached, see Waynet::lineOfSight(). RaycastBatch::NO_WAYPOINT
+        // for positions not on the waynet.
+        bs::Vector<bs::UINT32> waypointsToGo;
+
+        // Milestones of the route which have not been turned into positionsToGo yet, see
+        // Waynet::findMilestones(). The waypoints in between are searched once needed,
+        // starting from lastRefinedWaypoint.
+        bs::Vector<HWaypoint> milestonesToRefine;
+        HWaypoint lastRefinedWaypoint;
+
+        // Position the route should end at. If shouldAppendDestination is set, this is added to
+        // positionsToGo once all milestones have been refined, since it's off the waynet.
+        bs::Vector3 destination;
+        bool shouldAppendDestination = false;
+
+        // Saves made before the destination was saved don't have it. Those routes still have
+        // all of their positions in positionsToGo, so the last one is used instead.
+        bool hasDestination = false;
 
         // If this is valid, the Creature will move to this entity, once it has been to
         // all positions it had to go to or has a direct line of sight to it
@@ -92,12 +124,83 @@ namespace REGoth
         return mUserConfiguration;
       }
 
+      /**
+       * Sets the navmesh of the world, used for moving near the start and the end of a route,
+       * where there is no waynet. Without one, raycasts are used instead. Not saved, must be
+       * set again after loading.
+       */
+      void setNavMesh(bs::SPtr<NavMesh> navMesh)
+      {
+        mNavMesh = navMesh;
+      }
+
       /**
        * @return Whether the Pathfinder thinks the given targetposition has been reached
        */
       static bool isTargetReachedByPosition(const bs::Vector3& position, const bs::Vector3& target);
 
     private:
+      /**
+       * Starts a new route to the given position. If the position is the one of a target
+       * entity, it will not be added as the last position to go to, since the entity could
+       * be moving. See startNewRouteTo().
+       */
+      void startNewRouteTo(const bs::Vector3& positionNow, const bs::Vector3& target,
+                           bool isTargetAnEntity);
+
+      /**
+       * Tries to start the route as a corridor over the navmesh, which only works for targets
+       * close enough. See startNewRouteTo().
+       *
+       * @return Whether a corridor to the target has been found and set as route. If not,
+       *         the route has to go over the waynet instead.
+       */
+      bool tryRouteOverNavMesh(const bs::Vector3& positionNow, const bs::Vector3& target,
+                               bool isTargetAnEntity);
+
+      /**
+       * Appends the positions of a corridor over the navmesh from `from` to `to` to the active
+       * route, excluding both `from` and `to`. Nothing is appended if there is no navmesh,
+       * both are close enough to walk straight or a vob is blocking the corridor.
+       *
+       * @return Whether a corridor was found and nothing is blocking it.
+       */
+      bool pushCorridor(const bs::Vector3& from, const bs::Vector3& to);
+
+      /**
+       * Searches the waypoints between the next milestones of the active route and appends
+       * them to positionsToGo, until there are enough positions ahead or all milestones have
+       * been refined.
+       */
+      void refineRouteAhead();
+
+      /**
+       * Access to the positions of the active route which have not been reached yet.
+       */
+      bool hasPositionsToGo() const;
+      size_t numPositionsToGo() const;
+      const bs::Vector3& nextPositionToGo() const;
+
+      /**
+       * Appends a position to the active route.
+       *
+       * @param  waypoint  Index of the waypoint at that position. RaycastBatch::NO_WAYPOINT
+       *                   if it's not on the waynet.
+       */
+      void pushPositionToGo(const bs::Vector3& position, bs::UINT32 waypoint);
+
+      /**
+       * @return Index of the waypoint at the position with the given index inside
+       *         positionsToGo. RaycastBatch::NO_WAYPOINT if there is none or not known, as
+       *         with routes saved before waypoints were stored.
+       */
+      bs::UINT32 waypointToGoAt(size_t index) const;
+
+      /**
+       * Drops the positions which have already been reached.
+       */
+      void dropReachedPositions();
+
       struct MovementReport
       {
         bool lowerThanStepHeight;
@@ -120,9 +223,12 @@ namespace REGoth
 
       /**
        * Performs a series of checks on whether the creature could directly walk to the given
-       * location
+       * location. Results are cached inside the waynet, see Waynet::lineOfSight(). If both
+       * locations are waypoints, pass their indices so the result is kept for longer.
        */
-      bool canDirectlyMovetoLocation(const bs::Vector3& from, const bs::Vector3& to) const;
+      bool canDirectlyMovetoLocation(const bs::Vector3& from, const bs::Vector3& to,
+                                     bs::UINT32 fromWaypoint = RaycastBatch::NO_WAYPOINT,
+                                     bs::UINT32 toWaypoint   = RaycastBatch::NO_WAYPOINT) const;
 
       /**
        * @param  floorposition  Position on the floor. The length from that position to the
@@ -186,13 +292,19 @@ namespace REGoth
        * Sometimes, the waynet isn't exactly detailed and NPCs take some weird looking detours
        * instead of going straight. This function uses raytraces to check which points on the route
        * can be erased because there are not obstacles on the way to them
+       *
+       * Goes over the route once: For each position kept, all positions close enough behind it
+       * are checked in one batch, and as many of them are skipped as possible.
        */
       void cleanupRoute();
 
       /**
-       * @return Whether the route-position on the given iterator can be removed. See cleanupRoute().
+       * @return Whether the route-position at index `it` can be removed without a raycast,
+       *         if the one at `prev` is the position right before it. That is the case if it
+       *         is at the same spot as one of its neighbours, or if the route goes back to
+       *         `prev` afterwards. See cleanupRoute().
        */
-      bool canRoutePositionBeRemoved(std::list<bs::Vector3>::iterator it);
+      bool isRoutePositionRedundant(size_t prev, size_t it) const;
 
       /**
        * @return Whether the currently active route is considered not up-to-date and should be
@@ -219,6 +331,11 @@ namespace REGoth
 
       HWaynet mWaynet;
 
+      /**
+       * See setNavMesh(). Can be null.
+       */
+      bs::SPtr<NavMesh> mNavMesh;
+
     public:
       REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(Pathfinder);
 
@@ -74,8 +74,9 @@ namespace REGoth
       mStateVictim = scriptVM().victimInstance();
       mStateItem   = scriptVM().itemInstance();
 
-      // Save name to the main function, to which we can append the tags like _LOOP and _END
-      mNextState.name        = s_NativeStateNames[index];
+      const auto& symbols = scriptVM().scriptSymbolsConst();
+
+      mNextState.symIndex    = symbols.findIndexBySymbolName(s_NativeStateNames[index]);
       mNextState.nativeState = state;
 
       fillStateScriptFunctions(mNextState);
@@ -86,22 +87,21 @@ namespace REGoth
       mNextState.isValid = true;
     }
 
-    void ScriptState::startScriptAIState(const bs::String& state)
+    void ScriptState::startScriptAIState(Scripting::SymbolIndex state)
     {
-      REGOTH_LOG(Info, Uncategorized, "[ScriptState] Starting state {0} on npc {1}", state,
-                 mHostCharacter->SO()->getName());
-
       // Save script variables used by the state
       mStateOther  = scriptVM().otherInstance();
       mStateVictim = scriptVM().victimInstance();
       mStateItem   = scriptVM().itemInstance();
 
-      // Save name to the main function, to which we can append the tags like _LOOP and _END
-      mNextState.name        = state;
+      mNextState.symIndex    = state;
       mNextState.nativeState = NativeState::ScriptBased;
 
       fillStateScriptFunctions(mNextState);
 
+      REGOTH_LOG(Info, Uncategorized, "[ScriptState] Starting state {0} on npc {1}",
+                 mNextState.name, mHostCharacter->SO()->getName());
+
       // Script states CAN be routine states, so while this is set to false here, it will
       // be set to true in startRoutineState() which calls this method first
       mNextState.isRoutineState = false;
@@ -109,7 +109,7 @@ namespace REGoth
       mNextState.isValid = true;
     }
 
-    void ScriptState::startRoutineState(const bs::String& state)
+    void ScriptState::startRoutineState(Scripting::SymbolIndex state)
     {
       startScriptAIState(state);
 
@@ -129,44 +129,17 @@ namespace REGoth
 
     void ScriptState::fillStateScriptFunctions(AIState& state)
     {
-      const bs::String end       = state.name + "_END";
-      const bs::String loop      = state.name + "_LOOP";
-      const bs::String interrupt = state.name + "_INTERRUPT";
-      const auto& symbols        = scriptVM().scriptSymbolsConst();
+      const auto& symbols = scriptVM().scriptSymbolsConst();
 
       // No check whether this exists here, let getSymbol throw if the main-function does not exist
-      mNextState.symIndex = symbols.getSymbol<Scripting::SymbolScriptFunction>(state.name).index;
+      state.name = symbols.getSymbol<Scripting::SymbolScriptFunction>(state.symIndex).name;
 
       // End, Loop and Interrupt are optional
-      if (symbols.hasSymbolWithName(end))
-      {
-        const auto& symbol = symbols.getSymbol<Scripting::SymbolScriptFunction>(end);
-        mNextState.symEnd  = symbol.index;
-      }
-      else
-      {
-        mNextState.symEnd = Scripting::SYMBOL_INDEX_INVALID;
-      }
+      AIStateFunctions functions = scriptVM().aiStateTable().functionsOf(state.symIndex);
 
-      if (symbols.hasSymbolWithName(loop))
-      {
-        const auto& symbol = symbols.getSymbol<Scripting::SymbolScriptFunction>(loop);
-        mNextState.symLoop = symbol.index;
-      }
-      else
-      {
-        mNextState.symLoop = Scripting::SYMBOL_INDEX_INVALID;
-      }
-
-      if (symbols.hasSymbolWithName(interrupt))
-      {
-        const auto& symbol      = symbols.getSymbol<Scripting::SymbolScriptFunction>(interrupt);
-        mNextState.symInterrupt = symbol.index;
-      }
-      else
-      {
-        mNextState.symInterrupt = Scripting::SYMBOL_INDEX_INVALID;
-      }
+      state.symEnd       = functions.end;
+      state.symLoop      = functions.loop;
+      state.symInterrupt = functions.interrupt;
     }
 
     bool ScriptState::applyStateChange()
@@ -433,7 +406,7 @@ namespace REGoth
           if (!mHostEventQueue->isEmpty()) return false;  // EM not empty, don't start routine yet!
 
           // Check if the routine is already running
-          if (mCurrentState.name == task.scriptFunction) return true;
+          if (mCurrentState.symIndex == task.scriptFunction) return true;
 
           if (!isInRoutine()) return false;  // Currently in other state...
         }
@@ -494,6 +467,39 @@ namespace REGoth
       mRoutine.hasRoutine = true;  // At least one routine-target present
     }
 
+    void ScriptState::resolveLegacyStateFunctions()
+    {
+      for (RoutineTask& task : mRoutine.routine)
+      {
+        if (task.legacyScriptFunctionName.empty()) continue;
+
+        task.scriptFunction = resolveLegacyStateFunction(task.legacyScriptFunctionName);
+      }
+    }
+
+    Scripting::SymbolIndex ScriptState::resolveLegacyStateFunction(bs::String& name)
+    {
+      if (name.empty()) return Scripting::SYMBOL_INDEX_INVALID;
+
+      const auto& symbols = scriptVM().scriptSymbolsConst();
+
+      Scripting::SymbolIndex function = Scripting::SYMBOL_INDEX_INVALID;
+
+      if (symbols.hasSymbolWithName(name))
+      {
+        function = symbols.findIndexBySymbolName(name);
+      }
+      else
+      {
+        REGOTH_LOG(Warning, Uncategorized, "[ScriptState] State function {0} from save not found",
+                   name);
+      }
+
+      name.clear();
+
+      return function;
+    }
+
     void ScriptState::reinitRoutine()
     {
       const bs::String& routine = mHostCharacter->dailyRoutine();
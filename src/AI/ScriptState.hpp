@@ -115,18 +115,17 @@ namespace REGoth
        * Note that just starting the state may not be enough, as you need to request to end the
        * currently running state. See requestEndActiveState() amd interruptActiveState().
        *
-       * @param  state  Name of the state to start. This is also the name of the states main
-       *                function inside the scripts, e.g. `ZS_TALK`. However, this can also
-       *                be an instruction-function, like `B_SOMETHING`, which is just executed
-       *                straight away. This seems weird to have here, but it's like the original
-       *                is doing it.
+       * @param  state  Symbol of the states main function inside the scripts, e.g. `ZS_TALK`.
+       *                However, this can also be an instruction-function, like `B_SOMETHING`,
+       *                which is just executed straight away. This seems weird to have here,
+       *                but it's like the original is doing it.
        */
-      void startScriptAIState(const bs::String& state);
+      void startScriptAIState(Scripting::SymbolIndex state);
 
       /**
        * Same as startScriptAIState(), but for states used for Routines.
        */
-      void startRoutineState(const bs::String& state);
+      void startRoutineState(Scripting::SymbolIndex state);
 
       /**
        * Runs a simple script instruction, such as `B_SOMETHING`.
@@ -236,9 +235,15 @@ namespace REGoth
         bs::INT32 minutesStart;
         bs::INT32 hoursEnd;
         bs::INT32 minutesEnd;
-        bs::String scriptFunction;
+        Scripting::SymbolIndex scriptFunction = Scripting::SYMBOL_INDEX_INVALID;
         bs::String waypoint;
 
+        /**
+         * Name of the script function, as saves from before scriptFunction store it. Only
+         * set until resolveLegacyStateFunctions() has looked it up.
+         */
+        bs::String legacyScriptFunctionName;
+
         REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(RoutineTask);
       };
 
@@ -249,6 +254,20 @@ namespace REGoth
        */
       void insertRoutineTask(const RoutineTask& task);
 
+      /**
+       * Looks up the script functions of routine tasks from saves which only stored their
+       * names. To be called once after deserialization.
+       */
+      void resolveLegacyStateFunctions();
+
+      /**
+       * Looks up a state function stored by name in an older save and clears the name.
+       *
+       * @return Symbol of the function. SYMBOL_INDEX_INVALID if the name is empty or the
+       *         function doesn't exist anymore.
+       */
+      Scripting::SymbolIndex resolveLegacyStateFunction(bs::String& name);
+
       /**
        * @return Time the Character already is inside this state
        */
@@ -323,13 +342,15 @@ namespace REGoth
       };
 
       /**
-       * Looks up the script functions for the state name inside the given script state.
+       * Looks up the script functions for the main-function set in the given script state.
        *
-       * Each state is only passed the *Name* of the state to activate. That might be
+       * Each state is only passed the main-function of the state to activate. That might be
        * something like `ZS_TALK`. However, this is only the script function to execute
        * on start of the state. If the state is running, we need to call `ZS_TALK_LOOP`
-       * and if it ended, we need to call `ZS_STATE_END`. Therefore, we search for these
-       * tagged function names and store their symbol indices for faster access.
+       * and if it ended, we need to call `ZS_STATE_END`. These are taken from the
+       * AIStateTable of the script VM. Also sets the name of the state.
+       *
+       * Throws if the main-function is not a script function.
        */
       void fillStateScriptFunctions(AIState& state);
 
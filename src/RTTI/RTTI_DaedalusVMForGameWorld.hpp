@@ -28,6 +28,7 @@ namespace REGoth
       {
         auto obj = static_cast<DaedalusVMForGameWorld*>(_obj);
 
+        obj->mAIStateTable.build(obj->mScriptSymbols);
         obj->createAllInformationInstances();
       }
 
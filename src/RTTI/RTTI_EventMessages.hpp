@@ -89,7 +89,7 @@ namespace REGoth
     class RTTI_StateMessage : public bs::RTTIType<StateMessage, NpcMessage, RTTI_StateMessage>
     {
       BS_BEGIN_RTTI_MEMBERS
-      BS_RTTI_MEMBER_PLAIN(state, 0)
+      BS_RTTI_MEMBER_PLAIN(legacyStateName, 0)
       BS_RTTI_MEMBER_PLAIN(interruptOldState, 1)
       BS_RTTI_MEMBER_REFL(other, 2)
       BS_RTTI_MEMBER_REFL(victim, 3)
@@ -97,6 +97,7 @@ namespace REGoth
       BS_RTTI_MEMBER_PLAIN(isPrgState, 5)
       BS_RTTI_MEMBER_PLAIN(waitTime, 6)
       BS_RTTI_MEMBER_PLAIN(wpname, 7)
+      BS_RTTI_MEMBER_PLAIN(state, 8)
       BS_END_RTTI_MEMBERS
 
       REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(StateMessage)
@@ -18,6 +18,7 @@ namespace REGoth
     BS_RTTI_MEMBER_REFL_ARRAY(mAllCharacters, 5)
     BS_RTTI_MEMBER_REFL_ARRAY(mAllItems, 6)
     BS_RTTI_MEMBER_REFL_ARRAY(mAllFocusables, 7)
+    BS_RTTI_MEMBER_PLAIN(mWorldMeshHash, 8)
     BS_END_RTTI_MEMBERS
 
   public:
@@ -22,6 +22,14 @@ namespace REGoth
       BS_RTTI_MEMBER_PLAIN_NAMED(targetEntityPositionOnStart,
                                 mActiveRoute.targetEntityPositionOnStart, 7)
       BS_RTTI_MEMBER_REFL(mWaynet, 8)
+      BS_RTTI_MEMBER_REFL_ARRAY_NAMED(milestonesToRefine, mActiveRoute.milestonesToRefine, 9)
+      BS_RTTI_MEMBER_REFL_NAMED(lastRefinedWaypoint, mActiveRoute.lastRefinedWaypoint, 10)
+      BS_RTTI_MEMBER_PLAIN_NAMED(destination, mActiveRoute.destination, 11)
+      BS_RTTI_MEMBER_PLAIN_NAMED(shouldAppendDestination, mActiveRoute.shouldAppendDestination,
+                                 12)
+      BS_RTTI_MEMBER_PLAIN_NAMED(waypointsToGo, mActiveRoute.waypointsToGo, 13)
+      BS_RTTI_MEMBER_PLAIN_NAMED(nextPositionIndex, mActiveRoute.nextPositionIndex, 14)
+      BS_RTTI_MEMBER_PLAIN_NAMED(hasDestination, mActiveRoute.hasDestination, 15)
       BS_END_RTTI_MEMBERS
 
     public:
@@ -29,6 +37,19 @@ namespace REGoth
       {
       }
 
+      void onDeserializationEnded(bs::IReflectable* _obj, bs::SerializationContext* context) override
+      {
+        auto obj    = static_cast<Pathfinder*>(_obj);
+        auto& route = obj->mActiveRoute;
+
+        // Rerouting would head for wherever the unset destination points to otherwise
+        if (!route.hasDestination && !route.positionsToGo.empty())
+        {
+          route.destination    = route.positionsToGo.back();
+          route.hasDestination = true;
+        }
+      }
+
       REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(Pathfinder)
     };
   }  // namespace AI
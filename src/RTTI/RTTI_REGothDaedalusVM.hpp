@@ -31,10 +31,14 @@ namespace REGoth
         obj->mDatFile = bs::bs_shared_ptr_new<Daedalus::DATFile>(obj->mDatFileData.data(),
                                                                  obj->mDatFileData.size());
 
+        obj->mBytecode.reset(obj->mDatFile);
+        obj->mBytecode.decodeAllScriptFunctions(obj->mScriptSymbols);
+        obj->buildFunctionTraceFlags();
+
         obj->mClassVarResolver = bs::bs_shared_ptr_new<DaedalusClassVarResolver>(
             obj->mScriptSymbols, obj->mScriptObjects);
 
-        obj->mClassTemplates.createClassTemplates(obj->mScriptSymbols);
+        obj->recreateClassTemplates();
         obj->registerAllExternals();
       }
 
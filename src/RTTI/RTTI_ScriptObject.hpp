@@ -14,11 +14,16 @@ namespace REGoth
       BS_BEGIN_RTTI_MEMBERS
       BS_RTTI_MEMBER_PLAIN(className, 0)
       BS_RTTI_MEMBER_PLAIN(handle, 1)
-      BS_RTTI_MEMBER_PLAIN(ints, 2)
-      BS_RTTI_MEMBER_PLAIN(floats, 3)
-      BS_RTTI_MEMBER_PLAIN(strings, 4)
-      BS_RTTI_MEMBER_PLAIN(functionPointers, 5)
+      BS_RTTI_MEMBER_PLAIN(legacyInts, 2)
+      BS_RTTI_MEMBER_PLAIN(legacyFloats, 3)
+      BS_RTTI_MEMBER_PLAIN(legacyStrings, 4)
+      BS_RTTI_MEMBER_PLAIN(legacyFunctionPointers, 5)
       BS_RTTI_MEMBER_PLAIN(instanceName, 6)
+      BS_RTTI_MEMBER_PLAIN(ints, 7)
+      BS_RTTI_MEMBER_PLAIN(floats, 8)
+      BS_RTTI_MEMBER_PLAIN(strings, 9)
+      BS_RTTI_MEMBER_PLAIN(functionPointers, 10)
+      // layout: Not saved, restored from the class templates by the ScriptVM
       BS_END_RTTI_MEMBERS
 
     public:
@@ -15,7 +15,8 @@ namespace REGoth
       BS_BEGIN_RTTI_MEMBERS
       // BS_RTTI_MEMBER_PLAIN(mObjects, 0) // Commented out: Added manually, see constructor
       // BS_RTTI_MEMBER_PLAIN(mObjectHandles, 1) // Commented out: Added manually, see constructor
-      BS_RTTI_MEMBER_PLAIN(mNextHandle, 2)
+      // BS_RTTI_MEMBER_PLAIN(mNextHandle, 2) // Retired: Handles are now slot index + generation
+      // BS_RTTI_MEMBER_PLAIN(mSlotGenerations, 3) // Commented out: Added manually, see constructor
       BS_END_RTTI_MEMBERS
 
       ScriptObject& getObject(OwnerType* obj, UINT32 idx)
@@ -58,6 +59,26 @@ namespace REGoth
         mObjectHandles.resize(val);
       }
 
+      UINT32& getSlotGeneration(OwnerType* obj, UINT32 idx)
+      {
+        return mSlotGenerations[idx];
+      }
+
+      void setSlotGeneration(OwnerType* obj, UINT32 idx, UINT32& val)
+      {
+        mSlotGenerations[idx] = val;
+      }
+
+      UINT32 getSizeSlotGenerations(OwnerType* obj)
+      {
+        return (UINT32)mSlotGenerations.size();
+      }
+
+      void setSizeSlotGenerations(OwnerType* obj, UINT32 val)
+      {
+        mSlotGenerations.resize(val);
+      }
+
     public:
       RTTI_ScriptObjectStorage()
       {
@@ -72,16 +93,29 @@ namespace REGoth
                            &RTTI_ScriptObjectStorage::getSizeObjectHandles,   //
                            &RTTI_ScriptObjectStorage::setObjectHandle,        //
                            &RTTI_ScriptObjectStorage::setSizeObjectHandles);  //
+
+        addPlainArrayField("slotGenerations", 3,                                //
+                           &RTTI_ScriptObjectStorage::getSlotGeneration,        //
+                           &RTTI_ScriptObjectStorage::getSizeSlotGenerations,   //
+                           &RTTI_ScriptObjectStorage::setSlotGeneration,        //
+                           &RTTI_ScriptObjectStorage::setSizeSlotGenerations);  //
       }
 
       void onSerializationStarted(bs::IReflectable* _obj, bs::SerializationContext* context) override
       {
         auto obj = static_cast<ScriptObjectStorage*>(_obj);
 
-        for (const auto& v : obj->mObjects)
+        for (bs::UINT32 i = 0; i < obj->mNumSlots; i++)
         {
-          mObjectHandles.push_back(v.first);
-          mObjects.push_back(v.second);
+          const ScriptObjectStorage::Slot& slot = obj->slotAt(i);
+
+          if (slot.isAlive)
+          {
+            mObjectHandles.push_back(ScriptObjectStorage::makeHandle(i, slot.generation));
+            mObjects.push_back(slot.object);
+          }
+
+          mSlotGenerations.push_back(slot.generation);
         }
       }
 
@@ -89,16 +123,47 @@ namespace REGoth
       {
         auto obj = static_cast<ScriptObjectStorage*>(_obj);
 
+        obj->clear();
+
+        bs::UINT32 numSlots = (bs::UINT32)mSlotGenerations.size();
+
+        for (ScriptObjectHandle handle : mObjectHandles)
+        {
+          numSlots = std::max(numSlots, ScriptObjectStorage::handleIndex(handle) + 1);
+        }
+
+        obj->growToNumSlots(numSlots);
+
+        for (bs::UINT32 i = 1; i < numSlots; i++)
+        {
+          // Saves made before handles had generations don't store them. Back then, every
+          // handle below the highest one had been used, so make sure they stay invalid.
+          obj->slotAt(i).generation = i < mSlotGenerations.size() ? mSlotGenerations[i] : 1;
+        }
+
         for (bs::UINT32 i = 0; i < (bs::UINT32)mObjectHandles.size(); i++)
         {
-          obj->mObjects[mObjectHandles[i]] = mObjects[i];
+          ScriptObjectStorage::Slot& slot =
+              obj->slotAt(ScriptObjectStorage::handleIndex(mObjectHandles[i]));
+
+          if (slot.isAlive)
+          {
+            REGOTH_THROW(InvalidStateException, "Two Script Objects share the same slot!");
+          }
+
+          slot.object     = mObjects[i];
+          slot.generation = ScriptObjectStorage::handleGeneration(mObjectHandles[i]);
+          slot.isAlive    = true;
         }
+
+        obj->rebuildFreeSlots();
       }
 
       REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(ScriptObjectStorage)
 
       bs::Vector<ScriptObject> mObjects;
       bs::Vector<ScriptObjectHandle> mObjectHandles;
+      bs::Vector<UINT32> mSlotGenerations;
     };
 
   }  // namespace Scripting
@@ -17,8 +17,9 @@ namespace REGoth
       BS_RTTI_MEMBER_PLAIN(minutesStart, 1)
       BS_RTTI_MEMBER_PLAIN(hoursEnd, 2)
       BS_RTTI_MEMBER_PLAIN(minutesEnd, 3)
-      BS_RTTI_MEMBER_PLAIN(scriptFunction, 4)
+      BS_RTTI_MEMBER_PLAIN(legacyScriptFunctionName, 4)
       BS_RTTI_MEMBER_PLAIN(waypoint, 5)
+      BS_RTTI_MEMBER_PLAIN(scriptFunction, 6)
       BS_END_RTTI_MEMBERS
 
     public:
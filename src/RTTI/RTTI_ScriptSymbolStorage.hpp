@@ -13,17 +13,74 @@ namespace REGoth
         : public bs::RTTIType<ScriptSymbolStorage, bs::IReflectable, RTTI_ScriptSymbolStorage>
     {
       BS_BEGIN_RTTI_MEMBERS
-      BS_RTTI_MEMBER_PLAIN(mSymbolsByName, 1)
-      BS_RTTI_MEMBER_REFLPTR_ARRAY(mStorage, 2)
-      BS_RTTI_MEMBER_PLAIN(mFunctionsByAddress, 3)
+      // BS_RTTI_MEMBER_PLAIN(mSymbolsByName, 1) // Retired: Rebuilt after loading
+      // BS_RTTI_MEMBER_REFLPTR_ARRAY(mStorage, 2) // Commented out: Added manually, see constructor
+      // BS_RTTI_MEMBER_PLAIN(mFunctionsByAddress, 3) // Retired: Rebuilt after loading
       BS_END_RTTI_MEMBERS
 
+      bs::SPtr<SymbolBase> getSymbol(OwnerType* obj, UINT32 idx)
+      {
+        return mStorage[idx];
+      }
+
+      void setSymbol(OwnerType* obj, UINT32 idx, bs::SPtr<SymbolBase> val)
+      {
+        mStorage[idx] = val;
+      }
+
+      UINT32 getSizeSymbols(OwnerType* obj)
+      {
+        return (UINT32)mStorage.size();
+      }
+
+      void setSizeSymbols(OwnerType* obj, UINT32 val)
+      {
+        mStorage.resize(val);
+      }
+
     public:
       RTTI_ScriptSymbolStorage()
       {
+        addReflectablePtrArrayField("mStorage", 2,                           //
+                                    &RTTI_ScriptSymbolStorage::getSymbol,       //
+                                    &RTTI_ScriptSymbolStorage::getSizeSymbols,  //
+                                    &RTTI_ScriptSymbolStorage::setSymbol,       //
+                                    &RTTI_ScriptSymbolStorage::setSizeSymbols);  //
+      }
+
+      void onSerializationStarted(bs::IReflectable* _obj, bs::SerializationContext* context) override
+      {
+        auto obj = static_cast<ScriptSymbolStorage*>(_obj);
+
+        mStorage.clear();
+        mStorage.reserve(obj->numSymbols());
+
+        for (SymbolIndex i = 0; i < obj->numSymbols(); i++)
+        {
+          mStorage.push_back(obj->makeSharedCopy(i));
+        }
+      }
+
+      void onDeserializationEnded(bs::IReflectable* _obj, bs::SerializationContext* context) override
+      {
+        auto obj = static_cast<ScriptSymbolStorage*>(_obj);
+
+        obj->clear();
+
+        for (const bs::SPtr<SymbolBase>& symbol : mStorage)
+        {
+          obj->appendSymbolCopyOfType(*symbol);
+
+          if (symbol->type == SymbolType::ScriptFunction)
+          {
+            obj->registerFunctionAddress(symbol->index);
+          }
+        }
       }
 
       REGOTH_IMPLEMENT_RTTI_CLASS_FOR_REFLECTABLE(ScriptSymbolStorage)
+
+      bs::Vector<bs::SPtr<SymbolBase>> mStorage;
     };
   }  // namespace Scripting
   // namespace Scripting
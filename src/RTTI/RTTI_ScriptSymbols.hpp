@@ -41,6 +41,7 @@ namespace REGoth
       BS_RTTI_MEMBER_PLAIN(parent, 3)
       BS_RTTI_MEMBER_PLAIN(isClassVar, 4)
       BS_RTTI_MEMBER_PLAIN(isKeptAfterLoad, 5)
+      BS_RTTI_MEMBER_PLAIN(memberSlot, 6)
       BS_END_RTTI_MEMBERS
 
       REGOTH_RTTI_SCRIPT_SYMBOL_GLUE(SymbolBase)
@@ -26,7 +26,7 @@ namespace REGoth
       {
         auto obj = static_cast<ScriptVM*>(_obj);
 
-        obj->mClassTemplates.createClassTemplates(obj->mScriptSymbols);
+        obj->recreateClassTemplates();
       }
 
       REGOTH_IMPLEMENT_RTTI_CLASS_ABSTRACT(ScriptVM)
@@ -20,6 +20,7 @@ namespace REGoth
     BS_RTTI_MEMBER_REFL(mRootMotionLastClip, 6)
     BS_RTTI_MEMBER_PLAIN(mRootMotionLastTime, 7)
     BS_RTTI_MEMBER_REFL(mPlayingMainAnimation, 8)
+    BS_RTTI_MEMBER_PLAIN(mPendingVisual, 9)
     BS_END_RTTI_MEMBERS
 
   public:
@@ -36,6 +37,12 @@ namespace REGoth
       {
         obj->createAnimationMap();
       }
+
+      // Saved while the visual was still loading, update() takes it from here
+      if (!obj->mPendingVisual.empty())
+      {
+        obj->mPendingModelScript = gOriginalGameResources().requestModelScript(obj->mPendingVisual);
+      }
     }
 
     REGOTH_IMPLEMENT_RTTI_CLASS_FOR_COMPONENT(VisualSkeletalAnimation)
@@ -10,6 +10,7 @@ namespace REGoth
   {
     BS_BEGIN_RTTI_MEMBERS
     BS_RTTI_MEMBER_REFL(mRenderable, 0)
+    BS_RTTI_MEMBER_PLAIN(mPendingMeshName, 1)
     BS_END_RTTI_MEMBERS
 
   public:
@@ -17,6 +18,17 @@ namespace REGoth
     {
     }
 
+    void onDeserializationEnded(bs::IReflectable* _obj, bs::SerializationContext* context) override
+    {
+      auto obj = static_cast<VisualStaticMesh*>(_obj);
+
+      // Saved while the mesh was still loading, update() takes it from here
+      if (!obj->mPendingMeshName.empty())
+      {
+        obj->mPendingMesh = gOriginalGameResources().requestStaticMesh(obj->mPendingMeshName);
+      }
+    }
+
     REGOTH_IMPLEMENT_RTTI_CLASS_FOR_COMPONENT(VisualStaticMesh)
   };
 
@@ -12,6 +12,7 @@ namespace REGoth
     BS_BEGIN_RTTI_MEMBERS
     BS_RTTI_MEMBER_REFL_ARRAY(mWaypoints, 0)
     BS_RTTI_MEMBER_REFL_ARRAY(mFreepoints, 1)
+    BS_RTTI_MEMBER_PLAIN(mRoutingTableCacheName, 2)
     BS_END_RTTI_MEMBERS
 
   public:
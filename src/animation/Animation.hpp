@@ -9,6 +9,10 @@ namespace REGoth
 {
   namespace AnimationState
   {
+    /**
+     * Evaluates the root motion curve of the clip to find how far it moved from `then`
+     * to `now`. Prefer the sampled RootMotionTable where the clip is known.
+     */
     bs::Vector3 getRootMotionSince(bs::HAnimationClip clip, float then, float now);
   }
 }
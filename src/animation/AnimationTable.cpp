@@ -0,0 +1,230 @@
+#include "AnimationTable.hpp"
+#include <Threading/BsThreading.h>
+#include <animation/StateNaming.hpp>
+#include <exception/Throw.hpp>
+#include <memory>
+
+namespace REGoth
+{
+  constexpr AnimationTable::AnimationId AnimationTable::NO_ANIMATION;
+  constexpr AnimationTable::StateId AnimationTable::NO_STATE;
+
+  static const AI::WeaponMode ALL_WEAPON_MODES[] = {
+      AI::WeaponMode::None,      AI::WeaponMode::OneHanded,
+      AI::WeaponMode::TwoHanded, AI::WeaponMode::Bow,
+      AI::WeaponMode::Crossbow,  AI::WeaponMode::Magic,
+      AI::WeaponMode::Fist,
+  };
+
+  static const AI::WalkMode ALL_WALK_MODES[] = {
+      AI::WalkMode::Run,   AI::WalkMode::Walk, AI::WalkMode::Sneak,
+      AI::WalkMode::Water, AI::WalkMode::Swim, AI::WalkMode::Dive,
+  };
+
+  AnimationTable::AnimationTable(const BsZenLib::Res::HModelScriptFile& modelScript)
+      : mModelScript(modelScript)
+  {
+    if (!modelScript)
+    {
+      REGOTH_THROW(InvalidParametersException, "No model script given!");
+    }
+
+    // Clips are named like "HUMANS-S_RUNL"
+    const bs::String prefix = modelScript->getName() + "-";
+
+    const auto& clips = modelScript->getAnimations();
+    mAnimations.reserve(clips.size());
+
+    for (const auto& clip : clips)
+    {
+      const bs::String& fullName = clip->getName();
+
+      Animation animation;
+      animation.clip  = clip;
+      animation.state = NO_STATE;
+
+      if (fullName.compare(0, prefix.length(), prefix) == 0)
+      {
+        animation.name = fullName.substr(prefix.length());
+      }
+      else
+      {
+        animation.name = fullName;
+      }
+
+      animation.isInterruptable = fullName.find("-T_") == bs::String::npos;
+      animation.rootMotion      = RootMotionTable(clip->mClip);
+
+      AnimationId id = (AnimationId)mAnimations.size();
+
+      mAnimationsByName[animation.name] = id;
+      mAnimationsByClipName[fullName]   = id;
+
+      mAnimations.push_back(std::move(animation));
+    }
+
+    // State animations first, so each state knows its animation
+    for (AnimationId id = 0; id < (AnimationId)mAnimations.size(); id++)
+    {
+      const bs::String stateName = AnimationState::getStateName(mAnimations[id].name);
+
+      if (stateName.empty()) continue;
+
+      StateId state = internState(stateName);
+
+      mAnimations[id].state    = state;
+      mStates[state].animation = id;
+    }
+
+    // Then the transitions, which are named like "T_RUN_2_RUNL". Both sides can be states
+    // without an animation, like in "T_JUMP_2_STAND".
+    for (AnimationId id = 0; id < (AnimationId)mAnimations.size(); id++)
+    {
+      const bs::String& name = mAnimations[id].name;
+
+      if (AnimationState::isTransitionNeeded(name)) continue;
+
+      size_t separator = name.find("_2_", 2);
+
+      if (separator == bs::String::npos) continue;
+
+      StateId from = internState(name.substr(2, separator - 2));
+      StateId to   = internState(name.substr(separator + 3));
+
+      mTransitions[transitionKey(from, to)] = id;
+    }
+
+    for (StateId state = 0; state < (StateId)mStates.size(); state++)
+    {
+      addStateByModes(state);
+    }
+  }
+
+  bs::SPtr<const AnimationTable> AnimationTable::forModelScript(
+      const BsZenLib::Res::HModelScriptFile& modelScript)
+  {
+    static bs::Mutex sMutex;
+    static bs::UnorderedMap<bs::String, std::weak_ptr<const AnimationTable>> sTables;
+
+    bs::Lock lock(sMutex);
+
+    std::weak_ptr<const AnimationTable>& cached = sTables[modelScript->getName()];
+    bs::SPtr<const AnimationTable> table        = cached.lock();
+
+    // The model script might have been unloaded and loaded again in the meantime, in which
+    // case the clips of the old table are not the ones of the model script anymore.
+    if (!table || table->modelScript() != modelScript)
+    {
+      table  = bs::bs_shared_ptr_new<AnimationTable>(modelScript);
+      cached = table;
+    }
+
+    return table;
+  }
+
+  AnimationTable::AnimationId AnimationTable::findAnimation(const bs::String& name) const
+  {
+    auto it = mAnimationsByName.find(name);
+
+    if (it == mAnimationsByName.end()) return NO_ANIMATION;
+
+    return it->second;
+  }
+
+  AnimationTable::AnimationId AnimationTable::findAnimation(
+      const BsZenLib::Res::HZAnimation& clip) const
+  {
+    if (!clip) return NO_ANIMATION;
+
+    auto it = mAnimationsByClipName.find(clip->getName());
+
+    if (it == mAnimationsByClipName.end()) return NO_ANIMATION;
+
+    return it->second;
+  }
+
+  AnimationTable::StateId AnimationTable::findStateOfAnimation(
+      const bs::String& stateAnimation) const
+  {
+    auto it = mStatesByAnimationName.find(stateAnimation);
+
+    if (it == mStatesByAnimationName.end()) return NO_STATE;
+
+    return it->second;
+  }
+
+  AnimationTable::StateId AnimationTable::findState(AI::WeaponMode weaponMode,
+                                                    AI::WalkMode walkMode,
+                                                    const bs::String& state) const
+  {
+    auto modes = mStatesByModes.find(modesKey(weaponMode, walkMode));
+
+    if (modes == mStatesByModes.end()) return NO_STATE;
+
+    auto it = modes->second.find(state);
+
+    if (it == modes->second.end()) return NO_STATE;
+
+    return it->second;
+  }
+
+  AnimationTable::AnimationId AnimationTable::findTransition(StateId from, StateId to) const
+  {
+    if (from == NO_STATE || to == NO_STATE) return NO_ANIMATION;
+
+    auto it = mTransitions.find(transitionKey(from, to));
+
+    if (it == mTransitions.end()) return NO_ANIMATION;
+
+    return it->second;
+  }
+
+  AnimationTable::StateId AnimationTable::internState(const bs::String& name)
+  {
+    const bs::String stateAnimation = "S_" + name;
+
+    auto it = mStatesByAnimationName.find(stateAnimation);
+
+    if (it != mStatesByAnimationName.end()) return it->second;
+
+    State state;
+    state.name      = name;
+    state.animation = NO_ANIMATION;
+
+    StateId id = (StateId)mStates.size();
+    mStates.push_back(state);
+
+    mStatesByAnimationName[stateAnimation] = id;
+
+    return id;
+  }
+
+  void AnimationTable::addStateByModes(StateId state)
+  {
+    const bs::String& name = mStates[state].name;
+
+    for (AI::WeaponMode weaponMode : ALL_WEAPON_MODES)
+    {
+      for (AI::WalkMode walkMode : ALL_WALK_MODES)
+      {
+        // Strip the "S_" so only the tags remain, like "1HRUN"
+        const bs::String tags =
+            AnimationState::constructStateAnimationName(weaponMode, walkMode, "").substr(2);
+
+        if (name.compare(0, tags.length(), tags) != 0) continue;
+
+        mStatesByModes[modesKey(weaponMode, walkMode)][name.substr(tags.length())] = state;
+      }
+    }
+  }
+
+  bs::UINT32 AnimationTable::modesKey(AI::WeaponMode weaponMode, AI::WalkMode walkMode)
+  {
+    return (bs::UINT32)weaponMode * 16 + (bs::UINT32)walkMode;
+  }
+
+  bs::UINT64 AnimationTable::transitionKey(StateId from, StateId to)
+  {
+    return ((bs::UINT64)from << 32) | to;
+  }
+}  // namespace REGoth
@@ -0,0 +1,212 @@
+/**\file
+ */
+
+#pragma once
+#include <AI/WalkMode.hpp>
+#include <AI/WeaponMode.hpp>
+#include <BsPrerequisites.h>
+#include <BsZenLib/ZenResources.hpp>
+#include <animation/RootMotionTable.hpp>
+
+namespace REGoth
+{
+  /**
+   * All animations of a model script, numbered so they can be looked up and compared
+   * without handling any strings.
+   *
+   * Animations are known by their name without the model script prefix, like `S_RUNL`.
+   * Next to them, the table knows the *states* the animations belong to, as named by
+   * AnimationState::getStateName(), and which transition animation leads from one state
+   * into another. For example, going from state `RUN` to `RUNL` is done by `T_RUN_2_RUNL`.
+   * States are taken from the state animations as well as from both sides of the
+   * transition animations, so states without an animation of their own, like the `STAND`
+   * in `T_JUMP_2_STAND`, are in here as well.
+   *
+   * The root motion of each animation is sampled into a RootMotionTable here as well.
+   *
+   * Building the table takes a moment for the bigger model scripts, so it is shared
+   * between everyone using the same model script, see forModelScript().
+   */
+  class AnimationTable
+  {
+  public:
+    using AnimationId = bs::UINT32;
+    using StateId     = bs::UINT32;
+
+    static constexpr AnimationId NO_ANIMATION = 0xFFFFFFFF;
+    static constexpr StateId NO_STATE         = 0xFFFFFFFF;
+
+    explicit AnimationTable(const BsZenLib::Res::HModelScriptFile& modelScript);
+
+    /**
+     * @return The table of the given model script. Built if nobody is using one for that
+     *         model script at the moment.
+     */
+    static bs::SPtr<const AnimationTable> forModelScript(
+        const BsZenLib::Res::HModelScriptFile& modelScript);
+
+    /**
+     * @param  name  UPPERCASE animation name, like `S_RUNL`.
+     *
+     * @return ID of the animation. NO_ANIMATION if there is none with that name.
+     */
+    AnimationId findAnimation(const bs::String& name) const;
+
+    /**
+     * @return ID of the given animation. NO_ANIMATION if it is not from this model script.
+     */
+    AnimationId findAnimation(const BsZenLib::Res::HZAnimation& clip) const;
+
+    /**
+     * @param  stateAnimation  Name of the state animation, like `S_RUNL`. Also works for states
+     *                         without an animation of their own, like `S_STAND`.
+     *
+     * @return ID of the state. NO_STATE if there is none with that name.
+     */
+    StateId findStateOfAnimation(const bs::String& stateAnimation) const;
+
+    /**
+     * Finds the state the animation constructed via AnimationState::constructStateAnimationName()
+     * would belong to, without constructing it.
+     *
+     * @param  state  Name of the state without weapon and walk mode, like `L`.
+     *
+     * @return ID of the state. NO_STATE if there is none.
+     */
+    StateId findState(AI::WeaponMode weaponMode, AI::WalkMode walkMode,
+                      const bs::String& state) const;
+
+    /**
+     * @return The transition animation going from one state into the other, like `T_RUN_2_RUNL`.
+     *         NO_ANIMATION if there is none.
+     */
+    AnimationId findTransition(StateId from, StateId to) const;
+
+    /**
+     * @return The animation clip, or an empty handle for NO_ANIMATION.
+     */
+    BsZenLib::Res::HZAnimation clip(AnimationId animation) const
+    {
+      return animation == NO_ANIMATION ? BsZenLib::Res::HZAnimation() : mAnimations[animation].clip;
+    }
+
+    /**
+     * @return Name of the animation, like `S_RUNL`.
+     */
+    const bs::String& name(AnimationId animation) const
+    {
+      return mAnimations[animation].name;
+    }
+
+    /**
+     * @return State the given state animation is in. NO_STATE for NO_ANIMATION and animations
+     *         which are not state animations.
+     */
+    StateId stateOf(AnimationId animation) const
+    {
+      return animation == NO_ANIMATION ? NO_STATE : mAnimations[animation].state;
+    }
+
+    /**
+     * @return Whether the animation can be interrupted by the user, see
+     *         VisualSkeletalAnimation::isPlayingAnimationInterruptable().
+     */
+    bool isInterruptable(AnimationId animation) const
+    {
+      return mAnimations[animation].isInterruptable;
+    }
+
+    /**
+     * @return Sampled root motion of the animation. Empty if it doesn't have any.
+     */
+    const RootMotionTable& rootMotion(AnimationId animation) const
+    {
+      return mAnimations[animation].rootMotion;
+    }
+
+    /**
+     * @return Name of the state, like `RUNL`.
+     */
+    const bs::String& stateName(StateId state) const
+    {
+      return mStates[state].name;
+    }
+
+    /**
+     * @return The state animation of the given state, like `S_RUNL` for `RUNL`. NO_ANIMATION if
+     *         there is none.
+     */
+    AnimationId stateAnimation(StateId state) const
+    {
+      return state == NO_STATE ? NO_ANIMATION : mStates[state].animation;
+    }
+
+    bs::UINT32 numAnimations() const
+    {
+      return (bs::UINT32)mAnimations.size();
+    }
+
+    /**
+     * @return The model script the table has been built from.
+     */
+    const BsZenLib::Res::HModelScriptFile& modelScript() const
+    {
+      return mModelScript;
+    }
+
+  private:
+    struct Animation
+    {
+      BsZenLib::Res::HZAnimation clip;
+      bs::String name;
+      StateId state;
+      bool isInterruptable;
+      RootMotionTable rootMotion;
+    };
+
+    struct State
+    {
+      bs::String name;
+      AnimationId animation;
+    };
+
+    /**
+     * @return ID of the state with the given name, which is added if it is not known yet.
+     */
+    StateId internState(const bs::String& name);
+
+    /**
+     * Registers the state under each combination of weapon and walk mode its name starts with,
+     * for findState(AI::WeaponMode, AI::WalkMode, const bs::String&).
+     */
+    void addStateByModes(StateId state);
+
+    static bs::UINT32 modesKey(AI::WeaponMode weaponMode, AI::WalkMode walkMode);
+
+    static bs::UINT64 transitionKey(StateId from, StateId to);
+
+    BsZenLib::Res::HModelScriptFile mModelScript;
+
+    bs::Vector<Animation> mAnimations;
+    bs::UnorderedMap<bs::String, AnimationId> mAnimationsByName;
+
+    /**
+     * The full names of the animation clips, like `HUMANS-S_RUNL`.
+     */
+    bs::UnorderedMap<bs::String, AnimationId> mAnimationsByClipName;
+
+    bs::Vector<State> mStates;
+
+    /**
+     * States by the name of their state animation, like `S_RUNL`.
+     */
+    bs::UnorderedMap<bs::String, StateId> mStatesByAnimationName;
+
+    /**
+     * States by the rest of their name after the weapon and walk mode tags, see modesKey().
+     */
+    bs::UnorderedMap<bs::UINT32, bs::UnorderedMap<bs::String, StateId>> mStatesByModes;
+
+    bs::UnorderedMap<bs::UINT64, AnimationId> mTransitions;
+  };
+}  // namespace REGoth
@@ -0,0 +1,113 @@
+#include "RootMotionTable.hpp"
+#include <Animation/BsAnimationClip.h>
+#include <algorithm>
+#include <cmath>
+
+namespace REGoth
+{
+  constexpr float RootMotionTable::SAMPLES_PER_SECOND;
+
+  RootMotionTable::RootMotionTable(const bs::HAnimationClip& clip)
+  {
+    if (!clip || !clip->getRootMotion()) return;
+
+    const auto& positionCurve = clip->getRootMotion()->position;
+    const auto& rotationCurve = clip->getRootMotion()->rotation;
+
+    if (clip->getLength() <= 0.0f) return;
+
+    enum : bool
+    {
+      Wrap  = true,
+      Clamp = false
+    };
+
+    mLength = clip->getLength();
+
+    // Have a sample exactly at the end of the clip, so wrapping around picks up all of it
+    bs::UINT32 numSamples = (bs::UINT32)std::ceil(mLength * SAMPLES_PER_SECOND) + 1;
+    mSampleInterval       = mLength / (float)(numSamples - 1);
+
+    bool hasRotation = rotationCurve.getNumKeyFrames() > 0;
+
+    bs::Vector3 startPosition = positionCurve.evaluate(0.0f, Clamp);
+    bs::Quaternion startRotationInverse =
+        hasRotation ? rotationCurve.evaluate(0.0f, Clamp).inverse() : bs::Quaternion::IDENTITY;
+
+    mPositions.resize(numSamples);
+    mRotations.resize(numSamples);
+
+    for (bs::UINT32 i = 0; i < numSamples; i++)
+    {
+      float time = std::min(i * mSampleInterval, mLength);
+
+      mPositions[i] = positionCurve.evaluate(time, Clamp) - startPosition;
+
+      if (hasRotation)
+      {
+        mRotations[i] = startRotationInverse * rotationCurve.evaluate(time, Clamp);
+      }
+      else
+      {
+        mRotations[i] = bs::Quaternion::IDENTITY;
+      }
+    }
+  }
+
+  bs::Vector3 RootMotionTable::motionSince(float then, float now) const
+  {
+    if (isEmpty()) return bs::Vector3(bs::BsZero);
+
+    if (now < then)
+    {
+      // Started over in the meantime
+      return (positionAt(mLength) - positionAt(then)) + positionAt(now);
+    }
+
+    return positionAt(now) - positionAt(then);
+  }
+
+  bs::Quaternion RootMotionTable::rotationSince(float then, float now) const
+  {
+    if (isEmpty()) return bs::Quaternion::IDENTITY;
+
+    if (now < then)
+    {
+      return (rotationAt(then).inverse() * rotationAt(mLength)) * rotationAt(now);
+    }
+
+    return rotationAt(then).inverse() * rotationAt(now);
+  }
+
+  bs::Vector3 RootMotionTable::positionAt(float time) const
+  {
+    float blend;
+    bs::UINT32 sample = findSample(time, blend);
+
+    if (sample + 1 >= mPositions.size()) return mPositions.back();
+
+    return bs::Vector3::lerp(blend, mPositions[sample], mPositions[sample + 1]);
+  }
+
+  bs::Quaternion RootMotionTable::rotationAt(float time) const
+  {
+    float blend;
+    bs::UINT32 sample = findSample(time, blend);
+
+    if (sample + 1 >= mRotations.size()) return mRotations.back();
+
+    return bs::Quaternion::slerp(blend, mRotations[sample], mRotations[sample + 1]);
+  }
+
+  bs::UINT32 RootMotionTable::findSample(float time, float& outBlend) const
+  {
+    float clamped  = std::max(0.0f, std::min(time, mLength));
+    float position = clamped / mSampleInterval;
+
+    bs::UINT32 sample = std::min((bs::UINT32)position, (bs::UINT32)mPositions.size() - 1);
+
+    outBlend = position - (float)sample;
+
+    return sample;
+  }
+}  // namespace REGoth
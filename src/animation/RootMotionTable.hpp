@@ -0,0 +1,85 @@
+/**\file
+ */
+
+#pragma once
+#include <BsPrerequisites.h>
+#include <Math/BsQuaternion.h>
+#include <Math/BsVector3.h>
+
+namespace REGoth
+{
+  /**
+   * Root motion of an animation clip, sampled at a fixed rate.
+   *
+   * Evaluating the root motion curves of a clip is rather expensive, and moving characters
+   * need to know how far their animation has moved them on every fixed update. This table
+   * stores where the root is at each sample relative to where it was at the start of the
+   * clip, so finding how far it moved between two points in time only needs a lookup and
+   * an interpolation for each of them.
+   */
+  class RootMotionTable
+  {
+  public:
+    /**
+     * How many samples to take per second of animation. Original animations run at 25
+     * frames per second, so this is enough to not lose any detail.
+     */
+    static constexpr float SAMPLES_PER_SECOND = 50.0f;
+
+    RootMotionTable() = default;
+
+    /**
+     * Samples the root motion of the given clip. The table stays empty if the clip
+     * doesn't have any.
+     */
+    explicit RootMotionTable(const bs::HAnimationClip& clip);
+
+    /**
+     * @return Whether there is no root motion in here.
+     */
+    bool isEmpty() const
+    {
+      return mPositions.empty();
+    }
+
+    /**
+     * How far the root has moved from time `then` to time `now`, in seconds into the clip.
+     * Times outside of the clip are clamped.
+     *
+     * If `now` is before `then`, the clip is assumed to have started over in the meantime.
+     * The motion is then the one up to the end of the clip plus the one from its start
+     * to `now`.
+     */
+    bs::Vector3 motionSince(float then, float now) const;
+
+    /**
+     * How far the root has rotated from time `then` to time `now`, like motionSince().
+     */
+    bs::Quaternion rotationSince(float then, float now) const;
+
+  private:
+    /**
+     * @return Position of the root at the given time, relative to the start of the clip.
+     */
+    bs::Vector3 positionAt(float time) const;
+
+    /**
+     * @return Rotation of the root at the given time, relative to the start of the clip.
+     */
+    bs::Quaternion rotationAt(float time) const;
+
+    /**
+     * Finds the samples around the given time.
+     *
+     * @return Index of the sample before the given time. `outBlend` is how far the time
+     *         is towards the next sample.
+     */
+    bs::UINT32 findSample(float time, float& outBlend) const;
+
+    float mLength         = 0.0f;
+    float mSampleInterval = 0.0f;
+
+    bs::Vector<bs::Vector3> mPositions;
+    bs::Vector<bs::Quaternion> mRotations;
+  };
+}  // namespace REGoth
@@ -143,13 +143,11 @@ namespace REGoth
     return scriptObjectData().functionPointerValue("START_AISTATE") != 0;
   }
 
-  const bs::String& Character::getStartAIState()
+  Scripting::SymbolIndex Character::getStartAIState()
   {
     bs::UINT32 address = scriptObjectData().functionPointerValue("START_AISTATE");
 
-    Scripting::SymbolIndex symbol = scriptVM().scriptSymbols().findFunctionByAddress(address);
-
-    return scriptVM().scriptSymbols().getSymbolName(symbol);
+    return scriptVM().scriptSymbols().findFunctionByAddress(address);
   }
 
   bs::String Character::dailyRoutine()
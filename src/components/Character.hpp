@@ -98,11 +98,11 @@ namespace REGoth
     void setCurrentWaypoint(const bs::String& waypoint);
 
     /**
-     * @return On monsters, this will return the AI-state the monster should
-     *         automatically start after spawning.
-     *         On Humans, this will return an empty string.
+     * @return On monsters, this will return the main-function of the AI-state the monster
+     *         should automatically start after spawning.
+     *         On Humans, this will return SYMBOL_INDEX_INVALID.
      */
-    const bs::String& getStartAIState();
+    Scripting::SymbolIndex getStartAIState();
 
     /**
      * @return Name of the script function to call for the daily routine.
@@ -132,8 +132,6 @@ namespace REGoth
 
   bool CharacterAI::goForward()
   {
-    bs::String anim = AnimationState::constructStateAnimationName(mWeaponMode, mWalkMode, "L");
-
     return tryTransitionToState("L");
   }
 
@@ -242,36 +240,45 @@ namespace REGoth
     // Cannot play animations if the character has no model yet
     if (!mVisual->hasVisual()) return false;
 
-    bs::String playingNow = mVisual->getPlayingAnimationName();
-    auto clipPlayingNow   = mVisual->findAnimationClip(playingNow);
-
-    bs::String animToPlay = mVisual->findAnimationToTransitionTo(anim);
-    auto clip             = mVisual->findAnimationClip(animToPlay);
-
-    // Already in target anim
-    if (clip == clipPlayingNow) return true;
+    const AnimationTable& animations = mVisual->animationTable();
 
-    // If there is no clip, then the transition isn't meant to be possible.
-    // That also includes the empty string.
-    if (!clip)
+    // Some animations are directly reachable, like S_RUN -> T_JUMPB. Whether the transition
+    // makes sense has to be checked elsewhere.
+    if (!AnimationState::isTransitionNeeded(anim))
     {
-      // However, some animations refer to a special "Stand" anim, which doesn't exist
-      // but rather means the current idle animation, if the character is in running
-      // or walking mode.
-      if (isStanding())
-      {
-        animToPlay = mVisual->findAnimationToTransitionTo("S_STAND", anim);
-        clip       = mVisual->findAnimationClip(animToPlay);
-      }
+      return tryPlayAnimation(animations.findAnimation(anim));
     }
 
-    if (!clip) return false;
+    return tryTransitionTo(animations.findStateOfAnimation(anim));
+  }
+
+  bool CharacterAI::tryTransitionTo(AnimationTable::StateId state)
+  {
+    const AnimationTable& animations = mVisual->animationTable();
+
+    AnimationTable::AnimationId toPlay = mVisual->findTransitionToState(state);
 
-    if (!mVisual->isAnimationPlaying(clip))
+    // If there is no transition, then it isn't meant to be possible. However, some animations
+    // refer to a special "Stand" state, which doesn't have an animation but rather means the
+    // current idle animation, if the character is in running or walking mode.
+    if (toPlay == AnimationTable::NO_ANIMATION && isStanding())
     {
-      mVisual->playAnimationClip(clip);
+      toPlay = mVisual->findTransitionToState(animations.findStateOfAnimation("S_STAND"), state);
     }
 
+    return tryPlayAnimation(toPlay);
+  }
+
+  bool CharacterAI::tryPlayAnimation(AnimationTable::AnimationId animation)
+  {
+    // Already in target anim. Like before, nothing playing and no animation to play counts
+    // as being there as well.
+    if (animation == mVisual->getPlayingAnimationId()) return true;
+
+    if (animation == AnimationTable::NO_ANIMATION) return false;
+
+    mVisual->playAnimation(animation);
+
     return true;
   }
 
@@ -279,41 +286,49 @@ namespace REGoth
   {
     if (!isStateSwitchAllowed()) return false;
 
-    bs::String anim = AnimationState::constructStateAnimationName(mWeaponMode, mWalkMode, state);
+    const AnimationTable& animations = mVisual->animationTable();
 
-    return tryPlayTransitionAnimationTo(anim);
+    return tryTransitionTo(animations.findState(mWeaponMode, mWalkMode, state));
   }
 
   bool CharacterAI::doesStateExist(const bs::String& state) const
   {
-    bs::String anim = AnimationState::constructStateAnimationName(mWeaponMode, mWalkMode, state);
+    const AnimationTable& animations = mVisual->animationTable();
+
+    AnimationTable::StateId found = animations.findState(mWeaponMode, mWalkMode, state);
 
-    return mVisual->findAnimationClip(anim);
+    return animations.stateAnimation(found) != AnimationTable::NO_ANIMATION;
   }
 
   bool CharacterAI::isStanding() const
   {
-    bs::String currentAnimation = mVisual->getPlayingAnimationName();
-    bs::String currentState     = AnimationState::getStateName(currentAnimation);
+    const AnimationTable& animations = mVisual->animationTable();
+
+    AnimationTable::StateId state = animations.stateOf(mVisual->getPlayingAnimationId());
+
+    if (state == AnimationTable::NO_STATE) return false;
 
-    if (currentState == "RUN") return true;
+    const bs::String& stateName = animations.stateName(state);
 
-    if (currentState == "WALK") return true;
+    if (stateName == "RUN") return true;
+
+    if (stateName == "WALK") return true;
 
     return false;
   }
 
   bool CharacterAI::isStateSwitchAllowed()
   {
-    mVisual                = SO()->getComponent<VisualCharacter>();
-    bs::String playingAnim = mVisual->getPlayingAnimationName();
+    mVisual = SO()->getComponent<VisualCharacter>();
+
+    const AnimationTable& animations = mVisual->animationTable();
 
-    if (playingAnim.empty()) return true;
+    AnimationTable::AnimationId playing = mVisual->getPlayingAnimationId();
 
-    bs::String state = AnimationState::getStateName(playingAnim);
+    if (playing == AnimationTable::NO_ANIMATION) return true;
 
     // Playing some weird animation we don't know the naming scheme for?
-    if (state.empty()) return false;
+    if (animations.stateOf(playing) == AnimationTable::NO_STATE) return false;
 
     if (!mVisual->isPlayingAnimationInterruptable()) return false;
 
@@ -358,6 +373,9 @@ namespace REGoth
 
   void CharacterAI::fixedUpdate()
   {
+    // Done first, so movement caused by anything else than physics is picked up too
+    updatePositionForRangeQueries();
+
     handlePhysicsActivation();
 
     if (!mIsPhysicsActive)
@@ -411,6 +429,22 @@ namespace REGoth
     }
   }
 
+  void CharacterAI::updatePositionForRangeQueries()
+  {
+    const bs::Vector3& position = SO()->getTransform().pos();
+
+    if (position == mLastPositionForRangeQueries) return;
+
+    if (!mCharacter)
+    {
+      mCharacter = SO()->getComponent<Character>();
+    }
+
+    mWorld->updateCharacterPositionForRangeQueries(mCharacter);
+
+    mLastPositionForRangeQueries = position;
+  }
+
   bool CharacterAI::needsToUpdatePhysics(const bs::Vector3& rootMotion) const
   {
     // Apply gravity while being airborne
@@ -538,9 +572,12 @@ namespace REGoth
 
   bool CharacterAI::changeWalkMode(AI::WalkMode walkMode)
   {
-    bs::String stateTarget = AnimationState::constructStateAnimationName(mWeaponMode, walkMode, "");
+    // Cannot play animations if the character has no model yet
+    if (!mVisual->hasVisual()) return false;
 
-    bool wasAllowed = tryPlayTransitionAnimationTo(stateTarget);
+    const AnimationTable& animations = mVisual->animationTable();
+
+    bool wasAllowed = tryTransitionTo(animations.findState(mWeaponMode, walkMode, ""));
 
     if (wasAllowed)
     {
@@ -566,9 +603,11 @@ namespace REGoth
     {
       // Model exists, check if the state transition is possible
 
-      bs::String stateTarget = AnimationState::constructStateAnimationName(mode, mWalkMode, "");
+      const AnimationTable& animations = mVisual->animationTable();
+
+      AnimationTable::StateId stateTarget = animations.findState(mode, mWalkMode, "");
 
-      bool wasAllowed = tryPlayTransitionAnimationTo(stateTarget);
+      bool wasAllowed = tryTransitionTo(stateTarget);
 
       if (wasAllowed)
       {
@@ -580,11 +619,11 @@ namespace REGoth
         // FIXME: We're missing some aniAliases, for example, "T_RUN_2_SNEAK" exists,
         //        and "T_SNEAK_2_RUN" is just the same animation but in reverse. This
         //        is defined using an aniAlias, which does not seem to be implemented.
-        auto c = mVisual->findAnimationClip(stateTarget);
+        AnimationTable::AnimationId stateAnimation = animations.stateAnimation(stateTarget);
 
-        if (c)
+        if (stateAnimation != AnimationTable::NO_ANIMATION)
         {
-          mVisual->playAnimationClip(c);
+          mVisual->playAnimation(stateAnimation);
           mWeaponMode = mode;
         }
       }
@@ -5,6 +5,7 @@
 #include <AI/WalkMode.hpp>
 #include <AI/WeaponMode.hpp>
 #include <RTTI/RTTIUtil.hpp>
+#include <animation/AnimationTable.hpp>
 
 namespace REGoth
 {
@@ -14,6 +15,9 @@ namespace REGoth
   class GameWorld;
   using HGameWorld = bs::GameObjectHandle<GameWorld>;
 
+  class Character;
+  using HCharacter = bs::GameObjectHandle<Character>;
+
   /**
    * Character AI. Implements most of the `AI_*` externals.
    * Needs to be attached to a scene-object which also has s `Character`-Component.
@@ -240,6 +244,12 @@ namespace REGoth
      */
     bool needsToUpdatePhysics(const bs::Vector3& rootMotion) const;
 
+    /**
+     * Tells the GameWorld if this character has moved since the last time, so
+     * it can be found by range queries at its new position.
+     */
+    void updatePositionForRangeQueries();
+
     /**
      * Tries to transition to the given animation name.
      *
@@ -249,6 +259,20 @@ namespace REGoth
      */
     bool tryPlayTransitionAnimationTo(const bs::String& anim);
 
+    /**
+     * Tries to play a transition to reach the given state of the visuals animation table.
+     *
+     * @return True, if the transition was possible.
+     */
+    bool tryTransitionTo(AnimationTable::StateId state);
+
+    /**
+     * Plays the given animation of the visuals animation table, unless it is already playing.
+     *
+     * @return False, if there is no animation to play.
+     */
+    bool tryPlayAnimation(AnimationTable::AnimationId animation);
+
     /**
      * Tries to play a transition to reach the given state.
      *
@@ -311,6 +335,12 @@ namespace REGoth
     // Velocity to apply to the y-axis while falling. Reset when the ground is hit.
     float mFallingVelocity = 0.0f;
 
+    // Character this AI belongs to. Not saved, looked up on first use.
+    HCharacter mCharacter;
+
+    // Position last reported to the GameWorld for range queries. Not saved.
+    bs::Vector3 mLastPositionForRangeQueries = bs::Vector3::ZERO;
+
   public:
     REGOTH_DECLARE_RTTI(CharacterAI);
 
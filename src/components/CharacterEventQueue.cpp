@@ -49,15 +49,39 @@ namespace REGoth
 
       mScriptState = bs::bs_shared_ptr_new<AI::ScriptState>(mWorld, mCharacter, hthis, mCharacterAI);
     }
+    else
+    {
+      resolveLegacyStateFunctions();
+    }
+  }
+
+  void CharacterEventQueue::resolveLegacyStateFunctions()
+  {
+    mScriptState->resolveLegacyStateFunctions();
+
+    for (const SharedEMessage& message : queuedMessages())
+    {
+      if (message->messageType != AI::EventMessageType::State) continue;
+
+      auto& stateMessage = *reinterpret_cast<AI::StateMessage*>(message.get());
+
+      if (stateMessage.legacyStateName.empty()) continue;
+
+      stateMessage.state = mScriptState->resolveLegacyStateFunction(stateMessage.legacyStateName);
+    }
   }
 
   void CharacterEventQueue::startRouteToPosition(const bs::Vector3& target)
   {
+    // Not saved with the pathfinder and the world might not have loaded it yet when this
+    // component was initialized
+    mPathfinder->setNavMesh(mWorld->navMesh());
     mPathfinder->startNewRouteTo(positionNow(), target);
   }
 
   void CharacterEventQueue::startRouteToObject(bs::HSceneObject target)
   {
+    mPathfinder->setNavMesh(mWorld->navMesh());
     mPathfinder->startNewRouteTo(positionNow(), target);
   }
 
@@ -299,7 +323,7 @@ namespace REGoth
           message.victim->useAsVictim();
         }
 
-        if (message.state.empty())
+        if (message.state == Scripting::SYMBOL_INDEX_INVALID)
         {
           mScriptState->startDailyRoutine(true);
         }
@@ -412,13 +436,21 @@ namespace REGoth
   {
     EventQueue::update();
 
-    if (mCharacterAI->isPhysicsActive())
+    AI::AIScheduler& scheduler = mWorld->aiScheduler();
+    AI::AIUpdateTier tier      = scheduler.tierOf(SO()->getTransform().pos());
+
+    float deltaTime;
+    bool shouldTick = scheduler.shouldTick(mAIUpdateSlot, SO()->getInstanceId(), tier, deltaTime);
+
+    if (!shouldTick) return;
+
+    if (!mCharacterAI->isPhysicsActive())
     {
-      mScriptState->doAIState(bs::gTime().getFrameDelta());
+      mScriptState->doAIStateDuringShrink();
     }
     else
     {
-      mScriptState->doAIStateDuringShrink();
+      mScriptState->doAIState(deltaTime);
     }
   }
 
@@ -493,10 +525,13 @@ namespace REGoth
 
   SharedEMessage CharacterEventQueue::pushTalkToCharacter(HCharacter other)
   {
-    return pushInterruptAndStartScriptState("ZS_TALK", "", other, {});
+    const auto& symbols = mWorld->scriptVM().scriptSymbols();
+
+    return pushInterruptAndStartScriptState(symbols.findIndexBySymbolName("ZS_TALK"), "", other,
+                                            {});
   }
 
-  SharedEMessage CharacterEventQueue::pushStartScriptState(const bs::String& state,
+  SharedEMessage CharacterEventQueue::pushStartScriptState(Scripting::SymbolIndex state,
                                                            const bs::String& waypoint,
                                                            HCharacter other, HCharacter victim)
   {
@@ -515,7 +550,7 @@ namespace REGoth
     return onMessage(msg);
   }
 
-  SharedEMessage CharacterEventQueue::pushInterruptAndStartScriptState(const bs::String& state,
+  SharedEMessage CharacterEventQueue::pushInterruptAndStartScriptState(Scripting::SymbolIndex state,
                                                                        const bs::String& waypoint,
                                                                        HCharacter other,
                                                                        HCharacter victim)
@@ -1,5 +1,6 @@
 #pragma once
 #include "EventQueue.hpp"
+#include <AI/AIScheduler.hpp>
 #include <AI/Pathfinder.hpp>
 #include <AI/ScriptState.hpp>
 #include <RTTI/RTTIUtil.hpp>
@@ -91,12 +92,12 @@ namespace REGoth
     /**
      * Push a message which starts a new script state after ending the current one gracefully.
      */
-    SharedEMessage pushStartScriptState(const bs::String& state, const bs::String& waypoint,
+    SharedEMessage pushStartScriptState(Scripting::SymbolIndex state, const bs::String& waypoint,
                                         HCharacter other, HCharacter victim);
     /**
      * Push a message which interrupts the currently active script state starts a new one.
      */
-    SharedEMessage pushInterruptAndStartScriptState(const bs::String& state,
+    SharedEMessage pushInterruptAndStartScriptState(Scripting::SymbolIndex state,
                                                     const bs::String& waypoint, HCharacter other,
                                                     HCharacter victim);
 
@@ -165,6 +166,12 @@ namespace REGoth
     virtual void update() override;
 
   private:
+    /**
+     * Looks up the state functions saves from before the symbol indices were saved only
+     * stored by name, see AI::ScriptState::resolveLegacyStateFunctions().
+     */
+    void resolveLegacyStateFunctions();
+
     bool EV_Event(AI::EventMessage& message, bs::HSceneObject sender);
     bool EV_Npc(AI::NpcMessage& message, bs::HSceneObject sender);
     bool EV_Damage(AI::DamageMessage& message, bs::HSceneObject sender);
@@ -187,6 +194,11 @@ namespace REGoth
     bs::SPtr<AI::Pathfinder> mPathfinder;
     bs::SPtr<AI::ScriptState> mScriptState;
 
+    /**
+     * Time passed since the AI-state was last ticked, see AI::AIScheduler. Not saved.
+     */
+    AI::AIUpdateSlot mAIUpdateSlot;
+
   public:
     REGOTH_DECLARE_RTTI(CharacterEventQueue)
 
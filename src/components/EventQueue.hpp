@@ -161,6 +161,14 @@ namespace REGoth
      */
     virtual void update() override;
 
+    /**
+     * @return The messages waiting to be handled, in the order they will be.
+     */
+    const bs::Vector<SharedEMessage>& queuedMessages() const
+    {
+      return mEventQueue;
+    }
+
   private:
     /**
      * Processes a single step of the message queue.
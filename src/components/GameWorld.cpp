@@ -7,6 +7,7 @@
 #include <Scene/BsPrefab.h>
 #include <Scene/BsSceneManager.h>
 #include <Threading/BsTaskScheduler.h>
+#include <Utility/BsTimer.h>
 
 #include <components/Character.hpp>
 #include <components/Focusable.hpp>
@@ -15,18 +16,32 @@
 #include <components/VisualCharacter.hpp>
 #include <components/Waynet.hpp>
 
+#include <AI/AIScheduler.hpp>
 #include <RTTI/RTTI_GameWorld.hpp>
 #include <exception/Assert.hpp>
 #include <exception/Throw.hpp>
 #include <log/logging.hpp>
+#include <original-content/OriginalGameResources.hpp>
 #include <original-content/VirtualFileSystem.hpp>
 #include <scripting/ScriptVMForGameWorld.hpp>
+#include <world/NavMesh.hpp>
+#include <world/PhysicsMeshRegistry.hpp>
 #include <world/internals/ConstructFromZEN.hpp>
 
 namespace REGoth
 {
   const char* const WORLD_STARTPOINT = "STARTPOINT";
 
+  /**
+   * Drops resources only the worlds loaded before have been using, if the memory budget
+   * demands it.
+   */
+  static void evictUnusedResources()
+  {
+    gOriginalGameResources().evictUnused();
+    gOriginalGameResources().logStats();
+  }
+
   GameWorld::GameWorld(const bs::HSceneObject& parent, const bs::String& zenFile)
       : bs::Component(parent)
       , mZenFile(zenFile)
@@ -52,6 +67,8 @@ namespace REGoth
     // Always do this after importing or deserializing
     fillFindByNameCache();
 
+    mAIScheduler = bs::bs_shared_ptr_new<AI::AIScheduler>(thisWorld);
+
     // FIXME: Enable these again if BsSceneManager::findComponents works at this point.
     //        It seems to be too early for the components to be found when deserializing the world...
     //        At the moment, these lists are stored inside the save game, which is not optimal.
@@ -60,14 +77,23 @@ namespace REGoth
     // findAllFocusables();
 
     // If this is true here, we're being de-serialized
-    if (mIsInitialized) return;
+    if (mIsInitialized)
+    {
+      loadNavMesh();
+      evictUnusedResources();
+      return;
+    }
 
     initScriptVM();
 
     if (!mZenFile.empty())
     {
+      bs::Timer timer;
+
       // Import the ZEN and add all scene objects as children to this SO.
-      bs::HSceneObject so = Internals::constructFromZEN(thisWorld, mZenFile);
+      Internals::ZenImportTimings timings;
+      bs::HSceneObject so =
+          Internals::constructFromZEN(thisWorld, mZenFile, &timings, &mWorldMeshHash);
 
       if (!so)
       {
@@ -75,6 +101,17 @@ namespace REGoth
       }
 
       findWaynet();
+
+      mWaynet->enableRoutingTable(mZenFile);
+
+      loadNavMesh();
+
+      REGOTH_LOG(Info, Uncategorized,
+                 "[GameWorld] Loaded {0} in {1} ms: parse {2} ms, pack {3} ms, world mesh {4} ms, "
+                 "physics mesh {5} ms, navmesh {6} ms, vobs {7} ms, waynet {8} ms",
+                 mZenFile, timer.getMilliseconds(), timings.parseMs, timings.packMs,
+                 timings.worldMeshMs, timings.physicsMeshMs, timings.navMeshMs,
+                 timings.vobImportMs, timings.waynetImportMs);
     }
     else
     {
@@ -88,6 +125,28 @@ namespace REGoth
     mGameClock->setTime(8, 0);
 
     mIsInitialized = true;
+
+    evictUnusedResources();
+  }
+
+  void GameWorld::loadNavMesh()
+  {
+    mNavMesh = nullptr;
+
+    if (mZenFile.empty()) return;
+
+    auto navMesh = bs::bs_shared_ptr_new<NavMesh>();
+
+    // Saves from before the hash was known accept any navmesh, see NavMesh::ANY_WORLD_MESH
+    if (!navMesh->load(NavMesh::cachePathFor(mZenFile), AI::Pathfinder::UserConfiguration(),
+                       mWorldMeshHash))
+    {
+      REGOTH_LOG(Warning, Uncategorized,
+                 "[GameWorld] No navmesh for {0}, creatures will only use the waynet", mZenFile);
+      return;
+    }
+
+    mNavMesh = navMesh;
   }
 
   void GameWorld::findAllCharacters()
@@ -128,6 +187,9 @@ namespace REGoth
 
     mAllFocusables.push_back(focusable);
 
+    mItemGrid.add(item, transform.pos());
+    mFocusableGrid.add(focusable, transform.pos());
+
     return item;
   }
 
@@ -170,6 +232,9 @@ namespace REGoth
 
     mAllFocusables.push_back(focusable);
 
+    // The characters Focusable is found via the character grid, see mFocusableGrid
+    mCharacterGrid.add(character, transform.pos());
+
     return character;
   }
 
@@ -209,6 +274,7 @@ namespace REGoth
       {
         *it = vector.back();
         vector.pop_back();
+        break;
       }
     }
   }
@@ -220,15 +286,19 @@ namespace REGoth
     removeHandleFromVector(item, mAllItems);
     removeHandleFromVector(focusable, mAllFocusables);
 
+    mItemGrid.remove(item);
+    mFocusableGrid.remove(focusable);
+
     item->SO()->destroy();
   }
 
   void GameWorld::initScriptVM()
   {
+    // The VM keeps its own copy to be saved along with it, so this is the only one made
     bs::Vector<bs::UINT8> data = gVirtualFileSystem().readFile("GOTHIC.DAT");
 
     mScriptVM = bs::bs_shared_ptr_new<Scripting::ScriptVMForGameWorld>(
-        bs::static_object_cast<GameWorld>(getHandle()), data);
+        bs::static_object_cast<GameWorld>(getHandle()), std::move(data));
 
     mScriptVM->initialize();
   }
@@ -342,55 +412,105 @@ namespace REGoth
     visit(SO());
   }
 
-  template <typename T>
-  static bs::Vector<GameWorld::FoundInRange<T>> findComponentsInRange(
-      const bs::Vector<T>& allComponents, float rangeInMeters, const bs::Vector3& around)
+  void GameWorld::fillRangeQueryGrids()
   {
-    // Squared distances are faster to compute in the tight loop later as they
-    // don't need the expensive sqrt().
-    float rangeSq = rangeInMeters * rangeInMeters;
+    for (HCharacter character : mAllCharacters)
+    {
+      mCharacterGrid.add(character, character->SO()->getTransform().pos());
+    }
 
-    bs::Vector<GameWorld::FoundInRange<T>> found;
+    for (HItem item : mAllItems)
+    {
+      mItemGrid.add(item, item->SO()->getTransform().pos());
+    }
 
-    for (T focusable : allComponents)
+    for (HFocusable focusable : mAllFocusables)
     {
-      const auto& transform = focusable->SO()->getTransform();
+      // Focusables of characters are found via mCharacterGrid
+      if (focusable->SO()->getComponent<Character>()) continue;
 
-      float distanceSq = transform.pos().squaredDistance(around);
+      mFocusableGrid.add(focusable, focusable->SO()->getTransform().pos());
+    }
 
-      if (distanceSq < rangeSq)
-      {
-        GameWorld::FoundInRange<T> result;
-        result.distanceSq = distanceSq;
-        result.thing      = focusable;
+    mHasFilledRangeQueryGrids = true;
+  }
 
-        found.emplace_back(result);
-      }
-    }
+  void GameWorld::updateCharacterPositionForRangeQueries(HCharacter character)
+  {
+    mCharacterGrid.move(character, character->SO()->getTransform().pos());
+  }
 
+  template <typename T>
+  static void sortByDistance(bs::Vector<GameWorld::FoundInRange<T>>& found)
+  {
     std::sort(found.begin(), found.end(), [](const auto& left, const auto& right) {
       return left.distanceSq < right.distanceSq;
     });
+  }
+
+  template <typename T, typename Hash>
+  static bs::Vector<GameWorld::FoundInRange<T>> findComponentsInRange(
+      const WorldHashGrid<T, Hash>& grid, float rangeInMeters, const bs::Vector3& around)
+  {
+    bs::Vector<GameWorld::FoundInRange<T>> found;
+
+    grid.forEachInRange(around, rangeInMeters, [&](const T& thing, float distanceSq) {
+      GameWorld::FoundInRange<T> result;
+      result.distanceSq = distanceSq;
+      result.thing      = thing;
+
+      found.emplace_back(result);
+    });
+
+    sortByDistance(found);
 
     return found;
   }
 
   bs::Vector<GameWorld::FoundInRange<HCharacter>> GameWorld::findCharactersInRange(
-      float rangeInMeters, const bs::Vector3& around) const
+      float rangeInMeters, const bs::Vector3& around)
   {
-    return findComponentsInRange(mAllCharacters, rangeInMeters, around);
+    if (!mHasFilledRangeQueryGrids) fillRangeQueryGrids();
+
+    return findComponentsInRange(mCharacterGrid, rangeInMeters, around);
   }
 
   bs::Vector<GameWorld::FoundInRange<HItem>> GameWorld::findItemsInRange(
-      float rangeInMeters, const bs::Vector3& around) const
+      float rangeInMeters, const bs::Vector3& around)
   {
-    return findComponentsInRange(mAllItems, rangeInMeters, around);
+    if (!mHasFilledRangeQueryGrids) fillRangeQueryGrids();
+
+    return findComponentsInRange(mItemGrid, rangeInMeters, around);
   }
 
   bs::Vector<GameWorld::FoundInRange<HFocusable>> GameWorld::findFocusablesInRange(
-      float rangeInMeters, const bs::Vector3& around) const
+      float rangeInMeters, const bs::Vector3& around)
   {
-    return findComponentsInRange(mAllFocusables, rangeInMeters, around);
+    if (!mHasFilledRangeQueryGrids) fillRangeQueryGrids();
+
+    bs::Vector<FoundInRange<HFocusable>> found;
+
+    mFocusableGrid.forEachInRange(around, rangeInMeters,
+                                  [&](const HFocusable& focusable, float distanceSq) {
+                                    FoundInRange<HFocusable> result;
+                                    result.distanceSq = distanceSq;
+                                    result.thing      = focusable;
+
+                                    found.emplace_back(result);
+                                  });
+
+    mCharacterGrid.forEachInRange(around, rangeInMeters,
+                                  [&](const HCharacter& character, float distanceSq) {
+                                    FoundInRange<HFocusable> result;
+                                    result.distanceSq = distanceSq;
+                                    result.thing = character->SO()->getComponent<Focusable>();
+
+                                    if (result.thing) found.emplace_back(result);
+                                  });
+
+    sortByDistance(found);
+
+    return found;
   }
 
   bs::Vector<HWaypoint> GameWorld::findWay(const bs::Vector3& from, const bs::Vector3& to)
@@ -436,6 +556,9 @@ namespace REGoth
 
   bs::SPtr<bs::Task> GameWorld::save(const bs::String& saveName)
   {
+    // The colliders refer to the physics meshes, which must be on disk to load them again
+    gPhysicsMeshRegistry().waitForPendingSaves();
+
     bs::HPrefab cached = bs::Prefab::create(SO());
 
     enum
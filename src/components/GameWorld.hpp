@@ -4,6 +4,7 @@
 #include <Scene/BsComponent.h>
 
 #include <RTTI/RTTIUtil.hpp>
+#include <world/WorldHashGrid.hpp>
 
 namespace REGoth
 {
@@ -28,6 +29,8 @@ namespace REGoth
   class Waypoint;
   using HWaypoint = bs::GameObjectHandle<Waypoint>;
 
+  class NavMesh;
+
   extern const char* const WORLD_STARTPOINT;
 
   namespace Scripting
@@ -35,6 +38,11 @@ namespace REGoth
     class ScriptVMForGameWorld;
   }
 
+  namespace AI
+  {
+    class AIScheduler;
+  }
+
   /**
    * Component to be attached to the scene root which manages the game world.
    *
@@ -156,6 +164,23 @@ namespace REGoth
       return *mScriptVM;
     }
 
+    /**
+     * Scheduler deciding which characters run their AI-state in the current frame.
+     */
+    AI::AIScheduler& aiScheduler()
+    {
+      return *mAIScheduler;
+    }
+
+    /**
+     * Navmesh of the world, baked when the ZEN was imported. Null if there is none, like
+     * on empty worlds.
+     */
+    bs::SPtr<NavMesh> navMesh() const
+    {
+      return mNavMesh;
+    }
+
     /**
      * Constructs a GameWorld-Component from an original ZEN-file.
      *
@@ -313,21 +338,32 @@ namespace REGoth
 
     /**
      * Finds all characters which are in the given range around the given location.
+     *
+     * Result is sorted by distance with the closest Character being the first entry.
      */
     bs::Vector<FoundInRange<HCharacter>> findCharactersInRange(float rangeInMeters,
-                                                               const bs::Vector3& around) const;
+                                                               const bs::Vector3& around);
     /**
      * Finds all items which are in the given range around the given location.
+     *
+     * Result is sorted by distance with the closest Item being the first entry.
      */
     bs::Vector<FoundInRange<HItem>> findItemsInRange(float rangeInMeters,
-                                                     const bs::Vector3& around) const;
+                                                     const bs::Vector3& around);
     /**
      * Finds all Focusables which are in the given range around the given location.
      *
      * Result is sorted by distance with the closest Focusable being the first entry.
      */
     bs::Vector<FoundInRange<HFocusable>> findFocusablesInRange(float rangeInMeters,
-                                                               const bs::Vector3& around) const;
+                                                               const bs::Vector3& around);
+
+    /**
+     * Updates the position of the given character used by the `find*InRange` method-family.
+     *
+     * Must be called whenever the character has moved. This is done by its CharacterAI.
+     */
+    void updateCharacterPositionForRangeQueries(HCharacter character);
 
     /**
      * Finds a way between two locations given by name.
@@ -362,6 +398,11 @@ namespace REGoth
      */
     void findWaynet();
 
+    /**
+     * Loads the navmesh baked while importing the ZEN into mNavMesh, if there is one.
+     */
+    void loadNavMesh();
+
     /**
      * Clears and fills the mSceneObjectsByNameCached map with objects being
      * in the scene right now.
@@ -376,6 +417,12 @@ namespace REGoth
     void findAllItems();
     void findAllFocusables();
 
+    /**
+     * Fills the grids used by the `find*InRange` method-family from mAllCharacters,
+     * mAllItems and mAllFocusables. Needed after loading, since the grids are not saved.
+     */
+    void fillRangeQueryGrids();
+
     /**
      * ZEN-File this world was created from, e.g. `NEWWORLD.ZEN`.
      */
@@ -396,6 +443,23 @@ namespace REGoth
      */
     bs::SPtr<Scripting::ScriptVMForGameWorld> mScriptVM;
 
+    /**
+     * Decides how often the characters run their AI-state. Not saved, created
+     * again after loading.
+     */
+    bs::SPtr<AI::AIScheduler> mAIScheduler;
+
+    /**
+     * See navMesh(). Not saved, loaded from the cache again.
+     */
+    bs::SPtr<NavMesh> mNavMesh;
+
+    /**
+     * Hash of the world mesh the navmesh was baked from, to not pick up an outdated one
+     * after loading a save. 0 on saves from before it was stored, which accepts any.
+     */
+    bs::UINT64 mWorldMeshHash = 0;
+
     /**
      * Contains a list of most scene objects by their names. This is used to find
      * object quicker than using findChild(), but it might be missing some objects,
@@ -413,6 +477,24 @@ namespace REGoth
     bs::Vector<HItem> mAllItems;
     bs::Vector<HFocusable> mAllFocusables;
 
+    /**
+     * Grids over the positions of all characters, items and focusables so range queries
+     * only need to look at what is nearby. Built from the `mAllSomething` vectors,
+     * thus not saved.
+     *
+     * Focusables of characters are not stored inside mFocusableGrid as they move around,
+     * those are found via mCharacterGrid instead.
+     *
+     * The cell size is chosen so that the common queries, like searching for a focusable
+     * in front of the player, only need to look at a handful of cells.
+     */
+    static constexpr float RANGE_QUERY_GRID_CELL_SIZE = 10.0f;  // Meters
+
+    WorldHashGrid<HCharacter, GameObjectHandleHash> mCharacterGrid{RANGE_QUERY_GRID_CELL_SIZE};
+    WorldHashGrid<HItem, GameObjectHandleHash> mItemGrid{RANGE_QUERY_GRID_CELL_SIZE};
+    WorldHashGrid<HFocusable, GameObjectHandleHash> mFocusableGrid{RANGE_QUERY_GRID_CELL_SIZE};
+    bool mHasFilledRangeQueryGrids = false;
+
     /**
      * Used to skip onInitialized() when loading via RTTI.
      */
@@ -32,7 +32,14 @@ namespace REGoth
   void Item::createVisual()
   {
     bs::String visual = scriptObjectData().stringValue("VISUAL");
-    Visual::addToSceneObject(SO(), visual);
+
+    // Items are inserted by scripts at any time, which shouldn't stall the game
+    enum : bool
+    {
+      DontWaitForMesh = false,
+    };
+
+    Visual::addToSceneObject(SO(), visual, DontWaitForMesh);
   }
 
   REGOTH_DEFINE_RTTI(Item)
@@ -47,7 +47,13 @@ namespace REGoth
     bs::HBone bone = boneSO->addComponent<bs::CBone>();
     bone->setBoneName(node);
 
-    bool hasCreated = Visual::addToSceneObject(boneSO, visual);
+    // Nothing depends on attachments being shown right away
+    enum : bool
+    {
+      DontWaitForMesh = false,
+    };
+
+    bool hasCreated = Visual::addToSceneObject(boneSO, visual, DontWaitForMesh);
 
     if (!hasCreated)
     {
@@ -38,14 +38,15 @@ namespace REGoth
     }
   }
 
-  bool Visual::addToSceneObject(bs::HSceneObject so, const bs::String& visual)
+  bool Visual::addToSceneObject(bs::HSceneObject so, const bs::String& visual,
+                                bool waitForResources)
   {
     VisualKind kind = guessVisualKind(visual);
 
     if (kind == VisualKind::StaticMesh)
     {
       HVisualStaticMesh mesh = so->addComponent<VisualStaticMesh>();
-      mesh->setMesh(visual);
+      mesh->setMesh(visual, waitForResources);
 
       return true;
     }
@@ -60,7 +61,7 @@ namespace REGoth
     {
       HVisualInteractiveObject mesh = so->addComponent<VisualInteractiveObject>();
 
-      mesh->setVisual(visual);
+      mesh->setVisual(visual, waitForResources);
 
       return true;
     }
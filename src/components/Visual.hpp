@@ -41,11 +41,17 @@ namespace REGoth
      *         `.ASC` are also used for character models. So don't use this function
      *         for characters, please.
      *
-     * @param  so      Scene-Object to create the component for.
-     * @param  visual  Name of the visual to create (The filename, that is), like `STONE.3DS`.
+     * Static meshes and interactive objects not in memory yet can be loaded in the background,
+     * see VisualStaticMesh::setMesh(). Morph meshes are always waited for.
+     *
+     * @param  so                Scene-Object to create the component for.
+     * @param  visual            Name of the visual to create (The filename, that is), like
+     *                           `STONE.3DS`.
+     * @param  waitForResources  Whether to block until the resources of the visual are loaded.
      *
      * @return Whether a visual component has been created.
      */
-    bool addToSceneObject(bs::HSceneObject so, const bs::String& visual);
+    bool addToSceneObject(bs::HSceneObject so, const bs::String& visual,
+                          bool waitForResources = true);
   }
 }
@@ -85,6 +85,10 @@ namespace REGoth
       REGOTH_THROW(InvalidParametersException, "ModelScript should have a name!");
     }
 
+    // Whatever setVisual() is still loading would replace this otherwise
+    mPendingModelScript = {};
+    mPendingVisual.clear();
+
     deleteObjectSubtree();
     mModelScript = modelScript;
 
@@ -98,10 +102,10 @@ namespace REGoth
       REGOTH_THROW(InvalidStateException, "No model script set!");
     }
 
-    for (auto anim : mModelScript->getAnimations())
-    {
-      mAnimationClips[anim->getName()] = anim;
-    }
+    mAnimationTable = AnimationTable::forModelScript(mModelScript);
+
+    // After deserialization, the main animation is already set
+    mPlayingAnimation = mAnimationTable->findAnimation(mPlayingMainAnimation);
   }
 
   void VisualSkeletalAnimation::setMesh(BsZenLib::Res::HMeshWithMaterials mesh)
@@ -145,15 +149,62 @@ namespace REGoth
     setMesh(mModelScript->getMeshes()[0]);
   }
 
-  void VisualSkeletalAnimation::setVisual(const bs::String& visual)
+  void VisualSkeletalAnimation::setVisual(const bs::String& visual, bool waitForVisual)
   {
-    auto modelScript = gOriginalGameResources().modelScript(visual);
+    mPendingModelScript = {};
+    mPendingVisual.clear();
+
+    BsZenLib::Res::HModelScriptFile modelScript;
+
+    if (waitForVisual)
+    {
+      modelScript = gOriginalGameResources().modelScript(visual);
+    }
+    else
+    {
+      auto request = gOriginalGameResources().requestModelScript(visual);
+
+      // Most of the time it's in memory already, so there's no need to wait a frame
+      if (!request.isReady())
+      {
+        mPendingModelScript = request;
+        mPendingVisual      = visual;
+        return;
+      }
+
+      modelScript = request.get();
+    }
 
     if (!modelScript)
     {
       REGOTH_THROW(InvalidParametersException, "Model Script " + visual + " could not be loaded!");
     }
 
+    useModelScript(modelScript);
+  }
+
+  void VisualSkeletalAnimation::update()
+  {
+    if (!mPendingModelScript.isReady()) return;
+
+    auto modelScript  = mPendingModelScript.get();
+    bs::String visual = mPendingVisual;
+
+    mPendingModelScript = {};
+    mPendingVisual.clear();
+
+    if (!modelScript)
+    {
+      REGOTH_LOG(Warning, Uncategorized,
+                 "[VisualSkeletalAnimation] Model Script {0} could not be loaded!", visual);
+      return;
+    }
+
+    useModelScript(modelScript);
+  }
+
+  void VisualSkeletalAnimation::useModelScript(BsZenLib::Res::HModelScriptFile modelScript)
+  {
     setModelScript(modelScript);
 
     // Using the first registered mesh as the default seems to be like the original is doing it
@@ -294,11 +345,11 @@ namespace REGoth
       // gDebug().logDebug("[VisualSkeletalAnimation] " + SO()->getName() + " - " + clip->getName() +
       //                   ": event PLAYCLIP: " + action);
 
-      auto clip = findAnimationClip(action);
+      AnimationTable::AnimationId next = mAnimationTable->findAnimation(action);
 
-      if (clip)
+      if (next != AnimationTable::NO_ANIMATION)
       {
-        playAnimationClip(clip);
+        playAnimation(next);
       }
       else
       {
@@ -320,11 +371,24 @@ namespace REGoth
 
   void VisualSkeletalAnimation::playAnimationClip(HZAnimationClip clip)
   {
-    using namespace bs;
-    using ZAnimationClip = BsZenLib::Res::ZAnimationClip;
+    throwIfNotReadyForRendering();
 
+    playClip(clip, mAnimationTable->findAnimation(clip));
+  }
+
+  void VisualSkeletalAnimation::playAnimation(AnimationTable::AnimationId animation)
+  {
     throwIfNotReadyForRendering();
 
+    playClip(mAnimationTable->clip(animation), animation);
+  }
+
+  void VisualSkeletalAnimation::playClip(HZAnimationClip clip,
+                                         AnimationTable::AnimationId animation)
+  {
+    using namespace bs;
+    using ZAnimationClip = BsZenLib::Res::ZAnimationClip;
+
     if (clip)
     {
       if (isClipLooping(clip))
@@ -349,17 +413,20 @@ namespace REGoth
 
         // TODO: Once blending is implemented, these won't be the main animation clips anymore
         mPlayingMainAnimation = clip;
+        mPlayingAnimation     = animation;
       }
       else
       {
         mSubAnimation->play(clip->mClip);
         mPlayingMainAnimation = clip;
+        mPlayingAnimation     = animation;
       }
     }
     else
     {
       mSubAnimation->stopAll();
       mPlayingMainAnimation = {};
+      mPlayingAnimation     = AnimationTable::NO_ANIMATION;
     }
   }
 
@@ -433,17 +500,43 @@ namespace REGoth
     return transition;
   }
 
-  HZAnimationClip VisualSkeletalAnimation::findAnimationClip(const bs::String& name) const
+  AnimationTable::AnimationId VisualSkeletalAnimation::findTransitionToState(
+      AnimationTable::StateId state) const
   {
-    using namespace bs;
+    throwIfNotReadyForRendering();
+
+    return findTransitionToState(mAnimationTable->stateOf(getPlayingAnimationId()), state);
+  }
+
+  AnimationTable::AnimationId VisualSkeletalAnimation::findTransitionToState(
+      AnimationTable::StateId from, AnimationTable::StateId to) const
+  {
+    throwIfNotReadyForRendering();
+
+    // See findAnimationToTransitionTo()
+    if (!mSubAnimation->isPlaying())
+    {
+      return mAnimationTable->stateAnimation(to);
+    }
 
-    bs::String actualName = mModelScript->getName() + "-" + name;
+    return mAnimationTable->findTransition(from, to);
+  }
 
-    auto result = mAnimationClips.find(actualName);
+  HZAnimationClip VisualSkeletalAnimation::findAnimationClip(const bs::String& name) const
+  {
+    if (!mAnimationTable) return {};
 
-    if (result == mAnimationClips.end()) return {};
+    return mAnimationTable->clip(mAnimationTable->findAnimation(name));
+  }
+
+  const AnimationTable& VisualSkeletalAnimation::animationTable() const
+  {
+    if (!mAnimationTable)
+    {
+      REGOTH_THROW(InvalidStateException, "No model script set!");
+    }
 
-    return result->second;
+    return *mAnimationTable;
   }
 
   bool VisualSkeletalAnimation::isAnimationPlaying(HZAnimationClip clip) const
@@ -458,24 +551,38 @@ namespace REGoth
     return false;
   }
 
-  bs::String VisualSkeletalAnimation::getPlayingAnimationName() const
+  bool VisualSkeletalAnimation::isAnimationPlaying(AnimationTable::AnimationId animation) const
+  {
+    if (animation == AnimationTable::NO_ANIMATION) return false;
+
+    return getPlayingAnimationId() == animation;
+  }
+
+  AnimationTable::AnimationId VisualSkeletalAnimation::getPlayingAnimationId() const
   {
     throwIfNotReadyForRendering();
 
-    if (!mSubAnimation->isPlaying()) return "";
-    if (!mSubAnimation->getClip(0)) return "";
+    if (!mSubAnimation->isPlaying()) return AnimationTable::NO_ANIMATION;
 
-    bs::String full = mSubAnimation->getClip(0)->getName();
+    return mPlayingAnimation;
+  }
 
-    // Strip the "HUMANS-" part
-    return full.substr(full.find_first_of('-') + 1);
+  bs::String VisualSkeletalAnimation::getPlayingAnimationName() const
+  {
+    AnimationTable::AnimationId playing = getPlayingAnimationId();
+
+    if (playing == AnimationTable::NO_ANIMATION) return "";
+
+    return mAnimationTable->name(playing);
   }
 
   bool VisualSkeletalAnimation::isPlayingAnimationInterruptable() const
   {
-    bs::String name = getPlayingAnimationName();
+    AnimationTable::AnimationId playing = getPlayingAnimationId();
+
+    if (playing == AnimationTable::NO_ANIMATION) return true;
 
-    return name.find("-T_") == bs::String::npos;
+    return mAnimationTable->isInterruptable(playing);
   }
 
   bool VisualSkeletalAnimation::isPlayingFlyingAnimation() const
@@ -488,7 +595,11 @@ namespace REGoth
 
   bs::String VisualSkeletalAnimation::getStateFromPlayingAnimation() const
   {
-    return AnimationState::getStateName(getPlayingAnimationName());
+    AnimationTable::StateId state = mAnimationTable->stateOf(getPlayingAnimationId());
+
+    if (state == AnimationTable::NO_STATE) return "";
+
+    return mAnimationTable->stateName(state);
   }
 
   bs::Vector3 VisualSkeletalAnimation::resolveFrameRootMotion()
@@ -530,25 +641,31 @@ namespace REGoth
     // Comparing floats here is intentional, since we don't touch them in the meantime.
     if (then != now)
     {
+      const bool isLooping = mSubAnimation->getWrapMode() == bs::AnimWrapMode::Loop;
+
       // Root motion has to be calculated using non-looping times since it needs to find the
       // first and last frames of animations.
-      if (mSubAnimation->getWrapMode() == bs::AnimWrapMode::Loop)
+      if (isLooping)
       {
         then = fmod(then, clipNow->getLength());
         now  = fmod(now, clipNow->getLength());
       }
+      else if (now < then)
+      {
+        // The clip has been started over. It didn't wrap, so the rest of the previous run
+        // must not be added.
+        then = 0.0f;
+      }
 
-      if (now < then)
+      if (isPlayingMainAnimation(clipNow))
       {
-        // Animation wrapped
-        // FIXME: Commented out because it doesn't work yet. These lines cause NPCs with
-        //        static animations to slide around. Some non-looped animations produce
-        //        weird jumps (ie. T_JUMPB).
-        // motion += AnimationState::getRootMotionSince(clipNow, 0.0f, now);
-        // motion += AnimationState::getRootMotionSince(clipNow, then, clipNow->getLength());
+        // Only looping animations get here with `now` before `then`, in which case the
+        // sampled root motion adds up the motion over the wrap
+        motion += mAnimationTable->rootMotion(mPlayingAnimation).motionSince(then, now);
       }
-      else
+      else if (now >= then)
       {
+        // Wrapping is only handled by the sampled root motion above
         motion += AnimationState::getRootMotionSince(clipNow, then, now);
       }
 
@@ -562,6 +679,13 @@ namespace REGoth
     return motion;
   }
 
+  bool VisualSkeletalAnimation::isPlayingMainAnimation(const bs::HAnimationClip& clip) const
+  {
+    if (mPlayingAnimation == AnimationTable::NO_ANIMATION) return false;
+
+    return mAnimationTable->clip(mPlayingAnimation)->mClip == clip;
+  }
+
   bool VisualSkeletalAnimation::isPlayingIdleAnimation() const
   {
     if (!mPlayingMainAnimation) return false;
@@ -7,6 +7,8 @@
 #include <BsZenLib/ZenResources.hpp>
 #include <RTTI/RTTIUtil.hpp>
 #include <Scene/BsComponent.h>
+#include <animation/AnimationTable.hpp>
+#include <original-content/OriginalGameResources.hpp>
 
 namespace REGoth
 {
@@ -72,11 +74,26 @@ namespace REGoth
      *
      * Will automatically resolve and set the model script and assign its first mesh.
      *
-     * Throws if that visual does not exist.
+     * If the model script is not in memory yet, this can either wait for it to be loaded
+     * or load it in the background. In the latter case, the visual is set up once the model
+     * script has arrived. Until then, hasVisual() stays false, or the previous visual is kept
+     * if there was one.
      *
-     * @param  visual  Name of the visual (model-script) to use, e.g. `HUMANS.MDS`.
+     * Throws if that visual does not exist. If that only turns out after loading it in the
+     * background, it is just logged.
+     *
+     * @param  visual         Name of the visual (model-script) to use, e.g. `HUMANS.MDS`.
+     * @param  waitForVisual  Whether to block until the model script is loaded.
      */
-    void setVisual(const bs::String& visual);
+    void setVisual(const bs::String& visual, bool waitForVisual = true);
+
+    /**
+     * @return Whether a visual set via setVisual() is still being loaded in the background.
+     */
+    bool isLoadingVisual() const
+    {
+      return mPendingModelScript.isValid();
+    }
 
     /**
      * @return Whether a visual has been assigned to this component, so that it can play animations.
@@ -125,6 +142,38 @@ namespace REGoth
      */
     void playAnimationClip(HZAnimationClip clip);
 
+    /**
+     * @return The animations of the current model script, for working with animation IDs
+     *         instead of names. Throws if no model script has been set.
+     */
+    const AnimationTable& animationTable() const;
+
+    /**
+     * Plays the given animation of the animationTable(). Stops all animations on NO_ANIMATION.
+     */
+    void playAnimation(AnimationTable::AnimationId animation);
+
+    /**
+     * @return Whether the given animation of the animationTable() is currently playing.
+     */
+    bool isAnimationPlaying(AnimationTable::AnimationId animation) const;
+
+    /**
+     * @return ID of the currently playing animation inside the animationTable().
+     *         NO_ANIMATION if none.
+     */
+    AnimationTable::AnimationId getPlayingAnimationId() const;
+
+    /**
+     * Same as findAnimationToTransitionTo(), but for a state of the animationTable().
+     *
+     * @return The animation to play to reach the given state. NO_ANIMATION if the transition
+     *         is not possible.
+     */
+    AnimationTable::AnimationId findTransitionToState(AnimationTable::StateId state) const;
+    AnimationTable::AnimationId findTransitionToState(AnimationTable::StateId from,
+                                                      AnimationTable::StateId to) const;
+
     /**
      * Searches for the default idle animation for this character and plays it.
      *
@@ -202,6 +251,7 @@ namespace REGoth
 
   protected:
     void onInitialized() override;
+    void update() override;
 
     /**
      * @return A list of animations to try playing after initialization or
@@ -259,10 +309,27 @@ namespace REGoth
 
   private:
     /**
-     * Fills mAnimations.
+     * Sets the model script and assigns its first mesh, see setVisual().
+     */
+    void useModelScript(BsZenLib::Res::HModelScriptFile modelScript);
+
+    /**
+     * Gets the animation table of the current model script.
      */
     void createAnimationMap();
 
+    /**
+     * Plays the given clip, see playAnimationClip(). `animation` is its ID inside
+     * the animation table, if it is in there.
+     */
+    void playClip(HZAnimationClip clip, AnimationTable::AnimationId animation);
+
+    /**
+     * @return Whether the given clip is the one of the main animation found in the
+     *         animation table.
+     */
+    bool isPlayingMainAnimation(const bs::HAnimationClip& clip) const;
+
     /**
      * @return Whether the given mesh is registered inside the currently set model script
      */
@@ -318,6 +385,13 @@ namespace REGoth
     BsZenLib::Res::HModelScriptFile mModelScript; /**< Model-script of the displayed model */
     BsZenLib::Res::HMeshWithMaterials mMesh; /**< Currently displayed mesh, from the model script */
 
+    /**
+     * Model script being loaded in the background, see setVisual(). Only the name is saved,
+     * the request is made again after loading.
+     */
+    ResourceRequest<BsZenLib::Res::HModelScriptFile> mPendingModelScript;
+    bs::String mPendingVisual;
+
     // Object Sub Tree --------------------------------------------------------
     bs::Vector<bs::HSceneObject> mSubObjects; /**< All created sub-objects by this component */
 
@@ -326,13 +400,19 @@ namespace REGoth
     HNodeVisuals mSubNodeVisuals;   /**< The NodeVisuals-Component created inside a sub object */
 
     // Animation --------------------------------------------------------------
-    bs::Map<bs::String, HZAnimationClip> mAnimationClips; /**< Animation names -> Clip */
+    bs::SPtr<const AnimationTable> mAnimationTable; /**< All animations of the model script */
     bs::HAnimationClip mRootMotionLastClip; /**< Last clip we got the root motion from */
     float mRootMotionLastTime = 0.0f; /**< Last time the animation was queried for root motion */
 
     HZAnimationClip mPlayingMainAnimation; /**< Handle of the currently playing main animation. May
                                               be invalid. */
 
+    /**
+     * ID of mPlayingMainAnimation inside the animation table. Not saved, since it's found
+     * again in createAnimationMap().
+     */
+    AnimationTable::AnimationId mPlayingAnimation = AnimationTable::NO_ANIMATION;
+
   public:
     REGOTH_DECLARE_RTTI(VisualSkeletalAnimation)
 
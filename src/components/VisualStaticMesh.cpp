@@ -14,10 +14,45 @@ namespace REGoth
     mRenderable = createRenderable();
   }
 
-  void VisualStaticMesh::setMesh(const bs::String& originalMeshFileName)
+  void VisualStaticMesh::setMesh(const bs::String& originalMeshFileName, bool waitForMesh)
   {
-    auto mesh = gOriginalGameResources().staticMesh(originalMeshFileName);
+    mPendingMesh = {};
+    mPendingMeshName.clear();
 
+    if (waitForMesh)
+    {
+      showMesh(gOriginalGameResources().staticMesh(originalMeshFileName), originalMeshFileName);
+      return;
+    }
+
+    auto request = gOriginalGameResources().requestStaticMesh(originalMeshFileName);
+
+    // Most of the time it's in memory already, so there's no need to wait a frame
+    if (request.isReady())
+    {
+      showMesh(request.get(), originalMeshFileName);
+      return;
+    }
+
+    mRenderable->setMesh(bs::HMesh());
+
+    mPendingMesh     = request;
+    mPendingMeshName = originalMeshFileName;
+  }
+
+  void VisualStaticMesh::update()
+  {
+    if (!mPendingMesh.isReady()) return;
+
+    showMesh(mPendingMesh.get(), mPendingMeshName);
+
+    mPendingMesh = {};
+    mPendingMeshName.clear();
+  }
+
+  void VisualStaticMesh::showMesh(BsZenLib::Res::HMeshWithMaterials mesh,
+                                  const bs::String& originalMeshFileName)
+  {
     if (!mesh)
     {
       REGOTH_LOG(Warning, Uncategorized, "[VisualStaticMesh] Failed to load mesh: {0}",
@@ -7,6 +7,7 @@
 #include <BsZenLib/ZenResources.hpp>
 #include <RTTI/RTTIUtil.hpp>
 #include <Scene/BsComponent.h>
+#include <original-content/OriginalGameResources.hpp>
 
 namespace REGoth
 {
@@ -24,13 +25,34 @@ namespace REGoth
     /**
      * Set which mesh this component should display.
      *
+     * If the mesh is not in memory yet, this can either wait for it to be loaded or
+     * load it in the background. In the latter case, nothing is shown until the mesh
+     * has arrived.
+     *
      * @param  originalMeshFile  The name of the mesh file the original game would
      *                           have set (e.g. "STONE.3DS").
+     * @param  waitForMesh       Whether to block until the mesh is loaded.
+     */
+    void setMesh(const bs::String& originalMeshFileName, bool waitForMesh = true);
+
+    /**
+     * @return Whether a mesh set via setMesh() is still being loaded in the background.
      */
-    void setMesh(const bs::String& originalMeshFileName);
+    bool isLoadingMesh() const
+    {
+      return mPendingMesh.isValid();
+    }
+
+  protected:
+    void update() override;
 
   private:
 
+    /**
+     * Puts the loaded mesh onto the renderable.
+     */
+    void showMesh(BsZenLib::Res::HMeshWithMaterials mesh, const bs::String& originalMeshFileName);
+
     /**
      * Creates the renderable on the scene object
      */
@@ -49,6 +71,13 @@ namespace REGoth
      */
     bs::HRenderable mRenderable;
 
+    /**
+     * Mesh being loaded in the background, see setMesh(). Only the name is saved, the
+     * request is made again after loading.
+     */
+    ResourceRequest<BsZenLib::Res::HMeshWithMaterials> mPendingMesh;
+    bs::String mPendingMeshName;
+
   public:
     REGOTH_DECLARE_RTTI(VisualStaticMesh)
 
@@ -1,18 +1,33 @@
 #include "Waynet.hpp"
+#include <BsZenLib/ImportPath.hpp>
 #include <Debug/BsDebugDraw.h>
 #include <RTTI/RTTI_Waynet.hpp>
 #include <Scene/BsSceneObject.h>
+#include <Utility/BsTimer.h>
 #include <components/AnchoredTextLabels.hpp>
 #include <components/Freepoint.hpp>
 #include <components/Waypoint.hpp>
+#include <log/logging.hpp>
 
 namespace REGoth
 {
+  /**
+   * Marks a waypoint without predecessor in the path search.
+   */
+  static constexpr bs::UINT32 NO_NODE = std::numeric_limits<bs::UINT32>::max();
+
   Waynet::Waynet(const bs::HSceneObject& parent)
       : bs::Component(parent)
   {
   }
 
+  void Waynet::onDestroyed()
+  {
+    mLineOfSight.logStats();
+
+    bs::Component::onDestroyed();
+  }
+
   HWaypoint Waynet::findWaypoint(const bs::String& name)
   {
     bs::HSceneObject waypointSO = SO()->findChild(name);
@@ -26,11 +41,19 @@ namespace REGoth
   {
     mWaypoints.push_back(waypoint);
     mWaypoints.back()->mIndex = mWaypoints.size() - 1;
+
+    // Search structures do not know about the new waypoint yet
+    mWaypointPositions.clear();
+    mGraphEdgeOffsets.clear();
+    mRoutingTable.clear();
   }
 
   void Waynet::addFreepoint(HFreepoint freepoint)
   {
     mFreepoints.push_back(freepoint);
+
+    // Search structures do not know about the new freepoint yet
+    mFreepointPositions.clear();
   }
 
   void Waynet::debugDraw(const REGoth::HAnchoredTextLabels& textLabels)
@@ -58,37 +81,21 @@ namespace REGoth
     }
 
     // No waypoints at all?
-    if (mWaypointPositions.empty())
+    if (mWaypointTree.isEmpty())
     {
       return {};
     }
 
-    bs::UINT32 secondNearestIndex = 0;
-    float secondNearestDistance   = std::numeric_limits<float>().max();
-
-    bs::UINT32 nearestIndex = 0;
-    float nearestDistance   = std::numeric_limits<float>().max();
+    KDTree::TwoNearest found = mWaypointTree.findTwoNearest(position);
 
-    for (bs::UINT32 i = 0; i < (bs::UINT32)mWaypointPositions.size(); i++)
+    if (found.secondNearest == KDTree::NO_POINT)
     {
-      float thisDistance = (position - mWaypointPositions[i]).squaredLength();
-
-      if (thisDistance < nearestDistance)
-      {
-        nearestDistance = thisDistance;
-        nearestIndex    = i;
-      }
-
-      if (thisDistance > nearestDistance && thisDistance < secondNearestDistance)
-      {
-        secondNearestDistance = thisDistance;
-        secondNearestIndex    = i;
-      }
+      found.secondNearest = found.nearest;
     }
 
     ClosestWaypoints result;
-    result.closest       = mWaypoints[nearestIndex];
-    result.secondClosest = mWaypoints[secondNearestIndex];
+    result.closest       = mWaypoints[found.nearest];
+    result.secondClosest = mWaypoints[found.secondNearest];
 
     return result;
   }
@@ -101,163 +108,427 @@ namespace REGoth
       populateFreepointPositionCache();
     }
 
-    // No freepoints at all?
-    if (mFreepointPositions.empty())
+    const KDTree& tree = freepointTreeFor(name);
+
+    // No matching freepoints at all?
+    if (tree.isEmpty())
     {
       return {};
     }
 
-    bs::UINT32 secondNearestIndex = 0;
-    float secondNearestDistance   = std::numeric_limits<float>().max();
+    KDTree::TwoNearest found = tree.findTwoNearest(position);
+
+    if (found.secondNearest == KDTree::NO_POINT)
+    {
+      found.secondNearest = found.nearest;
+    }
+
+    ClosestFreepoints result;
+    result.closest       = mFreepoints[found.nearest];
+    result.secondClosest = mFreepoints[found.secondNearest];
 
-    bs::UINT32 nearestIndex = 0;
-    float nearestDistance   = std::numeric_limits<float>().max();
+    return result;
+  }
 
-    for (bs::UINT32 i = 0; i < (bs::UINT32)mFreepointPositions.size(); i++)
+  const KDTree& Waynet::freepointTreeFor(const bs::String& name)
+  {
+    auto it = mFreepointTreesByName.find(name);
+
+    if (it != mFreepointTreesByName.end())
     {
-      float thisDistance = (position - mFreepointPositions[i]).squaredLength();
+      return it->second;
+    }
 
-      if (thisDistance < nearestDistance)
-      {
-        nearestDistance = thisDistance;
-        nearestIndex    = i;
-      }
+    bs::Vector<bs::UINT32> matching;
 
-      if (thisDistance > nearestDistance && thisDistance < secondNearestDistance)
+    for (bs::UINT32 i = 0; i < (bs::UINT32)mFreepoints.size(); i++)
+    {
+      if (mFreepoints[i]->SO()->getName().find(name) != bs::String::npos)
       {
-        secondNearestDistance = thisDistance;
-        secondNearestIndex    = i;
+        matching.push_back(i);
       }
     }
 
-    ClosestFreepoints result;
-    result.closest       = mFreepoints[nearestIndex];
-    result.secondClosest = mFreepoints[secondNearestIndex];
+    KDTree& tree = mFreepointTreesByName[name];
+    tree.build(mFreepointPositions, matching);
 
-    return result;
+    return tree;
   }
 
   bs::Vector<HWaypoint> Waynet::findWay(HWaypoint from, HWaypoint to)
   {
-    if (!hasCachedWaypointPositions())
+    if (!from || !to) return {};
+
+    if (!hasSearchGraph())
     {
-      populateWaypointPositionCache();
+      populateSearchGraph();
     }
 
-    if (!from || !to) return {};
+    const bs::UINT32 start = from->mIndex;
+    const bs::UINT32 goal  = to->mIndex;
 
-    // FIXME: HACK, this waypoint does not seem to go anywhere but that takes AGES to figure out!
-    if (to->getName() == "SPAWN_TALL_PATH_BANDITOS2_02_04") return {};
+    if (start >= mWaypoints.size() || goal >= mWaypoints.size()) return {};
 
-    // FIXME: This is not a very fast implementation. Improve!
-    // FIXME: The FIXME above is as old as old REGoth. And now part of REGoth-bs! Wohoo!
-    //        Please please, somebody, improve this. This code is absolutely bat-shit ugly.
-    //        Not even I understand it anymore. When I wrote this, only God and I were knew
-    //        how it worked. Now only God knows.
-    //
-    //        Commets tagged with PM are from Present Me. Have fun!
+    if (isUsingRoutingTable())
+    {
+      return findWayUsingRoutingTable(start, goal);
+    }
+
+    return findWayBySearching(start, goal);
+  }
 
-    // Simple Dijkstra-Implementation. Totally non-optimized.
+  AI::LineOfSightCache& Waynet::lineOfSight()
+  {
+    if (!hasSearchGraph())
+    {
+      populateSearchGraph();
+    }
 
-    constexpr size_t NO_NODE = SIZE_MAX;
+    return mLineOfSight;
+  }
 
-    // Give all other nodes a distance of infinity // PM: What other nodes?!
-    std::vector<float> distances(mWaypoints.size(), FLT_MAX);
-    std::vector<size_t> prev(mWaypoints.size(), NO_NODE);
+  bs::UINT32 Waynet::indexOf(HWaypoint waypoint) const
+  {
+    if (!waypoint) return AI::RaycastBatch::NO_WAYPOINT;
 
-    std::set<size_t> unvisitedSet;
+    return waypoint->mIndex;
+  }
 
-    // PM: Remember a complete set of all waypoints for speed. Waypoints are not
-    //     supposed to be created during gamplay.
-    static std::set<size_t> unvisitedSetCached;
+  bs::Vector<HWaypoint> Waynet::findMilestones(HWaypoint from, HWaypoint to)
+  {
+    if (!from || !to) return {};
 
-    if (unvisitedSetCached.empty())
+    if (!hasSearchGraph())
     {
-      // Fill a set with 0..n, all nodes are unvisited right now
-      for (size_t i = 0; i < mWaypoints.size(); i++)
-      {
-        unvisitedSetCached.insert(i);
-      }
+      populateSearchGraph();
+    }
+
+    const bs::UINT32 start = from->mIndex;
+    const bs::UINT32 goal  = to->mIndex;
+
+    if (start >= mWaypoints.size() || goal >= mWaypoints.size()) return {};
+
+    bs::Vector<bs::UINT32> milestones =
+        mClusters.findMilestones(start, goal, mWaypointPositions[goal]);
+
+    bs::Vector<HWaypoint> result;
+    result.reserve(milestones.size());
+
+    for (bs::UINT32 index : milestones)
+    {
+      result.push_back(mWaypoints[index]);
     }
 
-    unvisitedSet = unvisitedSetCached;
+    return result;
+  }
+
+  bs::Vector<HWaypoint> Waynet::findWayBySearching(bs::UINT32 start, bs::UINT32 goal)
+  {
+    // A* over the search graph. The straight line distance to the goal is used as heuristic,
+    // which never overestimates since the connections between waypoints are straight lines too.
+    const bs::Vector3& goalPosition = mWaypointPositions[goal];
+
+    beginPathSearch();
+
+    PathSearchNode& startNode     = mPathSearchNodes[start];
+    startNode.costFromStart       = 0.0f;
+    startNode.estimatedCostToGoal = mWaypointPositions[start].distance(goalPosition);
+    startNode.previous            = NO_NODE;
+    startNode.searchMark          = mPathSearchMark;
+    startNode.isClosed            = false;
 
-    // Init startnode with a distance of 0
-    distances[from->mIndex] = 0.0f;
+    pushPathSearchHeap(start);
 
-    // PM: Awesome coding style #1: Use names as short as possible! This might have made
-    // sense as some article on the algorithm used the same name, but who knows
-    // where that may be? Anyways, could mean "current node", could mean something else.
-    size_t cn = from->mIndex;
+    bool hasReachedGoal = false;
 
-    do
+    while (!mPathSearchHeap.empty())
     {
-      // PM: I don't even know, too many loops, too deeply nested.
-      // Whatever, let's hope it doesn't break..
-      for (auto e : mWaypoints[cn]->allPaths())
+      bs::UINT32 current = popPathSearchHeap();
+
+      if (current == goal)
       {
-        bs::UINT32 index = e->mIndex;
-        if (unvisitedSet.find(index) != unvisitedSet.end())
-        {
-          // Check if this actually was a shorter path
-          float tentativeDist =
-              distances[cn] + (mWaypointPositions[cn] - mWaypointPositions[index]).squaredLength();
-          if (distances[index] > tentativeDist)
-          {
-            distances[index] = tentativeDist;
-            prev[index]      = cn;
-          }
-        }
+        hasReachedGoal = true;
+        break;
       }
 
-      unvisitedSet.erase(cn);
+      mPathSearchNodes[current].isClosed = true;
+
+      const float currentCost = mPathSearchNodes[current].costFromStart;
 
-      if (!unvisitedSet.empty())
+      for (bs::UINT32 e = mGraphEdgeOffsets[current]; e < mGraphEdgeOffsets[current + 1]; e++)
       {
-        size_t smallest = *unvisitedSet.begin();
-        for (size_t n : unvisitedSet)
+        bs::UINT32 neighbour = mGraphNeighbours[e];
+        float cost           = currentCost + mGraphEdgeLengths[e];
+
+        PathSearchNode& node = mPathSearchNodes[neighbour];
+
+        if (node.searchMark != mPathSearchMark)
+        {
+          // First time seeing this one during this search
+          node.costFromStart       = cost;
+          node.estimatedCostToGoal = mWaypointPositions[neighbour].distance(goalPosition);
+          node.previous            = current;
+          node.searchMark          = mPathSearchMark;
+          node.isClosed            = false;
+
+          pushPathSearchHeap(neighbour);
+        }
+        else if (!node.isClosed)
         {
-          if (distances[smallest] > distances[n])
+          if (cost < node.costFromStart)
+          {
+            node.costFromStart = cost;
+            node.previous      = current;
+
+            siftUpPathSearchHeap(node.heapPosition);
+          }
+          else if (cost == node.costFromStart && current < node.previous)
           {
-            smallest = n;
+            // Equally long way: Prefer the lower index so the result does not depend on
+            // the order in which the nodes were expanded.
+            node.previous = current;
           }
         }
-
-        cn = smallest;
       }
+    }
 
-      // PM: Now that's a condition. Good look figuring that out, ouch. Look, we even have a
-      // unsigned -1 in there! I love unsigned negative numbers!
-    } while (unvisitedSet.find(to->mIndex) != unvisitedSet.end() && cn != NO_NODE &&
-             cn != to->mIndex);
-
-    // No path found
-    if (cn == NO_NODE) return {};
+    if (!hasReachedGoal) return {};
 
-    // Put path together
+    // Put path together, starting from the goal
     bs::Vector<HWaypoint> path;
-    cn = to->mIndex;
 
-    while (prev[cn] != NO_NODE)
+    for (bs::UINT32 n = goal; n != NO_NODE; n = mPathSearchNodes[n].previous)
     {
-      path.push_back(mWaypoints[cn]);
-      cn = prev[cn];
+      path.push_back(mWaypoints[n]);
     }
 
-    // Happens on short paths // PM: What are you talking about? Back of the path not being the same
-    //                        // as the starting pos? How does that happen??
-    if (!path.empty() && path.back() != from)
+    std::reverse(path.begin(), path.end());
+
+    return path;
+  }
+
+  bs::Vector<HWaypoint> Waynet::findWayUsingRoutingTable(bs::UINT32 start, bs::UINT32 goal)
+  {
+    bs::Vector<HWaypoint> path;
+    path.push_back(mWaypoints[start]);
+
+    for (bs::UINT32 current = start; current != goal;)
     {
-      path.push_back(from);
-    };
+      current = mRoutingTable.nextHop(current, goal);
 
-    // PM: Seems like I fucked up the order at some point and just rolled with reversing afterwards.
-    //     Nice! Efficient!
-    std::reverse(path.begin(), path.end());
+      // A shortest way never visits a waypoint twice, so anything longer is broken
+      if (current == WaynetRoutingTable::NO_WAYPOINT || path.size() >= mWaypoints.size())
+      {
+        return {};
+      }
+
+      path.push_back(mWaypoints[current]);
+    }
 
     return path;
   }
 
+  void Waynet::enableRoutingTable(const bs::String& cacheName)
+  {
+    mRoutingTableCacheName = cacheName;
+    mRoutingTable.clear();
+
+    if (hasSearchGraph())
+    {
+      loadOrBuildRoutingTable();
+    }
+  }
+
+  void Waynet::disableRoutingTable()
+  {
+    mRoutingTableCacheName = "";
+    mRoutingTable.clear();
+  }
+
+  void Waynet::loadOrBuildRoutingTable()
+  {
+    if (mRoutingTableCacheName.empty()) return;
+
+    bs::Path path = BsZenLib::GothicPathToCachedWorld(mRoutingTableCacheName + ".routes");
+
+    bs::UINT64 graphHash =
+        WaynetRoutingTable::hashGraph(mGraphEdgeOffsets, mGraphNeighbours, mGraphEdgeLengths);
+
+    if (mRoutingTable.load(path, graphHash)) return;
+
+    REGOTH_LOG(Info, Uncategorized, "[Waynet] Building routing table for {0} waypoints",
+               mWaypoints.size());
+
+    bs::Timer timer;
+
+    mRoutingTable.build(mGraphEdgeOffsets, mGraphNeighbours, mGraphEdgeLengths);
+
+    REGOTH_LOG(Info, Uncategorized, "[Waynet] Built routing table with {0} runs in {1} ms",
+               mRoutingTable.numRuns(), timer.getMilliseconds());
+
+    mRoutingTable.save(path, graphHash);
+  }
+
+  void Waynet::rebuildSearchStructures()
+  {
+    populateWaypointPositionCache();
+    populateFreepointPositionCache();
+    populateSearchGraph();
+  }
+
+  void Waynet::populateSearchGraph()
+  {
+    if (!hasCachedWaypointPositions())
+    {
+      populateWaypointPositionCache();
+    }
+
+    const bs::UINT32 numWaypoints = (bs::UINT32)mWaypoints.size();
+
+    mGraphEdgeOffsets.clear();
+    mGraphNeighbours.clear();
+    mGraphEdgeLengths.clear();
+
+    mGraphEdgeOffsets.reserve(numWaypoints + 1);
+
+    for (bs::UINT32 i = 0; i < numWaypoints; i++)
+    {
+      mGraphEdgeOffsets.push_back((bs::UINT32)mGraphNeighbours.size());
+
+      for (const HWaypoint& to : mWaypoints[i]->allPaths())
+      {
+        if (!to || to->mIndex >= numWaypoints) continue;
+
+        mGraphNeighbours.push_back(to->mIndex);
+        mGraphEdgeLengths.push_back(mWaypointPositions[i].distance(mWaypointPositions[to->mIndex]));
+      }
+    }
+
+    mGraphEdgeOffsets.push_back((bs::UINT32)mGraphNeighbours.size());
+
+    mPathSearchNodes.resize(numWaypoints);
+    mPathSearchHeap.reserve(numWaypoints);
+
+    mClusters.build(mWaypointPositions, mGraphEdgeOffsets, mGraphNeighbours, mGraphEdgeLengths);
+    mLineOfSight.reset(mGraphEdgeOffsets, mGraphNeighbours);
+
+    loadOrBuildRoutingTable();
+  }
+
+  bool Waynet::hasSearchGraph() const
+  {
+    return !mGraphEdgeOffsets.empty();
+  }
+
+  void Waynet::beginPathSearch()
+  {
+    mPathSearchHeap.clear();
+    mPathSearchMark++;
+
+    // Wrapped around, so old marks could be mistaken for current ones
+    if (mPathSearchMark == 0)
+    {
+      for (PathSearchNode& node : mPathSearchNodes)
+      {
+        node.searchMark = 0;
+      }
+
+      mPathSearchMark = 1;
+    }
+  }
+
+  bool Waynet::isPathSearchHeapEntryLess(bs::UINT32 a, bs::UINT32 b) const
+  {
+    const PathSearchNode& nodeA = mPathSearchNodes[a];
+    const PathSearchNode& nodeB = mPathSearchNodes[b];
+
+    float totalA = nodeA.costFromStart + nodeA.estimatedCostToGoal;
+    float totalB = nodeB.costFromStart + nodeB.estimatedCostToGoal;
+
+    if (totalA != totalB) return totalA < totalB;
+
+    // Keeps the expansion order independent of the heaps internal layout
+    return a < b;
+  }
+
+  void Waynet::pushPathSearchHeap(bs::UINT32 node)
+  {
+    mPathSearchHeap.push_back(node);
+    mPathSearchNodes[node].heapPosition = (bs::UINT32)mPathSearchHeap.size() - 1;
+
+    siftUpPathSearchHeap(mPathSearchNodes[node].heapPosition);
+  }
+
+  bs::UINT32 Waynet::popPathSearchHeap()
+  {
+    bs::UINT32 top = mPathSearchHeap.front();
+
+    mPathSearchHeap.front() = mPathSearchHeap.back();
+    mPathSearchHeap.pop_back();
+
+    if (!mPathSearchHeap.empty())
+    {
+      mPathSearchNodes[mPathSearchHeap.front()].heapPosition = 0;
+      siftDownPathSearchHeap(0);
+    }
+
+    return top;
+  }
+
+  void Waynet::siftUpPathSearchHeap(bs::UINT32 position)
+  {
+    bs::UINT32 node = mPathSearchHeap[position];
+
+    while (position > 0)
+    {
+      bs::UINT32 parent = (position - 1) / 2;
+
+      if (!isPathSearchHeapEntryLess(node, mPathSearchHeap[parent])) break;
+
+      bs::UINT32 moved                     = mPathSearchHeap[parent];
+      mPathSearchHeap[position]            = moved;
+      mPathSearchNodes[moved].heapPosition = position;
+
+      position = parent;
+    }
+
+    mPathSearchHeap[position]           = node;
+    mPathSearchNodes[node].heapPosition = position;
+  }
+
+  void Waynet::siftDownPathSearchHeap(bs::UINT32 position)
+  {
+    const bs::UINT32 size = (bs::UINT32)mPathSearchHeap.size();
+    bs::UINT32 node       = mPathSearchHeap[position];
+
+    while (true)
+    {
+      bs::UINT32 child = position * 2 + 1;
+
+      if (child >= size) break;
+
+      bool isRightChildLess =
+          child + 1 < size &&
+          isPathSearchHeapEntryLess(mPathSearchHeap[child + 1], mPathSearchHeap[child]);
+
+      if (isRightChildLess)
+      {
+        child++;
+      }
+
+      if (!isPathSearchHeapEntryLess(mPathSearchHeap[child], node)) break;
+
+      bs::UINT32 moved                     = mPathSearchHeap[child];
+      mPathSearchHeap[position]            = moved;
+      mPathSearchNodes[moved].heapPosition = position;
+
+      position = child;
+    }
+
+    mPathSearchHeap[position]           = node;
+    mPathSearchNodes[node].heapPosition = position;
+  }
+
   void Waynet::populateWaypointPositionCache()
   {
     mWaypointPositions.clear();
@@ -267,6 +538,8 @@ namespace REGoth
     {
       mWaypointPositions.push_back(wp->SO()->getTransform().pos());
     }
+
+    mWaypointTree.build(mWaypointPositions);
   }
 
   void Waynet::populateFreepointPositionCache()
@@ -278,6 +551,9 @@ namespace REGoth
     {
       mFreepointPositions.push_back(fp->SO()->getTransform().pos());
     }
+
+    // Built on demand as they refer to the positions just replaced
+    mFreepointTreesByName.clear();
   }
 
   bool Waynet::hasCachedWaypointPositions() const
@@ -1,7 +1,11 @@
 #pragma once
 #include <BsPrerequisites.h>
 #include <Scene/BsComponent.h>
+#include <AI/LineOfSight.hpp>
 #include <RTTI/RTTIUtil.hpp>
+#include <world/KDTree.hpp>
+#include <world/WaynetClusters.hpp>
+#include <world/WaynetRoutingTable.hpp>
 
 namespace REGoth
 {
@@ -104,8 +108,9 @@ namespace REGoth
      *
      * @param  position  Position to search around.
      *
-     * @return Closest Waypoint to the given position. Should only be empty
-     *         if no waypoint exists at all.
+     * @return Closest and second closest Waypoint to the given position. Should only be
+     *         empty if no waypoint exists at all. If there is only a single waypoint,
+     *         both will be the same.
      */
     ClosestWaypoints findClosestWaypointTo(const bs::Vector3& position);
 
@@ -116,25 +121,91 @@ namespace REGoth
     };
 
     /**
-     * Searches the closest Freepoint to the given position.
+     * Searches the closest Freepoint with the given name to the given position.
+     *
+     * Like in the original, a Freepoint matches if its name *contains* the given
+     * one, so `FP_ROAM` will find `FP_ROAM_OW_WOLF_01` and the like.
      *
      * Does not check whether the Freepoint is obstructed by anything and
      * ignores all waypoint connections.
      *
+     * @param  name      Name (or part of the name) of the Freepoints to consider.
+     *                   Pass an empty string to consider all of them.
      * @param  position  Position to search around.
      *
-     * @return Closest Freepoint to the given position. Should only be empty
-     *         if no Freepoint exists at all.
+     * @return Closest and second closest matching Freepoint to the given position.
+     *         Should only be empty if no matching Freepoint exists at all. If there is
+     *         only a single matching one, both will be the same.
      */
     ClosestFreepoints findClosestFreepointTo(const bs::String& name, const bs::Vector3& position);
 
     /**
-     * Finds a way between two waypoints in the given waypoint instance
+     * Finds the shortest way between two waypoints in the given waypoint instance.
+     *
+     * If there are multiple ways of the same length, the one going over the waypoints
+     * with the lower indices is taken, so the same query will always yield the same way.
+     *
+     * If the routing table is enabled, see enableRoutingTable(), the way is read from
+     * there instead of searching the waynet.
      *
-     * @return List of all waypoints that need to be visited. Will be empty if no path was found.
+     * @return List of all waypoints that need to be visited, including `from` and `to`.
+     *         Will be empty if no path was found.
      */
     bs::Vector<HWaypoint> findWay(HWaypoint from, HWaypoint to);
 
+    /**
+     * Finds the milestones of the shortest way between two waypoints. These are only the
+     * waypoints where the way goes from one cluster of waypoints into another, see
+     * WaynetClusters, so only a small part of the waynet needs to be looked at.
+     *
+     * The waypoints between two consecutive milestones can then be found via findWay()
+     * once they are needed. For waypoints close to each other, this just returns both.
+     *
+     * @return List of milestones, including `from` and `to`. Will be empty if no path
+     *         was found.
+     */
+    bs::Vector<HWaypoint> findMilestones(HWaypoint from, HWaypoint to);
+
+    /**
+     * Makes findWay() use a precomputed routing table, see WaynetRoutingTable.
+     *
+     * The table is cached on disk under the given name. If there is no cached table
+     * or it was built for a different waynet, it is built and cached again, which
+     * takes a moment on the bigger worlds.
+     *
+     * If the search structures exist already, the table is loaded or built right away.
+     * Otherwise this happens once they are built, see rebuildSearchStructures().
+     *
+     * @param  cacheName  Name to cache the table under, usually the name of the ZEN.
+     */
+    void enableRoutingTable(const bs::String& cacheName);
+
+    /**
+     * Drops the routing table, so findWay() goes back to searching the waynet.
+     */
+    void disableRoutingTable();
+
+    /**
+     * @return Whether findWay() currently uses a routing table.
+     */
+    bool isUsingRoutingTable() const
+    {
+      return !mRoutingTable.isEmpty();
+    }
+
+    /**
+     * Cache of which waypoints can be seen from each other, shared by all creatures
+     * walking on this waynet. Reset whenever the search structures are rebuilt, see
+     * rebuildSearchStructures().
+     */
+    AI::LineOfSightCache& lineOfSight();
+
+    /**
+     * @return Index of the given waypoint, as used by lineOfSight(). RaycastBatch::NO_WAYPOINT
+     *         if the waypoint is invalid.
+     */
+    bs::UINT32 indexOf(HWaypoint waypoint) const;
+
     /**
      * Registers the given freepoint in the waynet.
      */
@@ -142,9 +213,24 @@ namespace REGoth
 
     /**
      * Registers the given waypoint in the waynet.
+     *
+     * Invalidates the search structures, see rebuildSearchStructures().
      */
     void addWaypoint(HWaypoint waypoint);
 
+    /**
+     * Builds the data structures used to search the waynet, like the cached waypoint
+     * positions and the graph findWay() runs on.
+     *
+     * They are built on first use if missing, but since that takes a moment on the
+     * bigger worlds, this should be called once all waypoints and the paths between
+     * them have been set up, i.e. right after importing the waynet.
+     *
+     * @note Paths added via Waypoint::addPathTo() after this was called will not be
+     *       known to findWay() until this is called again.
+     */
+    void rebuildSearchStructures();
+
     /**
      * @return List of all waypoints.
      */
@@ -166,16 +252,26 @@ namespace REGoth
      */
     void debugDraw(const REGoth::HAnchoredTextLabels& textLabels);
 
+  protected:
+    void onDestroyed() override;
+
   private:
 
     /**
-     * Fills mWaypointPositions with the positions from all registered waypoints.
+     * Fills mWaypointPositions with the positions from all registered waypoints
+     * and builds the k-d tree over them.
      *
      * Will drop anything already in the vector and thus can be called multiple times.
      */
     void populateWaypointPositionCache();
     void populateFreepointPositionCache();
 
+    /**
+     * @return The k-d tree over all freepoints whose name contains the given one.
+     *         Built on first use for each name.
+     */
+    const KDTree& freepointTreeFor(const bs::String& name);
+
     /**
      * @return Whether mWaypointPositions has been filled with data.
      *
@@ -184,6 +280,64 @@ namespace REGoth
     bool hasCachedWaypointPositions() const;
     bool hasCachedFreepointPositions() const;
 
+    /**
+     * Fills the mGraph*-vectors from the paths of all registered waypoints.
+     *
+     * Will drop anything already in there and thus can be called multiple times.
+     */
+    void populateSearchGraph();
+
+    /**
+     * @return Whether the search graph has been built.
+     *
+     * @note To build it, use populateSearchGraph().
+     */
+    bool hasSearchGraph() const;
+
+    /**
+     * Loads the routing table for the current search graph from the cache or builds
+     * and caches it, if it is not there or outdated. Does nothing if the routing table
+     * has not been enabled.
+     */
+    void loadOrBuildRoutingTable();
+
+    /**
+     * findWay() implementations searching the waynet or reading the routing table.
+     * Expect the search graph to be built and the indices to be valid.
+     */
+    bs::Vector<HWaypoint> findWayBySearching(bs::UINT32 start, bs::UINT32 goal);
+    bs::Vector<HWaypoint> findWayUsingRoutingTable(bs::UINT32 start, bs::UINT32 goal);
+
+    /**
+     * Per-waypoint bookkeeping of findWay().
+     */
+    struct PathSearchNode
+    {
+      float costFromStart;
+      float estimatedCostToGoal;
+      bs::UINT32 previous;
+      bs::UINT32 heapPosition;
+      bs::UINT32 searchMark;
+      bool isClosed;
+    };
+
+    /**
+     * Starts a new search by invalidating all nodes in mPathSearchNodes and
+     * clearing the open list.
+     */
+    void beginPathSearch();
+
+    /**
+     * Open list of findWay(): A binary min-heap of waypoint indices, keyed by the
+     * estimated total cost of their PathSearchNode. The position of every node inside
+     * the heap is tracked so its key can be decreased in place.
+     */
+    void pushPathSearchHeap(bs::UINT32 node);
+    bs::UINT32 popPathSearchHeap();
+    void siftUpPathSearchHeap(bs::UINT32 position);
+    void siftDownPathSearchHeap(bs::UINT32 position);
+    bool isPathSearchHeapEntryLess(bs::UINT32 a, bs::UINT32 b) const;
+
     bs::Vector<HWaypoint> mWaypoints;
     bs::Vector<HFreepoint> mFreepoints;
 
@@ -194,6 +348,56 @@ namespace REGoth
     bs::Vector<bs::Vector3> mWaypointPositions;
     bs::Vector<bs::Vector3> mFreepointPositions;
 
+    /**
+     * Spatial index over mWaypointPositions for findClosestWaypointTo().
+     */
+    KDTree mWaypointTree;
+
+    /**
+     * Spatial indices over the freepoints matching a name for findClosestFreepointTo(),
+     * by the name they were searched for. Refers to mFreepointPositions.
+     */
+    bs::UnorderedMap<bs::String, KDTree> mFreepointTreesByName;
+
+    /**
+     * Connections between all waypoints as flat adjacency lists: The neighbours of the
+     * waypoint with index `i` are `mGraphNeighbours[mGraphEdgeOffsets[i]]` up to (excluding)
+     * `mGraphNeighbours[mGraphEdgeOffsets[i + 1]]`. `mGraphEdgeLengths` holds the length of
+     * each of those connections at the same index.
+     *
+     * Built from the waypoints, so this doesn't need to be saved.
+     */
+    bs::Vector<bs::UINT32> mGraphEdgeOffsets;
+    bs::Vector<bs::UINT32> mGraphNeighbours;
+    bs::Vector<float> mGraphEdgeLengths;
+
+    /**
+     * Clusters over the search graph for findMilestones(). Built together with the
+     * search graph.
+     */
+    WaynetClusters mClusters;
+
+    /**
+     * See lineOfSight(). Reset together with the search graph.
+     */
+    AI::LineOfSightCache mLineOfSight;
+
+    /**
+     * Scratch space for findWay(), kept between searches so routing doesn't need to allocate.
+     * A node in mPathSearchNodes is only valid for the current search if its `searchMark`
+     * matches mPathSearchMark, which saves resetting all of them on every search.
+     */
+    bs::Vector<PathSearchNode> mPathSearchNodes;
+    bs::Vector<bs::UINT32> mPathSearchHeap;
+    bs::UINT32 mPathSearchMark = 0;
+
+    /**
+     * Name the routing table is cached under. Empty if the routing table is disabled.
+     * The table itself is not saved, it is loaded from the cache again.
+     */
+    bs::String mRoutingTableCacheName;
+    WaynetRoutingTable mRoutingTable;
+
   public:
     REGOTH_DECLARE_RTTI(Waynet)
 
@@ -28,7 +28,7 @@ namespace REGoth
     /**
      * @return All paths from this waypoint.
      */
-    const bs::Vector<HWaypoint> allPaths() const
+    const bs::Vector<HWaypoint>& allPaths() const
     {
       return mPaths;
     }
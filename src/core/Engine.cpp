@@ -23,6 +23,8 @@
 #include <original-content/OriginalGameFiles.hpp>
 #include <original-content/OriginalGameResources.hpp>
 #include <original-content/VirtualFileSystem.hpp>
+#include <scripting/daedalus/REGothDaedalusVM.hpp>
+#include <world/PhysicsMeshRegistry.hpp>
 
 using namespace REGoth;
 
@@ -31,6 +33,11 @@ using namespace REGoth;
  */
 const bs::String REGOTH_CONTENT_DIR_NAME = "content";
 
+/**
+ * Name of the file the VDFS index is cached in, inside the cache directory
+ */
+const bs::String VDFS_INDEX_CACHE_NAME = "vdfs.index";
+
 Engine::~Engine()
 {
   // pass
@@ -42,6 +49,14 @@ void Engine::loadGamePackages()
 
   gVirtualFileSystem().setPathToEngineExecutable(config()->engineExecutablePath.toString());
 
+  bs::Path indexCachePath = BsZenLib::GetCacheDirectory();
+  indexCachePath.append(VDFS_INDEX_CACHE_NAME);
+
+  if (!gVirtualFileSystem().loadIndexCache(indexCachePath))
+  {
+    REGOTH_LOG(Info, Uncategorized, "[VDFS] No index cache found, reading all packages");
+  }
+
   REGOTH_LOG(Info, Uncategorized, "[VDFS] Indexing packages: ");
 
   for (auto p : files.allVdfsPackages())
@@ -53,6 +68,8 @@ void Engine::loadGamePackages()
   gVirtualFileSystem().mountDirectory(files.vdfsFileEntryPoint());
 
   loadModPackages(files);
+
+  gVirtualFileSystem().saveIndexCache(indexCachePath);
 }
 
 void Engine::loadModPackages(const OriginalGameFiles& /* files */)
@@ -65,7 +82,15 @@ void Engine::saveCachedResourceManifests()
   REGOTH_LOG(Info, Uncategorized, "[Engine] Saving resource manifests:");
 
   REGOTH_LOG(Info, Uncategorized, "[Engine]   - Gothic Cache");
-  BsZenLib::SaveResourceManifest();
+
+  // Physics meshes are added to the manifest right away, but written in the background.
+  // Don't save entries for files which might never be written.
+  gPhysicsMeshRegistry().waitForPendingSaves();
+
+  {
+    ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+    BsZenLib::SaveResourceManifest();
+  }
 
   // Engine-Content manifest is saved after every resource load since
   // there are only a few resources to handle. If that ever takes too long
@@ -119,7 +144,32 @@ void Engine::loadCachedResourceManifests()
 
 void REGoth::Engine::populateResourceCache()
 {
-  OriginalGameResources::populateCache();
+  OriginalGameResources::populateCache(config()->cacheJobs);
+
+  gOriginalGameResources().setMemoryBudget((bs::UINT64)config()->resourceMemoryBudget * 1024 *
+                                           1024);
+}
+
+void Engine::setupScripting()
+{
+  auto splitFunctionNames = [](const bs::String& list) {
+    bs::String upper = list;
+    bs::StringUtil::toUpperCase(upper);
+
+    bs::Vector<bs::String> names;
+
+    for (bs::String name : bs::StringUtil::split(upper, ","))
+    {
+      bs::StringUtil::trim(name);
+
+      if (!name.empty()) names.push_back(name);
+    }
+
+    return names;
+  };
+
+  Scripting::DaedalusVM::setTraceFilter(splitFunctionNames(config()->scriptTrace),
+                                        splitFunctionNames(config()->scriptTraceHide));
 }
 
 void Engine::setupInput()
@@ -217,6 +267,9 @@ void Engine::run()
 
 void Engine::shutdown()
 {
+  // Don't exit while physics meshes are still being written
+  gPhysicsMeshRegistry().waitForPendingSaves();
+
   if (bs::Application::isStarted())
   {
     REGOTH_LOG(Info, Uncategorized, "[Engine] Shutting down bs::f");
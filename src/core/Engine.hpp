@@ -88,7 +88,7 @@ namespace REGoth
 
     /**
      * Goes through the loaded VDFS packages and imports the original games resources
-     * which were not already cached.
+     * which were not already cached. Also sets how much memory they may take up once loaded.
      */
     void populateResourceCache();
 
@@ -97,6 +97,12 @@ namespace REGoth
      */
     void saveCachedResourceManifests();
 
+    /**
+     * Passes the scripting related settings from the configuration to the script VMs
+     * created later on.
+     */
+    void setupScripting();
+
     /**
      * Assign buttons and axis to control the game.
      */
@@ -68,6 +68,27 @@ void EngineConfig::registerCLIEngineOptions(cxxopts::Options& options)
                      "used in Gothic II",
                      cxxopts::value<Sky::RenderMode>(skyRenderMode), "[plane|dome]");
 
+  // Debug options.
+  const std::string dbggrp = "Debug";
+  options.add_option(dbggrp, "", "script-trace",
+                     "Comma separated list of script functions to log the disassembly of, "
+                     "including the functions they call",
+                     cxxopts::value<bs::String>(scriptTrace), "[FUNCTION,...]");
+  options.add_option(dbggrp, "", "script-trace-hide",
+                     "Comma separated list of script functions to leave out of the script trace",
+                     cxxopts::value<bs::String>(scriptTraceHide), "[FUNCTION,...]");
+
+  // Cache options.
+  const std::string cachegrp = "Cache";
+  options.add_option(cachegrp, "", "cache-jobs",
+                     "Number of resources to import at the same time when populating the cache.  "
+                     "0 uses one per CPU core",
+                     cxxopts::value<unsigned int>(cacheJobs), "[N]");
+  options.add_option(cachegrp, "", "resource-memory-budget",
+                     "Memory in MiB the loaded game resources may use before unused ones are "
+                     "dropped.  0 for no limit",
+                     cxxopts::value<unsigned int>(resourceMemoryBudget), "[MIB]");
+
   // Allow game-assets to also be a positional.
   options.parse_positional({"game-assets"});
 }
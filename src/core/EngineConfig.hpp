@@ -115,5 +115,29 @@ namespace REGoth
      * The sky render mode of the game.
      */
     Sky::RenderMode skyRenderMode = Sky::RenderMode::Plane;
+
+    /**
+     * Comma separated names of script functions to log the disassembly of. Functions called
+     * by them will be logged as well.
+     */
+    bs::String scriptTrace;
+
+    /**
+     * Comma separated names of script functions to leave out of the disassembly log, even
+     * when called by a traced function.
+     */
+    bs::String scriptTraceHide = "PRINTDEBUGNPC,PRINTGLOBALS,PRINTDEBUGINT";
+
+    /**
+     * How many resources may be imported at the same time while populating the cache.
+     * 0 to use one job per core.
+     */
+    unsigned int cacheJobs = 0;
+
+    /**
+     * How much memory in MiB the loaded original game resources may take up before unused
+     * ones are dropped. 0 for no limit.
+     */
+    unsigned int resourceMemoryBudget = 1024;
   };
 }  // namespace REGoth
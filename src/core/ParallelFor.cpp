@@ -0,0 +1,44 @@
+#include "ParallelFor.hpp"
+#include <Threading/BsTaskScheduler.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace REGoth
+{
+  void parallelFor(const bs::String& name, bs::UINT32 count,
+                   const std::function<void(bs::UINT32)>& job, bs::UINT32 maxNumTasks)
+  {
+    if (count == 0) return;
+
+    if (maxNumTasks == 0)
+    {
+      maxNumTasks = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    bs::UINT32 numTasks = std::min(maxNumTasks, count);
+
+    std::atomic<bs::UINT32> nextIndex(0);
+
+    auto work = [&]() {
+      for (bs::UINT32 i = nextIndex++; i < count; i = nextIndex++)
+      {
+        job(i);
+      }
+    };
+
+    bs::Vector<bs::SPtr<bs::Task>> tasks;
+
+    for (bs::UINT32 t = 0; t < numTasks; t++)
+    {
+      tasks.push_back(bs::Task::create(name, work));
+      bs::TaskScheduler::instance().addTask(tasks.back());
+    }
+
+    // Waiting lends this thread to the scheduler, so its core is not wasted
+    for (const auto& task : tasks)
+    {
+      task->wait();
+    }
+  }
+}  // namespace REGoth
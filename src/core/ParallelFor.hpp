@@ -0,0 +1,22 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <functional>
+
+namespace REGoth
+{
+  /**
+   * Calls `job` for every index in `[0, count)` on the worker threads of bsf's task
+   * scheduler and blocks until all of them are done.
+   *
+   * The indices are handed out one at a time, so jobs taking very different amounts of time
+   * still spread evenly over the threads. Jobs may run in any order and at the same time,
+   * so they must only write to state belonging to their index.
+   *
+   * @param  name         Name of the tasks, for debugging.
+   * @param  count        Number of times to call `job`.
+   * @param  job          Function to call with each index.
+   * @param  maxNumTasks  How many jobs may run at the same time. 0 for one per core.
+   */
+  void parallelFor(const bs::String& name, bs::UINT32 count,
+                   const std::function<void(bs::UINT32)>& job, bs::UINT32 maxNumTasks = 0);
+}  // namespace REGoth
@@ -5,14 +5,18 @@
 
 #include <BsPrerequisites.h>
 #include <FileSystem/BsPath.h>
+#include <Utility/BsTimer.h>
 
 #include <core/Engine.hpp>
 #include <log/logging.hpp>
+#include <original-content/VirtualFileSystem.hpp>
 
 using namespace REGoth;
 
 int REGoth::runEngine(Engine& engine)
 {
+  bs::Timer startupTimer;
+
   engine.initializeBsf();
 
   REGOTH_LOG(Info, Uncategorized, "[Main] Running Engine");
@@ -25,8 +29,21 @@ int REGoth::runEngine(Engine& engine)
   engine.findEngineContent();
 
   REGOTH_LOG(Info, Uncategorized, "[Main] Loading original game packages");
+  bs::Timer packagesTimer;
   engine.loadGamePackages();
 
+  VirtualFileSystem::IndexStats indexStats = gVirtualFileSystem().indexStats();
+
+  // The index cache is warm if no package had to be indexed again. It only shortens REGoth's
+  // own index, ZenLib mounts every package either way.
+  REGOTH_LOG(Info, Uncategorized,
+             "[Main] Loaded original game packages in {0} ms: ZenLib mount {1} ms, index {2} ms "
+             "({3} index cache, {4} packages from it, {5} indexed)",
+             packagesTimer.getMilliseconds(), indexStats.mountMicroseconds / 1000,
+             indexStats.indexMicroseconds / 1000,
+             indexStats.numPackagesIndexed == 0 ? "warm" : "cold",
+             indexStats.numPackagesFromCache, indexStats.numPackagesIndexed);
+
   if (!engine.hasFoundGameFiles())
   {
     REGOTH_LOG(Fatal, Uncategorized,
@@ -43,6 +60,9 @@ int REGoth::runEngine(Engine& engine)
   REGOTH_LOG(Info, Uncategorized, "[Engine] Caching original resources");
   engine.populateResourceCache();
 
+  REGOTH_LOG(Info, Uncategorized, "[Engine] Setting up scripting");
+  engine.setupScripting();
+
   REGOTH_LOG(Info, Uncategorized, "[Engine] Setting up input");
   engine.setupInput();
 
@@ -55,6 +75,10 @@ int REGoth::runEngine(Engine& engine)
   REGOTH_LOG(Info, Uncategorized, "[Engine] Save cached resource manifests");
   engine.saveCachedResourceManifests();
 
+  REGOTH_LOG(Info, Uncategorized, "[Main] Started up in {0} ms ({1} index cache)",
+             startupTimer.getMilliseconds(),
+             indexStats.numPackagesIndexed == 0 ? "warm" : "cold");
+
   REGOTH_LOG(Info, Uncategorized, "[Engine] Run");
   engine.run();
 
@@ -0,0 +1,300 @@
+#include <memory>
+
+#include <Utility/BsTimer.h>
+
+#include <core.hpp>
+#include <components/Character.hpp>
+#include <components/GameWorld.hpp>
+#include <log/logging.hpp>
+#include <scripting/ScriptSymbolQueries.hpp>
+#include <scripting/ScriptVMForGameWorld.hpp>
+
+/**
+ * Runs all `C_INFO` condition functions over and over and reports how many
+ * script instructions per second the VM manages to execute. In builds configured with
+ * `REGOTH_SCRIPT_BENCHMARK_BASELINE`, this is first done as a baseline, with the VM
+ * decoding every instruction while running like it did before the bytecode was decoded
+ * up front, and then the way the VM normally runs.
+ *
+ * Afterwards, does the same for all script functions building strings via
+ * `ConcatStrings`, like the ones assembling texts for `PrintDebug*`, and reports
+ * how many memory allocations they caused. With `REGOTH_SCRIPT_BENCHMARK_BASELINE`,
+ * this is also done as a baseline first, with every temporary string allocated anew
+ * like before the stack had its string arena, so both counts come from the same build.
+ *
+ * Allocations are only counted by bsf if it was built with profiling enabled
+ * (`BS_PROFILING_ENABLED`), otherwise all counts read 0 and a warning is logged.
+ */
+class REGothScriptBenchmark : public REGoth::EmptyGame
+{
+public:
+  using REGoth::EmptyGame::EmptyGame;
+
+  void setupScene() override
+  {
+    using namespace REGoth;
+    using namespace REGoth::Scripting;
+
+    HGameWorld world = GameWorld::createEmpty();
+
+    HCharacter self  = world->insertCharacter("PC_HERO", bs::Transform::IDENTITY);
+    HCharacter other = world->insertCharacter("PC_HERO", bs::Transform::IDENTITY);
+
+    ScriptVMForGameWorld& vm = world->scriptVM();
+
+    bs::Vector<SymbolIndex> conditions = findConditionFunctions(vm);
+
+    REGOTH_LOG(Info, Uncategorized, "[ScriptBenchmark] Found {0} condition functions",
+               conditions.size());
+
+    // Warm-up, so everything has been touched once before measuring
+    for (SymbolIndex function : conditions)
+    {
+      vm.runInfoConditionFunction(function, self, other);
+    }
+
+#ifdef REGOTH_SCRIPT_BENCHMARK_BASELINE
+    // Baseline: Decode each instruction while running, like the VM used to
+    vm.setDecodeEachInstruction(true);
+    double baseline = runConditionFunctions(vm, conditions, self, other, "baseline");
+
+    vm.setDecodeEachInstruction(false);
+    double decoded = runConditionFunctions(vm, conditions, self, other, "pre-decoded");
+
+    REGOTH_LOG(Info, Uncategorized, "[ScriptBenchmark] Pre-decoded is {0}x as fast as baseline",
+               baseline > 0.0 ? decoded / baseline : 0.0);
+#else
+    runConditionFunctions(vm, conditions, self, other, "pre-decoded");
+
+    REGOTH_LOG(Info, Uncategorized,
+               "[ScriptBenchmark] Configure with REGOTH_SCRIPT_BENCHMARK_BASELINE=ON to compare "
+               "against a baseline");
+#endif
+
+    runStringBenchmark(vm, self);
+  }
+
+protected:
+  static constexpr bs::UINT32 NUM_ROUNDS = 100;
+
+  /**
+   * Runs the given condition functions NUM_ROUNDS times and logs how long that took.
+   *
+   * @return Instructions executed per second.
+   */
+  double runConditionFunctions(REGoth::Scripting::ScriptVMForGameWorld& vm,
+                               const bs::Vector<REGoth::Scripting::SymbolIndex>& conditions,
+                               REGoth::HCharacter self, REGoth::HCharacter other,
+                               const char* label)
+  {
+    using namespace REGoth;
+    using namespace REGoth::Scripting;
+
+    bs::UINT64 instructionsBefore = vm.numExecutedInstructions();
+
+    bs::Timer timer;
+
+    for (bs::UINT32 round = 0; round < NUM_ROUNDS; round++)
+    {
+      for (SymbolIndex function : conditions)
+      {
+        vm.runInfoConditionFunction(function, self, other);
+      }
+    }
+
+    bs::UINT64 microseconds = timer.getMicroseconds();
+    bs::UINT64 instructions = vm.numExecutedInstructions() - instructionsBefore;
+    double seconds          = (double)microseconds / 1000000.0;
+    double perSecond        = seconds > 0.0 ? (double)instructions / seconds : 0.0;
+
+    REGOTH_LOG(Info, Uncategorized,
+               "[ScriptBenchmark] ({0}) Ran {1} condition functions {2} times: {3} instructions "
+               "in {4} s, {5} instructions per second",
+               label, conditions.size(), NUM_ROUNDS, instructions, seconds,
+               (bs::UINT64)perSecond);
+
+    return perSecond;
+  }
+
+  void runStringBenchmark(REGoth::Scripting::ScriptVMForGameWorld& vm, REGoth::HCharacter self)
+  {
+    using namespace REGoth;
+    using namespace REGoth::Scripting;
+
+    bs::Vector<SymbolIndex> functions = findStringFunctions(vm);
+
+    REGOTH_LOG(Info, Uncategorized, "[ScriptBenchmark] Found {0} string building functions",
+               functions.size());
+
+    if (!isCountingAllocations())
+    {
+      REGOTH_LOG(Warning, Uncategorized,
+                 "[ScriptBenchmark] bsf was built without profiling, allocations are not "
+                 "counted. Build bsf with BS_PROFILING_ENABLED to get allocation counts.");
+    }
+
+    // Warm-up, so temporary strings have grown to their final sizes
+    for (SymbolIndex function : functions)
+    {
+      vm.runFunctionOnSelf(function, self);
+    }
+
+#ifdef REGOTH_SCRIPT_BENCHMARK_BASELINE
+    // Baseline: Allocate every temporary string anew, like the VM used to
+    vm.setReuseTemporaryStrings(false);
+    bs::UINT64 baseline = runStringFunctions(vm, functions, self, "baseline");
+
+    vm.setReuseTemporaryStrings(true);
+    bs::UINT64 arena = runStringFunctions(vm, functions, self, "string arena");
+
+    REGOTH_LOG(Info, Uncategorized,
+               "[ScriptBenchmark] String arena saved {0} of {1} allocations", baseline - arena,
+               baseline);
+#else
+    runStringFunctions(vm, functions, self, "string arena");
+#endif
+  }
+
+  /**
+   * Runs the given string building functions NUM_ROUNDS times and logs how long that took
+   * and how many allocations that caused.
+   *
+   * @return Number of allocations made while running the functions.
+   */
+  bs::UINT64 runStringFunctions(REGoth::Scripting::ScriptVMForGameWorld& vm,
+                                const bs::Vector<REGoth::Scripting::SymbolIndex>& functions,
+                                REGoth::HCharacter self, const char* label)
+  {
+    using namespace REGoth;
+    using namespace REGoth::Scripting;
+
+    bs::UINT64 allocationsBefore  = bs::MemoryCounter::getNumAllocs();
+    bs::UINT64 instructionsBefore = vm.numExecutedInstructions();
+
+    bs::Timer timer;
+
+    for (bs::UINT32 round = 0; round < NUM_ROUNDS; round++)
+    {
+      for (SymbolIndex function : functions)
+      {
+        vm.runFunctionOnSelf(function, self);
+      }
+    }
+
+    bs::UINT64 microseconds = timer.getMicroseconds();
+    bs::UINT64 allocations  = bs::MemoryCounter::getNumAllocs() - allocationsBefore;
+    bs::UINT64 instructions = vm.numExecutedInstructions() - instructionsBefore;
+    bs::UINT64 numCalls     = functions.size() * NUM_ROUNDS;
+
+    REGOTH_LOG(Info, Uncategorized,
+               "[ScriptBenchmark] ({0}) Ran {1} string building functions {2} times: {3} "
+               "instructions in {4} s, {5} allocations, {6} per function call",
+               label, functions.size(), NUM_ROUNDS, instructions,
+               (double)microseconds / 1000000.0, allocations,
+               numCalls > 0 ? (double)allocations / (double)numCalls : 0.0);
+
+    return allocations;
+  }
+
+  /**
+   * @return Whether bsf counts allocations, which it only does if built with profiling.
+   */
+  static bool isCountingAllocations()
+  {
+    bs::UINT64 before = bs::MemoryCounter::getNumAllocs();
+
+    void* probe = bs::bs_alloc(1);
+    bs::bs_free(probe);
+
+    return bs::MemoryCounter::getNumAllocs() != before;
+  }
+
+  /**
+   * @return Symbols of script functions calling `ConcatStrings` which are safe to run
+   *         without a proper world around them, i.e. don't touch any instances and only
+   *         call externals dealing with strings.
+   */
+  bs::Vector<REGoth::Scripting::SymbolIndex> findStringFunctions(
+      REGoth::Scripting::ScriptVMForGameWorld& vm)
+  {
+    using namespace REGoth::Scripting;
+
+    static const bs::Set<bs::String> ALLOWED_EXTERNALS = {
+        "CONCATSTRINGS", "INTTOSTRING",      "FLOATTOSTRING",   "PRINT",
+        "PRINTDEBUG",    "PRINTDEBUGINSTCH", "PRINTDEBUGINST",  "PRINTDEBUGCH",
+    };
+
+    auto& symbols = vm.scriptSymbols();
+
+    bs::Vector<SymbolIndex> candidates = symbols.query([](const SymbolBase& s) {
+      return s.type == SymbolType::ScriptFunction && !s.isClassVar && s.isKeptAfterLoad;
+    });
+
+    bs::Vector<SymbolIndex> result;
+
+    for (SymbolIndex function : candidates)
+    {
+      bool usesInstances;
+      bs::Vector<SymbolIndex> externals = vm.findReachableExternals(function, usesInstances);
+
+      if (usesInstances) continue;
+
+      bool callsConcat = false;
+      bool onlyAllowed = true;
+
+      for (SymbolIndex external : externals)
+      {
+        const bs::String& name = symbols.getSymbolName(external);
+
+        callsConcat |= name == "CONCATSTRINGS";
+        onlyAllowed &= ALLOWED_EXTERNALS.find(name) != ALLOWED_EXTERNALS.end();
+      }
+
+      if (callsConcat && onlyAllowed)
+      {
+        result.push_back(function);
+      }
+    }
+
+    return result;
+  }
+
+  /**
+   * @return Symbols of the condition functions of all `C_INFO` instances.
+   */
+  bs::Vector<REGoth::Scripting::SymbolIndex> findConditionFunctions(
+      REGoth::Scripting::ScriptVMForGameWorld& vm)
+  {
+    using namespace REGoth::Scripting;
+
+    auto& symbols = vm.scriptSymbols();
+    auto& objects = vm.scriptObjects();
+
+    bs::Vector<SymbolIndex> result;
+
+    for (SymbolIndex s : Queries::findAllInstancesOfClass(symbols, "C_INFO"))
+    {
+      ScriptObjectHandle handle = symbols.getSymbol<SymbolInstance>(s).instance;
+
+      if (!objects.isValid(handle)) continue;
+
+      bs::UINT32 address   = objects.get(handle).functionPointerValue("CONDITION");
+      SymbolIndex function = symbols.findFunctionByAddress(address);
+
+      if (function != SYMBOL_INDEX_INVALID)
+      {
+        result.push_back(function);
+      }
+    }
+
+    return result;
+  }
+};
+
+int main(int argc, char** argv)
+{
+  auto config = REGoth::parseArguments<REGoth::EngineConfig>(argc, argv);
+  REGothScriptBenchmark engine{std::move(config)};
+
+  return REGoth::runEngine(engine);
+}
@@ -1,9 +1,12 @@
+#include <cmath>
 #include <memory>
+#include <random>
 
 #include <BsFPSCamera.h>
 #include <Components/BsCCamera.h>
 #include <GUI/BsCGUIWidget.h>
 #include <Scene/BsSceneObject.h>
+#include <Utility/BsTimer.h>
 
 #include <core.hpp>
 #include <components/AnchoredTextLabels.hpp>
@@ -11,12 +14,36 @@
 #include <components/Waynet.hpp>
 #include <components/Waypoint.hpp>
 #include <exception/Throw.hpp>
+#include <log/logging.hpp>
 #include <original-content/VirtualFileSystem.hpp>
 
-class REGothWaynetTester : public REGoth::EmptyGame
+struct WaynetTestConfig : public REGoth::EngineConfig
+{
+  virtual void registerCLIOptions(cxxopts::Options& opts) override
+  {
+    const std::string grp = "WaynetTest";
+    opts.add_option(grp, "", "benchmark-routing",
+                    "If set, routes between random waypoints with and without the routing "
+                    "table and reports the throughput, instead of drawing the waynet",
+                    cxxopts::value<bool>(benchmarkRouting), "");
+  }
+
+  bool benchmarkRouting = false;
+};
+
+class REGothWaynetTester : public REGoth::Engine
 {
 public:
-  using REGoth::EmptyGame::EmptyGame;
+  REGothWaynetTester(std::unique_ptr<const WaynetTestConfig>&& config)
+      : mConfig{std::move(config)}
+  {
+    // pass
+  }
+
+  const WaynetTestConfig* config() const override
+  {
+    return mConfig.get();
+  }
 
   void setupMainCamera() override
   {
@@ -38,16 +65,139 @@ public:
 
     HGameWorld world = GameWorld::importZEN("OLDWORLD.ZEN");
 
-    world->waynet()->debugDraw(mTextLabels);
+    if (config()->benchmarkRouting)
+    {
+      benchmarkRouting(world->waynet());
+    }
+    else
+    {
+      world->waynet()->debugDraw(mTextLabels);
+    }
   }
 
 protected:
+  static constexpr bs::UINT32 NUM_ROUTES = 20000;
+
+  struct RoutingResult
+  {
+    bs::UINT64 microseconds        = 0;
+    bs::UINT64 numWaypointsVisited = 0;
+    bs::Vector<float> lengths;
+  };
+
+  /**
+   * Routes between the same random waypoint pairs twice, once by searching the waynet
+   * and once using the routing table. Also checks that both found equally long ways.
+   */
+  void benchmarkRouting(REGoth::HWaynet waynet)
+  {
+    using namespace REGoth;
+
+    const bs::Vector<HWaypoint>& waypoints = waynet->allWaypoints();
+
+    if (waypoints.empty())
+    {
+      REGOTH_THROW(InvalidStateException, "Expected waypoints in world");
+    }
+
+    // Fixed seed, so runs can be compared against each other
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<size_t> pickWaypoint(0, waypoints.size() - 1);
+
+    bs::Vector<std::pair<HWaypoint, HWaypoint>> routes;
+    routes.reserve(NUM_ROUTES);
+
+    for (bs::UINT32 i = 0; i < NUM_ROUTES; i++)
+    {
+      routes.emplace_back(waypoints[pickWaypoint(random)], waypoints[pickWaypoint(random)]);
+    }
+
+    const bs::String cacheName = "OLDWORLD.ZEN";
+
+    waynet->disableRoutingTable();
+    RoutingResult searched = runRoutes(waynet, routes);
+    logRoutingResult("Searching", searched);
+
+    bs::Timer loadTimer;
+    waynet->enableRoutingTable(cacheName);
+
+    REGOTH_LOG(Info, Uncategorized, "[WaynetTest] Loading routing table took {0} ms",
+               loadTimer.getMilliseconds());
+
+    RoutingResult table = runRoutes(waynet, routes);
+    logRoutingResult("Routing table", table);
+
+    bs::UINT32 numMismatches = 0;
+
+    for (size_t i = 0; i < routes.size(); i++)
+    {
+      if (std::abs(searched.lengths[i] - table.lengths[i]) > 0.01f)
+      {
+        numMismatches++;
+      }
+    }
+
+    REGOTH_LOG(Info, Uncategorized, "[WaynetTest] {0} of {1} ways differ in length",
+               numMismatches, routes.size());
+  }
+
+  RoutingResult runRoutes(REGoth::HWaynet waynet,
+                          const bs::Vector<std::pair<REGoth::HWaypoint, REGoth::HWaypoint>>& routes)
+  {
+    using namespace REGoth;
+
+    RoutingResult result;
+    result.lengths.reserve(routes.size());
+
+    bs::Vector<bs::Vector<HWaypoint>> ways;
+    ways.reserve(routes.size());
+
+    bs::Timer timer;
+
+    for (const auto& route : routes)
+    {
+      ways.push_back(waynet->findWay(route.first, route.second));
+    }
+
+    result.microseconds = timer.getMicroseconds();
+
+    for (const auto& way : ways)
+    {
+      float length = 0.0f;
+
+      for (size_t i = 1; i < way.size(); i++)
+      {
+        length += way[i - 1]->SO()->getTransform().pos().distance(
+            way[i]->SO()->getTransform().pos());
+      }
+
+      result.numWaypointsVisited += way.size();
+      result.lengths.push_back(length);
+    }
+
+    return result;
+  }
+
+  void logRoutingResult(const bs::String& mode, const RoutingResult& result)
+  {
+    size_t numWays = result.lengths.size();
+    double seconds = (double)result.microseconds / 1000000.0;
+
+    REGOTH_LOG(Info, Uncategorized,
+               "[WaynetTest] {0}: {1} ways over {2} waypoints in {3} s, {4} ways per second",
+               mode, numWays, result.numWaypointsVisited, seconds,
+               seconds > 0.0 ? (bs::UINT64)((double)numWays / seconds) : 0);
+  }
+
   REGoth::HAnchoredTextLabels mTextLabels;
+
+private:
+  std::unique_ptr<const WaynetTestConfig> mConfig;
 };
 
 int main(int argc, char** argv)
 {
-  auto config = REGoth::parseArguments<REGoth::EngineConfig>(argc, argv);
+  auto config = REGoth::parseArguments<WaynetTestConfig>(argc, argv);
   REGothWaynetTester engine{std::move(config)};
 
   return REGoth::runEngine(engine);
@@ -4,12 +4,10 @@
 #include <Components/BsCCamera.h>
 #include <Utility/BsTimer.h>
 
-#include <BsZenLib/CacheUtility.hpp>
-
 #include <core.hpp>
 #include <exception/Throw.hpp>
 #include <log/logging.hpp>
-#include <original-content/VirtualFileSystem.hpp>
+#include <original-content/OriginalGameResources.hpp>
 
 class REGothWorldCacheTest : public REGoth::EmptyGame
 {
@@ -20,7 +18,7 @@ public:
   {
     using namespace REGoth;
 
-    BsZenLib::CacheWholeVDFS(gVirtualFileSystem().getFileIndex());
+    OriginalGameResources::populateCache(config()->cacheJobs);
 
     REGOTH_LOG(Info, Uncategorized, "Finished caching");
   }
@@ -1,179 +1,983 @@
 #include "OriginalGameResources.hpp"
 
-#include <BsZenLib/CacheUtility.hpp>
 #include <BsZenLib/ImportFont.hpp>
 #include <BsZenLib/ImportMorphMesh.hpp>
+#include <BsZenLib/ImportPath.hpp>
 #include <BsZenLib/ImportSkeletalMesh.hpp>
 #include <BsZenLib/ImportStaticMesh.hpp>
 #include <BsZenLib/ImportTexture.hpp>
+#include <BsZenLib/ResourceManifest.hpp>
+#include <BsZenLib/ZenResources.hpp>
 
+#include <core/ParallelFor.hpp>
 #include <log/logging.hpp>
 #include <original-content/VirtualFileSystem.hpp>
+#include <zenload/zCProgMeshProto.h>
 
+#include <Animation/BsAnimationClip.h>
+#include <FileSystem/BsDataStream.h>
+#include <FileSystem/BsFileSystem.h>
+#include <Image/BsPixelUtil.h>
 #include <Image/BsSpriteTexture.h>
+#include <Image/BsTexture.h>
+#include <Material/BsMaterial.h>
+#include <Material/BsShader.h>
+#include <Mesh/BsMesh.h>
+#include <RenderAPI/BsVertexDataDesc.h>
+#include <Resources/BsResources.h>
+#include <Text/BsFont.h>
 #include <Threading/BsTaskScheduler.h>
+#include <Utility/BsTimer.h>
+#include <Utility/BsUUID.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
 
 namespace REGoth
 {
-  void OriginalGameResources::populateCache()
+  static bs::HTexture loadOrImportTexture(const bs::String& originalFileName);
+  static BsZenLib::Res::HModelScriptFile loadOrImportModelScript(
+      const bs::String& originalFileName);
+  static BsZenLib::Res::HMeshWithMaterials loadOrImportStaticMesh(
+      const bs::String& originalFileName);
+  static BsZenLib::Res::HMeshWithMaterials loadOrImportMorphMesh(
+      const bs::String& originalFileName);
+  static bs::HFont loadOrImportFont(const bs::String& originalFileName);
+
+  /**
+   * Number of resources imported between two saves of the resource manifest. Everything
+   * imported after the last save has to be imported again if the run is interrupted.
+   */
+  static constexpr bs::UINT32 CACHE_CHECKPOINT_INTERVAL = 256;
+
+  namespace
+  {
+    /**
+     * A kind of resource populateCache() imports.
+     */
+    struct CachedResourceType
+    {
+      const char* name;
+
+      /**
+       * Extensions of the files inside the VDFS to look for, as they are stored in there.
+       */
+      bs::Vector<bs::String> storedExtensions;
+
+      /**
+       * Turns the name of a stored file into the name the resource is imported by.
+       */
+      std::function<bs::String(const bs::String&)> toOriginalName;
+
+      std::function<bool(const bs::String&)> isCached;
+
+      /**
+       * Takes gResourceManifestMutex() itself, for as little as possible.
+       *
+       * @return Whether the import worked.
+       */
+      std::function<bool(const bs::String&)> importAndCache;
+    };
+
+    /**
+     * What populateCache() has done for each type, for the report.
+     */
+    struct CacheTypeReport
+    {
+      std::atomic<bs::UINT32> numAlreadyCached{0};
+      std::atomic<bs::UINT32> numImported{0};
+      std::atomic<bs::UINT32> numFailed{0};
+      std::atomic<bs::UINT64> importMicroseconds{0};
+      std::atomic<bs::UINT64> importedBytes{0};
+    };
+
+    struct PendingImport
+    {
+      bs::UINT32 type;
+      bs::String originalName;
+      bs::String storedName;
+    };
+  }  // namespace
+
+  /**
+   * Replaces everything after the last dot of the given file name, and `suffix` right in front
+   * of the dot, if it's there. E.g. `STONE-C.TEX` becomes `STONE.TGA`.
+   */
+  static bs::String replaceExtension(const bs::String& fileName, const bs::String& suffix,
+                                     const bs::String& newExtension)
   {
-    BsZenLib::CacheWholeVDFS(gVirtualFileSystem().getFileIndex());
+    bs::String base = fileName.substr(0, fileName.find_last_of('.'));
+
+    if (!suffix.empty() && bs::StringUtil::endsWith(base, suffix, false))
+    {
+      base = base.substr(0, base.size() - suffix.size());
+    }
+
+    return base + newExtension;
   }
 
-  bs::HTexture OriginalGameResources::texture(const bs::String& originalFileName)
+  /**
+   * Reads and packs a static mesh from the VDFS. This is most of the work of importing one and
+   * doesn't touch the resource manifest, so it may run on any thread without holding
+   * gResourceManifestMutex().
+   *
+   * @return Whether the mesh could be read.
+   */
+  static bool readPackedStaticMesh(const bs::String& originalFileName,
+                                   ZenLoad::PackedMesh& outMesh)
   {
-    bs::HTexture htexture;
+    // Referred to as `.3DS`, but only stored compiled
+    bs::String compiledName = replaceExtension(originalFileName, "", ".MRM");
+
+    if (!gVirtualFileSystem().hasFile(compiledName)) return false;
+
+    ZenLoad::zCProgMeshProto mesh(compiledName.c_str(), gVirtualFileSystem().getFileIndex());
+    mesh.packMesh(outMesh, 0.01f);
+
+    return !outMesh.subMeshes.empty();
+  }
+
+  /**
+   * Imports a static mesh into the cache. Only building and caching the mesh out of the packed
+   * one is done while holding gResourceManifestMutex().
+   */
+  static BsZenLib::Res::HMeshWithMaterials importAndCacheStaticMesh(
+      const bs::String& originalFileName)
+  {
+    ZenLoad::PackedMesh packedMesh;
+    bool hasPackedMesh = readPackedStaticMesh(originalFileName, packedMesh);
 
-    auto it = mTextures.find(originalFileName);
+    ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
 
-    if (it != mTextures.end())
+    // Might have been imported by someone else while reading it
+    if (BsZenLib::HasCachedStaticMesh(originalFileName))
     {
-      return it->second;
+      BsZenLib::Res::HMeshWithMaterials hmesh =
+          BsZenLib::LoadCachedStaticMesh(originalFileName);
+
+      if (hmesh.isLoaded()) return hmesh;
     }
 
-    if (BsZenLib::HasCachedTexture(originalFileName))
+    // Not something we know how to read, so leave all of it to BsZenLib
+    if (!hasPackedMesh)
     {
-      htexture = BsZenLib::LoadCachedTexture(originalFileName);
+      return BsZenLib::ImportAndCacheStaticMesh(originalFileName,
+                                                gVirtualFileSystem().getFileIndex());
     }
 
-    // This call also checks whether dependencies are loaded. Broken resources
-    // can be fixed by importing them.
-    if (!htexture.isLoaded())
+    return BsZenLib::ImportAndCacheStaticMesh(originalFileName, packedMesh,
+                                              gVirtualFileSystem().getFileIndex());
+  }
+
+  static bs::Vector<CachedResourceType> cachedResourceTypes()
+  {
+    const VDFS::FileIndex& vdfs = gVirtualFileSystem().getFileIndex();
+
+    auto keepName = [](const bs::String& name) { return name; };
+
+    bs::Vector<CachedResourceType> types;
+
+    // Textures are only stored compiled, but referred to by their original name
+    types.push_back({"Textures",
+                     {".TEX"},
+                     [](const bs::String& name) { return replaceExtension(name, "-C", ".TGA"); },
+                     [](const bs::String& name) {
+                       ResourceManifestReadLock manifestLock(gResourceManifestMutex());
+                       return BsZenLib::HasCachedTexture(name);
+                     },
+                     [&vdfs](const bs::String& name) {
+                       ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+                       return BsZenLib::ImportAndCacheTexture(name, vdfs).isLoaded();
+                     }});
+
+    // Importing a model script also imports the skeletal meshes (MDM, MDH) it refers to
+    types.push_back({"Model scripts",
+                     {".MDS", ".MSB"},
+                     [](const bs::String& name) { return replaceExtension(name, "", ".MDS"); },
+                     [](const bs::String& name) {
+                       ResourceManifestReadLock manifestLock(gResourceManifestMutex());
+                       return BsZenLib::HasCachedMDS(name);
+                     },
+                     [&vdfs](const bs::String& name) {
+                       ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+                       return BsZenLib::ImportAndCacheMDS(name, vdfs).isLoaded();
+                     }});
+
+    types.push_back({"Static meshes",
+                     {".MRM"},
+                     [](const bs::String& name) { return replaceExtension(name, "", ".3DS"); },
+                     [](const bs::String& name) {
+                       ResourceManifestReadLock manifestLock(gResourceManifestMutex());
+                       return BsZenLib::HasCachedStaticMesh(name);
+                     },
+                     [](const bs::String& name) {
+                       return importAndCacheStaticMesh(name).isLoaded();
+                     }});
+
+    types.push_back({"Morph meshes",
+                     {".MMB"},
+                     [](const bs::String& name) { return replaceExtension(name, "", ".MMS"); },
+                     [](const bs::String& name) {
+                       ResourceManifestReadLock manifestLock(gResourceManifestMutex());
+                       return BsZenLib::HasCachedMorphMesh(name);
+                     },
+                     [&vdfs](const bs::String& name) {
+                       ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+                       return BsZenLib::ImportAndCacheMorphMesh(name, vdfs).isLoaded();
+                     }});
+
+    types.push_back({"Fonts",
+                     {".FNT"},
+                     keepName,
+                     [](const bs::String& name) {
+                       ResourceManifestReadLock manifestLock(gResourceManifestMutex());
+                       return BsZenLib::HasCachedFont(name);
+                     },
+                     [&vdfs](const bs::String& name) {
+                       ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+                       return BsZenLib::ImportAndCacheFont(name, vdfs).isLoaded();
+                     }});
+
+    return types;
+  }
+
+  void OriginalGameResources::populateCache(bs::UINT32 numJobs)
+  {
+    bs::Timer timer;
+
+    bs::Vector<CachedResourceType> types = cachedResourceTypes();
+    bs::Vector<CacheTypeReport> reports(types.size());
+
+    // Find out what's left to do first. Whatever has been cached by an earlier, possibly
+    // interrupted, run is skipped.
+    bs::Vector<PendingImport> pending;
+
+    for (bs::UINT32 t = 0; t < types.size(); t++)
     {
-      htexture =
-          BsZenLib::ImportAndCacheTexture(originalFileName, gVirtualFileSystem().getFileIndex());
+      bs::Set<bs::String> originalNames;
+
+      for (const bs::String& ext : types[t].storedExtensions)
+      {
+        for (const bs::String& storedName : gVirtualFileSystem().listByExtension(ext))
+        {
+          bs::String originalName = types[t].toOriginalName(storedName);
+
+          // Compiled and uncompiled versions of the same file import the same resource
+          if (!originalNames.insert(originalName).second) continue;
+
+          if (types[t].isCached(originalName))
+          {
+            reports[t].numAlreadyCached++;
+            continue;
+          }
+
+          pending.push_back({t, originalName, storedName});
+        }
+      }
     }
 
-    mTextures[originalFileName] = htexture;
+    REGOTH_LOG(Info, Uncategorized, "[OriginalGameResources] Caching {0} resources",
+               pending.size());
 
-    return htexture;
+    for (size_t batchStart = 0; batchStart < pending.size();
+         batchStart += CACHE_CHECKPOINT_INTERVAL)
+    {
+      size_t batchSize = std::min((size_t)CACHE_CHECKPOINT_INTERVAL, pending.size() - batchStart);
+
+      parallelFor("PopulateCache", (bs::UINT32)batchSize,
+                  [&](bs::UINT32 i) {
+                    const PendingImport& import = pending[batchStart + i];
+                    CacheTypeReport& report     = reports[import.type];
+
+                    bs::Timer importTimer;
+
+                    bool hasImported = types[import.type].importAndCache(import.originalName);
+
+                    report.importMicroseconds += importTimer.getMicroseconds();
+
+                    if (hasImported)
+                    {
+                      report.numImported++;
+                      report.importedBytes += gVirtualFileSystem().fileSize(import.storedName);
+                    }
+                    else
+                    {
+                      report.numFailed++;
+                    }
+                  },
+                  numJobs);
+
+      {
+        ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+        BsZenLib::SaveResourceManifest();
+      }
+
+      // Nothing is being imported right now, so don't keep everything imported so far
+      // in memory
+      bs::gResources().unloadAllUnused();
+
+      REGOTH_LOG(Info, Uncategorized, "[OriginalGameResources] Cached {0}/{1} resources",
+                 batchStart + batchSize, pending.size());
+    }
+
+    bs::StringStream report;
+    report << "Populated cache in " << timer.getMilliseconds() << " ms\n";
+
+    for (bs::UINT32 t = 0; t < types.size(); t++)
+    {
+      const CacheTypeReport& r = reports[t];
+
+      report << types[t].name << ": " << r.numImported << " imported ("
+             << r.importedBytes / 1024 << " KiB in " << r.importMicroseconds / 1000
+             << " ms of import time), " << r.numAlreadyCached << " already cached, "
+             << r.numFailed << " failed\n";
+    }
+
+    REGOTH_LOG(Info, Uncategorized, "[OriginalGameResources] {0}", bs::String(report.str()));
+
+    bs::Path reportPath = BsZenLib::GetCacheDirectory();
+    reportPath.append("cache-report.txt");
+
+    bs::SPtr<bs::DataStream> stream = bs::FileSystem::createAndOpenFile(reportPath);
+
+    if (stream)
+    {
+      stream->writeString(report.str());
+      stream->close();
+    }
   }
 
-  BsZenLib::Res::HModelScriptFile OriginalGameResources::modelScript(
-      const bs::String& originalFileName)
+  /**
+   * Estimates of how much memory a loaded resource takes up, see setMemoryBudget().
+   */
+  static bs::UINT64 memorySizeOf(const bs::HTexture& texture)
   {
-    BsZenLib::Res::HModelScriptFile hmodelScript;
+    if (!texture.isLoaded()) return 0;
+
+    const bs::TextureProperties& props = texture->getProperties();
 
-    auto it = mModelScripts.find(originalFileName);
+    bs::UINT64 size = 0;
 
-    if (it != mModelScripts.end())
+    for (bs::UINT32 mip = 0; mip <= props.getNumMipmaps(); mip++)
     {
-      return it->second;
+      size += bs::PixelUtil::getMemorySize(std::max(1u, props.getWidth() >> mip),
+                                           std::max(1u, props.getHeight() >> mip),
+                                           std::max(1u, props.getDepth() >> mip),
+                                           props.getFormat());
     }
 
-    if (BsZenLib::HasCachedMDS(originalFileName))
+    return size * props.getNumFaces();
+  }
+
+  static bs::UINT64 memorySizeOf(const bs::HMesh& mesh)
+  {
+    if (!mesh.isLoaded()) return 0;
+
+    const bs::MeshProperties& props = mesh->getProperties();
+
+    // Assuming 32-bit indices, as that's what the imported meshes use
+    bs::UINT64 size = (bs::UINT64)props.getNumVertices() * mesh->getVertexDesc()->getVertexStride() +
+                      (bs::UINT64)props.getNumIndices() * sizeof(bs::UINT32);
+
+    // Meshes kept on the CPU for cooking physics meshes take the same space again
+    if (mesh->getCachedData())
     {
-      hmodelScript = BsZenLib::LoadCachedMDS(originalFileName);
+      size *= 2;
     }
 
-    // This call also checks whether dependencies are loaded. Broken resources
-    // can be fixed by importing them.
-    if (!hmodelScript.isLoaded())
+    return size;
+  }
+
+  static bs::UINT64 memorySizeOf(const BsZenLib::Res::HMeshWithMaterials& mesh)
+  {
+    if (!mesh.isLoaded()) return 0;
+
+    return memorySizeOf(mesh->getMesh());
+  }
+
+  /**
+   * Collects the textures used by the materials of a loaded resource, see
+   * OriginalGameResources::addMaterialTextures(). Only meshes come with materials.
+   */
+  template <typename T>
+  static void collectMaterialTextures(const T& /* resource */,
+                                      bs::Vector<bs::HTexture>& /* outTextures */)
+  {
+  }
+
+  static void collectMaterialTextures(const BsZenLib::Res::HMeshWithMaterials& mesh,
+                                      bs::Vector<bs::HTexture>& outTextures)
+  {
+    if (!mesh.isLoaded()) return;
+
+    for (const bs::HMaterial& material : mesh->getMaterials())
     {
-      hmodelScript =
-          BsZenLib::ImportAndCacheMDS(originalFileName, gVirtualFileSystem().getFileIndex());
+      if (!material.isLoaded() || !material->getShader().isLoaded()) continue;
+
+      for (const auto& param : material->getShader()->getTextureParams())
+      {
+        bs::HTexture texture = material->getTexture(param.first);
+
+        if (texture.isLoaded())
+        {
+          outTextures.push_back(texture);
+        }
+      }
     }
+  }
 
-    mModelScripts[originalFileName] = hmodelScript;
+  static bs::UINT64 memorySizeOf(const bs::HAnimationClip& clip)
+  {
+    if (!clip.isLoaded()) return 0;
 
-    return hmodelScript;
+    bs::SPtr<bs::AnimationCurves> curves = clip->getCurves();
+
+    if (!curves) return 0;
+
+    bs::UINT64 size = 0;
+
+    for (const auto& c : curves->position)
+    {
+      size += c.curve.getNumKeyFrames() * sizeof(bs::TKeyframe<bs::Vector3>);
+    }
+
+    for (const auto& c : curves->rotation)
+    {
+      size += c.curve.getNumKeyFrames() * sizeof(bs::TKeyframe<bs::Quaternion>);
+    }
+
+    for (const auto& c : curves->scale)
+    {
+      size += c.curve.getNumKeyFrames() * sizeof(bs::TKeyframe<bs::Vector3>);
+    }
+
+    for (const auto& c : curves->generic)
+    {
+      size += c.curve.getNumKeyFrames() * sizeof(bs::TKeyframe<float>);
+    }
+
+    return size;
   }
 
-  BsZenLib::Res::HMeshWithMaterials OriginalGameResources::staticMesh(
-      const bs::String& originalFileName)
+  static bs::UINT64 memorySizeOf(const BsZenLib::Res::HModelScriptFile& modelScript)
   {
-    BsZenLib::Res::HMeshWithMaterials hmesh;
+    if (!modelScript.isLoaded()) return 0;
 
-    auto it = mStaticMeshes.find(originalFileName);
+    bs::UINT64 size = 0;
 
-    if (it != mStaticMeshes.end())
+    for (const auto& mesh : modelScript->getMeshes())
     {
-      return it->second;
+      size += memorySizeOf(mesh);
     }
 
-    if (BsZenLib::HasCachedStaticMesh(originalFileName))
+    for (const auto& animation : modelScript->getAnimations())
     {
-      hmesh = BsZenLib::LoadCachedStaticMesh(originalFileName);
+      if (animation.isLoaded())
+      {
+        size += memorySizeOf(animation->mClip);
+      }
     }
 
-    // This call also checks whether dependencies are loaded. Broken resources
-    // can be fixed by importing them.
-    if (!hmesh.isLoaded())
+    return size;
+  }
+
+  static void collectMaterialTextures(const BsZenLib::Res::HModelScriptFile& modelScript,
+                                      bs::Vector<bs::HTexture>& outTextures)
+  {
+    if (!modelScript.isLoaded()) return;
+
+    for (const auto& mesh : modelScript->getMeshes())
     {
-      hmesh =
-          BsZenLib::ImportAndCacheStaticMesh(originalFileName, gVirtualFileSystem().getFileIndex());
+      collectMaterialTextures(mesh, outTextures);
     }
+  }
 
-    mStaticMeshes[originalFileName] = hmesh;
+  static bs::UINT64 memorySizeOf(const bs::HFont& font)
+  {
+    if (!font.isLoaded()) return 0;
 
-    return hmesh;
+    // Original fonts only come in a single size
+    bs::SPtr<const bs::FontBitmap> bitmap = font->getBitmap(font->getClosestSize(0));
+
+    if (!bitmap) return 0;
+
+    bs::UINT64 size = 0;
+
+    for (const bs::HTexture& page : bitmap->texturePages)
+    {
+      size += memorySizeOf(page);
+    }
+
+    return size;
   }
 
-  BsZenLib::Res::HMeshWithMaterials OriginalGameResources::morphMesh(
-      const bs::String& originalFileName)
+  template <typename T>
+  ResourceRequest<T> OriginalGameResources::request(Cache<T>& cache,
+                                                    const bs::String& originalFileName,
+                                                    T (*load)(const bs::String&), bool isAsync)
   {
-    BsZenLib::Res::HMeshWithMaterials hmesh;
+    auto promise = bs::bs_shared_ptr_new<std::promise<T>>();
+
+    auto job = [promise, load, originalFileName, isAsync]() {
+      try
+      {
+        promise->set_value(load(originalFileName));
+      }
+      catch (...)
+      {
+        // Whoever is waiting for this would wait forever otherwise
+        promise->set_value({});
+
+        // Nobody would catch this on a worker thread
+        if (!isAsync) throw;
+
+        REGOTH_LOG(Error, Uncategorized, "[OriginalGameResources] Failed to load {0}",
+                   originalFileName);
+      }
+    };
+
+    bs::SPtr<bs::Task> task;
+    ResourceRequest<T> newRequest;
+
+    {
+      bs::Lock lock(mMutex);
+
+      auto it = cache.entries.find(originalFileName);
+
+      if (it != cache.entries.end())
+      {
+        cache.numHits++;
+        it->second.lastUsed = ++mUseCounter;
+
+        return it->second.request;
+      }
+
+      cache.numMisses++;
 
-    auto it = mMorphMeshes.find(originalFileName);
+      if (isAsync)
+      {
+        task = bs::Task::create("LoadOriginalGameResource", job);
+      }
 
-    if (it != mMorphMeshes.end())
+      newRequest = ResourceRequest<T>(promise->get_future().share(), task);
+
+      CacheEntry<T>& entry = cache.entries[originalFileName];
+      entry.request        = newRequest;
+      entry.lastUsed       = ++mUseCounter;
+    }
+
+    if (task)
     {
-      return it->second;
+      bs::TaskScheduler::instance().addTask(task);
     }
+    else
+    {
+      job();
+    }
+
+    return newRequest;
+  }
 
-    if (BsZenLib::HasCachedMorphMesh(originalFileName))
+  template <typename T>
+  OriginalGameResources::CategoryStats OriginalGameResources::updateSizes(Cache<T>& cache)
+  {
+    CategoryStats stats;
+    stats.numHits      = cache.numHits;
+    stats.numMisses    = cache.numMisses;
+    stats.numEvictions = cache.numEvictions;
+
+    for (auto& it : cache.entries)
     {
-      hmesh = BsZenLib::LoadCachedMorphMesh(originalFileName);
+      CacheEntry<T>& entry = it.second;
+
+      if (!entry.isSizeKnown)
+      {
+        if (!entry.request.isReady()) continue;
+
+        entry.sizeBytes   = memorySizeOf(entry.request.get());
+        entry.isSizeKnown = true;
+
+        addMaterialTextures(entry);
+      }
+
+      stats.numResident++;
+      stats.residentBytes += entry.sizeBytes;
     }
 
-    // This call also checks whether dependencies are loaded. Broken resources
-    // can be fixed by importing them.
-    if (!hmesh.isLoaded())
+    return stats;
+  }
+
+  template <typename T>
+  void OriginalGameResources::addMaterialTextures(CacheEntry<T>& entry)
+  {
+    bs::Vector<bs::HTexture> textures;
+    collectMaterialTextures(entry.request.get(), textures);
+
+    for (const bs::HTexture& texture : textures)
+    {
+      bs::UUID uuid = texture.getUUID();
+
+      // Textures used by more than one material of the same mesh only count once
+      if (std::find(entry.materialTextures.begin(), entry.materialTextures.end(), uuid) !=
+          entry.materialTextures.end())
+      {
+        continue;
+      }
+
+      MaterialTexture& materialTexture = mMaterialTextures[uuid];
+
+      if (materialTexture.numUsers == 0)
+      {
+        materialTexture.sizeBytes = memorySizeOf(texture);
+      }
+
+      materialTexture.numUsers++;
+      entry.materialTextures.push_back(uuid);
+    }
+  }
+
+  template <typename T>
+  void OriginalGameResources::eraseEntry(
+      Cache<T>& cache, typename bs::Map<bs::String, CacheEntry<T>>::iterator it)
+  {
+    for (const bs::UUID& uuid : it->second.materialTextures)
     {
-      hmesh =
-          BsZenLib::ImportAndCacheMorphMesh(originalFileName, gVirtualFileSystem().getFileIndex());
+      auto texture = mMaterialTextures.find(uuid);
+
+      if (texture == mMaterialTextures.end()) continue;
+
+      texture->second.numUsers--;
+
+      if (texture->second.numUsers == 0)
+      {
+        mMaterialTextures.erase(texture);
+      }
     }
 
-    mMorphMeshes[originalFileName] = hmesh;
+    cache.entries.erase(it);
+  }
 
-    return hmesh;
+  void OriginalGameResources::setMemoryBudget(bs::UINT64 bytes)
+  {
+    mMemoryBudget = bytes;
   }
 
-  bs::HFont OriginalGameResources::font(const bs::String& originalFileName)
+  void OriginalGameResources::evictUnused()
   {
-    bs::HFont hfont;
+    if (mMemoryBudget == 0) return;
 
-    auto it = mFonts.find(originalFileName);
+    // Visits each cache along with the function loading its resources
+    auto forEachCache = [this](auto&& visit) {
+      visit(mTextures, &loadOrImportTexture);
+      visit(mModelScripts, &loadOrImportModelScript);
+      visit(mStaticMeshes, &loadOrImportStaticMesh);
+      visit(mMorphMeshes, &loadOrImportMorphMesh);
+      visit(mFonts, &loadOrImportFont);
+    };
 
-    if (it != mFonts.end())
+    struct Candidate
     {
-      return it->second;
+      bs::UINT64 lastUsed;
+      bs::UINT64 sizeBytes;
+      bs::UINT32 category;
+      bs::String name;
+      bs::UUID uuid;
+      bs::Vector<bs::UUID> materialTextures;
+    };
+
+    bs::Vector<Candidate> candidates;
+    bs::UINT64 residentBytes = 0;
+
+    // Copied, to find out which textures dropping the candidates would free
+    bs::UnorderedMap<bs::UUID, MaterialTexture> materialTextures;
+
+    {
+      bs::Lock lock(mMutex);
+
+      bs::UINT32 category = 0;
+
+      forEachCache([&](auto& cache, auto /* load */) {
+        residentBytes += updateSizes(cache).residentBytes;
+
+        for (const auto& it : cache.entries)
+        {
+          // Resources still being loaded can't be dropped
+          if (!it.second.isSizeKnown) continue;
+
+          candidates.push_back({it.second.lastUsed, it.second.sizeBytes, category, it.first,
+                                bs::UUID::EMPTY, it.second.materialTextures});
+        }
+
+        category++;
+      });
+
+      materialTextures = mMaterialTextures;
+
+      for (const auto& it : materialTextures)
+      {
+        residentBytes += it.second.sizeBytes;
+      }
     }
 
-    if (BsZenLib::HasCachedFont(originalFileName))
+    if (residentBytes <= mMemoryBudget) return;
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.lastUsed < b.lastUsed; });
+
+    // Pick the least recently used ones until the rest would fit. A material texture is only
+    // freed along with the last of the picked candidates using it.
+    bs::UINT64 bytesToFree = residentBytes - mMemoryBudget;
+    bs::UINT64 bytesPicked = 0;
+    size_t numPicked       = 0;
+
+    while (numPicked < candidates.size() && bytesPicked < bytesToFree)
     {
-      hfont = BsZenLib::LoadCachedFont(originalFileName);
+      Candidate& candidate = candidates[numPicked];
+
+      for (const bs::UUID& uuid : candidate.materialTextures)
+      {
+        MaterialTexture& texture = materialTextures[uuid];
+
+        if (texture.numUsers == 0) continue;
+
+        texture.numUsers--;
+
+        if (texture.numUsers == 0)
+        {
+          candidate.sizeBytes += texture.sizeBytes;
+        }
+      }
+
+      bytesPicked += candidate.sizeBytes;
+      numPicked++;
     }
 
-    // This call also checks whether dependencies are loaded. Broken resources
-    // can be fixed by importing them.
-    if (!hfont.isLoaded())
+    candidates.resize(numPicked);
+
     {
-      hfont = BsZenLib::ImportAndCacheFont(originalFileName, gVirtualFileSystem().getFileIndex());
+      bs::Lock lock(mMutex);
+
+      bs::UINT32 category = 0;
+
+      forEachCache([&](auto& cache, auto /* load */) {
+        for (Candidate& candidate : candidates)
+        {
+          if (candidate.category != category) continue;
+
+          auto it = cache.entries.find(candidate.name);
+
+          // Might have been asked for again in the meantime
+          if (it == cache.entries.end() || it->second.lastUsed != candidate.lastUsed) continue;
+
+          candidate.uuid = it->second.request.get().getUUID();
+
+          eraseEntry(cache, it);
+        }
+
+        category++;
+      });
     }
 
-    mFonts[originalFileName] = hfont;
+    // Only bsf knows whether a resource is still referenced somewhere else. Those are still
+    // loaded afterwards and stay in memory anyway, so they are looked up again, which is cheap
+    // and keeps the accounting right.
+    bs::gResources().unloadAllUnused();
 
-    return hfont;
+    bs::UINT32 numEvicted  = 0;
+    bs::UINT64 bytesFreed  = 0;
+    bs::UINT32 numReloaded = 0;
+    bs::UINT32 category    = 0;
+
+    forEachCache([&](auto& cache, auto load) {
+      for (const Candidate& candidate : candidates)
+      {
+        if (candidate.category != category || candidate.uuid.empty()) continue;
+
+        if (bs::gResources().isLoaded(candidate.uuid))
+        {
+          numReloaded++;
+
+          {
+            bs::Lock lock(mMutex);
+
+            // Asked for again in the meantime
+            if (cache.entries.find(candidate.name) != cache.entries.end()) continue;
+
+            // Looking it up again is not something anyone asked for
+            cache.numMisses--;
+          }
+
+          request(cache, candidate.name, load, false);
+
+          bs::Lock lock(mMutex);
+
+          // Still as unused as before, so it is the first to go next time again
+          auto it = cache.entries.find(candidate.name);
+
+          if (it != cache.entries.end())
+          {
+            it->second.lastUsed = candidate.lastUsed;
+          }
+        }
+        else
+        {
+          numEvicted++;
+          bytesFreed += candidate.sizeBytes;
+
+          bs::Lock lock(mMutex);
+          cache.numEvictions++;
+        }
+      }
+
+      category++;
+    });
+
+    REGOTH_LOG(Info, Uncategorized,
+               "[OriginalGameResources] Evicted {0} resources ({1} KiB), {2} still in use",
+               numEvicted, bytesFreed / 1024, numReloaded);
   }
 
-  bs::HSpriteTexture OriginalGameResources::sprite(const bs::String& originalFileName)
+  OriginalGameResources::Stats OriginalGameResources::stats()
+  {
+    bs::Lock lock(mMutex);
+
+    Stats stats;
+    stats.textures     = updateSizes(mTextures);
+    stats.modelScripts = updateSizes(mModelScripts);
+    stats.staticMeshes = updateSizes(mStaticMeshes);
+    stats.morphMeshes  = updateSizes(mMorphMeshes);
+    stats.fonts        = updateSizes(mFonts);
+
+    for (const auto& it : mMaterialTextures)
+    {
+      stats.materialTextures.numResident++;
+      stats.materialTextures.residentBytes += it.second.sizeBytes;
+    }
+
+    return stats;
+  }
+
+  void OriginalGameResources::logStats()
+  {
+    Stats s = stats();
+
+    bs::UINT64 residentBytes = s.textures.residentBytes + s.modelScripts.residentBytes +
+                               s.staticMeshes.residentBytes + s.morphMeshes.residentBytes +
+                               s.fonts.residentBytes + s.materialTextures.residentBytes;
+
+    REGOTH_LOG(Info, Uncategorized,
+               "[OriginalGameResources] {0} MiB resident, budget {1} MiB (0 = unlimited)",
+               residentBytes / (1024 * 1024), mMemoryBudget / (1024 * 1024));
+
+    auto logCategory = [](const char* name, const CategoryStats& c) {
+      bs::UINT64 numRequests = c.numHits + c.numMisses;
+      bs::UINT64 hitRate     = numRequests == 0 ? 0 : c.numHits * 100 / numRequests;
+
+      REGOTH_LOG(Info, Uncategorized,
+                 "[OriginalGameResources]   {0}: {1} resident ({2} KiB), {3}% hit rate ({4} hits, "
+                 "{5} misses), {6} evicted",
+                 bs::String(name), c.numResident, c.residentBytes / 1024, hitRate, c.numHits,
+                 c.numMisses, c.numEvictions);
+    };
+
+    logCategory(mTextures.name, s.textures);
+    logCategory(mModelScripts.name, s.modelScripts);
+    logCategory(mStaticMeshes.name, s.staticMeshes);
+    logCategory(mMorphMeshes.name, s.morphMeshes);
+    logCategory(mFonts.name, s.fonts);
+    logCategory("Material textures", s.materialTextures);
+  }
+
+  bs::HTexture OriginalGameResources::texture(const bs::String& originalFileName)
+  {
+    return request(mTextures, originalFileName, &loadOrImportTexture, false).get();
+  }
+
+  BsZenLib::Res::HModelScriptFile OriginalGameResources::modelScript(
+      const bs::String& originalFileName)
+  {
+    return request(mModelScripts, originalFileName, &loadOrImportModelScript, false).get();
+  }
+
+  BsZenLib::Res::HMeshWithMaterials OriginalGameResources::staticMesh(
+      const bs::String& originalFileName)
+  {
+    return request(mStaticMeshes, originalFileName, &loadOrImportStaticMesh, false).get();
+  }
+
+  BsZenLib::Res::HMeshWithMaterials OriginalGameResources::morphMesh(
+      const bs::String& originalFileName)
+  {
+    return request(mMorphMeshes, originalFileName, &loadOrImportMorphMesh, false).get();
+  }
+
+  bs::HFont OriginalGameResources::font(const bs::String& originalFileName)
+  {
+    return request(mFonts, originalFileName, &loadOrImportFont, false).get();
+  }
+
+  ResourceRequest<bs::HTexture> OriginalGameResources::requestTexture(
+      const bs::String& originalFileName)
+  {
+    return request(mTextures, originalFileName, &loadOrImportTexture, true);
+  }
+
+  ResourceRequest<BsZenLib::Res::HModelScriptFile> OriginalGameResources::requestModelScript(
+      const bs::String& originalFileName)
   {
-    auto it = mSprites.find(originalFileName);
+    return request(mModelScripts, originalFileName, &loadOrImportModelScript, true);
+  }
+
+  ResourceRequest<BsZenLib::Res::HMeshWithMaterials> OriginalGameResources::requestStaticMesh(
+      const bs::String& originalFileName)
+  {
+    return request(mStaticMeshes, originalFileName, &loadOrImportStaticMesh, true);
+  }
+
+  ResourceRequest<BsZenLib::Res::HMeshWithMaterials> OriginalGameResources::requestMorphMesh(
+      const bs::String& originalFileName)
+  {
+    return request(mMorphMeshes, originalFileName, &loadOrImportMorphMesh, true);
+  }
+
+  ResourceRequest<bs::HFont> OriginalGameResources::requestFont(
+      const bs::String& originalFileName)
+  {
+    return request(mFonts, originalFileName, &loadOrImportFont, true);
+  }
+
+  void OriginalGameResources::preloadMeshes(const bs::Vector<bs::String>& staticMeshes,
+                                            const bs::Vector<bs::String>& morphMeshes)
+  {
+    bs::Vector<ResourceRequest<BsZenLib::Res::HMeshWithMaterials>> requests;
+
+    for (const bs::String& name : staticMeshes)
+    {
+      requests.push_back(requestStaticMesh(name));
+    }
+
+    for (const bs::String& name : morphMeshes)
+    {
+      requests.push_back(requestMorphMesh(name));
+    }
+
+    for (const auto& r : requests)
+    {
+      r.get();
+    }
+  }
 
-    if (it != mSprites.end())
+  bs::HSpriteTexture OriginalGameResources::sprite(const bs::String& originalFileName)
+  {
     {
-      return it->second;
+      bs::Lock lock(mMutex);
+
+      auto it = mSprites.find(originalFileName);
+
+      if (it != mSprites.end())
+      {
+        return it->second;
+      }
     }
 
     bs::HTexture t = texture(originalFileName);
@@ -188,15 +992,193 @@ namespace REGoth
 
     bs::HSpriteTexture hsprite = bs::SpriteTexture::create(t);
 
+    bs::Lock lock(mMutex);
+
     mSprites[originalFileName] = hsprite;
 
     return hsprite;
   }
 
+  /**
+   * Loads a resource from the cache or imports it if that did not work. Do not touch any
+   * state of OriginalGameResources, so these are safe to call from worker threads.
+   */
+  static bs::HTexture loadOrImportTexture(const bs::String& originalFileName)
+  {
+    bs::HTexture htexture;
+
+    {
+      ResourceManifestReadLock manifestLock(gResourceManifestMutex());
+
+      if (BsZenLib::HasCachedTexture(originalFileName))
+      {
+        htexture = BsZenLib::LoadCachedTexture(originalFileName);
+      }
+    }
+
+    // This call also checks whether dependencies are loaded. Broken resources
+    // can be fixed by importing them.
+    if (!htexture.isLoaded())
+    {
+      ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+
+      // Might have been imported by someone else while waiting for the lock
+      if (BsZenLib::HasCachedTexture(originalFileName))
+      {
+        htexture = BsZenLib::LoadCachedTexture(originalFileName);
+      }
+
+      if (!htexture.isLoaded())
+      {
+        htexture = BsZenLib::ImportAndCacheTexture(originalFileName,
+                                                   gVirtualFileSystem().getFileIndex());
+      }
+    }
+
+    return htexture;
+  }
+
+  static BsZenLib::Res::HModelScriptFile loadOrImportModelScript(
+      const bs::String& originalFileName)
+  {
+    BsZenLib::Res::HModelScriptFile hmodelScript;
+
+    {
+      ResourceManifestReadLock manifestLock(gResourceManifestMutex());
+
+      if (BsZenLib::HasCachedMDS(originalFileName))
+      {
+        hmodelScript = BsZenLib::LoadCachedMDS(originalFileName);
+      }
+    }
+
+    // This call also checks whether dependencies are loaded. Broken resources
+    // can be fixed by importing them.
+    if (!hmodelScript.isLoaded())
+    {
+      ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+
+      // Might have been imported by someone else while waiting for the lock
+      if (BsZenLib::HasCachedMDS(originalFileName))
+      {
+        hmodelScript = BsZenLib::LoadCachedMDS(originalFileName);
+      }
+
+      if (!hmodelScript.isLoaded())
+      {
+        hmodelScript =
+            BsZenLib::ImportAndCacheMDS(originalFileName, gVirtualFileSystem().getFileIndex());
+      }
+    }
+
+    return hmodelScript;
+  }
+
+  static BsZenLib::Res::HMeshWithMaterials loadOrImportStaticMesh(
+      const bs::String& originalFileName)
+  {
+    BsZenLib::Res::HMeshWithMaterials hmesh;
+
+    {
+      ResourceManifestReadLock manifestLock(gResourceManifestMutex());
+
+      if (BsZenLib::HasCachedStaticMesh(originalFileName))
+      {
+        hmesh = BsZenLib::LoadCachedStaticMesh(originalFileName);
+      }
+    }
+
+    // This call also checks whether dependencies are loaded. Broken resources
+    // can be fixed by importing them.
+    if (!hmesh.isLoaded())
+    {
+      hmesh = importAndCacheStaticMesh(originalFileName);
+    }
+
+    return hmesh;
+  }
+
+  static BsZenLib::Res::HMeshWithMaterials loadOrImportMorphMesh(
+      const bs::String& originalFileName)
+  {
+    BsZenLib::Res::HMeshWithMaterials hmesh;
+
+    {
+      ResourceManifestReadLock manifestLock(gResourceManifestMutex());
+
+      if (BsZenLib::HasCachedMorphMesh(originalFileName))
+      {
+        hmesh = BsZenLib::LoadCachedMorphMesh(originalFileName);
+      }
+    }
+
+    // This call also checks whether dependencies are loaded. Broken resources
+    // can be fixed by importing them.
+    if (!hmesh.isLoaded())
+    {
+      ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+
+      // Might have been imported by someone else while waiting for the lock
+      if (BsZenLib::HasCachedMorphMesh(originalFileName))
+      {
+        hmesh = BsZenLib::LoadCachedMorphMesh(originalFileName);
+      }
+
+      if (!hmesh.isLoaded())
+      {
+        hmesh = BsZenLib::ImportAndCacheMorphMesh(originalFileName,
+                                                  gVirtualFileSystem().getFileIndex());
+      }
+    }
+
+    return hmesh;
+  }
+
+  static bs::HFont loadOrImportFont(const bs::String& originalFileName)
+  {
+    bs::HFont hfont;
+
+    {
+      ResourceManifestReadLock manifestLock(gResourceManifestMutex());
+
+      if (BsZenLib::HasCachedFont(originalFileName))
+      {
+        hfont = BsZenLib::LoadCachedFont(originalFileName);
+      }
+    }
+
+    // This call also checks whether dependencies are loaded. Broken resources
+    // can be fixed by importing them.
+    if (!hfont.isLoaded())
+    {
+      ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+
+      // Might have been imported by someone else while waiting for the lock
+      if (BsZenLib::HasCachedFont(originalFileName))
+      {
+        hfont = BsZenLib::LoadCachedFont(originalFileName);
+      }
+
+      if (!hfont.isLoaded())
+      {
+        hfont = BsZenLib::ImportAndCacheFont(originalFileName, gVirtualFileSystem().getFileIndex());
+      }
+    }
+
+    return hfont;
+  }
+
   OriginalGameResources& gOriginalGameResources()
   {
     static OriginalGameResources s_instance;
 
     return s_instance;
   }
+
+  std::shared_timed_mutex& gResourceManifestMutex()
+  {
+    static std::shared_timed_mutex s_mutex;
+
+    return s_mutex;
+  }
 }  // namespace REGoth
@@ -1,5 +1,11 @@
 #pragma once
 #include <BsPrerequisites.h>
+#include <Threading/BsTaskScheduler.h>
+#include <Threading/BsThreading.h>
+#include <Utility/BsUUID.h>
+#include <chrono>
+#include <future>
+#include <shared_mutex>
 
 namespace BsZenLib
 {
@@ -15,6 +21,64 @@ namespace BsZenLib
 
 namespace REGoth
 {
+  /**
+   * Handle to a resource requested from OriginalGameResources, which might still be loading
+   * in the background. Copies refer to the same request.
+   */
+  template <typename T>
+  class ResourceRequest
+  {
+  public:
+    ResourceRequest() = default;
+
+    ResourceRequest(std::shared_future<T> future, bs::SPtr<bs::Task> task)
+        : mFuture(std::move(future))
+        , mTask(std::move(task))
+    {
+    }
+
+    /**
+     * @return Whether anything has been requested.
+     */
+    bool isValid() const
+    {
+      return mFuture.valid();
+    }
+
+    /**
+     * @return Whether the resource has arrived, or failed to load. Does not block.
+     */
+    bool isReady() const
+    {
+      return mFuture.valid() &&
+             mFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    /**
+     * Blocks until the resource has arrived.
+     *
+     * @return bsf resource handle. Empty if loading failed or nothing has been requested.
+     */
+    T get() const
+    {
+      if (!mFuture.valid()) return {};
+
+      // The scheduler lets another task run while waiting on one, so this can't run out of
+      // worker threads when called from a task itself
+      if (mTask) mTask->wait();
+
+      return mFuture.get();
+    }
+
+  private:
+    std::shared_future<T> mFuture;
+
+    /**
+     * Task loading the resource. Not set if it is loaded on the thread which requested it.
+     */
+    bs::SPtr<bs::Task> mTask;
+  };
+
   /**
    * This provides a global object to load resources from the original game.
    *
@@ -29,15 +93,59 @@ namespace REGoth
    * To make loading more efficient, a check whether the resource to load has been
    * cached is done. If it was not, the resource is imported into the cache so it
    * can be loaded quicker next time.
+   *
+   * Next to the blocking methods, each resource can also be requested to be loaded on
+   * a worker thread, see requestTexture() and friends. Requests for the same resource
+   * are only loaded once, even if one is asked for again while it is still loading. All
+   * methods except sprite(), evictUnused() and logStats() may be called from any thread.
+   *
+   * Loaded resources are kept in memory as long as they fit into the memory budget. Once
+   * the budget is exceeded, evictUnused() drops the least recently used resources which are
+   * not referenced anywhere else. They will be loaded from the cache again when asked for.
    */
   class OriginalGameResources
   {
   public:
+    /**
+     * What the cache of one kind of resource holds and how well it is doing.
+     */
+    struct CategoryStats
+    {
+      bs::UINT32 numResident   = 0;
+      bs::UINT64 residentBytes = 0;
+      bs::UINT64 numHits       = 0;
+      bs::UINT64 numMisses     = 0;
+      bs::UINT64 numEvictions  = 0;
+    };
+
+    struct Stats
+    {
+      CategoryStats textures;
+      CategoryStats modelScripts;
+      CategoryStats staticMeshes;
+      CategoryStats morphMeshes;
+      CategoryStats fonts;
+
+      /**
+       * Textures used by the materials of the loaded meshes. Only the resident ones are
+       * counted, requests for them go through the meshes.
+       */
+      CategoryStats materialTextures;
+    };
+
     /**
      * Goes through the loaded VDFS packages and imports the original games resources
      * which were not already cached.
+     *
+     * Resources are imported in parallel, in batches. Reading and parsing the original files
+     * runs on the workers, only adding the results to the cache is done one at a time, see
+     * gResourceManifestMutex(). After each batch, the resource manifest is saved, so an
+     * interrupted run continues where it stopped the next time. Once done, a report of how
+     * long each type of resource took is logged and written to the cache directory.
+     *
+     * @param  numJobs  How many resources to import at the same time. 0 for one per core.
      */
-    static void populateCache();
+    static void populateCache(bs::UINT32 numJobs = 0);
 
     /**
      * Loads a texture from the original game files.
@@ -99,6 +207,37 @@ namespace REGoth
      */
     bs::HFont font(const bs::String& originalFileName);
 
+    /**
+     * Like texture(), but loads the texture on a worker thread if it is not in memory yet.
+     *
+     * @return Request to check whether the texture has arrived and to get it.
+     */
+    ResourceRequest<bs::HTexture> requestTexture(const bs::String& originalFileName);
+
+    /**
+     * Like modelScript(), but loads the model script on a worker thread if it is not in
+     * memory yet.
+     */
+    ResourceRequest<BsZenLib::Res::HModelScriptFile> requestModelScript(
+        const bs::String& originalFileName);
+
+    /**
+     * Like staticMesh(), but loads the mesh on a worker thread if it is not in memory yet.
+     */
+    ResourceRequest<BsZenLib::Res::HMeshWithMaterials> requestStaticMesh(
+        const bs::String& originalFileName);
+
+    /**
+     * Like morphMesh(), but loads the mesh on a worker thread if it is not in memory yet.
+     */
+    ResourceRequest<BsZenLib::Res::HMeshWithMaterials> requestMorphMesh(
+        const bs::String& originalFileName);
+
+    /**
+     * Like font(), but loads the font on a worker thread if it is not in memory yet.
+     */
+    ResourceRequest<bs::HFont> requestFont(const bs::String& originalFileName);
+
     /**
      * Loads a texture into a sprite.
      *
@@ -108,20 +247,187 @@ namespace REGoth
      */
     bs::HSpriteTexture sprite(const bs::String& originalFileName);
 
+    /**
+     * Loads the given static and morph meshes on the worker threads, so the following calls
+     * to staticMesh() and morphMesh() find them in memory. Meshes which have not been cached
+     * yet are imported there as well. Only adding them to the cache is done one at a time,
+     * see gResourceManifestMutex(). Blocks until all meshes are loaded.
+     *
+     * @param  staticMeshes  File names of static meshes, e.g. `STONE.3DS`.
+     * @param  morphMeshes   File names of morph meshes, e.g. `FIRE.MMS`.
+     */
+    void preloadMeshes(const bs::Vector<bs::String>& staticMeshes,
+                       const bs::Vector<bs::String>& morphMeshes);
+
+    /**
+     * Sets how many bytes the loaded resources may take up before evictUnused() drops some
+     * of them. 0 for no limit, which is the default.
+     *
+     * Sizes are estimated from the GPU-side data of textures and meshes and the keyframes
+     * of animations. Textures referenced by the materials of meshes are counted once, no
+     * matter how many meshes share them, and only count as freed once the last of those
+     * meshes is dropped.
+     */
+    void setMemoryBudget(bs::UINT64 bytes);
+
+    bs::UINT64 memoryBudget() const
+    {
+      return mMemoryBudget;
+    }
+
+    /**
+     * If the loaded resources exceed the memory budget, drops the least recently used ones
+     * until they fit again. Resources still referenced anywhere else, like by a scene object,
+     * are kept, since dropping them would not free anything.
+     *
+     * Unloads all unused bsf resources on the way, so this must be called from the main
+     * thread. A good time is after loading a world, when the previous one is gone.
+     */
+    void evictUnused();
+
+    /**
+     * @return How much memory each kind of resource takes up and how often it was found in
+     *         memory.
+     */
+    Stats stats();
+
+    /**
+     * Logs stats() along with the memory budget.
+     */
+    void logStats();
+
   private:
+    template <typename T>
+    struct CacheEntry
+    {
+      ResourceRequest<T> request;
+
+      /**
+       * Value of mUseCounter when this was last asked for.
+       */
+      bs::UINT64 lastUsed = 0;
+
+      /**
+       * Estimated size, found once the resource has been loaded. Does not include the
+       * material textures, as those might be shared with other entries.
+       */
+      bs::UINT64 sizeBytes = 0;
+      bool isSizeKnown     = false;
+
+      /**
+       * Textures used by the materials of the resource, each listed once. Holds a reference
+       * on each of them inside mMaterialTextures, see addMaterialTextures().
+       */
+      bs::Vector<bs::UUID> materialTextures;
+    };
+
     /**
-     * Caches so that we don't have to re-load resources.
+     * A texture used by the materials of one or more loaded entries.
      */
-    bs::Map<bs::String, bs::HTexture> mTextures;
-    bs::Map<bs::String, BsZenLib::Res::HModelScriptFile> mModelScripts;
-    bs::Map<bs::String, BsZenLib::Res::HMeshWithMaterials> mStaticMeshes;
-    bs::Map<bs::String, BsZenLib::Res::HMeshWithMaterials> mMorphMeshes;
-    bs::Map<bs::String, bs::HFont> mFonts;
+    struct MaterialTexture
+    {
+      bs::UINT64 sizeBytes = 0;
+
+      /**
+       * Number of entries listing this texture in their `materialTextures`.
+       */
+      bs::UINT32 numUsers = 0;
+    };
+
+    template <typename T>
+    struct Cache
+    {
+      explicit Cache(const char* name)
+          : name(name)
+      {
+      }
+
+      const char* name;
+      bs::Map<bs::String, CacheEntry<T>> entries;
+
+      bs::UINT64 numHits      = 0;
+      bs::UINT64 numMisses    = 0;
+      bs::UINT64 numEvictions = 0;
+    };
+
+    /**
+     * Looks up the resource in the given cache. If it has not been requested before, it is
+     * loaded via `load`, either on a worker thread or right away on the calling one.
+     */
+    template <typename T>
+    ResourceRequest<T> request(Cache<T>& cache, const bs::String& originalFileName,
+                               T (*load)(const bs::String&), bool isAsync);
+
+    /**
+     * Finds the sizes of the entries which have been loaded since the last call. Must be
+     * called with mMutex locked.
+     *
+     * @return Stats of the cache, without the resources still being loaded.
+     */
+    template <typename T>
+    CategoryStats updateSizes(Cache<T>& cache);
+
+    /**
+     * Adds the textures used by the materials of a loaded entry to mMaterialTextures, or
+     * adds a user to them if another entry uses them already. Materials of different meshes
+     * often share their textures, so their sizes are not part of the entries own size.
+     * Must be called with mMutex locked.
+     */
+    template <typename T>
+    void addMaterialTextures(CacheEntry<T>& entry);
+
+    /**
+     * Drops an entry from its cache, along with its references on the material textures.
+     * Textures without users left are dropped as well. Must be called with mMutex locked.
+     */
+    template <typename T>
+    void eraseEntry(Cache<T>& cache, typename bs::Map<bs::String, CacheEntry<T>>::iterator it);
+
+    /**
+     * Caches so that we don't have to re-load resources. Resources still being loaded
+     * are in here as well, so they are not loaded twice.
+     */
+    Cache<bs::HTexture> mTextures{"Textures"};
+    Cache<BsZenLib::Res::HModelScriptFile> mModelScripts{"Model scripts"};
+    Cache<BsZenLib::Res::HMeshWithMaterials> mStaticMeshes{"Static meshes"};
+    Cache<BsZenLib::Res::HMeshWithMaterials> mMorphMeshes{"Morph meshes"};
+    Cache<bs::HFont> mFonts{"Fonts"};
     bs::Map<bs::String, bs::HSpriteTexture> mSprites;
+
+    /**
+     * Counts up each time a resource is asked for, to find the least recently used ones.
+     */
+    bs::UINT64 mUseCounter = 0;
+
+    /**
+     * Textures used by the materials of the loaded entries, see addMaterialTextures().
+     */
+    bs::UnorderedMap<bs::UUID, MaterialTexture> mMaterialTextures;
+
+    bs::UINT64 mMemoryBudget = 0;
+
+    /**
+     * Guards the caches.
+     */
+    bs::Mutex mMutex;
   };
 
   /**
    * Global access to the virtual file system.
    */
   OriginalGameResources& gOriginalGameResources();
+
+  /**
+   * BsZenLib keeps a single global resource manifest, which is not thread safe: Loading a
+   * cached resource looks it up there, and each import adds to it. Imports might also import
+   * and save textures shared with other resources.
+   *
+   * Checking for and loading cached resources must hold a ResourceManifestReadLock. Importing,
+   * adding to and saving the manifest must hold a ResourceManifestWriteLock, so imports are
+   * done one at a time. Reading and parsing the original files doesn't need either.
+   */
+  std::shared_timed_mutex& gResourceManifestMutex();
+
+  using ResourceManifestReadLock  = std::shared_lock<std::shared_timed_mutex>;
+  using ResourceManifestWriteLock = std::unique_lock<std::shared_timed_mutex>;
 }  // namespace REGoth
@@ -1,11 +1,306 @@
 #include "VirtualFileSystem.hpp"
+#include <FileSystem/BsDataStream.h>
 #include <FileSystem/BsFileSystem.h>
+#include <Threading/BsThreading.h>
+#include <Utility/BsTimer.h>
+#include <cstring>
 #include <exception/Throw.hpp>
 #include <log/logging.hpp>
 #include <vdfs/fileIndex.h>
 
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <String/BsUnicode.h>
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 using namespace REGoth;
 
+namespace
+{
+  /**
+   * A whole file mapped into memory, read-only.
+   */
+  class MappedFile
+  {
+  public:
+    /**
+     * @return The mapped file. Null if it could not be opened or mapped.
+     */
+    static bs::SPtr<MappedFile> open(const bs::Path& path);
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const bs::UINT8* data() const
+    {
+      return mData;
+    }
+
+    size_t size() const
+    {
+      return mSize;
+    }
+
+  private:
+    const bs::UINT8* mData = nullptr;
+    size_t mSize           = 0;
+
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+    HANDLE mFile    = INVALID_HANDLE_VALUE;
+    HANDLE mMapping = nullptr;
+#endif
+  };
+
+#if BS_PLATFORM == BS_PLATFORM_WIN32
+  bs::SPtr<MappedFile> MappedFile::open(const bs::Path& path)
+  {
+    auto result = bs::bs_shared_ptr_new<MappedFile>();
+
+    bs::WString widePath = bs::UTF8::toWide(path.toString());
+
+    result->mFile = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (result->mFile == INVALID_HANDLE_VALUE) return nullptr;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(result->mFile, &size)) return nullptr;
+
+    // Empty files can't be mapped, but there is nothing to map either
+    if (size.QuadPart == 0) return result;
+
+    result->mMapping = CreateFileMappingW(result->mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (!result->mMapping) return nullptr;
+
+    void* data = MapViewOfFile(result->mMapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!data) return nullptr;
+
+    result->mData = (const bs::UINT8*)data;
+    result->mSize = (size_t)size.QuadPart;
+
+    return result;
+  }
+
+  MappedFile::~MappedFile()
+  {
+    if (mData) UnmapViewOfFile(mData);
+    if (mMapping) CloseHandle(mMapping);
+    if (mFile != INVALID_HANDLE_VALUE) CloseHandle(mFile);
+  }
+#else
+  bs::SPtr<MappedFile> MappedFile::open(const bs::Path& path)
+  {
+    int fd = ::open(path.toString().c_str(), O_RDONLY);
+
+    if (fd < 0) return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+      close(fd);
+      return nullptr;
+    }
+
+    auto result = bs::bs_shared_ptr_new<MappedFile>();
+
+    // Empty files can't be mapped, but there is nothing to map either
+    if (info.st_size > 0)
+    {
+      void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+      if (data == MAP_FAILED)
+      {
+        close(fd);
+        return nullptr;
+      }
+
+      result->mData = (const bs::UINT8*)data;
+      result->mSize = (size_t)info.st_size;
+    }
+
+    // The mapping stays valid without the descriptor
+    close(fd);
+
+    return result;
+  }
+
+  MappedFile::~MappedFile()
+  {
+    if (mData) munmap((void*)mData, mSize);
+  }
+#endif
+
+  /**
+   * Layout of the header and catalog of a VDF package, as written by Gothics packer.
+   */
+  struct VdfHeader
+  {
+    char comment[256];
+    char signature[16];
+    bs::UINT32 numEntries;
+    bs::UINT32 numFiles;
+    bs::UINT32 timestamp;
+    bs::UINT32 dataSize;
+    bs::UINT32 catalogOffset;
+    bs::UINT32 entrySize;
+  };
+
+  struct VdfEntry
+  {
+    char name[64];
+    bs::UINT32 offset;
+    bs::UINT32 size;
+    bs::UINT32 type;
+    bs::UINT32 attributes;
+  };
+
+  static_assert(sizeof(VdfHeader) == 296, "VdfHeader must match the layout on disk");
+  static_assert(sizeof(VdfEntry) == 80, "VdfEntry must match the layout on disk");
+
+  /**
+   * Prefix of the signature of all known VDF versions.
+   */
+  const char* VDF_SIGNATURE = "PSVDSC_V2.00";
+
+  /**
+   * Set inside VdfEntry::type for directories. All other entries are files.
+   */
+  constexpr bs::UINT32 VDF_ENTRY_DIRECTORY = 0x80000000;
+
+  /**
+   * Where the data of a file can be found, for reading it without going through the file index.
+   */
+  struct FileSource
+  {
+    /**
+     * How often the file was found. The file index decides which one is read if there are
+     * multiple, so only a file found once may be read directly.
+     */
+    bs::UINT32 numFound = 0;
+
+    /**
+     * Index of the package the file is in. NO_PACKAGE if it is inside the mounted directory,
+     * at `path`.
+     */
+    bs::UINT32 package = 0;
+    bs::UINT32 offset  = 0;
+    bs::UINT32 size    = 0;
+    bs::Path path;
+  };
+
+  constexpr bs::UINT32 NO_PACKAGE = 0xFFFFFFFF;
+
+  /**
+   * Files inside a package, as read from its catalog. Saved to the index cache, so the
+   * catalog doesn't have to be read again, see VirtualFileSystem::loadIndexCache().
+   */
+  struct PackageCatalog
+  {
+    struct Entry
+    {
+      bs::String name;
+      bs::UINT32 offset;
+      bs::UINT32 size;
+    };
+
+    bs::String path;
+
+    /**
+     * Used to tell whether the package has changed since the catalog was read.
+     */
+    bs::UINT64 lastModifiedTime = 0;
+    bs::UINT64 fileSize         = 0;
+
+    bs::Vector<Entry> entries;
+  };
+
+  /**
+   * Written at the start of the index cache. Bump the version whenever the layout changes.
+   */
+  constexpr bs::UINT32 INDEX_CACHE_MAGIC   = 0x58444956;  // "VIDX"
+  constexpr bs::UINT32 INDEX_CACHE_VERSION = 1;
+
+  template <typename T>
+  void writeValue(bs::Vector<bs::UINT8>& buffer, const T& value)
+  {
+    const bs::UINT8* bytes = (const bs::UINT8*)&value;
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+  }
+
+  void writeString(bs::Vector<bs::UINT8>& buffer, const bs::String& value)
+  {
+    writeValue(buffer, (bs::UINT32)value.size());
+    buffer.insert(buffer.end(), value.begin(), value.end());
+  }
+
+  /**
+   * Reads what has been written via writeValue() and writeString() back out of a buffer.
+   * Fails once the end has been reached, so damaged files don't do any harm.
+   */
+  class BufferReader
+  {
+  public:
+    BufferReader(const bs::Vector<bs::UINT8>& buffer)
+        : mBuffer(buffer)
+    {
+    }
+
+    template <typename T>
+    bool read(T& outValue)
+    {
+      if (mPosition + sizeof(T) > mBuffer.size()) return false;
+
+      memcpy(&outValue, mBuffer.data() + mPosition, sizeof(T));
+      mPosition += sizeof(T);
+
+      return true;
+    }
+
+    bool readString(bs::String& outValue)
+    {
+      bs::UINT32 length;
+
+      if (!read(length) || mPosition + length > mBuffer.size()) return false;
+
+      outValue.assign((const char*)mBuffer.data() + mPosition, length);
+      mPosition += length;
+
+      return true;
+    }
+
+  private:
+    const bs::Vector<bs::UINT8>& mBuffer;
+    size_t mPosition = 0;
+  };
+
+  struct Package
+  {
+    bs::Path path;
+
+    /**
+     * Mapped on the first read, see InternalVirtualFileSystem::mappingOf().
+     */
+    bs::SPtr<MappedFile> mapping;
+    bool hasTriedMapping = false;
+  };
+}  // namespace
+
 class REGoth::InternalVirtualFileSystem
 {
 public:
@@ -15,6 +310,249 @@ public:
   VDFS::FileIndex fileIndex;
   bool isFinalized = false;
 
+  /**
+   * Where to find the files, by UPPERCASE name. Filled as packages are loaded and
+   * directories are mounted.
+   */
+  bs::UnorderedMap<bs::String, FileSource> sources;
+  bs::Vector<Package> packages;
+
+  /**
+   * Set if the catalog of a package could not be read. Then it is unknown which files
+   * exist multiple times, so all files have to be read through the file index.
+   */
+  bool hasUnknownSources = false;
+
+  /**
+   * Catalogs of all loaded packages, to be saved to the index cache.
+   */
+  bs::Vector<PackageCatalog> catalogs;
+
+  /**
+   * Catalogs loaded from the index cache, by path of the package.
+   */
+  bs::UnorderedMap<bs::String, PackageCatalog> cachedCatalogs;
+
+  VirtualFileSystem::IndexStats indexStats;
+
+  /**
+   * All known files in UPPERCASE and the same grouped by their extension. Built on the first
+   * query and dropped whenever files are added.
+   */
+  bool isListingBuilt = false;
+  bs::Vector<bs::String> allFilesUpperCase;
+  bs::UnorderedMap<bs::String, bs::Vector<bs::String>> filesByExtension;
+
+  /**
+   * Guards finalizing the file index, mapping packages and building the listing.
+   */
+  bs::Mutex mutex;
+
+  void addSource(const bs::String& file, const FileSource& source)
+  {
+    bs::String upper = file;
+    bs::StringUtil::toUpperCase(upper);
+
+    FileSource& existing = sources[upper];
+
+    bs::UINT32 numFound = existing.numFound + 1;
+
+    existing          = source;
+    existing.numFound = numFound;
+  }
+
+  /**
+   * Adds all files inside the given package to the sources. Their list is taken from the
+   * index cache if the package has not changed since, otherwise its catalog is read.
+   */
+  void addPackageSources(const bs::Path& path)
+  {
+    PackageCatalog catalog;
+    catalog.path             = path.toString();
+    catalog.lastModifiedTime = (bs::UINT64)bs::FileSystem::getLastModifiedTime(path);
+    catalog.fileSize         = bs::FileSystem::getFileSize(path);
+
+    auto cached = cachedCatalogs.find(catalog.path);
+
+    if (cached != cachedCatalogs.end() &&
+        cached->second.lastModifiedTime == catalog.lastModifiedTime &&
+        cached->second.fileSize == catalog.fileSize)
+    {
+      catalog.entries = std::move(cached->second.entries);
+      cachedCatalogs.erase(cached);
+
+      indexStats.numPackagesFromCache++;
+    }
+    else if (readPackageCatalog(path, catalog))
+    {
+      indexStats.numPackagesIndexed++;
+    }
+    else
+    {
+      REGOTH_LOG(Warning, Uncategorized,
+                 "[VDFS] Cannot read catalog of {0}, files will be copied when read",
+                 path.toString());
+
+      hasUnknownSources = true;
+      return;
+    }
+
+    bs::UINT32 packageIndex = (bs::UINT32)packages.size();
+
+    packages.emplace_back();
+    packages.back().path = path;
+
+    for (const PackageCatalog::Entry& entry : catalog.entries)
+    {
+      FileSource source;
+      source.package = packageIndex;
+      source.offset  = entry.offset;
+      source.size    = entry.size;
+
+      addSource(entry.name, source);
+    }
+
+    catalogs.push_back(std::move(catalog));
+  }
+
+  /**
+   * Reads the list of files out of the catalog stored inside the given VDF package.
+   *
+   * @return Whether the catalog could be read.
+   */
+  static bool readPackageCatalog(const bs::Path& path, PackageCatalog& outCatalog)
+  {
+    bs::SPtr<bs::DataStream> stream = bs::FileSystem::openFile(path, true);
+
+    VdfHeader header;
+
+    if (!stream || stream->read(&header, sizeof(header)) != sizeof(header) ||
+        strncmp(header.signature, VDF_SIGNATURE, strlen(VDF_SIGNATURE)) != 0 ||
+        header.entrySize != sizeof(VdfEntry))
+    {
+      return false;
+    }
+
+    bs::Vector<VdfEntry> entries(header.numEntries);
+
+    stream->seek(header.catalogOffset);
+
+    size_t catalogSize = entries.size() * sizeof(VdfEntry);
+
+    if (stream->read(entries.data(), catalogSize) != catalogSize)
+    {
+      return false;
+    }
+
+    for (const VdfEntry& entry : entries)
+    {
+      if (entry.type & VDF_ENTRY_DIRECTORY) continue;
+
+      // Names are padded with spaces
+      bs::String name(entry.name, strnlen(entry.name, sizeof(entry.name)));
+      bs::StringUtil::trim(name, " ", false, true);
+
+      outCatalog.entries.push_back({name, entry.offset, entry.size});
+    }
+
+    return true;
+  }
+
+  /**
+   * Builds the lists used by listAllFiles() and listByExtension(), if not done already.
+   */
+  void buildListing()
+  {
+    if (isListingBuilt) return;
+
+    std::vector<std::string> allStl = fileIndex.getKnownFiles();
+
+    allFilesUpperCase.resize(allStl.size());
+    filesByExtension.clear();
+
+    for (size_t i = 0; i < allStl.size(); i++)
+    {
+      bs::String& name = allFilesUpperCase[i];
+
+      // Internal file index will return the files in the casing they were stored in.
+      // To be consistent, convert them all to uppercase here.
+      name = allStl[i].c_str();
+      bs::StringUtil::toUpperCase(name);
+
+      size_t dot = name.find_last_of('.');
+
+      if (dot != bs::String::npos)
+      {
+        filesByExtension[name.substr(dot)].push_back(name);
+      }
+    }
+
+    isListingBuilt = true;
+  }
+
+  /**
+   * @return Mapping of the given package, mapping it if that has not been tried yet.
+   *         Null if it could not be mapped.
+   */
+  bs::SPtr<MappedFile> mappingOf(bs::UINT32 packageIndex)
+  {
+    bs::Lock lock(mutex);
+
+    Package& package = packages[packageIndex];
+
+    if (!package.hasTriedMapping)
+    {
+      package.mapping         = MappedFile::open(package.path);
+      package.hasTriedMapping = true;
+
+      if (!package.mapping)
+      {
+        REGOTH_LOG(Warning, Uncategorized, "[VDFS] Failed to map {0} into memory",
+                   package.path.toString());
+      }
+    }
+
+    return package.mapping;
+  }
+
+  /**
+   * Reads the given file directly from where it is stored, if possible.
+   *
+   * @return Whether the file could be read directly.
+   */
+  bool tryReadDirectly(const bs::String& file, FileView& outView)
+  {
+    if (hasUnknownSources) return false;
+
+    bs::String upper = file;
+    bs::StringUtil::toUpperCase(upper);
+
+    auto it = sources.find(upper);
+
+    if (it == sources.end() || it->second.numFound != 1) return false;
+
+    const FileSource& source = it->second;
+
+    if (source.package == NO_PACKAGE)
+    {
+      bs::SPtr<MappedFile> mapping = MappedFile::open(source.path);
+
+      if (!mapping) return false;
+
+      outView = FileView(mapping, mapping->data(), mapping->size());
+      return true;
+    }
+
+    bs::SPtr<MappedFile> mapping = mappingOf(source.package);
+
+    if (!mapping) return false;
+
+    if ((size_t)source.offset + source.size > mapping->size()) return false;
+
+    outView = FileView(mapping, mapping->data() + source.offset, source.size);
+    return true;
+  }
+
   bool isReadyToReadFiles()
   {
     if (!isFinalized)
@@ -29,6 +567,10 @@ public:
 
   void finalizeFileIndex()
   {
+    bs::Lock lock(mutex);
+
+    if (isFinalized) return;
+
     fileIndex.finalizeLoad();
     isFinalized = true;
   }
@@ -52,6 +594,20 @@ void VirtualFileSystem::mountDirectory(const bs::Path& path)
 
   REGOTH_LOG(Info, Uncategorized, "[VDFS] Mounting directory (recursive): {0}", path.toString());
 
+  // Files not inside any of the mounted directories are not known to the file index either,
+  // which readFileView() checks first. So it's fine to add all of them here.
+  mInternal->isListingBuilt = false;
+
+  auto onFile = [&](const bs::Path& p) {
+    FileSource source;
+    source.package = NO_PACKAGE;
+    source.path    = p;
+
+    mInternal->addSource(p.getFilename(), source);
+
+    return true;
+  };
+
   auto onDirectory = [&](const bs::Path& p) {
     bs::Path relative = p.getRelative(path);
     REGOTH_LOG(Info, Uncategorized, "[VDFS]  - {0}", relative.toString());
@@ -67,7 +623,7 @@ void VirtualFileSystem::mountDirectory(const bs::Path& path)
     NonRecursive = false,
   };
 
-  bs::FileSystem::iterate(path, nullptr, onDirectory, Recursive);
+  bs::FileSystem::iterate(path, onFile, onDirectory, Recursive);
 }
 
 bool VirtualFileSystem::loadPackage(const bs::Path& package)
@@ -79,35 +635,172 @@ bool VirtualFileSystem::loadPackage(const bs::Path& package)
     REGOTH_THROW(InvalidStateException, "Cannot load packages on finalized file index.");
   }
 
-  return mInternal->fileIndex.loadVDF(package.toString().c_str());
+  bs::Timer timer;
+
+  if (!mInternal->fileIndex.loadVDF(package.toString().c_str()))
+  {
+    return false;
+  }
+
+  mInternal->indexStats.mountMicroseconds += timer.getMicroseconds();
+
+  timer.reset();
+
+  mInternal->isListingBuilt = false;
+
+  mInternal->addPackageSources(package);
+
+  mInternal->indexStats.indexMicroseconds += timer.getMicroseconds();
+
+  return true;
 }
 
-bs::Vector<bs::String> VirtualFileSystem::listAllFiles()
+bool VirtualFileSystem::loadIndexCache(const bs::Path& path)
+{
+  throwOnMissingInternalState();
+
+  if (!bs::FileSystem::isFile(path)) return false;
+
+  bs::SPtr<bs::DataStream> stream = bs::FileSystem::openFile(path, true);
+
+  if (!stream) return false;
+
+  // Read everything at once, parsing is done in memory
+  bs::Vector<bs::UINT8> buffer(stream->size());
+
+  bool isComplete = stream->read(buffer.data(), buffer.size()) == buffer.size();
+
+  stream->close();
+
+  if (!isComplete) return false;
+
+  BufferReader reader(buffer);
+
+  bs::UINT32 magic;
+  bs::UINT32 version;
+  bs::UINT32 numCatalogs;
+
+  if (!reader.read(magic) || magic != INDEX_CACHE_MAGIC) return false;
+  if (!reader.read(version) || version != INDEX_CACHE_VERSION) return false;
+  if (!reader.read(numCatalogs)) return false;
+
+  bs::UnorderedMap<bs::String, PackageCatalog> catalogs;
+
+  for (bs::UINT32 c = 0; c < numCatalogs; c++)
+  {
+    PackageCatalog catalog;
+    bs::UINT32 numEntries;
+
+    if (!reader.readString(catalog.path) || !reader.read(catalog.lastModifiedTime) ||
+        !reader.read(catalog.fileSize) || !reader.read(numEntries))
+    {
+      return false;
+    }
+
+    catalog.entries.resize(numEntries);
+
+    for (PackageCatalog::Entry& entry : catalog.entries)
+    {
+      if (!reader.readString(entry.name) || !reader.read(entry.offset) ||
+          !reader.read(entry.size))
+      {
+        return false;
+      }
+    }
+
+    bs::String key = catalog.path;
+    catalogs[key]  = std::move(catalog);
+  }
+
+  mInternal->cachedCatalogs = std::move(catalogs);
+
+  return true;
+}
+
+void VirtualFileSystem::saveIndexCache(const bs::Path& path) const
 {
-  std::vector<std::string> allStl = mInternal->fileIndex.getKnownFiles();
-  bs::Vector<bs::String> all(allStl.size());
+  throwOnMissingInternalState();
+
+  // Nothing new to remember
+  if (mInternal->indexStats.numPackagesIndexed == 0 && mInternal->cachedCatalogs.empty())
+  {
+    return;
+  }
+
+  bs::Vector<bs::UINT8> buffer;
+
+  writeValue(buffer, INDEX_CACHE_MAGIC);
+  writeValue(buffer, INDEX_CACHE_VERSION);
+  writeValue(buffer, (bs::UINT32)mInternal->catalogs.size());
 
-  for (size_t i = 0; i < allStl.size(); i++)
+  for (const PackageCatalog& catalog : mInternal->catalogs)
   {
-    all[i] = allStl[i].c_str();
+    writeString(buffer, catalog.path);
+    writeValue(buffer, catalog.lastModifiedTime);
+    writeValue(buffer, catalog.fileSize);
+    writeValue(buffer, (bs::UINT32)catalog.entries.size());
 
-    // Internal file index will return the files in the casing they were stored in.
-    // To be consistent, convert them all to uppercase here.
-    bs::StringUtil::toUpperCase(all[i]);
+    for (const PackageCatalog::Entry& entry : catalog.entries)
+    {
+      writeString(buffer, entry.name);
+      writeValue(buffer, entry.offset);
+      writeValue(buffer, entry.size);
+    }
   }
 
-  return all;
+  bs::FileSystem::createDir(path.getParent());
+
+  bs::SPtr<bs::DataStream> stream = bs::FileSystem::createAndOpenFile(path);
+
+  if (!stream) return;
+
+  stream->write(buffer.data(), buffer.size());
+  stream->close();
+}
+
+VirtualFileSystem::IndexStats VirtualFileSystem::indexStats() const
+{
+  throwOnMissingInternalState();
+
+  return mInternal->indexStats;
+}
+
+bs::Vector<bs::String> VirtualFileSystem::listAllFiles()
+{
+  throwOnMissingInternalState();
+
+  bs::Lock lock(mInternal->mutex);
+
+  mInternal->buildListing();
+
+  return mInternal->allFilesUpperCase;
 }
 
 bs::Vector<bs::String> REGoth::VirtualFileSystem::listByExtension(const bs::String& ext)
 {
-  bs::Vector<bs::String> allFilesUpperCase = listAllFiles();
+  throwOnMissingInternalState();
 
   // Convert extension to UPPERCASE since all files returned by listAllFiles() are also
   // uppercase. That way, we make the extension-parameter case insensitive.
   bs::String extUpper = ext;
   bs::StringUtil::toUpperCase(extUpper);
 
+  bs::Lock lock(mInternal->mutex);
+
+  mInternal->buildListing();
+
+  // Files are grouped by what follows their last dot, which covers all simple extensions
+  if (!extUpper.empty() && extUpper[0] == '.' && extUpper.find('.', 1) == bs::String::npos)
+  {
+    auto it = mInternal->filesByExtension.find(extUpper);
+
+    if (it == mInternal->filesByExtension.end()) return {};
+
+    return it->second;
+  }
+
+  const bs::Vector<bs::String>& allFilesUpperCase = mInternal->allFilesUpperCase;
+
   enum
   {
     RespectCase = false,
@@ -130,25 +823,41 @@ bs::Vector<bs::String> REGoth::VirtualFileSystem::listByExtension(const bs::Stri
 }
 
 bs::Vector<bs::UINT8> VirtualFileSystem::readFile(const bs::String& file) const
+{
+  FileView view = readFileView(file);
+
+  return bs::Vector<bs::UINT8>(view.begin(), view.end());
+}
+
+FileView VirtualFileSystem::readFileView(const bs::String& file) const
 {
   throwOnMissingInternalState();
 
-  if (!mInternal->isFinalized)
-  {
-    mInternal->finalizeFileIndex();
-  }
+  mInternal->finalizeFileIndex();
 
   if (!mInternal->isReadyToReadFiles())
   {
     REGOTH_THROW(InvalidStateException, "VDFS is not ready to read files yet.");
   }
 
-  std::vector<uint8_t> stlData;
+  if (!mInternal->fileIndex.hasFile(file.c_str()))
+  {
+    return {};
+  }
+
+  FileView view;
 
-  mInternal->fileIndex.getFileData(file.c_str(), stlData);
+  if (mInternal->tryReadDirectly(file, view))
+  {
+    return view;
+  }
+
+  // Let the view own the buffer, so it doesn't need to be copied again
+  auto buffer = bs::bs_shared_ptr_new<std::vector<uint8_t>>();
 
-  // FIXME: Need some other way to get the file data so we don't have to copy the data here
-  return bs::Vector<bs::UINT8>(stlData.begin(), stlData.end());
+  mInternal->fileIndex.getFileData(file.c_str(), *buffer);
+
+  return FileView(buffer, buffer->data(), buffer->size());
 }
 
 bool REGoth::VirtualFileSystem::hasFile(const bs::String& file) const
@@ -162,6 +871,27 @@ bool REGoth::VirtualFileSystem::hasFile(const bs::String& file) const
   return mInternal->fileIndex.hasFile(file.c_str());
 }
 
+bs::UINT64 REGoth::VirtualFileSystem::fileSize(const bs::String& file) const
+{
+  throwOnMissingInternalState();
+
+  bs::String upper = file;
+  bs::StringUtil::toUpperCase(upper);
+
+  auto it = mInternal->sources.find(upper);
+
+  if (it == mInternal->sources.end()) return 0;
+
+  const FileSource& source = it->second;
+
+  if (source.package == NO_PACKAGE)
+  {
+    return bs::FileSystem::getFileSize(source.path);
+  }
+
+  return source.size;
+}
+
 void REGoth::VirtualFileSystem::throwIfFileIsMissing(const bs::String& file,
                                                      const bs::String& message) const
 {
@@ -191,10 +921,7 @@ const VDFS::FileIndex& VirtualFileSystem::getFileIndex()
 {
   throwOnMissingInternalState();
 
-  if (!mInternal->isFinalized)
-  {
-    mInternal->finalizeFileIndex();
-  }
+  mInternal->finalizeFileIndex();
 
   return mInternal->fileIndex;
 }
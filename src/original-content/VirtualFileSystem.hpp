@@ -31,6 +31,10 @@
  * the FileIndex REGoth uses acts on one global file index, which saves us from
  * passing the FileIndex-object to everything.
  *
+ * Reading files is done without copying their data where possible: Files stored inside
+ * packages are not compressed, so the packages are mapped into memory and handed out
+ * as FileView pointing right into the mapping. See readFileView().
+ *
  */
 
 #pragma once
@@ -45,6 +49,58 @@ namespace VDFS
 
 namespace REGoth
 {
+  /**
+   * Read-only view of the data of a file inside the VDFS, see VirtualFileSystem::readFileView().
+   *
+   * The data is kept alive for as long as any copy of the view exists. Copying a view is
+   * cheap, as it does not copy the data.
+   */
+  class FileView
+  {
+  public:
+    FileView() = default;
+
+    /**
+     * @param  owner  Keeps the memory `data` points to alive.
+     */
+    FileView(bs::SPtr<const void> owner, const bs::UINT8* data, size_t size)
+        : mOwner(std::move(owner))
+        , mData(data)
+        , mSize(size)
+    {
+    }
+
+    const bs::UINT8* data() const
+    {
+      return mData;
+    }
+
+    size_t size() const
+    {
+      return mSize;
+    }
+
+    bool empty() const
+    {
+      return mSize == 0;
+    }
+
+    const bs::UINT8* begin() const
+    {
+      return mData;
+    }
+
+    const bs::UINT8* end() const
+    {
+      return mData + mSize;
+    }
+
+  private:
+    bs::SPtr<const void> mOwner;
+    const bs::UINT8* mData = nullptr;
+    size_t mSize           = 0;
+  };
+
   class InternalVirtualFileSystem;
   class VirtualFileSystem
   {
@@ -90,11 +146,61 @@ namespace REGoth
      */
     void mountDirectory(const bs::Path& path);
 
+    /**
+     * How the packages were indexed, see loadIndexCache().
+     */
+    struct IndexStats
+    {
+      bs::UINT32 numPackagesFromCache = 0;
+      bs::UINT32 numPackagesIndexed   = 0;
+
+      /**
+       * Time spent in ZenLib mounting the packages, which the index cache can't shorten.
+       */
+      bs::UINT64 mountMicroseconds = 0;
+
+      /**
+       * Time spent building REGoth's own index of the packages, from the cache or not.
+       */
+      bs::UINT64 indexMicroseconds = 0;
+    };
+
+    /**
+     * Loads the list of files inside each package saved by saveIndexCache() in an earlier run.
+     *
+     * Packages loaded afterwards, whose size and modification time have not changed since,
+     * take their list of files from there instead of reading it out of the package. Must be
+     * called before loading any packages.
+     *
+     * This only covers REGoth's own index, which the file views and listings are built on.
+     * ZenLib still mounts every package and reads its catalog, as it offers no way to restore
+     * its index from elsewhere.
+     *
+     * @param  path  File the index cache was saved to.
+     *
+     * @return Whether the cache could be loaded. If not, packages are indexed as usual.
+     */
+    bool loadIndexCache(const bs::Path& path);
+
+    /**
+     * Saves the list of files inside each package loaded so far, see loadIndexCache().
+     * Does nothing if the loaded cache matched all packages.
+     *
+     * @param  path  File to save the index cache to, will be overwritten.
+     */
+    void saveIndexCache(const bs::Path& path) const;
+
+    /**
+     * @return How many packages were indexed and how many taken from the index cache.
+     */
+    IndexStats indexStats() const;
+
     /**
      * Returns a list of all files known to the index.
      *
      * This will go through all packages and assemble a list containing all
-     * known files names which one could read using readFile().
+     * known files names which one could read using readFile(). The list is only
+     * assembled once, until more packages are loaded.
      *
      * @return Names of all files known to the index, all UPPERCASE.
      */
@@ -103,6 +209,8 @@ namespace REGoth
     /**
      * Returns a list of files with the given file extension.
      *
+     * Files are indexed by extension along with listAllFiles(), so this is a lookup.
+     *
      * @param  ext  File extension to look for, with leading dot. E.g. `.3DS`,
      *              case insensitive.
      *
@@ -114,6 +222,8 @@ namespace REGoth
     /**
      * Reads the contents of a file and returns them as byte array.
      *
+     * This copies the data once, prefer readFileView() if a copy is not needed.
+     *
      * To load a package, which contains files, see loadPackage().
      *
      * @note   Check with hasFile() whether the file exists within the file index.
@@ -125,6 +235,22 @@ namespace REGoth
      */
     bs::Vector<bs::UINT8> readFile(const bs::String& file) const;
 
+    /**
+     * Like readFile(), but without copying the data if possible.
+     *
+     * Files only found in a single package or the mounted directory are read straight from
+     * a memory mapping of their package or of the file itself. Files which exist multiple
+     * times are read through the file index, which knows which one wins, into a buffer
+     * owned by the view.
+     *
+     * Safe to call from multiple threads once the file index has been finalized.
+     *
+     * @param  file  Case-insensitive name of the file, see readFile().
+     *
+     * @return View of the complete data of the given file. Empty if the file does not exist.
+     */
+    FileView readFileView(const bs::String& file) const;
+
     /**
      * Searches through the file index to see if the given file has been registered
      * inside the file index.
@@ -138,6 +264,16 @@ namespace REGoth
      */
     bool hasFile(const bs::String& file) const;
 
+    /**
+     * Looks up the size of a file without reading it.
+     *
+     * @param  file  Case-insensitive name of the file, see readFile().
+     *
+     * @return Size of the file in bytes. 0 if the file does not exist or its size is not
+     *         known without reading it.
+     */
+    bs::UINT64 fileSize(const bs::String& file) const;
+
     /**
      * Throws if the given file is missing in the file index.
      *
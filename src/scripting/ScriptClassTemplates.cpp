@@ -21,53 +21,71 @@ namespace REGoth
 
         auto members = Queries::findAllWithParentOf(scriptSymbols, parent);
 
-        ScriptObject classTemplate = createClassTemplate(classSymbol.name, members, scriptSymbols);
+        ScriptObject classTemplate = createClassTemplate(classSymbol, members, scriptSymbols);
 
         mClassTemplates[classSymbol.name] = classTemplate;
       }
     }
 
-    ScriptObject ScriptClassTemplates::createClassTemplate(const bs::String& className,
+    ScriptObject ScriptClassTemplates::createClassTemplate(const SymbolClass& classSymbol,
                                                            const bs::Vector<SymbolIndex>& members,
                                                            const ScriptSymbolStorage& scriptSymbols)
     {
       ScriptObject obj;
-      obj.className = className;
+      obj.className = classSymbol.name;
+
+      auto layout         = bs::bs_shared_ptr_new<ScriptClassLayout>();
+      layout->classSymbol = classSymbol.index;
 
       for (SymbolIndex memberSymbolIndex : members)
       {
         SymbolBase& memberSymbol = scriptSymbols.getSymbolBase(memberSymbolIndex);
         bs::String name          = demangleMemberName(memberSymbol.name);
+        MemberSlot slot          = memberSymbol.memberSlot;
+
+        if (slot == MEMBER_SLOT_INVALID)
+        {
+          REGOTH_THROW(InvalidStateException,
+                       "Member symbol " + memberSymbol.name + " has no slot assigned");
+        }
 
         if (memberSymbol.type == SymbolType::Int)
         {
           auto num = ((SymbolInt&)memberSymbol).ints.size();
 
-          obj.ints[name].resize(num, 0);
+          if (slot >= obj.ints.size()) obj.ints.resize(slot + 1);
+          obj.ints[slot].resize(num, 0);
         }
         else if (memberSymbol.type == SymbolType::Float)
         {
           auto num = ((SymbolFloat&)memberSymbol).floats.size();
 
-          obj.floats[name].resize(num, 0.0f);
+          if (slot >= obj.floats.size()) obj.floats.resize(slot + 1);
+          obj.floats[slot].resize(num, 0.0f);
         }
         else if (memberSymbol.type == SymbolType::String)
         {
           auto num = ((SymbolString&)memberSymbol).strings.size();
 
-          obj.strings[name].resize(num, "");
+          if (slot >= obj.strings.size()) obj.strings.resize(slot + 1);
+          obj.strings[slot].resize(num, "");
         }
         else if (memberSymbol.type == SymbolType::ScriptFunction)
         {
-          obj.functionPointers[name] = 0;
+          if (slot >= obj.functionPointers.size()) obj.functionPointers.resize(slot + 1);
+          obj.functionPointers[slot] = 0;
         }
         else
         {
           REGOTH_THROW(InvalidParametersException,
                        "Unexpected member symbol type: " + symbolTypeToString(memberSymbol.type));
         }
+
+        layout->membersByName[name] = ScriptClassLayout::Member{memberSymbol.type, slot};
       }
 
+      obj.layout = layout;
+
       return obj;
     }
 
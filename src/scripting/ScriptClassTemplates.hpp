@@ -29,14 +29,16 @@ namespace REGoth
      *
      * # What exactly is a class template?
      *
-     * Our script objects are basically simple key/value-pairs. With a key for each
-     * member variable. The blank script object would have not one single key, but
+     * Our script objects are basically simple arrays with a slot for each member
+     * variable. The blank script object would have not one single slot, but
      * other code will expect an instance of a class to provide all member variables
      * of that class!
      *
      * To be able to provide script objects which look like they were created from
      * a certain class, we gather all member variables of that class and create
-     * keys for them in a script object (With default values). That script object
+     * slots for them in a script object (With default values). The slot of each member
+     * variable has already been decided when loading the symbols, so the VM can access
+     * members without looking at their names. That script object
      * will be then used as a template: When someone wants to instanciate a class
      * the template is copied to the new script object.
      */
@@ -67,8 +69,12 @@ namespace REGoth
     private:
       /**
        * Creates a single script class template. See createClassTemplates().
+       *
+       * The member variables are placed at the slots already assigned to their symbols,
+       * see SymbolBase::memberSlot. The created template also carries the layout shared
+       * by all objects of that class.
        */
-      ScriptObject createClassTemplate(const bs::String& className,
+      ScriptObject createClassTemplate(const SymbolClass& classSymbol,
                                        const bs::Vector<SymbolIndex>& members,
                                        const ScriptSymbolStorage& scriptSymbols);
 
@@ -10,50 +10,56 @@ namespace REGoth
     {
       REGOTH_LOG(Info, Uncategorized, "Dumping object of class: {0}", object.className);
 
-      for (const auto& ints : object.ints)
+      if (!object.layout)
       {
-        const auto& values = ints.second;
-
-        bs::String line;
-        for (const auto& v : values)
-        {
-          line += bs::toString(v) + " ";
-        }
-
-        REGOTH_LOG(Info, Uncategorized, " - {0} : {1} = {2}", ints.first, "int", line);
+        REGOTH_LOG(Info, Uncategorized, "");
+        return;
       }
 
-      for (const auto& floats : object.floats)
+      for (const auto& member : object.layout->membersByName)
       {
-        const auto& values = floats.second;
+        const bs::String& name = member.first;
+        MemberSlot slot        = member.second.slot;
 
         bs::String line;
-        for (const auto& v : values)
+
+        switch (member.second.type)
         {
-          line += bs::toString(v) + " ";
-        }
+          case SymbolType::Int:
+            for (const auto& v : object.ints[slot])
+            {
+              line += bs::toString(v) + " ";
+            }
 
-        REGOTH_LOG(Info, Uncategorized, " - {0} : {1} = {2}", floats.first, "int", line);
-      }
+            REGOTH_LOG(Info, Uncategorized, " - {0} : {1} = {2}", name, "int", line);
+            break;
 
-      for (const auto& strings : object.strings)
-      {
-        const auto& values = strings.second;
+          case SymbolType::Float:
+            for (const auto& v : object.floats[slot])
+            {
+              line += bs::toString(v) + " ";
+            }
 
-        bs::String line;
-        for (const auto& v : values)
-        {
-          line += "'" + v + "' ";
-        }
+            REGOTH_LOG(Info, Uncategorized, " - {0} : {1} = {2}", name, "float", line);
+            break;
 
-        REGOTH_LOG(Info, Uncategorized, " - {0} : {1} = {2}", strings.first, "string", line);
-      }
+          case SymbolType::String:
+            for (const auto& v : object.strings[slot])
+            {
+              line += "'" + v + "' ";
+            }
 
-      for (const auto& ints : object.functionPointers)
-      {
-        const auto& value = ints.second;
+            REGOTH_LOG(Info, Uncategorized, " - {0} : {1} = {2}", name, "string", line);
+            break;
 
-        REGOTH_LOG(Info, Uncategorized, " - {0} : {1} = {2}", ints.first, "function", value);
+          case SymbolType::ScriptFunction:
+            REGOTH_LOG(Info, Uncategorized, " - {0} : {1} = {2}", name, "function",
+                       object.functionPointers[slot]);
+            break;
+
+          default:
+            break;
+        }
       }
 
       REGOTH_LOG(Info, Uncategorized, "");
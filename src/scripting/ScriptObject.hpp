@@ -9,7 +9,46 @@ namespace REGoth
   namespace Scripting
   {
     /**
-     * General script object, storing key/value pairs of different types.
+     * Describes where the member variables of a script class are stored inside the
+     * script objects of that class. Shared by all objects of the same class.
+     *
+     * See ScriptClassTemplates for how this is created.
+     */
+    struct ScriptClassLayout
+    {
+      struct Member
+      {
+        SymbolType type;
+        MemberSlot slot;
+      };
+
+      /**
+       * Symbol of the script class, e.g. `C_ITEM`.
+       */
+      SymbolIndex classSymbol = SYMBOL_INDEX_INVALID;
+
+      /**
+       * Slots of all member variables by their name without the class prefix, e.g.
+       * `VALUE` instead of `C_ITEM.VALUE`.
+       */
+      bs::Map<bs::String, Member> membersByName;
+
+      /**
+       * @return The member with the given name and type. nullptr, if there is none.
+       */
+      const Member* findMember(const bs::String& name, SymbolType type) const
+      {
+        auto it = membersByName.find(name);
+
+        if (it == membersByName.end()) return nullptr;
+        if (it->second.type != type) return nullptr;
+
+        return &it->second;
+      }
+    };
+
+    /**
+     * General script object, storing the member variables of a script class.
      */
     struct ScriptObject : public bs::IReflectable
     {
@@ -30,38 +69,53 @@ namespace REGoth
       ScriptObjectHandle handle;
 
       /**
-       * Data storage mapping. Each of these holds a key/value pair to describe the
-       * member variables of the object like in this example:
+       * Layout of the script class this object represents. Maps member variable names
+       * to their slots in the storage below.
+       */
+      bs::SPtr<const ScriptClassLayout> layout;
+
+      /**
+       * Data storage of the member variables, indexed by their slots. Each type has its
+       * own slots, so for this example
        *
        *     int healh;
        *     int attributes[50];
        *     string name;
        *
-       * Note that there are save access methods below.
+       * `ints` would have two entries with `health` at slot 0 and `attributes` at slot 1,
+       * while `strings` would only have one entry for `name`.
+       *
+       * The slot of a member variable is stored inside its symbol, see SymbolBase::memberSlot.
+       * Note that there are save access methods by name below.
+       */
+      bs::Vector<ScriptInts> ints;
+      bs::Vector<ScriptFloats> floats;
+      bs::Vector<ScriptStrings> strings;
+      bs::Vector<bs::UINT32> functionPointers;
+
+      /**
+       * Member variables by their name, as saves from before the member slots store them.
+       * Only filled while loading such a save, until ScriptVM::recreateClassTemplates() has
+       * moved them into their slots.
        */
-      bs::Map<bs::String, ScriptInts> ints;
-      bs::Map<bs::String, ScriptFloats> floats;
-      bs::Map<bs::String, ScriptStrings> strings;
-      bs::Map<bs::String, bs::UINT32> functionPointers;
+      bs::Map<bs::String, ScriptInts> legacyInts;
+      bs::Map<bs::String, ScriptFloats> legacyFloats;
+      bs::Map<bs::String, ScriptStrings> legacyStrings;
+      bs::Map<bs::String, bs::UINT32> legacyFunctionPointers;
 
       /**
        * Save access to a string value. Throws if the value does not exist.
        */
       bs::String& stringValue(const bs::String& name, bs::UINT32 arrayIndex = 0)
       {
-        auto it = strings.find(name);
+        ScriptStrings& values = strings[findMemberSlot(name, SymbolType::String, "String")];
 
-        if (it == strings.end())
-        {
-          throwVariableDoesNotExist(name, "String");
-        }
-
-        if (arrayIndex >= it->second.size())
+        if (arrayIndex >= values.size())
         {
           throwArrayOutOfRange(name, "String", arrayIndex);
         }
 
-        return it->second[arrayIndex];
+        return values[arrayIndex];
       }
 
       /**
@@ -69,19 +123,14 @@ namespace REGoth
        */
       float& floatValue(const bs::String& name, bs::UINT32 arrayIndex = 0)
       {
-        auto it = floats.find(name);
-
-        if (it == floats.end())
-        {
-          throwVariableDoesNotExist(name, "Float");
-        }
+        ScriptFloats& values = floats[findMemberSlot(name, SymbolType::Float, "Float")];
 
-        if (arrayIndex >= it->second.size())
+        if (arrayIndex >= values.size())
         {
           throwArrayOutOfRange(name, "Float", arrayIndex);
         }
 
-        return it->second[arrayIndex];
+        return values[arrayIndex];
       }
 
       /**
@@ -89,19 +138,14 @@ namespace REGoth
        */
       bs::INT32& intValue(const bs::String& name, bs::UINT32 arrayIndex = 0)
       {
-        auto it = ints.find(name);
+        ScriptInts& values = ints[findMemberSlot(name, SymbolType::Int, "Int")];
 
-        if (it == ints.end())
-        {
-          throwVariableDoesNotExist(name, "Int");
-        }
-
-        if (arrayIndex >= it->second.size())
+        if (arrayIndex >= values.size())
         {
           throwArrayOutOfRange(name, "Int", arrayIndex);
         }
 
-        return it->second[arrayIndex];
+        return values[arrayIndex];
       }
 
       /**
@@ -109,14 +153,25 @@ namespace REGoth
        */
       bs::UINT32& functionPointerValue(const bs::String& name)
       {
-        auto it = functionPointers.find(name);
+        return functionPointers[findMemberSlot(name, SymbolType::ScriptFunction, "Int")];
+      }
+
+      /**
+       * Looks up the slot of the member variable with the given name and type.
+       *
+       * Throws if there is no such member.
+       */
+      MemberSlot findMemberSlot(const bs::String& name, SymbolType type,
+                                const bs::String& typeName)
+      {
+        const ScriptClassLayout::Member* member = layout ? layout->findMember(name, type) : nullptr;
 
-        if (it == functionPointers.end())
+        if (!member)
         {
-          throwVariableDoesNotExist(name, "Int");
+          throwVariableDoesNotExist(name, typeName);
         }
 
-        return it->second;
+        return member->slot;
       }
 
       void throwVariableDoesNotExist(const bs::String& name, const bs::String& type)
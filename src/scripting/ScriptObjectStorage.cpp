@@ -5,15 +5,18 @@ namespace REGoth
 {
   namespace Scripting
   {
+    ScriptObjectStorage::ScriptObjectStorage()
+    {
+      clear();
+    }
+
     ScriptObjectStorage::~ScriptObjectStorage()
     {
     }
 
     bool ScriptObjectStorage::isDestroyed(ScriptObjectHandle handle) const
     {
-      if (handle == SCRIPT_OBJECT_HANDLE_INVALID) return true;
-
-      return mObjects.find(handle) == mObjects.end();
+      return findAliveSlot(handle) == nullptr;
     }
 
     bool ScriptObjectStorage::isValid(ScriptObjectHandle handle) const
@@ -23,30 +26,46 @@ namespace REGoth
 
     ScriptObject& ScriptObjectStorage::create()
     {
-      ScriptObject object;
-      object.handle = mNextHandle;
-      mNextHandle += 1;
+      bs::UINT32 index;
 
-      if (object.handle > mNextHandle)
+      if (!mFreeSlots.empty())
       {
-        REGOTH_THROW(InvalidStateException, "Script Object Handle overflow");
+        index = mFreeSlots.back();
+        mFreeSlots.pop_back();
       }
+      else
+      {
+        if (mNumSlots > HANDLE_INDEX_MASK)
+        {
+          REGOTH_THROW(InvalidStateException, "Script Object Handle overflow");
+        }
 
-      invalidateCache();
+        index = mNumSlots;
+        growToNumSlots(mNumSlots + 1);
+      }
 
-      return mObjects.insert({object.handle, std::move(object)}).first->second;
+      return occupySlot(index);
     }
 
     void ScriptObjectStorage::destroy(ScriptObjectHandle scriptObjectHandle)
     {
-      if (isDestroyed(scriptObjectHandle))
+      Slot* slot = findAliveSlot(scriptObjectHandle);
+
+      if (!slot)
       {
         REGOTH_THROW(InvalidStateException, "Script Object was destroyed already!");
       }
 
-      mObjects.erase(scriptObjectHandle);
+      slot->object  = ScriptObject();
+      slot->isAlive = false;
+      slot->generation += 1;
 
-      invalidateCache();
+      // Once a slot has gone through all generations it is retired for good, since
+      // reusing it would make old handles valid again.
+      if (slot->generation != MAX_GENERATION)
+      {
+        mFreeSlots.push_back(handleIndex(scriptObjectHandle));
+      }
     }
 
     ScriptObject& ScriptObjectStorage::get(ScriptObjectHandle handle)
@@ -56,69 +75,101 @@ namespace REGoth
         REGOTH_THROW(InvalidStateException, "Script Object Handle is invalid!");
       }
 
-      ScriptObject* pCached = findHandleInCache(handle);
+      Slot* slot = findAliveSlot(handle);
 
-      if (pCached)
+      if (!slot)
       {
-        return *pCached;
+        REGOTH_THROW(InvalidStateException, "Script Object Handle does reference a known object!");
       }
-      else
+
+      return slot->object;
+    }
+
+    bs::Vector<ScriptObjectHandle> ScriptObjectStorage::allHandles() const
+    {
+      bs::Vector<ScriptObjectHandle> handles;
+      handles.reserve(mNumSlots - mFreeSlots.size());
+
+      for (bs::UINT32 i = 0; i < mNumSlots; i++)
       {
-        auto it = mObjects.find(handle);
+        const Slot& slot = slotAt(i);
 
-        if (it == mObjects.end())
+        if (slot.isAlive)
         {
-          REGOTH_THROW(InvalidStateException, "Script Object Handle does reference a known object!");
+          handles.push_back(makeHandle(i, slot.generation));
         }
-
-        addObjectToCache(handle, it->second);
-
-        return it->second;
       }
+
+      return handles;
     }
 
     void ScriptObjectStorage::clear()
     {
-      mObjects.clear();
-      mNextHandle = 1;
+      mChunks.clear();
+      mFreeSlots.clear();
+      mNumSlots = 0;
 
-      invalidateCache();
+      // Slot 0 is never handed out, see mChunks
+      growToNumSlots(1);
     }
 
-    ScriptObject* ScriptObjectStorage::findHandleInCache(ScriptObjectHandle handle) const
+    ScriptObjectStorage::Slot* ScriptObjectStorage::findAliveSlot(ScriptObjectHandle handle)
     {
-      for (bs::UINT32 i = 0; i < ACCESS_CACHE_SIZE; i++)
-      {
-        if (mAccessCachedHandles[i] == handle)
-        {
-          return mAccessCachedObjects[i];
-        }
-      }
+      const ScriptObjectStorage* constThis = this;
 
-      return nullptr;
+      return const_cast<Slot*>(constThis->findAliveSlot(handle));
     }
 
-    void ScriptObjectStorage::addObjectToCache(ScriptObjectHandle handle, ScriptObject& object)
+    const ScriptObjectStorage::Slot* ScriptObjectStorage::findAliveSlot(
+        ScriptObjectHandle handle) const
     {
-      mAccessCachedHandles[mCachePosition] = handle;
-      mAccessCachedObjects[mCachePosition] = &object;
+      bs::UINT32 index = handleIndex(handle);
+
+      if (index >= mNumSlots) return nullptr;
 
-      mCachePosition = (mCachePosition + 1) % ACCESS_CACHE_SIZE;
+      const Slot& slot = slotAt(index);
+
+      if (!slot.isAlive) return nullptr;
+      if (slot.generation != handleGeneration(handle)) return nullptr;
+
+      return &slot;
     }
 
-    void ScriptObjectStorage::invalidateCache()
+    void ScriptObjectStorage::growToNumSlots(bs::UINT32 numSlots)
     {
-      for (auto& h : mAccessCachedHandles)
+      while (mChunks.size() * SLOTS_PER_CHUNK < numSlots)
       {
-        h = SCRIPT_OBJECT_HANDLE_INVALID;
+        mChunks.emplace_back(SLOTS_PER_CHUNK);
       }
 
-      for (auto& p : mAccessCachedObjects)
+      mNumSlots = std::max(mNumSlots, numSlots);
+    }
+
+    ScriptObject& ScriptObjectStorage::occupySlot(bs::UINT32 index)
+    {
+      Slot& slot = slotAt(index);
+
+      slot.object        = ScriptObject();
+      slot.object.handle = makeHandle(index, slot.generation);
+      slot.isAlive       = true;
+
+      return slot.object;
+    }
+
+    void ScriptObjectStorage::rebuildFreeSlots()
+    {
+      mFreeSlots.clear();
+
+      // Walk backwards so the lowest indices are reused first
+      for (bs::UINT32 i = mNumSlots - 1; i > 0; i--)
       {
-        p = nullptr;
-      }
+        const Slot& slot = slotAt(i);
 
-      mCachePosition = 0;
+        if (!slot.isAlive && slot.generation != MAX_GENERATION)
+        {
+          mFreeSlots.push_back(i);
+        }
+      }
     }
 
     REGOTH_DEFINE_RTTI(ScriptObjectStorage)
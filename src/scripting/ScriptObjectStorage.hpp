@@ -13,14 +13,20 @@ namespace REGoth
      * Note that you should always access the storage using a handle. Do not save the
      * reference to the actual data somewhere for later use!
      *
-     * The handles used here are just a ever increasing number into a map. Deleted
-     * script objects will be taken out of the map, but all other handles will
-     * remain intact.
+     * The objects are stored inside a slot map: A handle is made of the index of the
+     * slot the object lives in and the *generation* of that slot. The generation is
+     * increased every time an object is destroyed, so handles to destroyed objects
+     * can never reference an object created later in the same slot. That way, both
+     * looking up an object and checking whether a handle is still valid is a simple
+     * array access.
+     *
+     * Slots are allocated in chunks which are never moved, so references returned
+     * by `get()` stay valid while other objects are created or destroyed.
      */
     class ScriptObjectStorage : public bs::IReflectable
     {
     public:
-      ScriptObjectStorage() = default;
+      ScriptObjectStorage();
       virtual ~ScriptObjectStorage();
 
       /**
@@ -56,59 +62,101 @@ namespace REGoth
       ScriptObject& get(ScriptObjectHandle handle);
 
       /**
-       * Removes all script objects created so far and resets the handle counter.
+       * @return Handles of all script objects currently alive.
+       */
+      bs::Vector<ScriptObjectHandle> allHandles() const;
+
+      /**
+       * Removes all script objects created so far and resets all slots.
        * All existing handles are to be seen as invalidated after this operation.
        */
       void clear();
 
     private:
-      bs::Map<ScriptObjectHandle, ScriptObject> mObjects;
-      ScriptObjectHandle mNextHandle = 1;
+      /**
+       * Number of lower bits of a handle used for the slot index. The remaining
+       * bits hold the generation of the slot.
+       */
+      static constexpr bs::UINT32 HANDLE_INDEX_BITS = 20;
+      static constexpr bs::UINT32 HANDLE_INDEX_MASK = (1 << HANDLE_INDEX_BITS) - 1;
+      static constexpr bs::UINT32 MAX_GENERATION    = 0xFFFFFFFF >> HANDLE_INDEX_BITS;
 
       /**
-       * Checks whether the script object behind the given handle is cached.
-       * If so, a pointer to that object is returned. If it was not cached,
-       * nullptr is returned.
+       * Number of slots allocated at once. Must be a power of two.
        */
-      ScriptObject* findHandleInCache(ScriptObjectHandle handle) const;
+      static constexpr bs::UINT32 SLOTS_PER_CHUNK = 256;
+
+      struct Slot
+      {
+        ScriptObject object;
+        bs::UINT32 generation = 0;
+        bool isAlive          = false;
+      };
+
+      static ScriptObjectHandle makeHandle(bs::UINT32 index, bs::UINT32 generation)
+      {
+        return (generation << HANDLE_INDEX_BITS) | index;
+      }
+
+      static bs::UINT32 handleIndex(ScriptObjectHandle handle)
+      {
+        return handle & HANDLE_INDEX_MASK;
+      }
+
+      static bs::UINT32 handleGeneration(ScriptObjectHandle handle)
+      {
+        return handle >> HANDLE_INDEX_BITS;
+      }
+
+      Slot& slotAt(bs::UINT32 index)
+      {
+        return mChunks[index / SLOTS_PER_CHUNK][index % SLOTS_PER_CHUNK];
+      }
+
+      const Slot& slotAt(bs::UINT32 index) const
+      {
+        return mChunks[index / SLOTS_PER_CHUNK][index % SLOTS_PER_CHUNK];
+      }
 
       /**
-       * Adds the given object to the cache. The oldest object inside the
-       * cache will be overridden.
+       * @return The slot referenced by the given handle or nullptr, if the handle
+       *         does not reference an object alive.
        */
-      void addObjectToCache(ScriptObjectHandle handle, ScriptObject& object);
+      Slot* findAliveSlot(ScriptObjectHandle handle);
+      const Slot* findAliveSlot(ScriptObjectHandle handle) const;
 
       /**
-       * Invalidates the cache and resets it to default, leaving it completely empty.
+       * Makes sure there are at least as many slots as given. New slots are dead.
        */
-      void invalidateCache();
+      void growToNumSlots(bs::UINT32 numSlots);
 
       /**
-       * Cache for accessing script objects via handle. Since the objects are
-       * stored within a bs::Map, access to them is rather slow. To speed up
-       * accessing of the same objects over and over again, the last few
-       * objects are cached here.
-       *
-       * The cache is implemented using two std::arrays, so the data they hold
-       * is local to the class and can be accessed without an indirection.
-       *
-       * There are two arrays: The cached handles and pointers to actual
-       * objects. Both arrays index the same way: Index i in one array belongs
-       * to index i in the other one.
-       *
-       * When a new object is supposed to be cached, the oldest entry is overwritten.
-       *
-       * Since it's not required for the bs::Map to keep all objects at the
-       * same addresses, the cache is cleaned once the object map is updated.
-       * However, most implementations should leave the data where it is, so
-       * we might be able to keep the cache on those implementations of bs::Map.
-       * If we ever do that, we only have to take care of invalidating the cache
-       * when removing objects.
-       */
-      static constexpr bs::UINT32 ACCESS_CACHE_SIZE = 5;
-      std::array<ScriptObjectHandle, ACCESS_CACHE_SIZE> mAccessCachedHandles;
-      std::array<ScriptObject*, ACCESS_CACHE_SIZE> mAccessCachedObjects;
-      bs::UINT32 mCachePosition = 0;
+       * Makes the given slot alive with its current generation and returns the
+       * object stored in it.
+       */
+      ScriptObject& occupySlot(bs::UINT32 index);
+
+      /**
+       * Fills the list of free slots with all dead slots which can still be reused.
+       */
+      void rebuildFreeSlots();
+
+      /**
+       * Chunks of slots. The chunks themselves are never resized, so the objects
+       * stored in them never move. Slot 0 is never used so no handle can be equal
+       * to `SCRIPT_OBJECT_HANDLE_INVALID`.
+       */
+      bs::Vector<bs::Vector<Slot>> mChunks;
+
+      /**
+       * Number of slots in use so far, including slot 0.
+       */
+      bs::UINT32 mNumSlots = 1;
+
+      /**
+       * Indices of dead slots which can be reused by `create()`.
+       */
+      bs::Vector<bs::UINT32> mFreeSlots;
 
     public:
       REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(ScriptObjectStorage)
@@ -1,10 +1,295 @@
 #include "ScriptSymbolStorage.hpp"
 #include <RTTI/RTTI_ScriptSymbolStorage.hpp>
+#include <algorithm>
 
 namespace REGoth
 {
   namespace Scripting
   {
+    /**
+     * Hash table gets resized once it is more than half full, which keeps the
+     * probe sequences short.
+     */
+    static constexpr bs::UINT32 INITIAL_NAME_SLOTS = 1024;
+
+    ScriptSymbolStorage::ScriptSymbolStorage(const ScriptSymbolStorage& other)
+    {
+      *this = other;
+    }
+
+    ScriptSymbolStorage& ScriptSymbolStorage::operator=(const ScriptSymbolStorage& other)
+    {
+      if (this == &other) return *this;
+
+      mPools                      = other.mPools;
+      mNameSlots                  = other.mNameSlots;
+      mNumNames                   = other.mNumNames;
+      mFunctionsByAddress         = other.mFunctionsByAddress;
+      mIsFunctionsByAddressSorted = other.mIsFunctionsByAddressSorted;
+
+      mSymbols.resize(other.mSymbols.size());
+      relinkSymbols();
+
+      return *this;
+    }
+
+    SymbolIndex ScriptSymbolStorage::findFunctionByAddress(bs::UINT32 scriptAddress)
+    {
+      if (!mIsFunctionsByAddressSorted)
+      {
+        auto byAddress = [](const FunctionAddress& a, const FunctionAddress& b) {
+          return a.address < b.address;
+        };
+
+        std::stable_sort(mFunctionsByAddress.begin(), mFunctionsByAddress.end(), byAddress);
+
+        // Only keep the function registered last for each address
+        bs::Vector<FunctionAddress> unique;
+        unique.reserve(mFunctionsByAddress.size());
+
+        for (const FunctionAddress& f : mFunctionsByAddress)
+        {
+          if (!unique.empty() && unique.back().address == f.address)
+          {
+            unique.back() = f;
+          }
+          else
+          {
+            unique.push_back(f);
+          }
+        }
+
+        mFunctionsByAddress         = std::move(unique);
+        mIsFunctionsByAddressSorted = true;
+      }
+
+      auto it = std::lower_bound(
+          mFunctionsByAddress.begin(), mFunctionsByAddress.end(), scriptAddress,
+          [](const FunctionAddress& f, bs::UINT32 address) { return f.address < address; });
+
+      if (it == mFunctionsByAddress.end() || it->address != scriptAddress)
+      {
+        return SYMBOL_INDEX_INVALID;
+      }
+
+      return it->symbol;
+    }
+
+    void ScriptSymbolStorage::resolveClassMemberSlots()
+    {
+      // Number of member variables of each type found for a class so far
+      struct ClassMemberCount
+      {
+        MemberSlot ints             = 0;
+        MemberSlot floats           = 0;
+        MemberSlot strings          = 0;
+        MemberSlot functionPointers = 0;
+      };
+
+      auto isMemberOfClass = [&](const SymbolBase& s) {
+        if (!s.isClassVar) return false;
+        if (s.parent == SYMBOL_INDEX_INVALID) return false;
+
+        return getSymbolType(s.parent) == SymbolType::Class;
+      };
+
+      bs::UnorderedMap<SymbolIndex, ClassMemberCount> countsByClass;
+
+      for (SymbolIndex index : query(isMemberOfClass))
+      {
+        SymbolBase& member      = getSymbolBase(index);
+        ClassMemberCount& count = countsByClass[member.parent];
+
+        switch (member.type)
+        {
+          case SymbolType::Int:
+            member.memberSlot = count.ints++;
+            break;
+
+          case SymbolType::Float:
+            member.memberSlot = count.floats++;
+            break;
+
+          case SymbolType::String:
+            member.memberSlot = count.strings++;
+            break;
+
+          case SymbolType::ScriptFunction:
+            member.memberSlot = count.functionPointers++;
+            break;
+
+          default:
+            // Not storable inside a script object, ScriptClassTemplates will complain.
+            break;
+        }
+      }
+    }
+
+    SymbolIndex ScriptSymbolStorage::appendSymbolCopyOfType(const SymbolBase& symbol)
+    {
+      switch (symbol.type)
+      {
+        case SymbolType::Float:
+          return appendSymbolCopy((const SymbolFloat&)symbol, symbol.name);
+        case SymbolType::Int:
+          return appendSymbolCopy((const SymbolInt&)symbol, symbol.name);
+        case SymbolType::String:
+          return appendSymbolCopy((const SymbolString&)symbol, symbol.name);
+        case SymbolType::Class:
+          return appendSymbolCopy((const SymbolClass&)symbol, symbol.name);
+        case SymbolType::ScriptFunction:
+          return appendSymbolCopy((const SymbolScriptFunction&)symbol, symbol.name);
+        case SymbolType::ExternalFunction:
+          return appendSymbolCopy((const SymbolExternalFunction&)symbol, symbol.name);
+        case SymbolType::Prototype:
+          return appendSymbolCopy((const SymbolPrototype&)symbol, symbol.name);
+        case SymbolType::Instance:
+          return appendSymbolCopy((const SymbolInstance&)symbol, symbol.name);
+        case SymbolType::Unsupported:
+        default:
+          return appendSymbolCopy((const SymbolUnsupported&)symbol, symbol.name);
+      }
+    }
+
+    bs::SPtr<SymbolBase> ScriptSymbolStorage::makeSharedCopy(SymbolIndex index) const
+    {
+      const SymbolBase& symbol = getSymbolBase(index);
+
+      switch (symbol.type)
+      {
+        case SymbolType::Float:
+          return bs::bs_shared_ptr_new<SymbolFloat>((const SymbolFloat&)symbol);
+        case SymbolType::Int:
+          return bs::bs_shared_ptr_new<SymbolInt>((const SymbolInt&)symbol);
+        case SymbolType::String:
+          return bs::bs_shared_ptr_new<SymbolString>((const SymbolString&)symbol);
+        case SymbolType::Class:
+          return bs::bs_shared_ptr_new<SymbolClass>((const SymbolClass&)symbol);
+        case SymbolType::ScriptFunction:
+          return bs::bs_shared_ptr_new<SymbolScriptFunction>((const SymbolScriptFunction&)symbol);
+        case SymbolType::ExternalFunction:
+          return bs::bs_shared_ptr_new<SymbolExternalFunction>(
+              (const SymbolExternalFunction&)symbol);
+        case SymbolType::Prototype:
+          return bs::bs_shared_ptr_new<SymbolPrototype>((const SymbolPrototype&)symbol);
+        case SymbolType::Instance:
+          return bs::bs_shared_ptr_new<SymbolInstance>((const SymbolInstance&)symbol);
+        case SymbolType::Unsupported:
+        default:
+          return bs::bs_shared_ptr_new<SymbolUnsupported>((const SymbolUnsupported&)symbol);
+      }
+    }
+
+    bs::UINT32 ScriptSymbolStorage::hashName(const bs::String& name)
+    {
+      bs::UINT32 hash = 2166136261u;
+
+      for (char c : name)
+      {
+        hash ^= (bs::UINT8)c;
+        hash *= 16777619u;
+      }
+
+      return hash;
+    }
+
+    const ScriptSymbolStorage::NameSlot& ScriptSymbolStorage::findNameSlot(const bs::String& name,
+                                                                           bs::UINT32 hash) const
+    {
+      static const NameSlot EMPTY_SLOT;
+
+      if (mNameSlots.empty()) return EMPTY_SLOT;
+
+      bs::UINT32 mask = (bs::UINT32)mNameSlots.size() - 1;
+
+      // Linear probing. The table is never full, so this will always hit an empty slot.
+      for (bs::UINT32 i = hash & mask;; i = (i + 1) & mask)
+      {
+        const NameSlot& slot = mNameSlots[i];
+
+        if (slot.symbol == SYMBOL_INDEX_INVALID) return slot;
+
+        if (slot.hash == hash && mSymbols[slot.symbol]->name == name) return slot;
+      }
+    }
+
+    void ScriptSymbolStorage::insertName(SymbolIndex index)
+    {
+      if ((mNumNames + 1) * 2 > mNameSlots.size())
+      {
+        rehashNames(std::max(INITIAL_NAME_SLOTS, (bs::UINT32)mNameSlots.size() * 2));
+      }
+
+      const bs::String& name = mSymbols[index]->name;
+      bs::UINT32 hash        = hashName(name);
+
+      NameSlot& slot = const_cast<NameSlot&>(findNameSlot(name, hash));
+
+      if (slot.symbol == SYMBOL_INDEX_INVALID)
+      {
+        mNumNames += 1;
+      }
+
+      slot.hash   = hash;
+      slot.symbol = index;
+    }
+
+    void ScriptSymbolStorage::rehashNames(bs::UINT32 numSlots)
+    {
+      bs::Vector<NameSlot> oldSlots = std::move(mNameSlots);
+
+      mNameSlots.clear();
+      mNameSlots.resize(numSlots);
+
+      bs::UINT32 mask = numSlots - 1;
+
+      for (const NameSlot& old : oldSlots)
+      {
+        if (old.symbol == SYMBOL_INDEX_INVALID) continue;
+
+        bs::UINT32 i = old.hash & mask;
+
+        while (mNameSlots[i].symbol != SYMBOL_INDEX_INVALID)
+        {
+          i = (i + 1) & mask;
+        }
+
+        mNameSlots[i] = old;
+      }
+    }
+
+    void ScriptSymbolStorage::clear()
+    {
+      mPools = SymbolPools();
+      mSymbols.clear();
+      mNameSlots.clear();
+      mNumNames = 0;
+      mFunctionsByAddress.clear();
+      mIsFunctionsByAddressSorted = true;
+    }
+
+    void ScriptSymbolStorage::relinkSymbols()
+    {
+      auto relink = [&](auto& symbols) {
+        for (auto& s : symbols)
+        {
+          mSymbols[s.index] = &s;
+        }
+      };
+
+      static_assert(std::tuple_size<SymbolPools>::value == 9, "Relink all pools");
+
+      relink(std::get<0>(mPools));
+      relink(std::get<1>(mPools));
+      relink(std::get<2>(mPools));
+      relink(std::get<3>(mPools));
+      relink(std::get<4>(mPools));
+      relink(std::get<5>(mPools));
+      relink(std::get<6>(mPools));
+      relink(std::get<7>(mPools));
+      relink(std::get<8>(mPools));
+    }
+
     REGOTH_DEFINE_RTTI(ScriptSymbolStorage)
   }
 }  // namespace REGoth
@@ -2,6 +2,7 @@
 #include "ScriptSymbols.hpp"
 #include <BsPrerequisites.h>
 #include <RTTI/RTTIUtil.hpp>
+#include <tuple>
 
 namespace REGoth
 {
@@ -12,12 +13,37 @@ namespace REGoth
      *
      * This is the only place where symbols should created and have
      * their types and names be set.
+     *
+     * Symbols are stored inside one pool per symbol type, with a table of pointers
+     * to look them up by index. Note that appending a symbol can move all other symbols
+     * of the same type around, so references to symbols should only be kept once all
+     * symbols have been appended. Use reserveSymbols() to avoid the moves.
+     *
+     * Lookup by name is done via a hash table using open addressing over the names
+     * stored inside the symbols, so no name is stored twice. Names are compared as they
+     * are, which is UPPERCASE for everything coming out of a DAT-file.
      */
     class ScriptSymbolStorage : public bs::IReflectable
     {
     public:
       ScriptSymbolStorage() = default;
 
+      /**
+       * Copies need their own table of pointers into their own pools.
+       */
+      ScriptSymbolStorage(const ScriptSymbolStorage& other);
+      ScriptSymbolStorage& operator=(const ScriptSymbolStorage& other);
+
+      /**
+       * Makes room for the given number of symbols of the given type, so that appending
+       * that many symbols won't move the others around.
+       */
+      template <typename T>
+      void reserveSymbols(bs::UINT32 count)
+      {
+        pool<T>().reserve(count);
+      }
+
       /**
        * Appends a symbol of the given type to the storage.
        *
@@ -29,25 +55,7 @@ namespace REGoth
       template <typename T>
       SymbolIndex appendSymbol(const bs::String& name)
       {
-        bs::SPtr<SymbolBase> symbol = bs::bs_shared_ptr_new<T>();
-
-        mStorage.emplace_back(std::move(symbol));
-
-        SymbolIndex index = (SymbolIndex)(mStorage.size() - 1);
-
-        mStorage.back()->name  = name;
-        mStorage.back()->index = index;
-        mStorage.back()->type  = T::TYPE;
-
-        if (mStorage.size() >= SYMBOL_INDEX_MAX)
-        {
-          using namespace bs;
-          BS_EXCEPT(InvalidStateException, "Symbol Index limit reached!");
-        }
-
-        mSymbolsByName[name] = index;
-
-        return index;
+        return appendSymbolCopy(T(), name);
       }
 
       /**
@@ -87,6 +95,14 @@ namespace REGoth
         return getSymbolBase(index).name;
       }
 
+      /**
+       * @return Number of symbols inside the storage. Valid symbol indices are below this.
+       */
+      bs::UINT32 numSymbols() const
+      {
+        return (bs::UINT32)mSymbols.size();
+      }
+
       /**
        * Looks up the symbol at the given index.
        *
@@ -102,7 +118,7 @@ namespace REGoth
       T& getSymbol(SymbolIndex index) const
       {
         throwOnInvalidSymbol(index);
-        throwOnMismatchingType<T>(*mStorage[index]);
+        throwOnMismatchingType<T>(*mSymbols[index]);
 
         return getTypedSymbolReference<T>(index);
       }
@@ -123,7 +139,7 @@ namespace REGoth
       {
         SymbolIndex index = findIndexBySymbolName(name);
         throwOnInvalidSymbol(index);
-        throwOnMismatchingType<T>(*mStorage[index]);
+        throwOnMismatchingType<T>(*mSymbols[index]);
 
         return getTypedSymbolReference<T>(index);
       }
@@ -141,7 +157,7 @@ namespace REGoth
       {
         bs::Vector<SymbolIndex> result;
 
-        for (const auto& s : mStorage)
+        for (const SymbolBase* s : mSymbols)
         {
           if (addIf(*s))
           {
@@ -166,7 +182,7 @@ namespace REGoth
       {
         throwOnInvalidSymbol(index);
 
-        return mStorage[index]->type;
+        return mSymbols[index]->type;
       }
 
       /**
@@ -184,7 +200,7 @@ namespace REGoth
         SymbolIndex index = findIndexBySymbolName(name);
         throwOnInvalidSymbol(index);
 
-        return mStorage[index]->type;
+        return mSymbols[index]->type;
       }
 
       /**
@@ -192,7 +208,7 @@ namespace REGoth
        */
       bool hasSymbolWithName(const bs::String& name) const
       {
-        return mSymbolsByName.find(name) != mSymbolsByName.end();
+        return findNameSlot(name, hashName(name)).symbol != SYMBOL_INDEX_INVALID;
       }
 
       /**
@@ -206,52 +222,178 @@ namespace REGoth
        */
       SymbolIndex findIndexBySymbolName(const bs::String& name) const
       {
-        auto it = mSymbolsByName.find(name);
+        SymbolIndex index = findNameSlot(name, hashName(name)).symbol;
 
-        if (it == mSymbolsByName.end())
+        if (index == SYMBOL_INDEX_INVALID)
         {
           using namespace bs;
           BS_EXCEPT(InvalidStateException, "Symbol with name " + name + " does not exist!");
         }
 
-        return it->second;
+        return index;
       }
 
       /**
        * Registers a mapping of script address -> symbol index so we can get the script
        * Symbol from an address. This might not fit here, since the symbol storage doesn't
        * know the types of the other symbols, but this seems to be the best place...
+       *
+       * Only actual functions are registered. Variables of type `func` are script function
+       * symbols too, but their address is whatever function has been assigned to them and
+       * would shadow the function itself.
        */
       void registerFunctionAddress(SymbolIndex index)
       {
         SymbolScriptFunction& fn = getSymbol<SymbolScriptFunction>(index);
 
-        mFunctionsByAddress[fn.address] = index;
+        // Function definitions are the constants, see SymbolBase::isKeptAfterLoad
+        if (!fn.isKeptAfterLoad || fn.isClassVar) return;
+
+        mFunctionsByAddress.push_back({fn.address, index});
+        mIsFunctionsByAddressSorted = false;
+      }
+
+      /**
+       * @return Symbol of the function with the given address. If multiple functions
+       *         were registered with the same address, the last one is returned.
+       */
+      SymbolIndex findFunctionByAddress(bs::UINT32 scriptAddress);
+
+      /**
+       * Assigns each member variable of a class the slot its data will be stored at
+       * inside the script objects of that class, see SymbolBase::memberSlot.
+       *
+       * The members are numbered in the order they appear in the symbol table, separately
+       * for each type. ScriptClassTemplates will then lay out the script objects storage
+       * the same way. Doing this again assigns the same slots.
+       */
+      void resolveClassMemberSlots();
+
+    private:
+      /**
+       * All pools, one per type of symbol.
+       */
+      using SymbolPools = std::tuple<bs::Vector<SymbolFloat>,             //
+                                     bs::Vector<SymbolInt>,               //
+                                     bs::Vector<SymbolString>,            //
+                                     bs::Vector<SymbolClass>,             //
+                                     bs::Vector<SymbolScriptFunction>,    //
+                                     bs::Vector<SymbolExternalFunction>,  //
+                                     bs::Vector<SymbolPrototype>,         //
+                                     bs::Vector<SymbolInstance>,          //
+                                     bs::Vector<SymbolUnsupported>>;      //
+
+      template <typename T>
+      bs::Vector<T>& pool()
+      {
+        return std::get<bs::Vector<T>>(mPools);
       }
 
       /**
-       * @return Symbol of the function with the given address.
+       * Appends a copy of the given symbol to the pool of its type, then gives it the
+       * passed name and the next free index.
+       *
+       * @return Index of the appended symbol.
        */
-      SymbolIndex findFunctionByAddress(bs::UINT32 scriptAddress)
+      template <typename T>
+      SymbolIndex appendSymbolCopy(const T& symbol, const bs::String& name)
       {
-        auto it = mFunctionsByAddress.find(scriptAddress);
+        if (mSymbols.size() + 1 >= SYMBOL_INDEX_MAX)
+        {
+          using namespace bs;
+          BS_EXCEPT(InvalidStateException, "Symbol Index limit reached!");
+        }
+
+        bs::Vector<T>& symbols = pool<T>();
+        const T* dataBefore    = symbols.data();
 
-        if (it == mFunctionsByAddress.end())
+        symbols.push_back(symbol);
+
+        SymbolIndex index = (SymbolIndex)mSymbols.size();
+
+        T& appended    = symbols.back();
+        appended.name  = name;
+        appended.index = index;
+        appended.type  = T::TYPE;
+
+        mSymbols.push_back(&appended);
+
+        // If the pool has grown, all of its symbols have moved
+        if (symbols.data() != dataBefore)
         {
-          return SYMBOL_INDEX_INVALID;
+          for (T& s : symbols)
+          {
+            mSymbols[s.index] = &s;
+          }
         }
 
-        return it->second;
+        insertName(index);
+
+        return index;
       }
 
-    private:
+      /**
+       * Appends a copy of the given symbol. Picks the right pool by looking at its type.
+       *
+       * @return Index of the appended symbol.
+       */
+      SymbolIndex appendSymbolCopyOfType(const SymbolBase& symbol);
+
+      /**
+       * @return A copy of the symbol with the given index, for serialization.
+       */
+      bs::SPtr<SymbolBase> makeSharedCopy(SymbolIndex index) const;
+
+      /**
+       * Entry of the hash table to look up symbols by name.
+       */
+      struct NameSlot
+      {
+        bs::UINT32 hash;
+        SymbolIndex symbol = SYMBOL_INDEX_INVALID;
+      };
+
+      /**
+       * @return Hash of the given name, FNV-1a.
+       */
+      static bs::UINT32 hashName(const bs::String& name);
+
+      /**
+       * Searches the slot of the symbol with the given name. If there is no such symbol,
+       * the empty slot the symbol would go to is returned.
+       */
+      const NameSlot& findNameSlot(const bs::String& name, bs::UINT32 hash) const;
+
+      /**
+       * Puts the name of the given symbol into the hash table. If there already is a
+       * symbol with the same name, it will not be found by name anymore.
+       */
+      void insertName(SymbolIndex index);
+
+      /**
+       * Resizes the hash table to the given number of slots, which must be a power of
+       * two, and inserts all names again.
+       */
+      void rehashNames(bs::UINT32 numSlots);
+
+      /**
+       * Drops all symbols, names and addresses.
+       */
+      void clear();
+
+      /**
+       * Points the entries of mSymbols to the symbols inside the pools.
+       */
+      void relinkSymbols();
+
+
       /**
        * @return The symbol at the given index cast to the passed type.
        */
       template <class T>
       T& getTypedSymbolReference(SymbolIndex index) const
       {
-        return *(T*)(mStorage[index].get());
+        return *static_cast<T*>(mSymbols[index]);
       }
 
       template <class T>
@@ -276,21 +418,37 @@ namespace REGoth
           BS_EXCEPT(InvalidStateException, "Symbol Index is set to INVALID!");
         }
 
-        if (index >= mStorage.size())
+        if (index >= mSymbols.size())
         {
           BS_EXCEPT(InvalidStateException, "Symbol Index out of range!");
         }
-
-        if (!mStorage[index])
-        {
-          BS_EXCEPT(InvalidStateException,
-                    "Symbol index " + bs::toString(index) + " pointing to NULL!");
-        }
       }
 
-      bs::Vector<bs::SPtr<SymbolBase>> mStorage;
-      bs::Map<bs::String, SymbolIndex> mSymbolsByName;
-      bs::Map<bs::UINT32, SymbolIndex> mFunctionsByAddress;
+      SymbolPools mPools;
+
+      /**
+       * Points to each symbol inside the pools, by symbol index.
+       */
+      bs::Vector<SymbolBase*> mSymbols;
+
+      /**
+       * Hash table of all symbol names. Size is always a power of two.
+       */
+      bs::Vector<NameSlot> mNameSlots;
+      bs::UINT32 mNumNames = 0;
+
+      /**
+       * Maps script address -> function symbol. Sorted by address on the first lookup
+       * after new functions have been registered.
+       */
+      struct FunctionAddress
+      {
+        bs::UINT32 address;
+        SymbolIndex symbol;
+      };
+
+      bs::Vector<FunctionAddress> mFunctionsByAddress;
+      bool mIsFunctionsByAddressSorted = true;
 
     public:
       REGOTH_DECLARE_RTTI_FOR_REFLECTABLE(ScriptSymbolStorage)
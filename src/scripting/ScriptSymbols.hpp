@@ -34,6 +34,15 @@ namespace REGoth
        */
       SymbolIndex parent = SYMBOL_INDEX_INVALID;
 
+      /**
+       * For member variables of a class, this is the slot the variables data is stored at
+       * inside the script objects of that class. See ScriptObject.
+       *
+       * Resolved once when the symbols are loaded, so accessing a member does not have to
+       * look at the symbols name. Set to MEMBER_SLOT_INVALID for all other symbols.
+       */
+      MemberSlot memberSlot = MEMBER_SLOT_INVALID;
+
       /**
        * If this is a class var, then the values held inside should be ignored
        * and rather taken from the script object set in *Current Instance*.
@@ -19,6 +19,17 @@ namespace REGoth
       SYMBOL_INDEX_INVALID = UINT32_MAX
     };
 
+    /**
+     * Index of a member variable inside the storage of a script object. Member variables
+     * of different types are numbered separately, so an int and a string member can both
+     * have slot 0.
+     */
+    typedef bs::UINT32 MemberSlot;
+    enum : MemberSlot
+    {
+      MEMBER_SLOT_INVALID = UINT32_MAX
+    };
+
     enum class SymbolType
     {
       Float,
@@ -45,8 +56,9 @@ namespace REGoth
     };
 
     /**
-     * Script objects will get a simple increasing number as a handle.
-     * No number can be used twice. An invalid handle will get the number 0.
+     * Script objects are referenced by a handle made of a slot index and generation,
+     * see `ScriptObjectStorage`. No number can be used twice. An invalid handle
+     * will get the number 0.
      */
     typedef bs::UINT32 ScriptObjectHandle;
 
@@ -20,6 +20,7 @@ namespace REGoth
       const ScriptObject& classTemplate = mClassTemplates.getClassTemplate(className);
 
       obj.className        = className;
+      obj.layout           = classTemplate.layout;
       obj.functionPointers = classTemplate.functionPointers;
       obj.floats           = classTemplate.floats;
       obj.ints             = classTemplate.ints;
@@ -28,6 +29,73 @@ namespace REGoth
       return obj.handle;
     }
 
+    /**
+     * Moves member variables stored by name into the slots the layout has for them. Members
+     * the class doesn't have anymore are dropped.
+     */
+    template <typename T>
+    static void moveLegacyMembers(bs::Map<bs::String, T>& legacy, bs::Vector<T>& slots,
+                                  const ScriptClassLayout& layout, SymbolType type)
+    {
+      for (auto& it : legacy)
+      {
+        const ScriptClassLayout::Member* member = layout.findMember(it.first, type);
+
+        if (!member || member->slot >= slots.size()) continue;
+
+        slots[member->slot] = std::move(it.second);
+      }
+
+      legacy.clear();
+    }
+
+    void ScriptVM::recreateClassTemplates()
+    {
+      // Saves made before the member slots were saved don't have them
+      mScriptSymbols.resolveClassMemberSlots();
+
+      mClassTemplates.createClassTemplates(mScriptSymbols);
+
+      for (ScriptObjectHandle handle : mScriptObjects.allHandles())
+      {
+        ScriptObject& obj                 = mScriptObjects.get(handle);
+        const ScriptObject& classTemplate = mClassTemplates.getClassTemplate(obj.className);
+
+        obj.layout = classTemplate.layout;
+
+        // Objects from those saves have their members stored by name instead
+        bool hasLegacyMembers = !obj.legacyInts.empty() || !obj.legacyFloats.empty() ||
+                                !obj.legacyStrings.empty() || !obj.legacyFunctionPointers.empty();
+
+        if (hasLegacyMembers)
+        {
+          obj.ints             = classTemplate.ints;
+          obj.floats           = classTemplate.floats;
+          obj.strings          = classTemplate.strings;
+          obj.functionPointers = classTemplate.functionPointers;
+
+          moveLegacyMembers(obj.legacyInts, obj.ints, *obj.layout, SymbolType::Int);
+          moveLegacyMembers(obj.legacyFloats, obj.floats, *obj.layout, SymbolType::Float);
+          moveLegacyMembers(obj.legacyStrings, obj.strings, *obj.layout, SymbolType::String);
+          moveLegacyMembers(obj.legacyFunctionPointers, obj.functionPointers, *obj.layout,
+                            SymbolType::ScriptFunction);
+
+          continue;
+        }
+
+        // Only happens if the scripts have changed since saving, in which case the object
+        // starts over with the values of a blank object
+        if (obj.ints.size() != classTemplate.ints.size()) obj.ints = classTemplate.ints;
+        if (obj.floats.size() != classTemplate.floats.size()) obj.floats = classTemplate.floats;
+        if (obj.strings.size() != classTemplate.strings.size()) obj.strings = classTemplate.strings;
+
+        if (obj.functionPointers.size() != classTemplate.functionPointers.size())
+        {
+          obj.functionPointers = classTemplate.functionPointers;
+        }
+      }
+    }
+
     REGOTH_DEFINE_RTTI(ScriptVM)
   }  // namespace Scripting
 }  // namespace REGoth
@@ -113,6 +113,16 @@ namespace REGoth
        */
       virtual void fillSymbolStorage() = 0;
 
+      /**
+       * Creates the class templates from the symbol storage again and links all existing
+       * script objects to the layout of their class. To be used after deserialization,
+       * since neither the templates nor the layouts are saved.
+       *
+       * Also resolves the member slots and moves the members of objects into them, for saves
+       * made before members were stored by slot.
+       */
+      void recreateClassTemplates();
+
     protected:
       // Storages for symbols and objects -----------------------------------------------------------
       ScriptSymbolStorage mScriptSymbols;
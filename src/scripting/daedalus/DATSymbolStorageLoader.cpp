@@ -34,6 +34,8 @@ namespace REGoth
       {
         const Daedalus::PARSymTable& symTable = mDatFile.getSymTable();
 
+        reserveSymbols(symTable);
+
         for (const Daedalus::PARSymbol& sym : symTable.symbols)
         {
           SymbolType type    = guessSymbolType(sym);
@@ -42,9 +44,35 @@ namespace REGoth
 
           // debugLogSymbol(mStorage.getSymbolBase(target));
         }
+
+        mStorage.resolveClassMemberSlots();
       }
 
     private:
+      /**
+       * Makes room for all symbols inside the storage up front, so it doesn't have to
+       * move them around while loading.
+       */
+      void reserveSymbols(const Daedalus::PARSymTable& symTable)
+      {
+        bs::Map<SymbolType, bs::UINT32> counts;
+
+        for (const Daedalus::PARSymbol& sym : symTable.symbols)
+        {
+          counts[guessSymbolType(sym)] += 1;
+        }
+
+        mStorage.reserveSymbols<SymbolFloat>(counts[SymbolType::Float]);
+        mStorage.reserveSymbols<SymbolInt>(counts[SymbolType::Int]);
+        mStorage.reserveSymbols<SymbolString>(counts[SymbolType::String]);
+        mStorage.reserveSymbols<SymbolClass>(counts[SymbolType::Class]);
+        mStorage.reserveSymbols<SymbolScriptFunction>(counts[SymbolType::ScriptFunction]);
+        mStorage.reserveSymbols<SymbolExternalFunction>(counts[SymbolType::ExternalFunction]);
+        mStorage.reserveSymbols<SymbolPrototype>(counts[SymbolType::Prototype]);
+        mStorage.reserveSymbols<SymbolInstance>(counts[SymbolType::Instance]);
+        mStorage.reserveSymbols<SymbolUnsupported>(counts[SymbolType::Unsupported]);
+      }
+
       SymbolType guessSymbolType(const Daedalus::PARSymbol& sym)
       {
         uint32_t type  = sym.properties.elemProps.type;
@@ -0,0 +1,225 @@
+#include "DaedalusBytecode.hpp"
+#include <daedalus/DATFile.h>
+#include <exception/Throw.hpp>
+#include <log/logging.hpp>
+#include <scripting/ScriptSymbolStorage.hpp>
+
+namespace REGoth
+{
+  namespace Scripting
+  {
+    /**
+     * @return Whether the given operation has a bytecode address as operand.
+     */
+    static bool hasTargetAddress(bs::UINT8 op)
+    {
+      return op == Daedalus::EParOp_Jump || op == Daedalus::EParOp_JumpIf ||
+             op == Daedalus::EParOp_Call;
+    }
+
+    void DaedalusBytecode::reset(bs::SPtr<Daedalus::DATFile> datFile)
+    {
+      mDatFile = datFile;
+      mInstructions.clear();
+      mInstructionIndexByAddress.clear();
+    }
+
+    void DaedalusBytecode::decodeAllScriptFunctions(const ScriptSymbolStorage& symbols)
+    {
+      // Class members and function variables also have the script function type, but
+      // only actual function definitions have a valid address.
+      auto isFunctionDefinition = [](const SymbolBase& s) {
+        return s.type == SymbolType::ScriptFunction && !s.isClassVar && s.isKeptAfterLoad;
+      };
+
+      bs::Vector<bs::UINT32> entryAddresses;
+
+      for (SymbolIndex index : symbols.query(isFunctionDefinition))
+      {
+        entryAddresses.push_back(symbols.getSymbol<SymbolScriptFunction>(index).address);
+      }
+
+      decodeReachableFrom(entryAddresses);
+
+      REGOTH_LOG(Info, Uncategorized, "[DaedalusBytecode] Decoded {0} instructions",
+                 mInstructions.size());
+    }
+
+    bs::UINT32 DaedalusBytecode::instructionIndexOf(bs::UINT32 address)
+    {
+      auto it = mInstructionIndexByAddress.find(address);
+
+      if (it == mInstructionIndexByAddress.end())
+      {
+        decodeReachableFrom({address});
+
+        it = mInstructionIndexByAddress.find(address);
+      }
+
+      return it->second;
+    }
+
+    void DaedalusBytecode::decodeReachableFrom(const bs::Vector<bs::UINT32>& entryAddresses)
+    {
+      if (!mDatFile)
+      {
+        REGOTH_THROW(InvalidStateException, "No DAT-file to decode bytecode from!");
+      }
+
+      bs::UINT32 firstNewInstruction = numInstructions();
+
+      bs::Vector<bs::UINT32> pending = entryAddresses;
+
+      while (!pending.empty())
+      {
+        bs::UINT32 address = pending.back();
+        pending.pop_back();
+
+        if (mInstructionIndexByAddress.find(address) != mInstructionIndexByAddress.end())
+        {
+          continue;
+        }
+
+        decodeRun(address, pending);
+      }
+
+      resolveTargets(firstNewInstruction);
+    }
+
+    void DaedalusBytecode::decodeRun(bs::UINT32 address, bs::Vector<bs::UINT32>& targetAddresses)
+    {
+      for (;;)
+      {
+        auto it = mInstructionIndexByAddress.find(address);
+
+        if (it != mInstructionIndexByAddress.end())
+        {
+          // Ran into code decoded before, which is somewhere else in the instruction array
+          DaedalusInstruction jump;
+          jump.op          = Daedalus::EParOp_Jump;
+          jump.arrayIndex  = 0;
+          jump.isSynthetic = true;
+          jump.operand     = address;
+          jump.address     = address;
+
+          mInstructions.push_back(jump);
+          return;
+        }
+
+        Daedalus::PARStackOpCode opcode = mDatFile->getStackOpCode(address);
+
+        DaedalusInstruction instruction;
+        instruction.op          = (bs::UINT8)opcode.op;
+        instruction.arrayIndex  = 0;
+        instruction.isSynthetic = false;
+        instruction.operand     = 0;
+        instruction.address     = address;
+
+        bool isEndOfRun = false;
+
+        switch (opcode.op)
+        {
+          case Daedalus::EParOp_PushInt:
+            instruction.operand = (bs::UINT32)opcode.value;
+            break;
+
+          case Daedalus::EParOp_PushVar:
+          case Daedalus::EParOp_PushInstance:
+          case Daedalus::EParOp_CallExternal:
+          case Daedalus::EParOp_SetInstance:
+            instruction.operand = (bs::UINT32)opcode.symbol;
+            break;
+
+          case Daedalus::EParOp_PushArrayVar:
+            instruction.operand    = (bs::UINT32)opcode.symbol;
+            instruction.arrayIndex = (bs::UINT8)opcode.index;
+            break;
+
+          case Daedalus::EParOp_JumpIf:
+          case Daedalus::EParOp_Call:
+            instruction.operand = (bs::UINT32)opcode.address;
+            targetAddresses.push_back(instruction.operand);
+            break;
+
+          case Daedalus::EParOp_Jump:
+            instruction.operand = (bs::UINT32)opcode.address;
+            targetAddresses.push_back(instruction.operand);
+            isEndOfRun = true;
+            break;
+
+          case Daedalus::EParOp_Ret:
+            isEndOfRun = true;
+            break;
+
+          case Daedalus::EParOp_Add:
+          case Daedalus::EParOp_Subract:
+          case Daedalus::EParOp_Multiply:
+          case Daedalus::EParOp_Divide:
+          case Daedalus::EParOp_Mod:
+          case Daedalus::EParOp_BinOr:
+          case Daedalus::EParOp_BinAnd:
+          case Daedalus::EParOp_ShiftLeft:
+          case Daedalus::EParOp_ShiftRight:
+          case Daedalus::EParOp_Negate:
+          case Daedalus::EParOp_LogOr:
+          case Daedalus::EParOp_LogAnd:
+          case Daedalus::EParOp_Less:
+          case Daedalus::EParOp_Greater:
+          case Daedalus::EParOp_LessOrEqual:
+          case Daedalus::EParOp_Equal:
+          case Daedalus::EParOp_NotEqual:
+          case Daedalus::EParOp_GreaterOrEqual:
+          case Daedalus::EParOp_Plus:
+          case Daedalus::EParOp_Minus:
+          case Daedalus::EParOp_Not:
+          case Daedalus::EParOp_AssignFunc:
+          case Daedalus::EParOp_AssignString:
+          case Daedalus::EParOp_AssignFloat:
+          case Daedalus::EParOp_AssignInstance:
+          case Daedalus::EParOp_Assign:
+          case Daedalus::EParOp_AssignAdd:
+          case Daedalus::EParOp_AssignSubtract:
+          case Daedalus::EParOp_AssignMultiply:
+          case Daedalus::EParOp_AssignDivide:
+          case Daedalus::EParOp_AssignStringRef:
+            break;
+
+          default:
+            // Unknown operation, the VM will complain once it gets here. There is no
+            // telling how large it is, so don't decode any further.
+            isEndOfRun = true;
+            break;
+        }
+
+        mInstructionIndexByAddress[address] = numInstructions();
+        mInstructions.push_back(instruction);
+
+        if (isEndOfRun) return;
+
+        address += opcode.opSize;
+      }
+    }
+
+    void DaedalusBytecode::resolveTargets(bs::UINT32 firstNewInstruction)
+    {
+      for (bs::UINT32 i = firstNewInstruction; i < numInstructions(); i++)
+      {
+        DaedalusInstruction& instruction = mInstructions[i];
+
+        if (!hasTargetAddress(instruction.op)) continue;
+
+        auto it = mInstructionIndexByAddress.find(instruction.operand);
+
+        if (it == mInstructionIndexByAddress.end())
+        {
+          REGOTH_THROW(InvalidStateException,
+                       bs::StringUtil::format("Target address {0} of instruction at {1} was "
+                                              "not decoded",
+                                              instruction.operand, instruction.address));
+        }
+
+        instruction.operand = it->second;
+      }
+    }
+  }  // namespace Scripting
+}  // namespace REGoth
@@ -0,0 +1,134 @@
+/**\file
+ */
+#pragma once
+#include <BsPrerequisites.h>
+#include <scripting/ScriptTypes.hpp>
+
+namespace Daedalus
+{
+  class DATFile;
+}  // namespace Daedalus
+
+namespace REGoth
+{
+  namespace Scripting
+  {
+    class ScriptSymbolStorage;
+
+    /**
+     * A single instruction decoded from the Daedalus bytecode.
+     *
+     * All operands are already taken out of the raw bytes, so the VM does not have to
+     * decode anything while running. Jump- and call-targets have been translated from
+     * bytecode addresses to indices into the decoded instructions.
+     */
+    struct DaedalusInstruction
+    {
+      /**
+       * Which operation this is, one of `Daedalus::EParOp`.
+       */
+      bs::UINT8 op;
+
+      /**
+       * Array index of the variable, for `PushArrayVar`.
+       */
+      bs::UINT8 arrayIndex;
+
+      /**
+       * Whether this instruction was not in the bytecode but added while decoding.
+       * This happens when the decoded code runs into code which was decoded before. Since
+       * that code is somewhere else in the decoded instructions, a jump to it is added.
+       */
+      bool isSynthetic;
+
+      /**
+       * Depends on the operation:
+       *
+       *  - `PushInt`: The value to push.
+       *  - `Jump`, `JumpIf`, `Call`: Index of the target instruction.
+       *  - `PushVar`, `PushArrayVar`, `PushInstance`, `CallExternal`, `SetInstance`: Index of
+       *    the symbol.
+       */
+      bs::UINT32 operand;
+
+      /**
+       * Address of the original instruction in the bytecode, used by the disassembler.
+       */
+      bs::UINT32 address;
+    };
+
+    /**
+     * Holds the bytecode of a DAT-file as a compact array of already decoded instructions.
+     *
+     * Decoding starts at the addresses of all script functions and follows every jump and
+     * call, so only code which can actually be run is decoded. If the VM is asked to run
+     * code at an address which has not been decoded yet, like an instance constructor,
+     * that code is decoded on demand.
+     */
+    class DaedalusBytecode
+    {
+    public:
+      /**
+       * Drops all decoded instructions and sets the DAT-file to decode from.
+       */
+      void reset(bs::SPtr<Daedalus::DATFile> datFile);
+
+      /**
+       * Decodes all script functions found in the given symbol storage, so that this
+       * doesn't have to be done while the game is running.
+       */
+      void decodeAllScriptFunctions(const ScriptSymbolStorage& symbols);
+
+      /**
+       * Looks up the decoded instruction for the given bytecode address. If nothing has
+       * been decoded at that address yet, decoding will start there.
+       *
+       * @param  address  Bytecode address, e.g. the address of a script function.
+       *
+       * @return Index of the instruction at that address.
+       */
+      bs::UINT32 instructionIndexOf(bs::UINT32 address);
+
+      /**
+       * @return The decoded instruction with the given index.
+       */
+      const DaedalusInstruction& instructionAt(bs::UINT32 index) const
+      {
+        return mInstructions[index];
+      }
+
+      /**
+       * @return Number of instructions decoded so far.
+       */
+      bs::UINT32 numInstructions() const
+      {
+        return (bs::UINT32)mInstructions.size();
+      }
+
+    private:
+      /**
+       * Decodes all code reachable from the given addresses which has not been decoded yet.
+       */
+      void decodeReachableFrom(const bs::Vector<bs::UINT32>& entryAddresses);
+
+      /**
+       * Decodes instructions starting at the given address until a `Ret`, a `Jump` or
+       * code decoded before is found.
+       *
+       * @param  address          Address to start decoding at.
+       * @param  targetAddresses  Addresses of jumps and calls found are added here.
+       */
+      void decodeRun(bs::UINT32 address, bs::Vector<bs::UINT32>& targetAddresses);
+
+      /**
+       * Translates the targets of the jumps and calls decoded in the last run of
+       * decodeReachableFrom() from addresses to instruction indices.
+       */
+      void resolveTargets(bs::UINT32 firstNewInstruction);
+
+      bs::SPtr<Daedalus::DATFile> mDatFile;
+      bs::Vector<DaedalusInstruction> mInstructions;
+      bs::UnorderedMap<bs::UINT32, bs::UINT32> mInstructionIndexByAddress;
+    };
+  }  // namespace Scripting
+}  // namespace REGoth
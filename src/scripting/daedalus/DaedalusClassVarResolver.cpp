@@ -11,84 +11,84 @@ namespace REGoth
     {
     }
 
-    ScriptInts& DaedalusClassVarResolver::resolveClassVariableInts(
-        const bs::String& memberSymbolName)
+    ScriptInts& DaedalusClassVarResolver::resolveClassVariableInts(const SymbolBase& memberSymbol)
     {
-      throwIfCurrentInstanceNotMatching(memberSymbolName);
-
       ScriptObject& obj = getCurrentInstanceObject();
-      bs::String member = demangleMemberName(memberSymbolName);
-
-      auto it = obj.ints.find(member);
-
-      if (it == obj.ints.end())
-      {
-        REGOTH_THROW(InvalidParametersException, "Current Instance Object of class " +
-                                                     obj.className + " does not have member " +
-                                                     member + " of type INT.");
-      }
 
-      return it->second;
+      return obj.ints[findMemberSlot(obj, memberSymbol, "INT", obj.ints.size())];
     }
 
     bs::UINT32& DaedalusClassVarResolver::resolveClassVariableFunctionPointer(
-        const bs::String& memberSymbolName)
+        const SymbolBase& memberSymbol)
     {
-      throwIfCurrentInstanceNotMatching(memberSymbolName);
-
       ScriptObject& obj = getCurrentInstanceObject();
-      bs::String member = demangleMemberName(memberSymbolName);
 
-      auto it = obj.functionPointers.find(member);
+      MemberSlot slot =
+          findMemberSlot(obj, memberSymbol, "FUNCTION POINTER", obj.functionPointers.size());
 
-      if (it == obj.functionPointers.end())
-      {
-        REGOTH_THROW(InvalidParametersException, "Current Instance Object of class " +
-                                                     obj.className + " does not have member " +
-                                                     member + " of type FUNCTION POINTER.");
-      }
-
-      return it->second;
+      return obj.functionPointers[slot];
     }
 
     ScriptFloats& DaedalusClassVarResolver::resolveClassVariableFloats(
-        const bs::String& memberSymbolName)
+        const SymbolBase& memberSymbol)
     {
-      throwIfCurrentInstanceNotMatching(memberSymbolName);
+      ScriptObject& obj = getCurrentInstanceObject();
+
+      return obj.floats[findMemberSlot(obj, memberSymbol, "FLOAT", obj.floats.size())];
+    }
 
+    ScriptStrings& DaedalusClassVarResolver::resolveClassVariableStrings(
+        const SymbolBase& memberSymbol)
+    {
       ScriptObject& obj = getCurrentInstanceObject();
-      bs::String member = demangleMemberName(memberSymbolName);
 
-      auto it = obj.floats.find(member);
+      return obj.strings[findMemberSlot(obj, memberSymbol, "STRING", obj.strings.size())];
+    }
 
-      if (it == obj.floats.end())
+    MemberSlot DaedalusClassVarResolver::findMemberSlot(const ScriptObject& obj,
+                                                        const SymbolBase& memberSymbol,
+                                                        const bs::String& typeName,
+                                                        size_t numSlots)
+    {
+      if (!obj.layout)
       {
-        REGOTH_THROW(InvalidParametersException, "Current Instance Object of class " +
-                                                     obj.className + " does not have member " +
-                                                     member + " of type FLOAT.");
+        REGOTH_THROW(InvalidStateException,
+                     "Current Instance Object of class " + obj.className + " has no layout.");
       }
 
-      return it->second;
-    }
+      MemberSlot slot = MEMBER_SLOT_INVALID;
 
-    ScriptStrings& DaedalusClassVarResolver::resolveClassVariableStrings(
-        const bs::String& memberSymbolName)
-    {
-      throwIfCurrentInstanceNotMatching(memberSymbolName);
+      // Fast path: The slot was already resolved when loading the symbols
+      if (obj.layout->classSymbol == memberSymbol.parent)
+      {
+        slot = memberSymbol.memberSlot;
+      }
 
-      ScriptObject& obj = getCurrentInstanceObject();
-      bs::String member = demangleMemberName(memberSymbolName);
+      if (slot == MEMBER_SLOT_INVALID)
+      {
+        bs::String member = demangleMemberName(memberSymbol.name);
+
+        const ScriptClassLayout::Member* found =
+            obj.layout->findMember(member, memberSymbol.type);
 
-      auto it = obj.strings.find(member);
+        if (!found)
+        {
+          REGOTH_THROW(InvalidParametersException, "Current Instance Object of class " +
+                                                       obj.className + " does not have member " +
+                                                       member + " of type " + typeName + ".");
+        }
 
-      if (it == obj.strings.end())
+        slot = found->slot;
+      }
+
+      if (slot >= numSlots)
       {
-        REGOTH_THROW(InvalidParametersException, "Current Instance Object of class " +
-                                                     obj.className + " does not have member " +
-                                                     member + " of type STRING.");
+        REGOTH_THROW(InvalidStateException, "Current Instance Object of class " + obj.className +
+                                                " has no room for member " + memberSymbol.name +
+                                                " of type " + typeName + ".");
       }
 
-      return it->second;
+      return slot;
     }
 
     bool DaedalusClassVarResolver::isCurrentInstanceValid() const
@@ -119,23 +119,6 @@ namespace REGoth
       mCurrentInstance = handle;
     }
 
-    void DaedalusClassVarResolver::throwIfCurrentInstanceNotOfClass(
-        const bs::String& className) const
-    {
-      if (!isCurrentInstanceValid())
-      {
-        REGOTH_THROW(InvalidParametersException,
-                     "Current Instance is not valid! Expected it to be a " + className);
-      }
-
-      if (!isCurrentInstanceOfClass(className))
-      {
-        bs::String actual = mScriptObjects.get(mCurrentInstance).className;
-        REGOTH_THROW(InvalidParametersException,
-                     "Current Instance is a " + actual + ". But we expected " + className + "!");
-      }
-    }
-
     void DaedalusClassVarResolver::throwIfCurrentInstanceIsInvalid() const
     {
       if (!isCurrentInstanceValid())
@@ -144,14 +127,6 @@ namespace REGoth
       }
     }
 
-    void DaedalusClassVarResolver::throwIfCurrentInstanceNotMatching(
-        const bs::String& memberSymbolName) const
-    {
-      bs::String expected = extractClassNameFromMemberSymbol(memberSymbolName);
-
-      throwIfCurrentInstanceNotOfClass(expected);
-    }
-
     bs::String DaedalusClassVarResolver::demangleMemberName(const bs::String& memberSymbolName)
     {
       auto nameParts = bs::StringUtil::split(memberSymbolName, ".");
@@ -160,19 +135,5 @@ namespace REGoth
 
       return nameParts[1];
     }
-
-    bs::String DaedalusClassVarResolver::extractClassNameFromMemberSymbol(
-        const bs::String& memberSymbolName) const
-    {
-      auto nameParts = bs::StringUtil::split(memberSymbolName, ".");
-
-      if (nameParts.size() != 2)
-      {
-        REGOTH_THROW(InvalidParametersException,
-                     memberSymbolName + " does not look like a Member Symbol Name.");
-      }
-
-      return nameParts[0];
-    }
   }  // namespace Scripting
 }  // namespace REGoth
@@ -53,60 +53,46 @@ namespace REGoth
       /**
        * Get a reference to the data of the member variable in the *Current Instance*.
        *
-       * If passed a string like `C_ITEM.VALUE`, this will return a reference to
+       * If passed the symbol `C_ITEM.VALUE`, this will return a reference to
        * the `VALUE`-members data from the instance set in the *Current Instance*-
        * register.
        *
+       * If the *Current Instance* is of the class the member belongs to, this only has to
+       * look at the slot stored inside the member symbol. Otherwise the member is searched
+       * by name, in case the other class happens to have a member like that.
+       *
        * Throws if the member does not exist or no *Current Instance* is set.
        *
-       * @param  memberSymbolName  Actual symbol name of the member variable, e.g.
-       * `C_ITEM.VALUE`.
+       * @param  memberSymbol  Symbol of the member variable, e.g. `C_ITEM.VALUE`.
        *
        * @return Reference to that members data within the *Current Instance*.
        */
-      ScriptInts& resolveClassVariableInts(const bs::String& memberSymbolName);
+      ScriptInts& resolveClassVariableInts(const SymbolBase& memberSymbol);
 
       /** @copydoc resolveClassVariableInts */
-      bs::UINT32& resolveClassVariableFunctionPointer(const bs::String& memberSymbolName);
+      bs::UINT32& resolveClassVariableFunctionPointer(const SymbolBase& memberSymbol);
 
       /** @copydoc resolveClassVariableInts */
-      ScriptFloats& resolveClassVariableFloats(const bs::String& memberSymbolName);
+      ScriptFloats& resolveClassVariableFloats(const SymbolBase& memberSymbol);
 
       /** @copydoc resolveClassVariableInts */
-      ScriptStrings& resolveClassVariableStrings(const bs::String& memberSymbolName);
+      ScriptStrings& resolveClassVariableStrings(const SymbolBase& memberSymbol);
 
     private:
 
-      /**
-       * Throws if the object referenced via *Current Instance* is not of the given
-       * class name.
-       */
-      void throwIfCurrentInstanceNotOfClass(const bs::String& className) const;
-
       /**
        * Throws if the object referenced via *Current Instance* is invalid.
        */
       void throwIfCurrentInstanceIsInvalid() const;
 
       /**
-       * Throws if the object referenced via *Current Instance* is not matching the
-       * class named within the member variables symbol name. So if the *Current Instance*
-       * is of class `C_NPC` and the given Member Symbol Name is like `C_ITEM.SOMETHING`,
-       * then this method will throw.
-       *
-       * It will also throw if the *Current Instance* is invalid.
-       */
-      void throwIfCurrentInstanceNotMatching(const bs::String& memberSymbolName) const;
-
-      /**
-       * Given the name of a member symbol, e.g. `C_ITEM.VALUE`, this will return the name
-       * of the class, so `C_ITEM`.
-       *
-       * Throws if the given name does not match the pattern.
+       * Finds the slot the given member variable is stored at inside the given object.
        *
-       * @return Name of the class the given member variable belongs to.
+       * Throws if the object has no such member, or if the slot is not below `numSlots`,
+       * the number of slots the object has for members of that type.
        */
-      bs::String extractClassNameFromMemberSymbol(const bs::String& memberSymbolName) const;
+      MemberSlot findMemberSlot(const ScriptObject& obj, const SymbolBase& memberSymbol,
+                                const bs::String& typeName, size_t numSlots);
 
       /**
        * Converts a symbol name to the actual member variable name.
@@ -4,184 +4,231 @@ namespace REGoth
 {
   namespace Scripting
   {
+    DaedalusStack::DaedalusStack()
+    {
+      mValues.reserve(INITIAL_CAPACITY);
+    }
+
     void DaedalusStack::pushInt(bs::INT32 value)
     {
-      mStackInt.emplace_back();
-      mStackInt.back().isVariableValue = false;
-      mStackInt.back().value           = value;
+      mValues.emplace_back();
+      mValues.back().type     = ValueType::Int;
+      mValues.back().intValue = value;
     }
 
     void DaedalusStack::pushIntVariable(SymbolIndex symbol, bs::UINT32 arrayIndex)
     {
-      mStackInt.emplace_back();
-      mStackInt.back().isVariableValue     = true;
-      mStackInt.back().variable.symbol     = symbol;
-      mStackInt.back().variable.arrayIndex = arrayIndex;
+      mValues.emplace_back();
+      mValues.back().type                = ValueType::IntVariable;
+      mValues.back().variable.symbol     = symbol;
+      mValues.back().variable.arrayIndex = arrayIndex;
     }
 
     void DaedalusStack::pushFloat(float value)
     {
-      mStackFloat.emplace_back();
-      mStackFloat.back().isVariableValue = false;
-      mStackFloat.back().value           = value;
+      mValues.emplace_back();
+      mValues.back().type       = ValueType::Float;
+      mValues.back().floatValue = value;
     }
 
     void DaedalusStack::pushFloatVariable(SymbolIndex symbol, bs::UINT32 arrayIndex)
     {
-      mStackFloat.emplace_back();
-      mStackFloat.back().isVariableValue     = true;
-      mStackFloat.back().variable.symbol     = symbol;
-      mStackFloat.back().variable.arrayIndex = arrayIndex;
+      mValues.emplace_back();
+      mValues.back().type                = ValueType::FloatVariable;
+      mValues.back().variable.symbol     = symbol;
+      mValues.back().variable.arrayIndex = arrayIndex;
+    }
+
+    void DaedalusStack::pushString(const bs::String& value)
+    {
+      // Assigning keeps the memory the temporary string already has
+      pushEmptyString() = value;
     }
 
-    void DaedalusStack::pushString(bs::String value)
+    bs::String& DaedalusStack::pushEmptyString()
     {
-      mStackString.emplace_back();
-      mStackString.back().isVariableValue = false;
-      mStackString.back().value           = value;
+      if (mNumTemporaryStrings == mTemporaryStrings.size())
+      {
+        mTemporaryStrings.emplace_back();
+      }
+
+      bs::UINT32 index = mNumTemporaryStrings;
+      mNumTemporaryStrings += 1;
+
+      mValues.emplace_back();
+      mValues.back().type            = ValueType::String;
+      mValues.back().temporaryString = index;
+
+      bs::String& string = mTemporaryStrings[index];
+      string.clear();
+
+      return string;
     }
 
     void DaedalusStack::pushStringVariable(SymbolIndex symbol, bs::UINT32 arrayIndex)
     {
-      mStackString.emplace_back();
-      mStackString.back().isVariableValue     = true;
-      mStackString.back().variable.symbol     = symbol;
-      mStackString.back().variable.arrayIndex = arrayIndex;
+      mValues.emplace_back();
+      mValues.back().type                = ValueType::StringVariable;
+      mValues.back().variable.symbol     = symbol;
+      mValues.back().variable.arrayIndex = arrayIndex;
     }
 
     void DaedalusStack::pushInstance(SymbolIndex symbol)
     {
-      mStackInstance.push_back(symbol);
+      mValues.emplace_back();
+      mValues.back().type   = ValueType::Instance;
+      mValues.back().symbol = symbol;
     }
 
     void DaedalusStack::pushFunction(SymbolIndex symbol)
     {
-      mStackFunction.push_back(symbol);
+      mValues.emplace_back();
+      mValues.back().type   = ValueType::Function;
+      mValues.back().symbol = symbol;
     }
 
     bool DaedalusStack::isTopOfIntStackVariable() const
     {
-      if (mStackInt.empty())
+      bs::INT32 position = findTopmost(ValueType::Int, ValueType::IntVariable);
+
+      if (position == -1)
       {
         // Gothic defaults to returning 0 on an empty stack, which is not a variable
         return false;
       }
 
-      return mStackInt.back().isVariableValue;
+      return mValues[position].type == ValueType::IntVariable;
     }
 
     bool DaedalusStack::isTopOfFloatStackVariable() const
     {
-      if (mStackFloat.empty())
+      bs::INT32 position = findTopmost(ValueType::Float, ValueType::FloatVariable);
+
+      if (position == -1)
       {
         // Gothic defaults to returning 0 on an empty stack, which is not a variable
         return false;
       }
 
-      return mStackFloat.back().isVariableValue;
+      return mValues[position].type == ValueType::FloatVariable;
     }
 
     bool DaedalusStack::isTopOfStringStackVariable() const
     {
-      if (mStackString.empty())
+      bs::INT32 position = findTopmost(ValueType::String, ValueType::StringVariable);
+
+      if (position == -1)
       {
         // Gothic defaults to returning 0 on an empty stack, which is not a variable
         return false;
       }
 
-      return mStackString.back().isVariableValue;
+      return mValues[position].type == ValueType::StringVariable;
     }
 
     bs::INT32 DaedalusStack::popInt()
     {
-      if (mStackInt.empty())
+      bs::INT32 position = findTopmost(ValueType::Int, ValueType::IntVariable);
+
+      if (position == -1)
       {
         // Gothic defaults to returning 0 on an empty stack
         return 0;
       }
 
-      if (isTopOfIntStackVariable())
+      if (mValues[position].type != ValueType::Int)
       {
         REGOTH_THROW(
             InvalidParametersException,
             "Top of script stack is a variable, but we were expecting it to be a simple integer!");
       }
 
-      bs::INT32 v = mStackInt.back().value;
+      bs::INT32 v = mValues[position].intValue;
 
-      mStackInt.pop_back();
+      removeAt(position);
 
       return v;
     }
 
     float DaedalusStack::popFloat()
     {
-      if (mStackFloat.empty())
+      bs::INT32 position = findTopmost(ValueType::Float, ValueType::FloatVariable);
+
+      if (position == -1)
       {
         // Gothic defaults to returning 0 on an empty stack
         return 0;
       }
 
-      if (isTopOfFloatStackVariable())
+      if (mValues[position].type != ValueType::Float)
       {
         REGOTH_THROW(
             InvalidParametersException,
             "Top of script stack is a variable, but we were expecting it to be a simple float!");
       }
 
-      float v = mStackFloat.back().value;
+      float v = mValues[position].floatValue;
 
-      mStackFloat.pop_back();
+      removeAt(position);
 
       return v;
     }
 
-    bs::String DaedalusStack::popString()
+    const bs::String& DaedalusStack::popString()
     {
-      if (mStackString.empty())
+      static const bs::String EMPTY_STRING;
+
+      bs::INT32 position = findTopmost(ValueType::String, ValueType::StringVariable);
+
+      if (position == -1)
       {
         // Gothic defaults to returning 0 on an empty stack, so we just guess ""?
-        return "";
+        return EMPTY_STRING;
       }
 
-      if (isTopOfStringStackVariable())
+      if (mValues[position].type != ValueType::String)
       {
         REGOTH_THROW(
             InvalidParametersException,
             "Top of script stack is a variable, but we were expecting it to be a simple string!");
       }
 
-      bs::String v = mStackString.back().value;
+      // The temporary string itself stays untouched until the arena is released
+      const bs::String& v = mTemporaryStrings[mValues[position].temporaryString];
 
-      mStackString.pop_back();
+      removeAt(position);
 
       return v;
     }
 
     SymbolIndex DaedalusStack::popInstance()
     {
-      if (mStackInstance.empty())
+      bs::INT32 position = findTopmost(ValueType::Instance, ValueType::Instance);
+
+      if (position == -1)
       {
         return SYMBOL_INDEX_INVALID;
       }
 
-      SymbolIndex v = mStackInstance.back();
+      SymbolIndex v = mValues[position].symbol;
 
-      mStackInstance.pop_back();
+      removeAt(position);
 
       return v;
     }
 
     SymbolIndex DaedalusStack::popFunction()
     {
-      if (mStackFunction.empty())
+      bs::INT32 position = findTopmost(ValueType::Function, ValueType::Function);
+
+      if (position == -1)
       {
         return SYMBOL_INDEX_INVALID;
       }
 
-      SymbolIndex v = mStackFunction.back();
+      SymbolIndex v = mValues[position].symbol;
 
-      mStackFunction.pop_back();
+      removeAt(position);
 
       return v;
     }
@@ -195,9 +242,10 @@ namespace REGoth
             "Top of script stack is a simple integer, but we were expecting it to be a variable!");
       }
 
-      StackVariableValue v = mStackInt.back().variable;
+      bs::INT32 position   = findTopmost(ValueType::Int, ValueType::IntVariable);
+      StackVariableValue v = mValues[position].variable;
 
-      mStackInt.pop_back();
+      removeAt(position);
 
       return v;
     }
@@ -211,9 +259,10 @@ namespace REGoth
             "Top of script stack is a simple float, but we were expecting it to be a variable!");
       }
 
-      StackVariableValue v = mStackFloat.back().variable;
+      bs::INT32 position   = findTopmost(ValueType::Float, ValueType::FloatVariable);
+      StackVariableValue v = mValues[position].variable;
 
-      mStackFloat.pop_back();
+      removeAt(position);
 
       return v;
     }
@@ -227,20 +276,74 @@ namespace REGoth
             "Top of script stack is a simple string, but we were expecting it to be a variable!");
       }
 
-      StackVariableValue v = mStackString.back().variable;
+      bs::INT32 position   = findTopmost(ValueType::String, ValueType::StringVariable);
+      StackVariableValue v = mValues[position].variable;
 
-      mStackString.pop_back();
+      removeAt(position);
 
       return v;
     }
 
     void DaedalusStack::clear()
     {
-      mStackInt.clear();
-      mStackFloat.clear();
-      mStackString.clear();
-      mStackInstance.clear();
-      mStackFunction.clear();
+      mValues.clear();
+      mNumTemporaryStrings = 0;
+    }
+
+    void DaedalusStack::releaseTemporaryStrings()
+    {
+      // Strings which are still on the stack are moved to the front of the arena. Their
+      // order inside the arena is the same as on the stack, so a string is never moved
+      // behind one which still has to be moved.
+      bs::UINT32 numKept = 0;
+
+      for (StackValue& value : mValues)
+      {
+        if (value.type != ValueType::String) continue;
+
+        if (value.temporaryString != numKept)
+        {
+          std::swap(mTemporaryStrings[numKept], mTemporaryStrings[value.temporaryString]);
+          value.temporaryString = numKept;
+        }
+
+        numKept += 1;
+      }
+
+      mNumTemporaryStrings = numKept;
+
+#ifdef REGOTH_SCRIPT_BENCHMARK_BASELINE
+      if (!mIsReusingTemporaryStrings)
+      {
+        mTemporaryStrings.resize(numKept);
+      }
+#endif
+    }
+
+    bs::INT32 DaedalusStack::findTopmost(ValueType type, ValueType variableType) const
+    {
+      for (bs::INT32 i = (bs::INT32)mValues.size() - 1; i >= 0; i--)
+      {
+        if (mValues[i].type == type || mValues[i].type == variableType)
+        {
+          return i;
+        }
+      }
+
+      return -1;
+    }
+
+    void DaedalusStack::removeAt(bs::INT32 position)
+    {
+      // Almost always the topmost value, see class documentation
+      if (position == (bs::INT32)mValues.size() - 1)
+      {
+        mValues.pop_back();
+      }
+      else
+      {
+        mValues.erase(mValues.begin() + position);
+      }
     }
   }  // namespace Scripting
 }  // namespace REGoth
@@ -14,23 +14,48 @@ namespace REGoth
      * In the original, the stack was a single list of 32-bit integers
      * which was used for everything. This is not unusual for a processor to do
      * as memory is just bytes anyways. However, to save us from all the casting
-     * and string related hacks, this Daedalus-Stack is using multiple stacks under
-     * the hood for the different types of values.
+     * and string related hacks, every value on this Daedalus-Stack is tagged with
+     * its type.
+     *
+     * All values live in a single array, but popping a value of some type will
+     * take the topmost value *of that type*, so the stack behaves as if there was
+     * a separate stack for each type. Values of different types usually don't mix
+     * in the wrong order, so the value popped is the one on top almost always.
      *
      * This keeps the VM type-save internally.
+     *
+     * Strings
+     * =======
+     *
+     * Strings held by variables are referenced by symbol and array index, so they are
+     * never copied onto the stack. This includes string literals, which are constant
+     * symbols as well. Strings produced while running, like the result of `ConcatStrings`,
+     * are stored in an arena of temporary strings owned by the stack. The strings inside
+     * the arena are reused once releaseTemporaryStrings() was called, so after a few
+     * script calls they have grown large enough to not allocate any more memory.
      */
     class DaedalusStack
     {
     public:
+      DaedalusStack();
+
       /**
        * Push a simple value onto the stack.
        */
       void pushInt(bs::INT32 value);
       void pushFloat(float value);
-      void pushString(bs::String value);
+      void pushString(const bs::String& value);
       void pushInstance(SymbolIndex symbol);
       void pushFunction(SymbolIndex symbol);
 
+      /**
+       * Pushes an empty temporary string onto the stack, which can then be filled
+       * via the returned reference. This saves copying the string when building it.
+       *
+       * The reference is only valid until releaseTemporaryStrings() is called.
+       */
+      bs::String& pushEmptyString();
+
       /**
        * Push a reference to a variable onto the stack.
        *
@@ -68,8 +93,10 @@ namespace REGoth
        *
        * Throws if this value on top is NOT a pure data value. To check that, use
        * isTopOfStringStackVariable(). If it IS a variable, use popStringVariable() instead.
+       *
+       * The returned reference is only valid until releaseTemporaryStrings() is called.
        */
-      bs::String popString();
+      const bs::String& popString();
 
       /**
        * Pops from the stack.
@@ -115,51 +142,89 @@ namespace REGoth
        */
       void clear();
 
-    private:
       /**
-       * Integer value to push onto the stack. Can be either a plain integer value
-       * or a variable value, which we have to look up in the symbol storage first.
+       * Allows the temporary strings to be reused. Strings still on the stack are kept.
+       *
+       * Should be called once no references returned by popString() are in use anymore,
+       * like after the outermost script function returned.
+       */
+      void releaseTemporaryStrings();
+
+#ifdef REGOTH_SCRIPT_BENCHMARK_BASELINE
+      /**
+       * If false, releaseTemporaryStrings() frees the released strings instead of keeping
+       * them for reuse, so every string pushed needs a new allocation like it did before
+       * the arena. Only meant as a baseline for benchmarking, so it is only there in builds
+       * configured with `REGOTH_SCRIPT_BENCHMARK_BASELINE`.
        */
-      struct StackInt
+      void setReuseTemporaryStrings(bool reuseTemporaryStrings)
       {
-        bool isVariableValue;
-        union {
-          StackVariableValue variable;
-          bs::INT32 value;
-        };
+        mIsReusingTemporaryStrings = reuseTemporaryStrings;
+      }
+#endif
+
+    private:
+      enum class ValueType : bs::UINT8
+      {
+        Int,
+        IntVariable,
+        Float,
+        FloatVariable,
+        String,
+        StringVariable,
+        Instance,
+        Function,
       };
 
       /**
-       * Integer value to push onto the stack. Can be either a plain integer value
-       * or a variable value, which we have to look up in the symbol storage first.
+       * A single value on the stack. Depending on the type, this is a plain value or
+       * a variable value, which we have to look up in the symbol storage first.
        */
-      struct StackFloat
+      struct StackValue
       {
-        bool isVariableValue;
+        ValueType type;
         union {
           StackVariableValue variable;
-          float value;
+          bs::INT32 intValue;
+          float floatValue;
+          bs::UINT32 temporaryString;
+          SymbolIndex symbol;
         };
       };
 
       /**
-       * Integer value to push onto the stack. Can be either a plain integer value
-       * or a variable value, which we have to look up in the symbol storage first.
+       * Searches the topmost value having one of the given types.
+       *
+       * @return Position of the value inside mValues or -1, if there is no such value.
        */
-      struct StackString
-      {
-        bool isVariableValue;
+      bs::INT32 findTopmost(ValueType type, ValueType variableType) const;
 
-        // Not a union to keep the default constructor
-        StackVariableValue variable;
-        bs::String value;
-      };
+      /**
+       * Removes the value at the given position from the stack.
+       */
+      void removeAt(bs::INT32 position);
 
-      bs::Vector<StackInt> mStackInt;
-      bs::Vector<StackFloat> mStackFloat;
-      bs::Vector<StackString> mStackString;
-      bs::Vector<SymbolIndex> mStackInstance;
-      bs::Vector<SymbolIndex> mStackFunction;
+      /**
+       * Initial capacity of the stack. Scripts rarely need more than a handful of values.
+       */
+      static constexpr bs::UINT32 INITIAL_CAPACITY = 256;
+
+      bs::Vector<StackValue> mValues;
+
+      /**
+       * Arena of temporary strings referenced by the `String` values. Only the first
+       * mNumTemporaryStrings are in use, the others are kept for reuse. Since this is a
+       * deque, references to the strings stay valid when more strings are added.
+       */
+      bs::Deque<bs::String> mTemporaryStrings;
+      bs::UINT32 mNumTemporaryStrings = 0;
+
+#ifdef REGOTH_SCRIPT_BENCHMARK_BASELINE
+      /**
+       * See setReuseTemporaryStrings().
+       */
+      bool mIsReusingTemporaryStrings = true;
+#endif
     };
   }  // namespace Scripting
 }  // namespace REGoth
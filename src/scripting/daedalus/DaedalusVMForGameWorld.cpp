@@ -14,6 +14,7 @@
 #include <components/StoryInformation.hpp>
 #include <components/VisualCharacter.hpp>
 #include <components/Waynet.hpp>
+#include <cstdio>
 #include <log/logging.hpp>
 #include <scripting/ScriptSymbolQueries.hpp>
 
@@ -25,8 +26,8 @@ namespace REGoth
   namespace Scripting
   {
     DaedalusVMForGameWorld::DaedalusVMForGameWorld(HGameWorld gameWorld,
-                                                   const bs::Vector<bs::UINT8>& datFileData)
-        : DaedalusVM(datFileData)
+                                                   bs::Vector<bs::UINT8> datFileData)
+        : DaedalusVM(std::move(datFileData))
         , mWorld(gameWorld)
     {
     }
@@ -47,6 +48,8 @@ namespace REGoth
       mOtherSymbol  = scriptSymbols().findIndexBySymbolName("OTHER");
       mVictimSymbol = scriptSymbols().findIndexBySymbolName("VICTIM");
       mItemSymbol   = scriptSymbols().findIndexBySymbolName("ITEM");
+
+      mAIStateTable.build(scriptSymbols());
     }
 
     ScriptObjectHandle DaedalusVMForGameWorld::instanciateClass(const bs::String& className,
@@ -498,8 +501,8 @@ namespace REGoth
 
     void DaedalusVMForGameWorld::external_PrintDebugInstCh()
     {
-      bs::String text     = popStringValue();
-      bs::INT32 character = popIntValue();
+      popStringValue();
+      popIntValue();
 
       // Don't need this. Just get the parameters off the stack.
     }
@@ -546,7 +549,12 @@ namespace REGoth
 
     void DaedalusVMForGameWorld::external_IntToString()
     {
-      mStack.pushString(bs::toString(popIntValue()));
+      // Formatted right into the temporary string, which saves the allocations a
+      // stringstream would do
+      char buffer[16];
+      snprintf(buffer, sizeof(buffer), "%d", popIntValue());
+
+      mStack.pushEmptyString().assign(buffer);
     }
 
     void DaedalusVMForGameWorld::external_IntToFloat()
@@ -561,10 +569,15 @@ namespace REGoth
 
     void DaedalusVMForGameWorld::external_ConcatStrings()
     {
-      bs::String b = popStringValue();
-      bs::String a = popStringValue();
+      // Both are only referenced, either from a variable or from a temporary string,
+      // which will stay valid until the outermost script function returned.
+      const bs::String& b = popStringValue();
+      const bs::String& a = popStringValue();
 
-      mStack.pushString(a + b);
+      bs::String& result = mStack.pushEmptyString();
+      result.reserve(a.size() + b.size());
+      result.append(a);
+      result.append(b);
     }
 
     void DaedalusVMForGameWorld::external_WLD_InsertItem()
@@ -724,6 +737,13 @@ namespace REGoth
       HFreepoint freepoint =
           mWorld->waynet()->findClosestFreepointTo(freepointName, at).secondClosest;
 
+      if (!freepoint)
+      {
+        REGOTH_LOG(Warning, Uncategorized, "[External] AI_GotoNextFP: No freepoint {0} for {1}",
+                   freepointName, self->SO()->getName());
+        return;
+      }
+
       eventQueue->pushGotoObject(freepoint->SO());
     }
 
@@ -759,10 +779,7 @@ namespace REGoth
 
       task.waypoint = waypoint;
 
-      if (action != SYMBOL_INDEX_INVALID)
-      {
-        task.scriptFunction = scriptSymbols().getSymbolName(action);
-      }
+      task.scriptFunction = action;
 
       auto eventQueue = self->SO()->getComponent<CharacterEventQueue>();
 
@@ -848,12 +865,13 @@ namespace REGoth
       if (endOldState != 0)
       {
         // End old state gracefully
-        eventQueue->pushStartScriptState(functionSym.name, waypoint, other(), victim());
+        eventQueue->pushStartScriptState(functionSym.index, waypoint, other(), victim());
       }
       else
       {
         // Interrupt old state
-        eventQueue->pushInterruptAndStartScriptState(functionSym.name, waypoint, other(), victim());
+        eventQueue->pushInterruptAndStartScriptState(functionSym.index, waypoint, other(),
+                                                     victim());
       }
     }
 
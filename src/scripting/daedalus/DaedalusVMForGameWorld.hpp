@@ -2,6 +2,7 @@
  */
 #pragma once
 #include "REGothDaedalusVM.hpp"
+#include <AI/AIStateTable.hpp>
 #include <BsPrerequisites.h>
 
 namespace REGoth
@@ -23,7 +24,7 @@ namespace REGoth
     class DaedalusVMForGameWorld : public DaedalusVM
     {
     public:
-      DaedalusVMForGameWorld(HGameWorld gameWorld, const bs::Vector<bs::UINT8>& datFileData);
+      DaedalusVMForGameWorld(HGameWorld gameWorld, bs::Vector<bs::UINT8> datFileData);
 
       /**
        * Initializes the ScriptVM. To be called after the object is constructed.
@@ -117,6 +118,14 @@ namespace REGoth
        */
       const bs::Vector<ScriptObjectHandle>& allInfosOfNpc(const bs::String& instanceName) const;
 
+      /**
+       * @return Table of the script functions belonging to each AI-state.
+       */
+      const AI::AIStateTable& aiStateTable() const
+      {
+        return mAIStateTable;
+      }
+
     protected:
       /**
        * Fills mAllInformationInstances. This is done here at one place because otherwise
@@ -254,6 +263,9 @@ namespace REGoth
       SymbolIndex mVictimSymbol = SYMBOL_INDEX_INVALID;
       SymbolIndex mItemSymbol   = SYMBOL_INDEX_INVALID;
 
+      /** Functions of all AI-states, built once the symbols are loaded */
+      AI::AIStateTable mAIStateTable;
+
       /** Cache of all information instances for all NPCs */
       bs::Map<SymbolIndex, bs::Vector<ScriptObjectHandle>> mInformationInstancesByNpcs;
 
@@ -1,5 +1,6 @@
 #include "REGothDaedalusVM.hpp"
 #include "DATSymbolStorageLoader.hpp"
+#include "DaedalusBytecode.hpp"
 #include "DaedalusClassVarResolver.hpp"
 #include "DaedalusDisassembler.hpp"
 #include <RTTI/RTTI_REGothDaedalusVM.hpp>
@@ -11,797 +12,934 @@ namespace REGoth
 {
   namespace Scripting
   {
-    const bs::Set<bs::String> FUNCTIONS_TO_ACTIVATE_DISASSEMBLER_FOR = {
-        "DIA_BAALPARVEZ_GOTOPSI_CONDITION",
-        "DIA_BAALPARVEZ_GOTOPSI_INFO",
-        "ZS_GUIDEPC_LOOP",
-        "INFO_DIEGO_EXIT_GAMESTART_CONDITION",
-    };
-
-    const bs::Set<bs::String> FUNCTIONS_TO_HIDE_IN_DISASSEMBLY = {
-        "PRINTDEBUGNPC",
-        "PRINTGLOBALS",
-        "PRINTDEBUGINT",
-    };
-
-    DaedalusVM::DaedalusVM(const bs::Vector<bs::UINT8>& datFileData)
+    /**
+     * Set via DaedalusVM::setTraceFilter().
+     */
+    static bs::Vector<bs::String> sFunctionsToTrace;
+    static bs::Vector<bs::String> sFunctionsToHideInTrace;
+
+    DaedalusVM::DaedalusVM(bs::Vector<bs::UINT8> datFileData)
+        : mDatFileData(std::move(datFileData))
     {
-      mDatFile = bs::bs_shared_ptr_new<Daedalus::DATFile>(datFileData.data(), datFileData.size());
+      mDatFile = bs::bs_shared_ptr_new<Daedalus::DATFile>(mDatFileData.data(), mDatFileData.size());
       mClassVarResolver =
           bs::bs_shared_ptr_new<DaedalusClassVarResolver>(mScriptSymbols, mScriptObjects);
-      mDatFileData = datFileData;
     }
 
     void DaedalusVM::fillSymbolStorage()
     {
       REGoth::Scripting::convertDatToREGothSymbolStorage(mScriptSymbols, *mDatFile);
 
+      mBytecode.reset(mDatFile);
+      mBytecode.decodeAllScriptFunctions(mScriptSymbols);
+
+      buildFunctionTraceFlags();
+
       registerAllExternals();
     }
 
-    bool DaedalusVM::shouldEnableDisassemblerForFunction(const bs::String& uppercaseName) const
+    void DaedalusVM::setTraceFilter(const bs::Vector<bs::String>& functionsToTrace,
+                                    const bs::Vector<bs::String>& functionsToHide)
     {
-      return FUNCTIONS_TO_ACTIVATE_DISASSEMBLER_FOR.find(uppercaseName) !=
-             FUNCTIONS_TO_ACTIVATE_DISASSEMBLER_FOR.end();
+      sFunctionsToTrace       = functionsToTrace;
+      sFunctionsToHideInTrace = functionsToHide;
     }
 
-    bool DaedalusVM::shouldHideFunctionInDisassembly(const bs::String& uppercaseName) const
+    void DaedalusVM::buildFunctionTraceFlags()
     {
-      return FUNCTIONS_TO_HIDE_IN_DISASSEMBLY.find(uppercaseName) !=
-             FUNCTIONS_TO_HIDE_IN_DISASSEMBLY.end();
-    }
+      mFunctionTraceFlags.clear();
 
-    void DaedalusVM::executeScriptFunction(const bs::String& name)
-    {
-      bs::String upper = name;
-      bs::StringUtil::toUpperCase(upper);
+      // Hiding functions only makes a difference if something is traced at all
+      if (sFunctionsToTrace.empty()) return;
 
-      const auto& symbol = mScriptSymbols.getSymbol<SymbolScriptFunction>(upper);
+      mFunctionTraceFlags.resize(mScriptSymbols.numSymbols(), 0);
 
-      mPC = symbol.address;
+      auto setFlag = [&](const bs::String& name, FunctionTraceFlag flag) {
+        if (!mScriptSymbols.hasSymbolWithName(name))
+        {
+          REGOTH_LOG(Warning, Uncategorized, "[DaedalusVM] Cannot trace unknown function: {0}",
+                     name);
+          return;
+        }
 
-      executeUntilReturn();
-    }
+        mFunctionTraceFlags[mScriptSymbols.findIndexBySymbolName(name)] |= flag;
+      };
 
-    void DaedalusVM::executeScriptFunction(bs::UINT32 address)
-    {
-      mPC = address;
+      for (const bs::String& name : sFunctionsToTrace)
+      {
+        setFlag(name, FUNCTION_TRACE_ENABLE);
+      }
 
-      executeUntilReturn();
+      for (const bs::String& name : sFunctionsToHideInTrace)
+      {
+        setFlag(name, FUNCTION_TRACE_HIDE);
+      }
     }
 
-    void DaedalusVM::executeUntilReturn()
+    void DaedalusVM::applyFunctionTraceFlags(bs::UINT32 address)
     {
-      bool wasDisassemblerEnabledBefore = mIsDisassemblerEnabled;
+      SymbolIndex symIndex = scriptSymbols().findFunctionByAddress(address);
 
-      auto symIndex = scriptSymbols().findFunctionByAddress(mPC);
+      if (symIndex == SYMBOL_INDEX_INVALID) return;
 
-      // TODO: Guard these by some configuration variable so they only run during development
-      if (symIndex != SYMBOL_INDEX_INVALID)
-      {
-        bs::String name = scriptSymbols().getSymbolName(symIndex);
+      bs::UINT8 flags = mFunctionTraceFlags[symIndex];
 
-        if (shouldEnableDisassemblerForFunction(name))
-        {
-          mIsDisassemblerEnabled = true;
-        }
-
-        if (mIsDisassemblerEnabled && shouldHideFunctionInDisassembly(name))
-        {
-          mIsDisassemblerEnabled = false;
-        }
-
-        if (mIsDisassemblerEnabled)
-        {
-          findFunctionAtAddressAndLog(mPC);
-        }
+      if (flags & FUNCTION_TRACE_ENABLE)
+      {
+        mIsDisassemblerEnabled = true;
       }
 
-      bool didNotReachReturn;
-
-      do
+      if (mIsDisassemblerEnabled && (flags & FUNCTION_TRACE_HIDE))
       {
-        didNotReachReturn = executeInstructionAtPC();
-      } while (didNotReachReturn);
+        mIsDisassemblerEnabled = false;
+      }
 
-      mIsDisassemblerEnabled = wasDisassemblerEnabledBefore;
+      if (mIsDisassemblerEnabled)
+      {
+        findFunctionAtAddressAndLog(address);
+      }
     }
 
-    bool DaedalusVM::executeInstructionAtPC()
+    bs::Vector<SymbolIndex> DaedalusVM::findReachableExternals(SymbolIndex function,
+                                                               bool& usesInstances)
     {
-      Daedalus::PARStackOpCode opcode = mDatFile->getStackOpCode(mPC);
+      const auto& symbol = mScriptSymbols.getSymbol<SymbolScriptFunction>(function);
 
-      mPC += opcode.opSize;
+      bs::Vector<bs::UINT32> toVisit = {mBytecode.instructionIndexOf(symbol.address)};
+      bs::Vector<bool> visited(mBytecode.numInstructions(), false);
+      bs::Vector<SymbolIndex> externals;
 
-      switch (opcode.op)
-      {
-          // Arithmetic
-          // ------------------------------------------------------------------------------
+      usesInstances = false;
 
-        case Daedalus::EParOp_Add:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs + rhs;
+      auto isInstanceRelated = [&](SymbolIndex index) {
+        const SymbolBase& variable = mScriptSymbols.getSymbolBase(index);
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
-          }
+        return variable.isClassVar || variable.type == SymbolType::Instance;
+      };
 
-          mStack.pushInt(res);
-        }
-        break;
+      while (!toVisit.empty())
+      {
+        bs::UINT32 index = toVisit.back();
+        toVisit.pop_back();
 
-        case Daedalus::EParOp_Subract:
+        // Follow the instructions until the function returns or jumps somewhere else
+        while (!visited[index])
         {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs - rhs;
+          visited[index] = true;
 
-          if (mIsDisassemblerEnabled)
+          const DaedalusInstruction& instruction = mBytecode.instructionAt(index);
+          bool isEndOfRun                        = false;
+
+          switch (instruction.op)
           {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
+            case Daedalus::EParOp_Ret:
+              isEndOfRun = true;
+              break;
+
+            case Daedalus::EParOp_Jump:
+              toVisit.push_back(instruction.operand);
+              isEndOfRun = true;
+              break;
+
+            case Daedalus::EParOp_JumpIf:
+            case Daedalus::EParOp_Call:
+              toVisit.push_back(instruction.operand);
+              break;
+
+            case Daedalus::EParOp_CallExternal:
+              if (std::find(externals.begin(), externals.end(), instruction.operand) ==
+                  externals.end())
+              {
+                externals.push_back(instruction.operand);
+              }
+              break;
+
+            case Daedalus::EParOp_PushVar:
+            case Daedalus::EParOp_PushArrayVar:
+              usesInstances |= isInstanceRelated(instruction.operand);
+              break;
+
+            case Daedalus::EParOp_PushInstance:
+            case Daedalus::EParOp_SetInstance:
+            case Daedalus::EParOp_AssignInstance:
+              usesInstances = true;
+              break;
+
+            default:
+              break;
           }
 
-          mStack.pushInt(res);
-        }
-        break;
+          if (isEndOfRun) break;
 
-        case Daedalus::EParOp_Multiply:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs * rhs;
+          index += 1;
+        }
+      }
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
-          }
+      return externals;
+    }
 
-          mStack.pushInt(res);
-        }
-        break;
+    void DaedalusVM::executeScriptFunction(const bs::String& name)
+    {
+      bs::String upper = name;
+      bs::StringUtil::toUpperCase(upper);
 
-        case Daedalus::EParOp_Divide:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs / rhs;
+      const auto& symbol = mScriptSymbols.getSymbol<SymbolScriptFunction>(upper);
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
-          }
+      mPC = mBytecode.instructionIndexOf(symbol.address);
 
-          mStack.pushInt(res);
-        }
-        break;
+      executeUntilReturn();
+    }
 
-        case Daedalus::EParOp_Mod:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs % rhs;
+    void DaedalusVM::executeScriptFunction(bs::UINT32 address)
+    {
+      mPC = mBytecode.instructionIndexOf(address);
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
-          }
+      executeUntilReturn();
+    }
 
-          mStack.pushInt(res);
-        }
-        break;
+    void DaedalusVM::executeUntilReturn()
+    {
+      bool wasDisassemblerEnabledBefore = mIsDisassemblerEnabled;
 
-          // Binary
-          // ----------------------------------------------------------------------------------
+      if (!mFunctionTraceFlags.empty())
+      {
+        applyFunctionTraceFlags(mBytecode.instructionAt(mPC).address);
+      }
 
-        case Daedalus::EParOp_BinOr:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs | rhs;
+      executeInstructionsUntilReturn();
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
-          }
+      mIsDisassemblerEnabled = wasDisassemblerEnabledBefore;
 
-          mStack.pushInt(res);
-        }
-        break;
+      // Nothing can reference the temporary strings once the outermost function returned
+      if (mCallDepth == 0)
+      {
+        mStack.releaseTemporaryStrings();
+      }
+    }
 
-        case Daedalus::EParOp_BinAnd:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs & rhs;
+    void DaedalusVM::executeInstructionsUntilReturn()
+    {
+      for (;;)
+      {
+        // Copied, since an external might decode more instructions and move them around
+        const DaedalusInstruction instruction = mBytecode.instructionAt(mPC);
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
-          }
+        mPC += 1;
+        mNumExecutedInstructions += 1;
 
-          mStack.pushInt(res);
+#ifdef REGOTH_SCRIPT_BENCHMARK_BASELINE
+        if (mIsDecodingEachInstruction && !instruction.isSynthetic)
+        {
+          mDatFile->getStackOpCode(instruction.address);
         }
-        break;
+#endif
 
-        case Daedalus::EParOp_ShiftLeft:
+        switch (instruction.op)
         {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs << rhs;
+            // Arithmetic
+            // ------------------------------------------------------------------------------
 
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_Add:
           {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
-          }
-
-          mStack.pushInt(res);
-        }
-        break;
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs + rhs;
 
-        case Daedalus::EParOp_ShiftRight:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs >> rhs;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
+            mStack.pushInt(res);
           }
+          break;
 
-          mStack.pushInt(res);
-        }
-        break;
+          case Daedalus::EParOp_Subract:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs - rhs;
 
-        case Daedalus::EParOp_Negate:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 res = ~lhs;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), "", bs::toString(res));
+            mStack.pushInt(res);
           }
+          break;
 
-          mStack.pushInt(res);
-        }
-        break;
+          case Daedalus::EParOp_Multiply:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs * rhs;
 
-          // Logic
-          // -----------------------------------------------------------------------------------
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-        case Daedalus::EParOp_LogOr:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs || rhs ? 1 : 0;
+            mStack.pushInt(res);
+          }
+          break;
 
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_Divide:
           {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
-          }
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs / rhs;
 
-          mStack.pushInt(res);
-        }
-        break;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-        case Daedalus::EParOp_LogAnd:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs && rhs ? 1 : 0;
+            mStack.pushInt(res);
+          }
+          break;
 
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_Mod:
           {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
-          }
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs % rhs;
 
-          mStack.pushInt(res);
-        }
-        break;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          // Comparision
-          // -----------------------------------------------------------------------------
+            mStack.pushInt(res);
+          }
+          break;
 
-        case Daedalus::EParOp_Less:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs < rhs ? 1 : 0;
+            // Binary
+            // ----------------------------------------------------------------------------------
 
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_BinOr:
           {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
-          }
-
-          mStack.pushInt(res);
-        }
-        break;
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs | rhs;
 
-        case Daedalus::EParOp_Greater:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs > rhs ? 1 : 0;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
+            mStack.pushInt(res);
           }
+          break;
 
-          mStack.pushInt(res);
-        }
-        break;
+          case Daedalus::EParOp_BinAnd:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs & rhs;
 
-        case Daedalus::EParOp_LessOrEqual:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs <= rhs ? 1 : 0;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
+            mStack.pushInt(res);
           }
+          break;
 
-          mStack.pushInt(res);
-        }
-        break;
+          case Daedalus::EParOp_ShiftLeft:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs << rhs;
 
-        case Daedalus::EParOp_Equal:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs == rhs ? 1 : 0;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
+            mStack.pushInt(res);
           }
+          break;
 
-          mStack.pushInt(res);
-        }
-        break;
+          case Daedalus::EParOp_ShiftRight:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs >> rhs;
 
-        case Daedalus::EParOp_NotEqual:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs != rhs ? 1 : 0;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
+            mStack.pushInt(res);
           }
+          break;
 
-          mStack.pushInt(res);
-        }
-        break;
+          case Daedalus::EParOp_Negate:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 res = ~lhs;
 
-        case Daedalus::EParOp_GreaterOrEqual:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 rhs = popIntValue();
-          bs::INT32 res = lhs >= rhs ? 1 : 0;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), "", bs::toString(res));
+            }
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), bs::toString(rhs), bs::toString(res));
+            mStack.pushInt(res);
           }
+          break;
 
-          mStack.pushInt(res);
-        }
-        break;
+            // Logic
+            // -----------------------------------------------------------------------------------
 
-          // Unary
-          // -----------------------------------------------------------------------------------
+          case Daedalus::EParOp_LogOr:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs || rhs ? 1 : 0;
 
-        case Daedalus::EParOp_Plus:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 res = +lhs;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), "", bs::toString(res));
+            mStack.pushInt(res);
           }
+          break;
 
-          mStack.pushInt(res);
-        }
-        break;
+          case Daedalus::EParOp_LogAnd:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs && rhs ? 1 : 0;
 
-        case Daedalus::EParOp_Minus:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 res = -lhs;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), "", bs::toString(res));
+            mStack.pushInt(res);
           }
+          break;
 
-          mStack.pushInt(res);
-        }
-        break;
-
-        case Daedalus::EParOp_Not:
-        {
-          bs::INT32 lhs = popIntValue();
-          bs::INT32 res = !lhs;
+            // Comparision
+            // -----------------------------------------------------------------------------
 
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_Less:
           {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs), "", bs::toString(res));
-          }
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs < rhs ? 1 : 0;
 
-          mStack.pushInt(res);
-        }
-        break;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          // Stack
-          // -----------------------------------------------------------------------------------
+            mStack.pushInt(res);
+          }
+          break;
 
-        case Daedalus::EParOp_PushInt:
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_Greater:
           {
-            disassembleAndLogOpcode(opcode, bs::toString(opcode.value), "", "");
-          }
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs > rhs ? 1 : 0;
+
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          mStack.pushInt(opcode.value);
+            mStack.pushInt(res);
+          }
           break;
 
-        case Daedalus::EParOp_PushVar:
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_LessOrEqual:
           {
-            disassembleAndLogOpcode(opcode, "", "", "");
-          }
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs <= rhs ? 1 : 0;
+
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
 
-          pushVariable((bs::UINT32)opcode.symbol, 0);
+            mStack.pushInt(res);
+          }
           break;
 
-        case Daedalus::EParOp_PushInstance:
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_Equal:
           {
-            disassembleAndLogOpcode(opcode, "", "", "");
-          }
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs == rhs ? 1 : 0;
 
-          mStack.pushInstance((bs::UINT32)opcode.symbol);
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
+
+            mStack.pushInt(res);
+          }
           break;
 
-        case Daedalus::EParOp_PushArrayVar:
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_NotEqual:
           {
-            disassembleAndLogOpcode(opcode, "", "", "");
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs != rhs ? 1 : 0;
+
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
+
+            mStack.pushInt(res);
           }
+          break;
+
+          case Daedalus::EParOp_GreaterOrEqual:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 rhs = popIntValue();
+            bs::INT32 res = lhs >= rhs ? 1 : 0;
 
-          pushVariable((bs::UINT32)opcode.symbol, opcode.index);
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), bs::toString(rhs),
+                                      bs::toString(res));
+            }
+
+            mStack.pushInt(res);
+          }
           break;
 
-          // Assign
-          // ----------------------------------------------------------------------------------
+            // Unary
+            // -----------------------------------------------------------------------------------
 
-        case Daedalus::EParOp_AssignFunc:
-          // Function Pointes are pushed as intergers
+          case Daedalus::EParOp_Plus:
           {
-            SymbolIndex targetIndex = mStack.popFunction();
-            SymbolIndex sourceIndex = (SymbolIndex)popIntValue();
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 res = +lhs;
 
             if (mIsDisassemblerEnabled)
             {
-              disassembleAndLogOpcode(opcode, "", "", "");
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), "", bs::toString(res));
             }
 
-            auto& target = mScriptSymbols.getSymbol<SymbolScriptFunction>(targetIndex);
-
-            SymbolBase& sourceBase = mScriptSymbols.getSymbolBase(sourceIndex);
+            mStack.pushInt(res);
+          }
+          break;
 
-            bs::UINT32 sourceAddress;
+          case Daedalus::EParOp_Minus:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 res = -lhs;
 
-            if (sourceBase.type == SymbolType::ScriptFunction)
+            if (mIsDisassemblerEnabled)
             {
-              auto& sourceFunction = (SymbolScriptFunction&)sourceBase;
-              sourceAddress        = sourceFunction.address;
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), "", bs::toString(res));
             }
-            else if (sourceBase.type == SymbolType::Instance)
+
+            mStack.pushInt(res);
+          }
+          break;
+
+          case Daedalus::EParOp_Not:
+          {
+            bs::INT32 lhs = popIntValue();
+            bs::INT32 res = !lhs;
+
+            if (mIsDisassemblerEnabled)
             {
-              // Because deadalus' type safety isn't what it seems like, we need to handle this
-              // stupid edgecase of an instance being assigned to a function-pointer class variable.
-              // Specifically `C_ITEM.owner`, which is declared as `VAR FUNC owner` but is then
-              // given instances of class `C_NPC`.
-              //
-              // Since the original just seems to store the symbol index, not caring about the type,
-              // it works there. However, REGoth stores the function address, so we have to work
-              // around that by storing the instances constructor address. Let's just hope it will
-              // work...
-              //
-              // We could also add another type of symbol for function pointers, but then we have
-              // Symbols which *should* refer to functions, but sometimes refer to instances, which
-              // sucks as well.
-              auto& sourceInstance = (SymbolInstance&)sourceBase;
-              sourceAddress        = sourceInstance.constructorAddress;
+              disassembleAndLogOpcode(instruction, bs::toString(lhs), "", bs::toString(res));
             }
-            else
+
+            mStack.pushInt(res);
+          }
+          break;
+
+            // Stack
+            // -----------------------------------------------------------------------------------
+
+          case Daedalus::EParOp_PushInt:
+            if (mIsDisassemblerEnabled)
             {
-              REGOTH_THROW(InvalidParametersException,
-                           bs::StringUtil::format("Cannot get the address of symbol {0} of type {1}",
-                                                  sourceBase.name, (int)sourceBase.type));
+              disassembleAndLogOpcode(instruction, bs::toString((bs::INT32)instruction.operand));
             }
 
-            if (target.isClassVar)
+            mStack.pushInt((bs::INT32)instruction.operand);
+            break;
+
+          case Daedalus::EParOp_PushVar:
+            if (mIsDisassemblerEnabled)
             {
-              mClassVarResolver->resolveClassVariableFunctionPointer(target.name) = sourceAddress;
+              disassembleAndLogOpcode(instruction, "", "", "");
             }
-            else
+
+            pushVariable(instruction.operand, 0);
+            break;
+
+          case Daedalus::EParOp_PushInstance:
+            if (mIsDisassemblerEnabled)
             {
-              target.address = sourceAddress;
+              disassembleAndLogOpcode(instruction, "", "", "");
             }
-          }
-          break;
 
-        case Daedalus::EParOp_AssignString:
-        {
-          auto& lhs       = popStringReference();
-          const auto& rhs = popStringValue();
+            mStack.pushInstance(instruction.operand);
+            break;
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, rhs, lhs, "");
-          }
+          case Daedalus::EParOp_PushArrayVar:
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, "", "", "");
+            }
 
-          lhs = rhs;
-        }
+            pushVariable(instruction.operand, instruction.arrayIndex);
+            break;
 
-        break;
+            // Assign
+            // ----------------------------------------------------------------------------------
 
-        case Daedalus::EParOp_AssignFloat:
-        {
-          auto& lhs       = popFloatReference();
-          const auto& rhs = popFloatValue();
+          case Daedalus::EParOp_AssignFunc:
+            // Function Pointes are pushed as intergers
+            {
+              SymbolIndex targetIndex = mStack.popFunction();
+              SymbolIndex sourceIndex = (SymbolIndex)popIntValue();
+
+              if (mIsDisassemblerEnabled)
+              {
+                disassembleAndLogOpcode(instruction, "", "", "");
+              }
+
+              auto& target = mScriptSymbols.getSymbol<SymbolScriptFunction>(targetIndex);
+
+              SymbolBase& sourceBase = mScriptSymbols.getSymbolBase(sourceIndex);
+
+              bs::UINT32 sourceAddress;
+
+              if (sourceBase.type == SymbolType::ScriptFunction)
+              {
+                auto& sourceFunction = (SymbolScriptFunction&)sourceBase;
+                sourceAddress        = sourceFunction.address;
+              }
+              else if (sourceBase.type == SymbolType::Instance)
+              {
+                // Because deadalus' type safety isn't what it seems like, we need to handle this
+                // stupid edgecase of an instance being assigned to a function-pointer class
+                // variable. Specifically `C_ITEM.owner`, which is declared as `VAR FUNC owner`
+                // but is then given instances of class `C_NPC`.
+                //
+                // Since the original just seems to store the symbol index, not caring about the
+                // type, it works there. However, REGoth stores the function address, so we have
+                // to work around that by storing the instances constructor address. Let's just
+                // hope it will work...
+                //
+                // We could also add another type of symbol for function pointers, but then we
+                // have Symbols which *should* refer to functions, but sometimes refer to
+                // instances, which sucks as well.
+                auto& sourceInstance = (SymbolInstance&)sourceBase;
+                sourceAddress        = sourceInstance.constructorAddress;
+              }
+              else
+              {
+                REGOTH_THROW(
+                    InvalidParametersException,
+                    bs::StringUtil::format("Cannot get the address of symbol {0} of type {1}",
+                                           sourceBase.name, (int)sourceBase.type));
+              }
+
+              if (target.isClassVar)
+              {
+                mClassVarResolver->resolveClassVariableFunctionPointer(target) = sourceAddress;
+              }
+              else
+              {
+                target.address = sourceAddress;
+              }
+            }
+            break;
 
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_AssignString:
           {
-            disassembleAndLogOpcode(opcode, bs::toString(rhs), bs::toString(lhs), "");
+            auto& lhs       = popStringReference();
+            const auto& rhs = popStringValue();
+
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, rhs, lhs, "");
+            }
+
+            lhs = rhs;
           }
 
-          lhs = rhs;
-        }
-        break;
+          break;
 
-        case Daedalus::EParOp_AssignInstance:
-          // -
+          case Daedalus::EParOp_AssignFloat:
           {
-            SymbolIndex targetIndex = mStack.popInstance();
-            SymbolIndex sourceIndex = mStack.popInstance();
-
-            auto& target = mScriptSymbols.getSymbol<SymbolInstance>(targetIndex);
-            auto& source = mScriptSymbols.getSymbol<SymbolInstance>(sourceIndex);
+            auto& lhs       = popFloatReference();
+            const auto& rhs = popFloatValue();
 
             if (mIsDisassemblerEnabled)
             {
-              disassembleAndLogOpcode(opcode, target.name, source.name, "");
+              disassembleAndLogOpcode(instruction, bs::toString(rhs), bs::toString(lhs), "");
             }
 
-            target.instance = source.instance;
+            lhs = rhs;
           }
           break;
 
-        case Daedalus::EParOp_Assign:
-        {
-          auto& lhs       = popIntReference();
-          const auto& rhs = popIntValue();
+          case Daedalus::EParOp_AssignInstance:
+            // -
+            {
+              SymbolIndex targetIndex = mStack.popInstance();
+              SymbolIndex sourceIndex = mStack.popInstance();
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode);
-          }
+              auto& target = mScriptSymbols.getSymbol<SymbolInstance>(targetIndex);
+              auto& source = mScriptSymbols.getSymbol<SymbolInstance>(sourceIndex);
 
-          lhs = rhs;
-        }
-        break;
+              if (mIsDisassemblerEnabled)
+              {
+                disassembleAndLogOpcode(instruction, target.name, source.name, "");
+              }
 
-        case Daedalus::EParOp_AssignAdd:
-        {
-          auto& lhs       = popIntReference();
-          const auto& rhs = popIntValue();
-          auto res        = lhs + rhs;
+              target.instance = source.instance;
+            }
+            break;
 
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_Assign:
           {
-            disassembleAndLogOpcode(opcode);
-          }
+            auto& lhs       = popIntReference();
+            const auto& rhs = popIntValue();
 
-          lhs = res;
-        }
-        break;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction);
+            }
 
-        case Daedalus::EParOp_AssignSubtract:
-        {
-          auto& lhs       = popIntReference();
-          const auto& rhs = popIntValue();
-          auto res        = lhs - rhs;
+            lhs = rhs;
+          }
+          break;
 
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_AssignAdd:
           {
-            disassembleAndLogOpcode(opcode);
-          }
+            auto& lhs       = popIntReference();
+            const auto& rhs = popIntValue();
+            auto res        = lhs + rhs;
 
-          lhs = res;
-        }
-        break;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction);
+            }
 
-        case Daedalus::EParOp_AssignMultiply:
-        {
-          auto& lhs       = popIntReference();
-          const auto& rhs = popIntValue();
-          auto res        = lhs * rhs;
+            lhs = res;
+          }
+          break;
 
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_AssignSubtract:
           {
-            disassembleAndLogOpcode(opcode);
-          }
+            auto& lhs       = popIntReference();
+            const auto& rhs = popIntValue();
+            auto res        = lhs - rhs;
 
-          lhs = res;
-        }
-        break;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction);
+            }
 
-        case Daedalus::EParOp_AssignDivide:
-        {
-          auto& lhs       = popIntReference();
-          const auto& rhs = popIntValue();
-          auto res        = lhs / rhs;
+            lhs = res;
+          }
+          break;
 
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_AssignMultiply:
           {
-            disassembleAndLogOpcode(opcode);
-          }
+            auto& lhs       = popIntReference();
+            const auto& rhs = popIntValue();
+            auto res        = lhs * rhs;
 
-          lhs = res;
-        }
-        break;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction);
+            }
 
-        case Daedalus::EParOp_AssignStringRef:
-          REGOTH_THROW(NotImplementedException, "AssignStringRef is not implemented.");
+            lhs = res;
+          }
           break;
 
-          // Control flow
-          // ----------------------------------------------------------------------------
-
-        case Daedalus::EParOp_Ret:
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_AssignDivide:
           {
-            disassembleAndLogOpcode(opcode);
-          }
+            auto& lhs       = popIntReference();
+            const auto& rhs = popIntValue();
+            auto res        = lhs / rhs;
 
-          // Script function Ends here!
-          return false;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction);
+            }
 
-        case Daedalus::EParOp_Jump:
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode);
+            lhs = res;
           }
-
-          mPC = (bs::UINT32)opcode.address;
           break;
 
-        case Daedalus::EParOp_JumpIf:
-        {
-          bs::UINT32 lhs = popIntValue();
+          case Daedalus::EParOp_AssignStringRef:
+            REGOTH_THROW(NotImplementedException, "AssignStringRef is not implemented.");
+            break;
 
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode, bs::toString(lhs));
-          }
+            // Control flow
+            // ----------------------------------------------------------------------------
 
-          // Jump if value on stack is 0
-          if (!lhs)
-          {
-            mPC = (bs::UINT32)opcode.address;
-          }
-        }
-        break;
+          case Daedalus::EParOp_Ret:
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction);
+            }
 
-        case Daedalus::EParOp_Call:
-        {
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode);
-          }
+            // Script function Ends here!
+            return;
 
-          // Save some of this functions state and execute the whole sub-function
-          SymbolIndex currentInstance = mClassVarResolver->getCurrentInstance();
-          bs::UINT32 pc               = mPC;
+          case Daedalus::EParOp_Jump:
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction);
+            }
 
-          mPC = (bs::UINT32)opcode.address;
-          mCallDepth += 1;
+            mPC = instruction.operand;
+            break;
 
-          executeUntilReturn();
+          case Daedalus::EParOp_JumpIf:
+          {
+            bs::UINT32 lhs = popIntValue();
 
-          mCallDepth -= 1;
-          mPC = pc;
-          mClassVarResolver->setCurrentInstance(currentInstance);
-        }
-        break;
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction, bs::toString(lhs));
+            }
 
-        case Daedalus::EParOp_CallExternal:
-        {
-          if (mIsDisassemblerEnabled)
-          {
-            disassembleAndLogOpcode(opcode);
+            // Jump if value on stack is 0
+            if (!lhs)
+            {
+              mPC = instruction.operand;
+            }
           }
+          break;
 
-          auto it = mExternals.find(opcode.symbol);
-
-          if (it != mExternals.end())
+          case Daedalus::EParOp_Call:
           {
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction);
+            }
+
+            // Save some of this functions state and execute the whole sub-function
             SymbolIndex currentInstance = mClassVarResolver->getCurrentInstance();
             bs::UINT32 pc               = mPC;
+
+            mPC = instruction.operand;
             mCallDepth += 1;
 
-            (this->*it->second)();
+            executeUntilReturn();
 
             mCallDepth -= 1;
             mPC = pc;
             mClassVarResolver->setCurrentInstance(currentInstance);
           }
-          else
+          break;
+
+          case Daedalus::EParOp_CallExternal:
           {
-            auto& sym = mScriptSymbols.getSymbol<SymbolExternalFunction>(opcode.symbol);
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction);
+            }
 
-            // REGOTH_LOG(Info, Uncategorized, "[REGothDaedalusVM] External not implemented: " + sym.name);
+            auto it = mExternals.find(instruction.operand);
 
-            // Put a dummy value onto the stack to get deterministic results
-            switch (sym.returnType)
+            if (it != mExternals.end())
             {
-              case ReturnType::Int:
-                mStack.pushInt(0);
-                break;
-              case ReturnType::Float:
-                mStack.pushFloat(0.0f);
-                break;
-              case ReturnType::String:
-                mStack.pushString("");
-                break;
-              case ReturnType::Invalid:
-              case ReturnType::Void:
-                break;
-            }
+              SymbolIndex currentInstance = mClassVarResolver->getCurrentInstance();
+              bs::UINT32 pc               = mPC;
+              mCallDepth += 1;
 
-            // REGOTH_THROW(
-            //     NotImplementedException,
-            //     "External not implemented: " +
-            //     mScriptSymbols.getSymbolBase(opcode.symbol).name);
+              (this->*it->second)();
+
+              mCallDepth -= 1;
+              mPC = pc;
+              mClassVarResolver->setCurrentInstance(currentInstance);
+            }
+            else
+            {
+              auto& sym = mScriptSymbols.getSymbol<SymbolExternalFunction>(instruction.operand);
+
+              // REGOTH_LOG(Info, Uncategorized,
+              //            "[REGothDaedalusVM] External not implemented: " + sym.name);
+
+              // Put a dummy value onto the stack to get deterministic results
+              switch (sym.returnType)
+              {
+                case ReturnType::Int:
+                  mStack.pushInt(0);
+                  break;
+                case ReturnType::Float:
+                  mStack.pushFloat(0.0f);
+                  break;
+                case ReturnType::String:
+                  mStack.pushEmptyString();
+                  break;
+                case ReturnType::Invalid:
+                case ReturnType::Void:
+                  break;
+              }
+
+              // REGOTH_THROW(
+              //     NotImplementedException,
+              //     "External not implemented: " +
+              //     mScriptSymbols.getSymbolBase(instruction.operand).name);
+            }
           }
-        }
-        break;
+          break;
 
-          // Other
-          // -----------------------------------------------------------------------------------
+            // Other
+            // -----------------------------------------------------------------------------------
 
-        case Daedalus::EParOp_SetInstance:
-        {
-          if (mIsDisassemblerEnabled)
+          case Daedalus::EParOp_SetInstance:
           {
-            disassembleAndLogOpcode(opcode);
+            if (mIsDisassemblerEnabled)
+            {
+              disassembleAndLogOpcode(instruction);
+            }
+
+            const SymbolInstance& instance =
+                mScriptSymbols.getSymbol<SymbolInstance>(instruction.operand);
+            mClassVarResolver->setCurrentInstance(instance.instance);
           }
+          break;
 
-          const SymbolInstance& instance = mScriptSymbols.getSymbol<SymbolInstance>(opcode.symbol);
-          mClassVarResolver->setCurrentInstance(instance.instance);
+          default:
+            REGOTH_THROW(InvalidParametersException,
+                         "Unsupported or invalid opcode: " + bs::toString((bs::UINT32)instruction.op));
+            break;
         }
-        break;
-
-        default:
-          REGOTH_THROW(InvalidParametersException,
-                       "Unsupported or invalid opcode: " + bs::toString(opcode.op));
-          break;
       }
-
-      // Script function hasn't returned yes, keep going.
-      // See RET-Instruction for `return false`.
-      return true;
     }
 
     bs::INT32 DaedalusVM::popIntValue()
@@ -839,7 +977,7 @@ namespace REGoth
       }
     }
 
-    bs::String DaedalusVM::popStringValue()
+    const bs::String& DaedalusVM::popStringValue()
     {
       if (mStack.isTopOfStringStackVariable())
       {
@@ -874,7 +1012,7 @@ namespace REGoth
       {
         if (symbol.isClassVar)
         {
-          ScriptInts& ints = mClassVarResolver->resolveClassVariableInts(symbol.name);
+          ScriptInts& ints = mClassVarResolver->resolveClassVariableInts(symbol);
 
           if (var.arrayIndex >= ints.size())
           {
@@ -917,7 +1055,7 @@ namespace REGoth
       {
         if (symbol.isClassVar)
         {
-          ScriptFloats& floats = mClassVarResolver->resolveClassVariableFloats(symbol.name);
+          ScriptFloats& floats = mClassVarResolver->resolveClassVariableFloats(symbol);
 
           if (var.arrayIndex >= floats.size())
           {
@@ -960,7 +1098,7 @@ namespace REGoth
       {
         if (symbol.isClassVar)
         {
-          ScriptStrings& strings = mClassVarResolver->resolveClassVariableStrings(symbol.name);
+          ScriptStrings& strings = mClassVarResolver->resolveClassVariableStrings(symbol);
 
           if (var.arrayIndex >= strings.size())
           {
@@ -1026,10 +1164,20 @@ namespace REGoth
       mExternals[symbol] = callback;
     }
 
-    void DaedalusVM::disassembleAndLogOpcode(const Daedalus::PARStackOpCode& opcode,
+    void DaedalusVM::disassembleAndLogOpcode(const DaedalusInstruction& instruction,
                                              const bs::String& lhs, const bs::String& rhs,
                                              const bs::String& res)
     {
+      if (instruction.isSynthetic)
+      {
+        // Not in the bytecode, so there is nothing to disassemble
+        return;
+      }
+
+      // Only the decoded instruction is kept around, so get the original one again. This is
+      // slow, but only done when the disassembler is enabled.
+      Daedalus::PARStackOpCode opcode = mDatFile->getStackOpCode(instruction.address);
+
       REGOTH_LOG(Info, Uncategorized,
              bs::StringUtil::format("[DaedalusVM] Exec: {0}{1}", makeCallDepthString(mCallDepth),
                                     disassembleOpcode(opcode, mScriptSymbols, lhs, rhs, res)));
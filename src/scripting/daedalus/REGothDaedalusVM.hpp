@@ -1,6 +1,7 @@
 /**\file
  */
 #pragma once
+#include "DaedalusBytecode.hpp"
 #include "DaedalusStack.hpp"
 #include <BsPrerequisites.h>
 #include <scripting/ScriptVM.hpp>
@@ -8,7 +9,6 @@
 namespace Daedalus
 {
   class DATFile;
-  class PARStackOpCode;
 }  // namespace Daedalus
 
 namespace REGoth
@@ -20,7 +20,60 @@ namespace REGoth
     class DaedalusVM : public ScriptVM
     {
     public:
-      DaedalusVM(const bs::Vector<bs::UINT8>& datFileData);
+      DaedalusVM(bs::Vector<bs::UINT8> datFileData);
+
+      /**
+       * @return How many instructions have been executed by this VM so far.
+       */
+      bs::UINT64 numExecutedInstructions() const
+      {
+        return mNumExecutedInstructions;
+      }
+
+#ifdef REGOTH_SCRIPT_BENCHMARK_BASELINE
+      /**
+       * Makes the VM decode every instruction from the DAT-file again before executing it,
+       * like it did before the bytecode was decoded up front. Only meant as a baseline for
+       * benchmarking, so it is only there in builds configured with
+       * `REGOTH_SCRIPT_BENCHMARK_BASELINE`.
+       */
+      void setDecodeEachInstruction(bool decodeEachInstruction)
+      {
+        mIsDecodingEachInstruction = decodeEachInstruction;
+      }
+
+      /**
+       * See DaedalusStack::setReuseTemporaryStrings().
+       */
+      void setReuseTemporaryStrings(bool reuseTemporaryStrings)
+      {
+        mStack.setReuseTemporaryStrings(reuseTemporaryStrings);
+      }
+#endif
+
+      /**
+       * Collects the externals which might be called when running the given script
+       * function, either directly or by the script functions it calls.
+       *
+       * @param  function       Script function to look at.
+       * @param  usesInstances  Set to whether any of that code accesses instances or
+       *                        their member variables.
+       *
+       * @return Symbols of the externals found, in no particular order.
+       */
+      bs::Vector<SymbolIndex> findReachableExternals(SymbolIndex function, bool& usesInstances);
+
+      /**
+       * Sets which script functions should have their disassembly logged. Only affects
+       * VMs which load their symbols afterwards.
+       *
+       * @param  functionsToTrace  Names of the functions to log, UPPERCASE. Functions called
+       *                           by these are logged as well.
+       * @param  functionsToHide   Names of the functions to never log, UPPERCASE, even if
+       *                           called by a traced function.
+       */
+      static void setTraceFilter(const bs::Vector<bs::String>& functionsToTrace,
+                                 const bs::Vector<bs::String>& functionsToHide);
 
     protected:
       /**
@@ -42,15 +95,13 @@ namespace REGoth
       void executeScriptFunction(bs::UINT32 address);
 
       /**
-       * Runs the instruction found at the Program Counter and modifies it.
+       * Runs the instructions starting at the Program Counter until a Return-statement
+       * has been executed.
        *
        * @note If this encounteres a CALL-instruction, it will execute the
        *       whole sub-function.
-       *
-       * @return Whether the script function is not over yet. If this returns
-       *         `false` then a Return-statement has been executed.
        */
-      bool executeInstructionAtPC();
+      void executeInstructionsUntilReturn();
 
       /**
        * Runs from the current PC until the function it is in returned.
@@ -73,10 +124,13 @@ namespace REGoth
 
       /**
        * Pops an value from the stack. Also resolves variables.
+       *
+       * Strings are only referenced. The reference stays valid until the outermost
+       * script function returned, unless the variable it comes from is modified.
        */
       bs::INT32 popIntValue();
       float popFloatValue();
-      bs::String popStringValue();
+      const bs::String& popStringValue();
       ScriptObjectHandle popInstanceScriptObject();
 
       /**
@@ -129,21 +183,38 @@ namespace REGoth
        */
       bool mIsDisassemblerEnabled = false;
 
+#ifdef REGOTH_SCRIPT_BENCHMARK_BASELINE
+      /**
+       * See setDecodeEachInstruction().
+       */
+      bool mIsDecodingEachInstruction = false;
+#endif
+
     private:
       /**
-       * Whether the disassembler should be turned on for the given function.
+       * What to do with the disassembler when entering a function.
+       */
+      enum FunctionTraceFlag : bs::UINT8
+      {
+        FUNCTION_TRACE_ENABLE = 1 << 0,
+        FUNCTION_TRACE_HIDE   = 1 << 1,
+      };
+
+      /**
+       * Fills mFunctionTraceFlags from the functions passed to setTraceFilter().
        */
-      bool shouldEnableDisassemblerForFunction(const bs::String& uppercaseName) const;
+      void buildFunctionTraceFlags();
 
       /**
-       * Whether to hide the given function in the disassembler, it it is active.
+       * Turns the disassembler on or off, depending on the trace flags of the function
+       * starting at the given bytecode address.
        */
-      bool shouldHideFunctionInDisassembly(const bs::String& uppercaseName) const;
+      void applyFunctionTraceFlags(bs::UINT32 address);
 
       /**
        * Disassembles and logs the given opcode in respect ti the call-depth.
        */
-      void disassembleAndLogOpcode(const Daedalus::PARStackOpCode& opcode,
+      void disassembleAndLogOpcode(const DaedalusInstruction& instruction,
                                    const bs::String& lhs = "", const bs::String& rhs = "",
                                    const bs::String& res = "");
 
@@ -153,10 +224,15 @@ namespace REGoth
       void findFunctionAtAddressAndLog(bs::UINT32 address);
 
       /**
-       * Program counter register
+       * Program counter register. Index of the next instruction inside mBytecode.
        */
       bs::UINT32 mPC = 0;
 
+      /**
+       * Counts every executed instruction, see numExecutedInstructions().
+       */
+      bs::UINT64 mNumExecutedInstructions = 0;
+
       /**
        * Function nesting counter.
        */
@@ -164,11 +240,20 @@ namespace REGoth
 
       bs::SPtr<Daedalus::DATFile> mDatFile;
 
+      // Instructions decoded from mDatFile, this is what actually gets executed
+      DaedalusBytecode mBytecode;
+
       // The whole DAT-file, for serialization
       bs::Vector<bs::UINT8> mDatFileData;
 
       bs::Map<SymbolIndex, externalCallback> mExternals;
 
+      /**
+       * FunctionTraceFlags for each symbol, by symbol index. Empty if no function is to be
+       * traced, so calling a function doesn't need to look up anything.
+       */
+      bs::Vector<bs::UINT8> mFunctionTraceFlags;
+
     public:
       // Remember, this is abstract, so don't create an rttiCreateEmpty()
       REGOTH_DECLARE_RTTI(DaedalusVM);
@@ -0,0 +1,132 @@
+#include "KDTree.hpp"
+#include <algorithm>
+
+namespace REGoth
+{
+  void KDTree::build(const bs::Vector<bs::Vector3>& points)
+  {
+    mNodes.clear();
+    mNodes.reserve(points.size());
+
+    for (bs::UINT32 i = 0; i < (bs::UINT32)points.size(); i++)
+    {
+      mNodes.push_back(Node{points[i], i, 0});
+    }
+
+    buildRange(0, (bs::UINT32)mNodes.size());
+  }
+
+  void KDTree::build(const bs::Vector<bs::Vector3>& points, const bs::Vector<bs::UINT32>& indices)
+  {
+    mNodes.clear();
+    mNodes.reserve(indices.size());
+
+    for (bs::UINT32 i : indices)
+    {
+      mNodes.push_back(Node{points[i], i, 0});
+    }
+
+    buildRange(0, (bs::UINT32)mNodes.size());
+  }
+
+  void KDTree::buildRange(bs::UINT32 begin, bs::UINT32 end)
+  {
+    if (end - begin < 2) return;
+
+    bs::Vector3 min = mNodes[begin].position;
+    bs::Vector3 max = mNodes[begin].position;
+
+    for (bs::UINT32 i = begin + 1; i < end; i++)
+    {
+      min = bs::Vector3::min(min, mNodes[i].position);
+      max = bs::Vector3::max(max, mNodes[i].position);
+    }
+
+    bs::Vector3 extent = max - min;
+
+    bs::UINT32 axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    bs::UINT32 middle = begin + (end - begin) / 2;
+
+    std::nth_element(mNodes.begin() + begin, mNodes.begin() + middle, mNodes.begin() + end,
+                     [axis](const Node& a, const Node& b) {
+                       return a.position[axis] < b.position[axis];
+                     });
+
+    mNodes[middle].splitAxis = axis;
+
+    buildRange(begin, middle);
+    buildRange(middle + 1, end);
+  }
+
+  KDTree::TwoNearest KDTree::findTwoNearest(const bs::Vector3& location) const
+  {
+    SearchState state;
+
+    searchRange(0, (bs::UINT32)mNodes.size(), location, state);
+
+    return state.result;
+  }
+
+  void KDTree::searchRange(bs::UINT32 begin, bs::UINT32 end, const bs::Vector3& location,
+                           SearchState& state) const
+  {
+    if (begin >= end) return;
+
+    bs::UINT32 middle = begin + (end - begin) / 2;
+    const Node& node  = mNodes[middle];
+
+    float distanceSq = location.squaredDistance(node.position);
+
+    // Ties go to the lower index, like they would on a linear search
+    auto isCloser = [&](float distanceA, bs::UINT32 indexA, float distanceB, bs::UINT32 indexB) {
+      return distanceA < distanceB || (distanceA == distanceB && indexA < indexB);
+    };
+
+    if (isCloser(distanceSq, node.index, state.nearestDistanceSq, state.result.nearest))
+    {
+      state.secondNearestDistanceSq = state.nearestDistanceSq;
+      state.result.secondNearest    = state.result.nearest;
+
+      state.nearestDistanceSq = distanceSq;
+      state.result.nearest    = node.index;
+    }
+    else if (isCloser(distanceSq, node.index, state.secondNearestDistanceSq,
+                      state.result.secondNearest))
+    {
+      state.secondNearestDistanceSq = distanceSq;
+      state.result.secondNearest    = node.index;
+    }
+
+    if (end - begin == 1) return;
+
+    float distanceToSplit = location[node.splitAxis] - node.position[node.splitAxis];
+
+    bool isLocationBeforeSplit = distanceToSplit < 0.0f;
+
+    if (isLocationBeforeSplit)
+    {
+      searchRange(begin, middle, location, state);
+    }
+    else
+    {
+      searchRange(middle + 1, end, location, state);
+    }
+
+    // The other side can only hold something closer if the splitting plane is closer
+    // than the second nearest point found so far.
+    if (distanceToSplit * distanceToSplit <= state.secondNearestDistanceSq)
+    {
+      if (isLocationBeforeSplit)
+      {
+        searchRange(middle + 1, end, location, state);
+      }
+      else
+      {
+        searchRange(begin, middle, location, state);
+      }
+    }
+  }
+}  // namespace REGoth
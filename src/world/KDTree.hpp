@@ -0,0 +1,105 @@
+#pragma once
+#include <limits>
+#include <BsPrerequisites.h>
+#include <Math/BsVector3.h>
+
+namespace REGoth
+{
+  /**
+   * Static k-d tree over a set of points, used to quickly find the points
+   * closest to a given location.
+   *
+   * The tree does not store the points themselves but refers to them by their
+   * index into the list of points it was built from, so it can be used as an
+   * acceleration structure next to an already existing list, like the cached
+   * waypoint positions of the Waynet. It can also be built over only a subset
+   * of that list, without changing the indices reported by the queries.
+   *
+   * Once built, the tree cannot be modified. If the points change, it has to be
+   * built again, which is an `O(n log n)`-operation.
+   *
+   * Searches are `O(log n)` on average. If multiple points have the same distance
+   * to the searched location, the one with the lower index is reported first, so
+   * the result matches what a linear search over the list would give.
+   */
+  class KDTree
+  {
+  public:
+    /**
+     * Index reported when there is no such point.
+     */
+    static constexpr bs::UINT32 NO_POINT = 0xFFFFFFFF;
+
+    struct TwoNearest
+    {
+      /**
+       * Index of the point nearest to the searched location.
+       */
+      bs::UINT32 nearest = NO_POINT;
+
+      /**
+       * Index of the point second nearest to the searched location. Never the same
+       * as `nearest`, so this is `NO_POINT` if the tree holds only a single point.
+       */
+      bs::UINT32 secondNearest = NO_POINT;
+    };
+
+    /**
+     * Builds the tree over all of the given points.
+     *
+     * Will drop anything already in the tree and thus can be called multiple times.
+     */
+    void build(const bs::Vector<bs::Vector3>& points);
+
+    /**
+     * Builds the tree over only the points with the given indices.
+     *
+     * Will drop anything already in the tree and thus can be called multiple times.
+     */
+    void build(const bs::Vector<bs::Vector3>& points, const bs::Vector<bs::UINT32>& indices);
+
+    /**
+     * Searches the point nearest and second nearest to the given location.
+     */
+    TwoNearest findTwoNearest(const bs::Vector3& location) const;
+
+    /**
+     * @return Whether there are no points in this tree.
+     */
+    bool isEmpty() const
+    {
+      return mNodes.empty();
+    }
+
+  private:
+    struct Node
+    {
+      bs::Vector3 position;
+      bs::UINT32 index;
+      bs::UINT32 splitAxis;
+    };
+
+    /**
+     * Sorts the nodes in range [begin, end) so that the one in the middle splits the
+     * others along the axis in which the range has its largest extent. Then goes on
+     * with both halves.
+     */
+    void buildRange(bs::UINT32 begin, bs::UINT32 end);
+
+    struct SearchState
+    {
+      TwoNearest result;
+      float nearestDistanceSq       = std::numeric_limits<float>::max();
+      float secondNearestDistanceSq = std::numeric_limits<float>::max();
+    };
+
+    void searchRange(bs::UINT32 begin, bs::UINT32 end, const bs::Vector3& location,
+                     SearchState& state) const;
+
+    /**
+     * Implicit binary tree: The node in the middle of a range is the root of that range,
+     * the ones before and after it make up its two subtrees.
+     */
+    bs::Vector<Node> mNodes;
+  };
+}  // namespace REGoth
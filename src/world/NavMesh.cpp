@@ -0,0 +1,965 @@
+#include "NavMesh.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <BsZenLib/ImportPath.hpp>
+#include <FileSystem/BsDataStream.h>
+#include <FileSystem/BsFileSystem.h>
+#include <log/logging.hpp>
+
+namespace REGoth
+{
+  /**
+   * Written at the start of saved navmeshes. Bump the version whenever the layout or the
+   * way of baking changes.
+   */
+  static constexpr bs::UINT32 NAVMESH_MAGIC   = 0x484D564E;  // "NVMH"
+  static constexpr bs::UINT32 NAVMESH_VERSION = 2;
+
+  /**
+   * Size of a cell on the XZ-plane, in meters. Doubled until the grid has at most
+   * MAX_NUM_CELLS cells, to keep the memory in check on huge worlds.
+   */
+  static const float CELL_SIZE              = 0.5f;
+  static constexpr bs::UINT64 MAX_NUM_CELLS = 16 * 1024 * 1024;
+
+  /**
+   * Cell offsets of the directions, in the order of NavMesh::Direction.
+   */
+  static const bs::INT32 DIRECTION_X[] = {1, 0, -1, 0};
+  static const bs::INT32 DIRECTION_Z[] = {0, 1, 0, -1};
+
+  /**
+   * Marks the end of a span list inside the heightfield.
+   */
+  static constexpr bs::UINT32 NO_HEIGHTFIELD_SPAN = 0xFFFFFFFF;
+
+  /**
+   * Maximum number of vertices a triangle can have after being clipped to a cell.
+   */
+  static constexpr int MAX_CLIPPED_VERTICES = 12;
+
+  constexpr bs::UINT32 NavMesh::NO_SPAN;
+  constexpr bs::UINT64 NavMesh::ANY_WORLD_MESH;
+  constexpr bs::UINT8 NavMesh::NO_LINK;
+
+  struct NavMeshFileHeader
+  {
+    bs::UINT32 magic;
+    bs::UINT32 version;
+    bs::UINT64 worldMeshHash;
+    float agentHeight;
+    float agentRadius;
+    float agentStepHeight;
+    float agentMaxSlopeAngle;
+    float originX;
+    float originY;
+    float originZ;
+    float cellSize;
+    bs::UINT32 numCellsX;
+    bs::UINT32 numCellsZ;
+    bs::UINT32 numSpans;
+  };
+
+  /**
+   * Solid height range inside a cell of the heightfield. The spans of a cell form a linked
+   * list sorted from bottom to top, without overlaps.
+   */
+  struct HeightfieldSpan
+  {
+    float min;
+    float max;
+    bool isWalkable;
+    bs::UINT32 next;
+  };
+
+  /**
+   * Rasterized world mesh, only used while baking.
+   */
+  struct Heightfield
+  {
+    bs::Vector3 origin;
+    float cellSize;
+    bs::UINT32 numCellsX;
+    bs::UINT32 numCellsZ;
+
+    /**
+     * Span at the bottom of each cell, NO_HEIGHTFIELD_SPAN if empty.
+     */
+    bs::Vector<bs::UINT32> cellBottoms;
+    bs::Vector<HeightfieldSpan> spans;
+    bs::UINT32 firstFreeSpan = NO_HEIGHTFIELD_SPAN;
+
+    /**
+     * Adds a solid range to the given cell, merging it with all ranges it overlaps.
+     *
+     * When merged, the top of the range decides whether it is walkable. If both tops are
+     * within `mergeThreshold`, it's walkable if either of them is.
+     */
+    void addSpan(bs::UINT32 cell, float min, float max, bool isWalkable, float mergeThreshold);
+  };
+
+  void Heightfield::addSpan(bs::UINT32 cell, float min, float max, bool isWalkable,
+                            float mergeThreshold)
+  {
+    bs::UINT32 previous = NO_HEIGHTFIELD_SPAN;
+    bs::UINT32 current  = cellBottoms[cell];
+
+    while (current != NO_HEIGHTFIELD_SPAN)
+    {
+      HeightfieldSpan& other = spans[current];
+
+      // Ranges are sorted, so nothing further up can overlap
+      if (other.min > max) break;
+
+      if (other.max < min)
+      {
+        previous = current;
+        current  = other.next;
+        continue;
+      }
+
+      // Overlapping, merge the other one into the new one and remove it
+      if (std::fabs(other.max - max) <= mergeThreshold)
+      {
+        isWalkable = isWalkable || other.isWalkable;
+      }
+      else if (other.max > max)
+      {
+        isWalkable = other.isWalkable;
+      }
+
+      min = std::min(min, other.min);
+      max = std::max(max, other.max);
+
+      bs::UINT32 next = other.next;
+
+      other.next    = firstFreeSpan;
+      firstFreeSpan = current;
+
+      if (previous == NO_HEIGHTFIELD_SPAN)
+      {
+        cellBottoms[cell] = next;
+      }
+      else
+      {
+        spans[previous].next = next;
+      }
+
+      current = next;
+    }
+
+    bs::UINT32 added;
+
+    if (firstFreeSpan != NO_HEIGHTFIELD_SPAN)
+    {
+      added         = firstFreeSpan;
+      firstFreeSpan = spans[added].next;
+    }
+    else
+    {
+      added = (bs::UINT32)spans.size();
+      spans.emplace_back();
+    }
+
+    spans[added] = {min, max, isWalkable, current};
+
+    if (previous == NO_HEIGHTFIELD_SPAN)
+    {
+      cellBottoms[cell] = added;
+    }
+    else
+    {
+      spans[previous].next = added;
+    }
+  }
+
+  /**
+   * Splits a convex polygon at the plane where the coordinate on the given axis equals
+   * `value`, into the part below and the part above.
+   */
+  static void dividePolygon(const bs::Vector3* polygon, int numVertices, float value,
+                            bs::UINT32 axis, bs::Vector3* below, int& numBelow,
+                            bs::Vector3* above, int& numAbove)
+  {
+    float distances[MAX_CLIPPED_VERTICES];
+
+    for (int i = 0; i < numVertices; i++)
+    {
+      distances[i] = value - polygon[i][axis];
+    }
+
+    numBelow = 0;
+    numAbove = 0;
+
+    for (int i = 0, j = numVertices - 1; i < numVertices; j = i, i++)
+    {
+      bool isPreviousBelow = distances[j] >= 0;
+      bool isCurrentBelow  = distances[i] >= 0;
+
+      if (isPreviousBelow != isCurrentBelow)
+      {
+        // Edge crosses the plane
+        float s = distances[j] / (distances[j] - distances[i]);
+
+        bs::Vector3 intersection = polygon[j] + (polygon[i] - polygon[j]) * s;
+
+        below[numBelow++] = intersection;
+        above[numAbove++] = intersection;
+
+        if (distances[i] > 0)
+        {
+          below[numBelow++] = polygon[i];
+        }
+        else if (distances[i] < 0)
+        {
+          above[numAbove++] = polygon[i];
+        }
+      }
+      else
+      {
+        if (distances[i] >= 0)
+        {
+          below[numBelow++] = polygon[i];
+
+          if (distances[i] != 0) continue;
+        }
+
+        above[numAbove++] = polygon[i];
+      }
+    }
+  }
+
+  /**
+   * Adds the height range the triangle covers inside each cell it touches to the heightfield.
+   */
+  static void rasterizeTriangle(Heightfield& heightfield, const bs::Vector3& a,
+                                const bs::Vector3& b, const bs::Vector3& c, bool isWalkable,
+                                float mergeThreshold)
+  {
+    const float cellSize = heightfield.cellSize;
+    const float minZ     = std::min(a.z, std::min(b.z, c.z));
+    const float maxZ     = std::max(a.z, std::max(b.z, c.z));
+
+    bs::INT32 z0 = (bs::INT32)std::floor((minZ - heightfield.origin.z) / cellSize);
+    bs::INT32 z1 = (bs::INT32)std::floor((maxZ - heightfield.origin.z) / cellSize);
+
+    z0 = std::max(z0, 0);
+    z1 = std::min(z1, (bs::INT32)heightfield.numCellsZ - 1);
+
+    bs::Vector3 buffers[4][MAX_CLIPPED_VERTICES];
+
+    bs::Vector3* remaining = buffers[0];
+    bs::Vector3* row       = buffers[1];
+    bs::Vector3* cell      = buffers[2];
+    bs::Vector3* rowRest   = buffers[3];
+
+    int numRemaining = 3;
+    remaining[0]     = a;
+    remaining[1]     = b;
+    remaining[2]     = c;
+
+    // Cut the triangle into rows, then each row into cells. The grid covers all vertices,
+    // so there is nothing in front of the first row or cell.
+    for (bs::INT32 z = z0; z <= z1 && numRemaining >= 3; z++)
+    {
+      int numRow;
+      float rowEnd = heightfield.origin.z + (z + 1) * cellSize;
+
+      dividePolygon(remaining, numRemaining, rowEnd, 2, row, numRow, rowRest, numRemaining);
+      std::swap(remaining, rowRest);
+
+      if (numRow < 3) continue;
+
+      float minX = row[0].x;
+      float maxX = row[0].x;
+
+      for (int i = 1; i < numRow; i++)
+      {
+        minX = std::min(minX, row[i].x);
+        maxX = std::max(maxX, row[i].x);
+      }
+
+      bs::INT32 x0 = (bs::INT32)std::floor((minX - heightfield.origin.x) / cellSize);
+      bs::INT32 x1 = (bs::INT32)std::floor((maxX - heightfield.origin.x) / cellSize);
+
+      x0 = std::max(x0, 0);
+      x1 = std::min(x1, (bs::INT32)heightfield.numCellsX - 1);
+
+      for (bs::INT32 x = x0; x <= x1 && numRow >= 3; x++)
+      {
+        int numCell;
+        float cellEnd = heightfield.origin.x + (x + 1) * cellSize;
+
+        dividePolygon(row, numRow, cellEnd, 0, cell, numCell, rowRest, numRow);
+        std::swap(row, rowRest);
+
+        if (numCell < 3) continue;
+
+        float minY = cell[0].y;
+        float maxY = cell[0].y;
+
+        for (int i = 1; i < numCell; i++)
+        {
+          minY = std::min(minY, cell[i].y);
+          maxY = std::max(maxY, cell[i].y);
+        }
+
+        bs::UINT32 cellIndex = (bs::UINT32)z * heightfield.numCellsX + (bs::UINT32)x;
+
+        heightfield.addSpan(cellIndex, minY, maxY, isWalkable, mergeThreshold);
+      }
+    }
+  }
+
+  static bool isSameAgent(const NavMeshFileHeader& header, const NavMesh::AgentConfiguration& agent)
+  {
+    return header.agentHeight == agent.height && header.agentRadius == agent.radius &&
+           header.agentStepHeight == agent.stepHeight &&
+           header.agentMaxSlopeAngle == agent.maxSlopeAngle;
+  }
+
+  void NavMesh::bake(const bs::Vector<bs::Vector3>& vertices, const bs::Vector<bs::UINT32>& indices,
+                     const AgentConfiguration& agent)
+  {
+    clear();
+
+    mAgent = agent;
+
+    if (vertices.empty() || indices.size() < 3) return;
+
+    setupGrid(vertices);
+
+    const bs::UINT32 numCells = mNumCellsX * mNumCellsZ;
+
+    Heightfield heightfield;
+    heightfield.origin    = mOrigin;
+    heightfield.cellSize  = mCellSize;
+    heightfield.numCellsX = mNumCellsX;
+    heightfield.numCellsZ = mNumCellsZ;
+    heightfield.cellBottoms.resize(numCells, NO_HEIGHTFIELD_SPAN);
+
+    // Winding order of the world mesh can't be relied on, so surfaces facing down count as
+    // walkable too. Those are mostly undersides of something, which don't have enough room
+    // above them or cannot be reached anyways.
+    const float minWalkableNormalY = std::cos(agent.maxSlopeAngle);
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+      const bs::Vector3& a = vertices[indices[i + 0]];
+      const bs::Vector3& b = vertices[indices[i + 1]];
+      const bs::Vector3& c = vertices[indices[i + 2]];
+
+      bs::Vector3 normal = (b - a).cross(c - a);
+      float area         = normal.length();
+
+      if (area < 0.0001f) continue;
+
+      bool isWalkable = std::fabs(normal.y) / area >= minWalkableNormalY;
+
+      rasterizeTriangle(heightfield, a, b, c, isWalkable, agent.stepHeight);
+    }
+
+    // Every walkable top with enough room above it becomes a span
+    mCellSpanOffsets.reserve(numCells + 1);
+
+    for (bs::UINT32 cell = 0; cell < numCells; cell++)
+    {
+      mCellSpanOffsets.push_back((bs::UINT32)mSpans.size());
+
+      bs::UINT32 numSpansInCell = 0;
+
+      bs::UINT32 s = heightfield.cellBottoms[cell];
+
+      for (; s != NO_HEIGHTFIELD_SPAN; s = heightfield.spans[s].next)
+      {
+        const HeightfieldSpan& solid = heightfield.spans[s];
+
+        if (!solid.isWalkable) continue;
+
+        float ceiling = solid.next != NO_HEIGHTFIELD_SPAN ? heightfield.spans[solid.next].min
+                                                          : std::numeric_limits<float>::max();
+
+        float clearance = ceiling - solid.max;
+
+        if (clearance < agent.height) continue;
+
+        // Links can only address that many spans per cell
+        if (numSpansInCell == NO_LINK) break;
+
+        Span span;
+        span.floor     = solid.max;
+        span.clearance = clearance;
+        std::fill(std::begin(span.neighbours), std::end(span.neighbours), NO_LINK);
+
+        mSpans.push_back(span);
+        mCellOfSpan.push_back(cell);
+
+        numSpansInCell++;
+      }
+    }
+
+    mCellSpanOffsets.push_back((bs::UINT32)mSpans.size());
+
+    connectSpans(agent);
+    erodeEdges(agent);
+  }
+
+  void NavMesh::setupGrid(const bs::Vector<bs::Vector3>& vertices)
+  {
+    bs::Vector3 min = vertices.front();
+    bs::Vector3 max = vertices.front();
+
+    for (const bs::Vector3& v : vertices)
+    {
+      min.x = std::min(min.x, v.x);
+      min.z = std::min(min.z, v.z);
+      max.x = std::max(max.x, v.x);
+      max.z = std::max(max.z, v.z);
+    }
+
+    mOrigin   = bs::Vector3(min.x, 0.0f, min.z);
+    mCellSize = CELL_SIZE;
+
+    while (true)
+    {
+      mNumCellsX = (bs::UINT32)std::ceil((max.x - min.x) / mCellSize) + 1;
+      mNumCellsZ = (bs::UINT32)std::ceil((max.z - min.z) / mCellSize) + 1;
+
+      if ((bs::UINT64)mNumCellsX * mNumCellsZ <= MAX_NUM_CELLS) break;
+
+      mCellSize *= 2.0f;
+    }
+
+    if (mCellSize != CELL_SIZE)
+    {
+      REGOTH_LOG(Warning, Uncategorized,
+                 "[NavMesh] World is huge, using cells of {0} m instead of {1} m", mCellSize,
+                 CELL_SIZE);
+    }
+  }
+
+  void NavMesh::connectSpans(const AgentConfiguration& agent)
+  {
+    for (bs::UINT32 z = 0; z < mNumCellsZ; z++)
+    {
+      for (bs::UINT32 x = 0; x < mNumCellsX; x++)
+      {
+        bs::UINT32 cell = cellIndexOf(x, z);
+
+        for (bs::UINT32 s = mCellSpanOffsets[cell]; s < mCellSpanOffsets[cell + 1]; s++)
+        {
+          Span& span = mSpans[s];
+
+          for (int direction = 0; direction < NumDirections; direction++)
+          {
+            bs::INT32 nx = (bs::INT32)x + DIRECTION_X[direction];
+            bs::INT32 nz = (bs::INT32)z + DIRECTION_Z[direction];
+
+            if (nx < 0 || nz < 0 || nx >= (bs::INT32)mNumCellsX || nz >= (bs::INT32)mNumCellsZ)
+            {
+              continue;
+            }
+
+            bs::UINT32 neighbourCell = cellIndexOf(nx, nz);
+            bs::UINT32 first         = mCellSpanOffsets[neighbourCell];
+            bs::UINT32 end           = mCellSpanOffsets[neighbourCell + 1];
+
+            float bestStep = std::numeric_limits<float>::max();
+
+            for (bs::UINT32 n = first; n < end; n++)
+            {
+              const Span& other = mSpans[n];
+
+              float step = std::fabs(other.floor - span.floor);
+
+              if (step > agent.stepHeight) continue;
+
+              // Must fit through the gap between both
+              float bottom = std::max(span.floor, other.floor);
+              float top    = std::min(span.floor + span.clearance, other.floor + other.clearance);
+
+              if (top - bottom < agent.height) continue;
+
+              if (step < bestStep)
+              {
+                bestStep                   = step;
+                span.neighbours[direction] = (bs::UINT8)(n - first);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  void NavMesh::erodeEdges(const AgentConfiguration& agent)
+  {
+    const bs::UINT32 numSpans  = (bs::UINT32)mSpans.size();
+    const bs::UINT32 unreached = std::numeric_limits<bs::UINT32>::max();
+
+    // Breadth first search from all spans at an edge, to find how many cells each span is
+    // away from the closest edge
+    bs::Vector<bs::UINT32> distances(numSpans, unreached);
+    bs::Vector<bs::UINT32> queue;
+    queue.reserve(numSpans);
+
+    for (bs::UINT32 s = 0; s < numSpans; s++)
+    {
+      const Span& span = mSpans[s];
+
+      bool isAtEdge = std::find(std::begin(span.neighbours), std::end(span.neighbours),
+                                NO_LINK) != std::end(span.neighbours);
+
+      if (isAtEdge)
+      {
+        distances[s] = 0;
+        queue.push_back(s);
+      }
+    }
+
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+      bs::UINT32 s = queue[i];
+      bs::INT32 x  = mCellOfSpan[s] % mNumCellsX;
+      bs::INT32 z  = mCellOfSpan[s] / mNumCellsX;
+
+      for (int direction = 0; direction < NumDirections; direction++)
+      {
+        bs::UINT32 neighbour = neighbourOf(s, x, z, (Direction)direction);
+
+        if (neighbour == NO_SPAN || distances[neighbour] != unreached) continue;
+
+        distances[neighbour] = distances[s] + 1;
+        queue.push_back(neighbour);
+      }
+    }
+
+    // Removed spans keep their place, so the links of the others stay valid, but they don't
+    // get any room above them, so they are never walked on
+    bs::Vector<bool> isRemoved(numSpans, false);
+
+    for (bs::UINT32 s = 0; s < numSpans; s++)
+    {
+      float distanceToEdge = ((float)distances[s] + 0.5f) * mCellSize;
+
+      if (distances[s] != unreached && distanceToEdge >= agent.radius) continue;
+
+      isRemoved[s]        = true;
+      mSpans[s].clearance = 0.0f;
+    }
+
+    for (bs::UINT32 s = 0; s < numSpans; s++)
+    {
+      bs::INT32 x = mCellOfSpan[s] % mNumCellsX;
+      bs::INT32 z = mCellOfSpan[s] / mNumCellsX;
+
+      for (int direction = 0; direction < NumDirections; direction++)
+      {
+        bs::UINT32 neighbour = neighbourOf(s, x, z, (Direction)direction);
+
+        if (isRemoved[s] || (neighbour != NO_SPAN && isRemoved[neighbour]))
+        {
+          mSpans[s].neighbours[direction] = NO_LINK;
+        }
+      }
+    }
+  }
+
+  bool NavMesh::findCell(const bs::Vector3& position, bs::INT32& outX, bs::INT32& outZ) const
+  {
+    if (isEmpty()) return false;
+
+    outX = (bs::INT32)std::floor((position.x - mOrigin.x) / mCellSize);
+    outZ = (bs::INT32)std::floor((position.z - mOrigin.z) / mCellSize);
+
+    return outX >= 0 && outZ >= 0 && outX < (bs::INT32)mNumCellsX && outZ < (bs::INT32)mNumCellsZ;
+  }
+
+  bs::UINT32 NavMesh::neighbourOf(bs::UINT32 span, bs::INT32 x, bs::INT32 z,
+                                  Direction direction) const
+  {
+    bs::UINT8 link = mSpans[span].neighbours[direction];
+
+    if (link == NO_LINK) return NO_SPAN;
+
+    bs::UINT32 neighbourCell = cellIndexOf(x + DIRECTION_X[direction], z + DIRECTION_Z[direction]);
+
+    return mCellSpanOffsets[neighbourCell] + link;
+  }
+
+  bs::Vector3 NavMesh::centerOf(bs::UINT32 span) const
+  {
+    bs::UINT32 x = mCellOfSpan[span] % mNumCellsX;
+    bs::UINT32 z = mCellOfSpan[span] / mNumCellsX;
+
+    return bs::Vector3(mOrigin.x + ((float)x + 0.5f) * mCellSize, mSpans[span].floor,
+                       mOrigin.z + ((float)z + 0.5f) * mCellSize);
+  }
+
+  bs::UINT32 NavMesh::findSpan(const bs::Vector3& position) const
+  {
+    bs::INT32 x;
+    bs::INT32 z;
+
+    if (!findCell(position, x, z)) return NO_SPAN;
+
+    bs::UINT32 cell = cellIndexOf(x, z);
+    bs::UINT32 best = NO_SPAN;
+
+    // Creatures are usually positioned somewhere around their center, so look a bit
+    // further down than up
+    const float highestFloor = position.y + mAgent.stepHeight;
+    const float lowestFloor  = position.y - mAgent.height * 2.0f;
+
+    for (bs::UINT32 s = mCellSpanOffsets[cell]; s < mCellSpanOffsets[cell + 1]; s++)
+    {
+      const Span& span = mSpans[s];
+
+      if (span.clearance < mAgent.height) continue;
+      if (span.floor > highestFloor || span.floor < lowestFloor) continue;
+
+      // Spans are sorted bottom to top, so the last matching one is the closest
+      best = s;
+    }
+
+    return best;
+  }
+
+  bool NavMesh::isWalkableLine(const bs::Vector3& from, const bs::Vector3& to) const
+  {
+    bs::INT32 x;
+    bs::INT32 z;
+    bs::INT32 targetX;
+    bs::INT32 targetZ;
+
+    if (!findCell(from, x, z) || !findCell(to, targetX, targetZ)) return false;
+
+    bs::UINT32 span   = findSpan(from);
+    bs::UINT32 target = findSpan(to);
+
+    if (span == NO_SPAN || target == NO_SPAN) return false;
+
+    // Walk along all cells the line touches, following the links between the spans
+    const float startX = (from.x - mOrigin.x) / mCellSize;
+    const float startZ = (from.z - mOrigin.z) / mCellSize;
+    const float deltaX = (to.x - mOrigin.x) / mCellSize - startX;
+    const float deltaZ = (to.z - mOrigin.z) / mCellSize - startZ;
+    const float never  = std::numeric_limits<float>::max();
+
+    const bs::INT32 stepX = deltaX > 0 ? 1 : -1;
+    const bs::INT32 stepZ = deltaZ > 0 ? 1 : -1;
+
+    // Fraction of the line between crossing two cell borders on each axis
+    const float tDeltaX = deltaX != 0 ? std::fabs(1.0f / deltaX) : never;
+    const float tDeltaZ = deltaZ != 0 ? std::fabs(1.0f / deltaZ) : never;
+
+    // Fraction of the line at which the next cell border is crossed on each axis
+    float tMaxX = never;
+    float tMaxZ = never;
+
+    if (deltaX > 0) tMaxX = (std::floor(startX) + 1.0f - startX) / deltaX;
+    if (deltaX < 0) tMaxX = (startX - std::floor(startX)) / -deltaX;
+    if (deltaZ > 0) tMaxZ = (std::floor(startZ) + 1.0f - startZ) / deltaZ;
+    if (deltaZ < 0) tMaxZ = (startZ - std::floor(startZ)) / -deltaZ;
+
+    const bs::INT32 numSteps = std::abs(targetX - x) + std::abs(targetZ - z);
+
+    for (bs::INT32 i = 0; i < numSteps; i++)
+    {
+      Direction direction;
+
+      if (tMaxX < tMaxZ)
+      {
+        direction = stepX > 0 ? PositiveX : NegativeX;
+        tMaxX += tDeltaX;
+      }
+      else
+      {
+        direction = stepZ > 0 ? PositiveZ : NegativeZ;
+        tMaxZ += tDeltaZ;
+      }
+
+      span = neighbourOf(span, x, z, direction);
+
+      if (span == NO_SPAN) return false;
+
+      x += DIRECTION_X[direction];
+      z += DIRECTION_Z[direction];
+    }
+
+    // Might have gone around the target cell because of rounding, or ended up on a different
+    // floor than the target
+    return x == targetX && z == targetZ && span == target;
+  }
+
+  bs::Vector<bs::Vector3> NavMesh::findCorridor(const bs::Vector3& from, const bs::Vector3& to,
+                                                bs::UINT32 maxSearchedSpans)
+  {
+    const bs::UINT32 start = findSpan(from);
+    const bs::UINT32 goal  = findSpan(to);
+
+    if (start == NO_SPAN || goal == NO_SPAN) return {};
+
+    if (start == goal || isWalkableLine(from, to)) return {from, to};
+
+    if (mSearchNodes.size() != mSpans.size())
+    {
+      mSearchNodes.assign(mSpans.size(), SearchNode{0.0f, NO_SPAN, 0, false});
+      mSearchMark = 0;
+    }
+
+    mSearchMark++;
+
+    // Wrapped around, so old marks could be mistaken for current ones
+    if (mSearchMark == 0)
+    {
+      for (SearchNode& node : mSearchNodes)
+      {
+        node.searchMark = 0;
+      }
+
+      mSearchMark = 1;
+    }
+
+    const bs::INT32 goalX = mCellOfSpan[goal] % mNumCellsX;
+    const bs::INT32 goalZ = mCellOfSpan[goal] / mNumCellsX;
+
+    // Costs are in cells, which makes the manhattan distance an exact lower bound
+    auto estimateCostToGoal = [&](bs::INT32 x, bs::INT32 z) {
+      return (float)(std::abs(goalX - x) + std::abs(goalZ - z));
+    };
+
+    using OpenEntry = std::pair<float, bs::UINT32>;
+    std::priority_queue<OpenEntry, bs::Vector<OpenEntry>, std::greater<OpenEntry>> open;
+
+    mSearchNodes[start] = SearchNode{0.0f, NO_SPAN, mSearchMark, false};
+    open.push(OpenEntry(0.0f, start));
+
+    bs::UINT32 numSearched = 0;
+    bool hasReachedGoal    = false;
+
+    while (!open.empty())
+    {
+      bs::UINT32 current = open.top().second;
+      open.pop();
+
+      SearchNode& node = mSearchNodes[current];
+
+      if (node.isClosed) continue;
+
+      node.isClosed = true;
+
+      if (current == goal)
+      {
+        hasReachedGoal = true;
+        break;
+      }
+
+      if (++numSearched > maxSearchedSpans) break;
+
+      bs::INT32 x = mCellOfSpan[current] % mNumCellsX;
+      bs::INT32 z = mCellOfSpan[current] / mNumCellsX;
+
+      for (int direction = 0; direction < NumDirections; direction++)
+      {
+        bs::UINT32 neighbour = neighbourOf(current, x, z, (Direction)direction);
+
+        if (neighbour == NO_SPAN) continue;
+
+        SearchNode& next = mSearchNodes[neighbour];
+        float newCost    = node.costFromStart + 1.0f;
+
+        bool isNew = next.searchMark != mSearchMark;
+
+        if (isNew || (!next.isClosed && newCost < next.costFromStart))
+        {
+          next = SearchNode{newCost, current, mSearchMark, false};
+
+          float estimate = estimateCostToGoal(x + DIRECTION_X[direction],
+                                              z + DIRECTION_Z[direction]);
+
+          open.push(OpenEntry(newCost + estimate, neighbour));
+        }
+      }
+    }
+
+    if (!hasReachedGoal) return {};
+
+    bs::Vector<bs::Vector3> positions;
+
+    for (bs::UINT32 s = goal; s != NO_SPAN; s = mSearchNodes[s].previous)
+    {
+      positions.push_back(centerOf(s));
+    }
+
+    std::reverse(positions.begin(), positions.end());
+
+    positions.front() = from;
+    positions.back()  = to;
+
+    return straightenCorridor(positions);
+  }
+
+  bs::Vector<bs::Vector3> NavMesh::straightenCorridor(
+      const bs::Vector<bs::Vector3>& positions) const
+  {
+    bs::Vector<bs::Vector3> result;
+    result.push_back(positions.front());
+
+    size_t current = 0;
+
+    while (current + 1 < positions.size())
+    {
+      size_t furthest = current + 1;
+
+      while (furthest + 1 < positions.size() &&
+             isWalkableLine(positions[current], positions[furthest + 1]))
+      {
+        furthest++;
+      }
+
+      result.push_back(positions[furthest]);
+      current = furthest;
+    }
+
+    return result;
+  }
+
+  float NavMesh::clearanceAt(const bs::Vector3& position) const
+  {
+    bs::UINT32 span = findSpan(position);
+
+    if (span == NO_SPAN) return std::numeric_limits<float>::max();
+
+    return mSpans[span].floor + mSpans[span].clearance - position.y;
+  }
+
+  bs::Path NavMesh::cachePathFor(const bs::String& zenFile)
+  {
+    return BsZenLib::GothicPathToCachedWorld(zenFile + ".navmesh");
+  }
+
+  static bool isSameWorldMesh(const NavMeshFileHeader& header, bs::UINT64 worldMeshHash)
+  {
+    return worldMeshHash == NavMesh::ANY_WORLD_MESH || header.worldMeshHash == worldMeshHash;
+  }
+
+  void NavMesh::save(const bs::Path& path, bs::UINT64 worldMeshHash) const
+  {
+    NavMeshFileHeader header;
+    header.magic              = NAVMESH_MAGIC;
+    header.version            = NAVMESH_VERSION;
+    header.worldMeshHash      = worldMeshHash;
+    header.agentHeight        = mAgent.height;
+    header.agentRadius        = mAgent.radius;
+    header.agentStepHeight    = mAgent.stepHeight;
+    header.agentMaxSlopeAngle = mAgent.maxSlopeAngle;
+    header.originX            = mOrigin.x;
+    header.originY            = mOrigin.y;
+    header.originZ            = mOrigin.z;
+    header.cellSize           = mCellSize;
+    header.numCellsX          = mNumCellsX;
+    header.numCellsZ          = mNumCellsZ;
+    header.numSpans           = (bs::UINT32)mSpans.size();
+
+    bs::FileSystem::createDir(path.getParent());
+
+    bs::SPtr<bs::DataStream> stream = bs::FileSystem::createAndOpenFile(path);
+
+    if (!stream) return;
+
+    stream->write(&header, sizeof(header));
+    stream->write(mCellSpanOffsets.data(), mCellSpanOffsets.size() * sizeof(bs::UINT32));
+    stream->write(mSpans.data(), mSpans.size() * sizeof(Span));
+    stream->close();
+  }
+
+  bool NavMesh::load(const bs::Path& path, const AgentConfiguration& agent,
+                     bs::UINT64 worldMeshHash)
+  {
+    clear();
+
+    if (!bs::FileSystem::isFile(path)) return false;
+
+    bs::SPtr<bs::DataStream> stream = bs::FileSystem::openFile(path, true);
+
+    if (!stream) return false;
+
+    NavMeshFileHeader header;
+
+    if (stream->read(&header, sizeof(header)) != sizeof(header)) return false;
+
+    if (header.magic != NAVMESH_MAGIC) return false;
+    if (header.version != NAVMESH_VERSION) return false;
+    if (!isSameAgent(header, agent)) return false;
+    if (!isSameWorldMesh(header, worldMeshHash)) return false;
+    if ((bs::UINT64)header.numCellsX * header.numCellsZ > MAX_NUM_CELLS) return false;
+
+    mAgent     = agent;
+    mOrigin    = bs::Vector3(header.originX, header.originY, header.originZ);
+    mCellSize  = header.cellSize;
+    mNumCellsX = header.numCellsX;
+    mNumCellsZ = header.numCellsZ;
+
+    mCellSpanOffsets.resize(mNumCellsX * mNumCellsZ + 1);
+    mSpans.resize(header.numSpans);
+
+    size_t offsetsSize = mCellSpanOffsets.size() * sizeof(bs::UINT32);
+    size_t spansSize   = mSpans.size() * sizeof(Span);
+
+    bool isComplete = stream->read(mCellSpanOffsets.data(), offsetsSize) == offsetsSize &&
+                      stream->read(mSpans.data(), spansSize) == spansSize;
+
+    stream->close();
+
+    if (!isComplete || mCellSpanOffsets.back() != header.numSpans)
+    {
+      clear();
+      return false;
+    }
+
+    mCellOfSpan.reserve(mSpans.size());
+
+    for (bs::UINT32 cell = 0; cell + 1 < mCellSpanOffsets.size(); cell++)
+    {
+      for (bs::UINT32 s = mCellSpanOffsets[cell]; s < mCellSpanOffsets[cell + 1]; s++)
+      {
+        mCellOfSpan.push_back(cell);
+      }
+    }
+
+    return true;
+  }
+
+  bool NavMesh::isSavedFor(const bs::Path& path, const AgentConfiguration& agent,
+                           bs::UINT64 worldMeshHash)
+  {
+    if (!bs::FileSystem::isFile(path)) return false;
+
+    bs::SPtr<bs::DataStream> stream = bs::FileSystem::openFile(path, true);
+
+    if (!stream) return false;
+
+    NavMeshFileHeader header;
+
+    bool hasHeader = stream->read(&header, sizeof(header)) == sizeof(header);
+
+    stream->close();
+
+    return hasHeader && header.magic == NAVMESH_MAGIC && header.version == NAVMESH_VERSION &&
+           isSameAgent(header, agent) && isSameWorldMesh(header, worldMeshHash);
+  }
+
+  void NavMesh::clear()
+  {
+    mNumCellsX = 0;
+    mNumCellsZ = 0;
+    mCellSpanOffsets.clear();
+    mSpans.clear();
+    mCellOfSpan.clear();
+    mSearchNodes.clear();
+  }
+}  // namespace REGoth
@@ -0,0 +1,263 @@
+#pragma once
+#include <AI/Pathfinder.hpp>
+#include <BsPrerequisites.h>
+#include <FileSystem/BsPath.h>
+#include <Math/BsVector3.h>
+
+namespace REGoth
+{
+  /**
+   * Walkable surfaces of a world, for moving creatures where there is no waynet.
+   *
+   * This is not a navmesh made of polygons, but a grid of cells on the XZ-plane. Each
+   * cell holds a list of *spans*, which are the surfaces inside that cell a creature
+   * could stand on, one above the other. A span knows the height of its floor, how much
+   * room there is above it and which spans of the four neighbouring cells can be reached
+   * from it by stepping up or down.
+   *
+   * Baking works like the heightfield stage of Recast: All triangles of the world mesh
+   * are rasterized into the grid, marking which height ranges of each cell are solid and
+   * whether their top can be walked on, which depends on the slope. Then the walkable
+   * tops with enough room above them become spans, get connected to their neighbours and
+   * the ones too close to an edge for the creature to fit are dropped.
+   *
+   * All of that depends on the size of the creature walking on it, so the navmesh is baked
+   * for a single AI::Pathfinder::UserConfiguration. Since baking takes a moment on the bigger
+   * worlds, the result is cached per world and tagged with a hash of the world mesh it was
+   * baked from, see cachePathFor().
+   *
+   * Like the KDTree, this only works on plain positions and doesn't know about the world
+   * itself.
+   */
+  class NavMesh
+  {
+  public:
+    using AgentConfiguration = AI::Pathfinder::UserConfiguration;
+
+    /**
+     * Reported when there is no walkable span at a position.
+     */
+    static constexpr bs::UINT32 NO_SPAN = 0xFFFFFFFF;
+
+    /**
+     * Passed as world mesh hash to accept a navmesh saved for any world mesh, for when
+     * the hash is not known.
+     */
+    static constexpr bs::UINT64 ANY_WORLD_MESH = 0;
+
+    /**
+     * Bakes the navmesh from the given triangles. Every three indices into `vertices` make
+     * up one triangle. Positions are expected in meters.
+     *
+     * Will drop anything already in there and thus can be called multiple times.
+     */
+    void bake(const bs::Vector<bs::Vector3>& vertices, const bs::Vector<bs::UINT32>& indices,
+              const AgentConfiguration& agent);
+
+    /**
+     * @return Where the navmesh of the given world is cached.
+     */
+    static bs::Path cachePathFor(const bs::String& zenFile);
+
+    /**
+     * Saves the navmesh to the given file, overwriting it.
+     *
+     * @param  worldMeshHash  Hash of the world mesh the navmesh was baked from, so a changed
+     *                        world doesn't pick up an outdated navmesh.
+     */
+    void save(const bs::Path& path, bs::UINT64 worldMeshHash) const;
+
+    /**
+     * Loads a navmesh previously saved via save().
+     *
+     * @param  worldMeshHash  Hash of the world mesh the navmesh is needed for, or
+     *                        ANY_WORLD_MESH.
+     *
+     * @return Whether the navmesh could be loaded. False if the file does not exist, is
+     *         damaged or was baked for a different agent or world mesh. The navmesh is
+     *         empty then.
+     */
+    bool load(const bs::Path& path, const AgentConfiguration& agent, bs::UINT64 worldMeshHash);
+
+    /**
+     * @return Whether a navmesh for the given agent and world mesh has been saved at the
+     *         given path, without loading all of it.
+     */
+    static bool isSavedFor(const bs::Path& path, const AgentConfiguration& agent,
+                           bs::UINT64 worldMeshHash);
+
+    /**
+     * @return Whether the navmesh has not been baked or loaded.
+     */
+    bool isEmpty() const
+    {
+      return mSpans.empty();
+    }
+
+    /**
+     * Drops the navmesh.
+     */
+    void clear();
+
+    /**
+     * Finds the span a creature at the given position is standing on. The position may be
+     * a little above the floor, as creatures are usually positioned at their center.
+     *
+     * @return Index of the span or NO_SPAN, if the position is not on the navmesh.
+     */
+    bs::UINT32 findSpan(const bs::Vector3& position) const;
+
+    /**
+     * @return Whether the given position is on the navmesh.
+     */
+    bool isOnNavMesh(const bs::Vector3& position) const
+    {
+      return findSpan(position) != NO_SPAN;
+    }
+
+    /**
+     * Checks whether a creature could walk in a straight line between the given positions,
+     * without leaving the navmesh or having to step up or down too much.
+     *
+     * @return Whether the line is walkable. False if either position is not on the navmesh.
+     */
+    bool isWalkableLine(const bs::Vector3& from, const bs::Vector3& to) const;
+
+    /**
+     * Finds a way over the navmesh between the given positions and straightens it.
+     *
+     * @param  maxSearchedSpans  How many spans may be looked at before giving up. Keeps
+     *                           the search cheap, as this is meant for short distances.
+     *
+     * @return Positions to walk to, including `from` and `to`. Empty if there is no way
+     *         or it could not be found within the limit.
+     */
+    bs::Vector<bs::Vector3> findCorridor(const bs::Vector3& from, const bs::Vector3& to,
+                                         bs::UINT32 maxSearchedSpans);
+
+    /**
+     * @return Room above the given position, up to the next obstacle. Maximum float value
+     *         if the position is not on the navmesh.
+     */
+    float clearanceAt(const bs::Vector3& position) const;
+
+    bs::UINT32 numSpans() const
+    {
+      return (bs::UINT32)mSpans.size();
+    }
+
+  private:
+    /**
+     * Directions to the neighbouring cells, in the order the links of a span are stored.
+     */
+    enum Direction
+    {
+      PositiveX,
+      PositiveZ,
+      NegativeX,
+      NegativeZ,
+      NumDirections,
+    };
+
+    /**
+     * Marks a missing link inside Span::neighbours.
+     */
+    static constexpr bs::UINT8 NO_LINK = 0xFF;
+
+    struct Span
+    {
+      float floor;
+      float clearance;
+
+      /**
+       * Index of the reachable span inside the cell in each direction, relative to the
+       * first span of that cell. NO_LINK if there is none.
+       */
+      bs::UINT8 neighbours[NumDirections];
+    };
+
+    /**
+     * Per-span bookkeeping of findCorridor(). See Waynet for how the search marks work.
+     */
+    struct SearchNode
+    {
+      float costFromStart;
+      bs::UINT32 previous;
+      bs::UINT32 searchMark;
+      bool isClosed;
+    };
+
+    bs::UINT32 cellIndexOf(bs::INT32 x, bs::INT32 z) const
+    {
+      return (bs::UINT32)z * mNumCellsX + (bs::UINT32)x;
+    }
+
+    /**
+     * @return Whether the given position is inside the grid. Writes the cell coordinates.
+     */
+    bool findCell(const bs::Vector3& position, bs::INT32& outX, bs::INT32& outZ) const;
+
+    /**
+     * @return Span reached when going from the given one into the given direction, or
+     *         NO_SPAN if there is no link.
+     */
+    bs::UINT32 neighbourOf(bs::UINT32 span, bs::INT32 x, bs::INT32 z, Direction direction) const;
+
+    /**
+     * @return Center of the given spans cell, at the height of its floor.
+     */
+    bs::Vector3 centerOf(bs::UINT32 span) const;
+
+    /**
+     * Sets up the grid to cover the given vertices.
+     */
+    void setupGrid(const bs::Vector<bs::Vector3>& vertices);
+
+    /**
+     * Links all spans to the ones they can step to in the neighbouring cells.
+     */
+    void connectSpans(const AgentConfiguration& agent);
+
+    /**
+     * Removes the spans too close to an edge of the walkable area for the agent to fit.
+     */
+    void erodeEdges(const AgentConfiguration& agent);
+
+    /**
+     * Straightens the way found by findCorridor() by skipping all positions which can
+     * be walked past in a straight line.
+     */
+    bs::Vector<bs::Vector3> straightenCorridor(const bs::Vector<bs::Vector3>& positions) const;
+
+    /**
+     * Agent this navmesh was baked for.
+     */
+    AgentConfiguration mAgent;
+
+    /**
+     * Grid layout. Cell (x, z) covers the area starting at `mOrigin + (x, z) * mCellSize`.
+     */
+    bs::Vector3 mOrigin = bs::Vector3::ZERO;
+    float mCellSize       = 0.5f;
+    bs::UINT32 mNumCellsX = 0;
+    bs::UINT32 mNumCellsZ = 0;
+
+    /**
+     * The spans of the cell with index `c` are `mSpans[mCellSpanOffsets[c]]` up to (excluding)
+     * `mSpans[mCellSpanOffsets[c + 1]]`, from bottom to top.
+     */
+    bs::Vector<bs::UINT32> mCellSpanOffsets;
+    bs::Vector<Span> mSpans;
+
+    /**
+     * Cell of each span, so the search doesn't need to look it up.
+     */
+    bs::Vector<bs::UINT32> mCellOfSpan;
+
+    /**
+     * Scratch space of findCorridor().
+     */
+    bs::Vector<SearchNode> mSearchNodes;
+    bs::UINT32 mSearchMark = 0;
+  };
+}  // namespace REGoth
@@ -0,0 +1,166 @@
+#include "PhysicsMeshRegistry.hpp"
+#include <BsZenLib/ImportPath.hpp>
+#include <BsZenLib/ResourceManifest.hpp>
+#include <FileSystem/BsFileSystem.h>
+#include <Mesh/BsMesh.h>
+#include <Physics/BsPhysicsMesh.h>
+#include <Resources/BsResources.h>
+#include <Threading/BsTaskScheduler.h>
+#include <log/logging.hpp>
+#include <original-content/OriginalGameResources.hpp>
+
+namespace REGoth
+{
+  bs::HPhysicsMesh PhysicsMeshRegistry::physicsMeshFor(const bs::HMesh& mesh)
+  {
+    if (!mesh) return {};
+
+    return physicsMeshFor(mesh->getName(), mesh);
+  }
+
+  bs::HPhysicsMesh PhysicsMeshRegistry::physicsMeshFor(const bs::String& name,
+                                                       const bs::HMesh& mesh)
+  {
+    std::promise<bs::HPhysicsMesh> promise;
+
+    {
+      bs::Lock lock(mMutex);
+
+      auto it = mPhysicsMeshes.find(name);
+
+      if (it != mPhysicsMeshes.end())
+      {
+        std::shared_future<bs::HPhysicsMesh> pending = it->second;
+
+        // Don't block others while waiting for whoever is loading it
+        lock.unlock();
+
+        mNumMemoryHits++;
+
+        return pending.get();
+      }
+
+      mPhysicsMeshes[name] = promise.get_future().share();
+    }
+
+    bs::HPhysicsMesh physicsMesh;
+
+    try
+    {
+      physicsMesh = loadOrCook(name, mesh);
+    }
+    catch (...)
+    {
+      // Whoever is waiting for this would wait forever otherwise
+      promise.set_value({});
+      throw;
+    }
+
+    promise.set_value(physicsMesh);
+
+    return physicsMesh;
+  }
+
+  bs::HPhysicsMesh PhysicsMeshRegistry::loadOrCook(const bs::String& name, const bs::HMesh& mesh)
+  {
+    bs::Path path = BsZenLib::GothicPathToCachedStaticMesh(name + ".physics");
+
+    if (bs::FileSystem::exists(path))
+    {
+      bs::HPhysicsMesh physicsMesh = bs::gResources().load<bs::PhysicsMesh>(path);
+
+      if (physicsMesh.isLoaded())
+      {
+        mNumCacheHits++;
+        return physicsMesh;
+      }
+
+      REGOTH_LOG(Warning, Uncategorized,
+                 "[PhysicsMeshRegistry] Failed to load cached physics mesh {0}, cooking it again",
+                 name);
+    }
+
+    if (!mesh) return {};
+
+    auto meshData = mesh->getCachedData();
+
+    if (!meshData) return {};
+
+    REGOTH_LOG(Info, Uncategorized, "[PhysicsMeshRegistry] Caching physics mesh for {0}", name);
+
+    bs::HPhysicsMesh physicsMesh = bs::PhysicsMesh::create(meshData, bs::PhysicsMeshType::Triangle);
+
+    mNumCooked++;
+
+    saveInBackground(physicsMesh, path);
+
+    return physicsMesh;
+  }
+
+  void PhysicsMeshRegistry::saveInBackground(const bs::HPhysicsMesh& physicsMesh,
+                                             const bs::Path& path)
+  {
+    // Registering in the manifest is cheap, so do it right away. Anything saved referring
+    // to the physics mesh can find it then, once waitForPendingSaves() has returned.
+    {
+      ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
+
+      BsZenLib::AddToResourceManifest(physicsMesh, path);
+    }
+
+    auto saveTask = bs::Task::create("SavePhysicsMesh", [physicsMesh, path]() {
+      bs::gResources().save(physicsMesh, path, true);
+    });
+
+    {
+      bs::Lock lock(mPendingSavesMutex);
+
+      mPendingSaves.push_back(saveTask);
+    }
+
+    bs::TaskScheduler::instance().addTask(saveTask);
+  }
+
+  void PhysicsMeshRegistry::waitForPendingSaves()
+  {
+    bs::Vector<bs::SPtr<bs::Task>> pendingSaves;
+
+    {
+      bs::Lock lock(mPendingSavesMutex);
+
+      pendingSaves.swap(mPendingSaves);
+    }
+
+    for (const auto& task : pendingSaves)
+    {
+      task->wait();
+    }
+  }
+
+  void PhysicsMeshRegistry::clear()
+  {
+    // A physics mesh could still be in use by a save
+    waitForPendingSaves();
+
+    bs::Lock lock(mMutex);
+
+    mPhysicsMeshes.clear();
+  }
+
+  PhysicsMeshRegistry::Stats PhysicsMeshRegistry::stats() const
+  {
+    Stats stats;
+    stats.numMemoryHits = mNumMemoryHits;
+    stats.numCacheHits  = mNumCacheHits;
+    stats.numCooked     = mNumCooked;
+
+    return stats;
+  }
+
+  PhysicsMeshRegistry& gPhysicsMeshRegistry()
+  {
+    static PhysicsMeshRegistry s_instance;
+
+    return s_instance;
+  }
+}  // namespace REGoth
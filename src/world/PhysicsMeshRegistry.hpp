@@ -0,0 +1,100 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <FileSystem/BsPath.h>
+#include <Threading/BsTaskScheduler.h>
+#include <Threading/BsThreading.h>
+#include <atomic>
+#include <future>
+
+namespace REGoth
+{
+  /**
+   * Keeps the triangle physics meshes of all meshes which need collision, so each of them is
+   * only loaded or cooked once, no matter how many objects are using it.
+   *
+   * Physics meshes are keyed by name, which usually is the name of the mesh they were cooked
+   * from. When one is asked for, it is
+   *
+   *  - taken from memory, if it has been asked for before,
+   *  - loaded from the cache on disk, if it has been cooked in an earlier run,
+   *  - or cooked from the meshes data otherwise.
+   *
+   * Freshly cooked physics meshes are saved to the cache in the background, so nobody has to
+   * wait for the disk. See waitForPendingSaves().
+   *
+   * All of this is thread-safe: Threads asking for the same physics mesh at the same time
+   * will wait for the one loading or cooking it, instead of doing the work twice.
+   */
+  class PhysicsMeshRegistry
+  {
+  public:
+    /**
+     * Where the physics meshes asked for came from.
+     */
+    struct Stats
+    {
+      bs::UINT64 numMemoryHits = 0;
+      bs::UINT64 numCacheHits  = 0;
+      bs::UINT64 numCooked     = 0;
+    };
+
+    /**
+     * Gets the physics mesh for the given mesh, keyed by the meshes name.
+     *
+     * The mesh must have CPU-caching enabled, so its data can be cooked.
+     *
+     * @return The physics mesh. Empty if the mesh has no data to cook it from.
+     */
+    bs::HPhysicsMesh physicsMeshFor(const bs::HMesh& mesh);
+
+    /**
+     * Like physicsMeshFor(const bs::HMesh&), but with a name to use instead of the one of the
+     * mesh. For meshes whose names are not unique, like the world meshes.
+     */
+    bs::HPhysicsMesh physicsMeshFor(const bs::String& name, const bs::HMesh& mesh);
+
+    /**
+     * Blocks until all physics meshes cooked so far have been saved to the cache. Needed
+     * before saving anything referring to them.
+     */
+    void waitForPendingSaves();
+
+    /**
+     * Drops all physics meshes kept in memory. They will be loaded from the cache when
+     * asked for again.
+     */
+    void clear();
+
+    Stats stats() const;
+
+  private:
+    /**
+     * Loads the physics mesh from the cache or cooks it.
+     */
+    bs::HPhysicsMesh loadOrCook(const bs::String& name, const bs::HMesh& mesh);
+
+    /**
+     * Saves a freshly cooked physics mesh on a worker thread.
+     */
+    void saveInBackground(const bs::HPhysicsMesh& physicsMesh, const bs::Path& path);
+
+    /**
+     * Physics meshes by name. A physics mesh still being loaded or cooked is in here as well,
+     * so others asking for it can wait for it.
+     */
+    bs::UnorderedMap<bs::String, std::shared_future<bs::HPhysicsMesh>> mPhysicsMeshes;
+    mutable bs::Mutex mMutex;
+
+    bs::Vector<bs::SPtr<bs::Task>> mPendingSaves;
+    bs::Mutex mPendingSavesMutex;
+
+    std::atomic<bs::UINT64> mNumMemoryHits{0};
+    std::atomic<bs::UINT64> mNumCacheHits{0};
+    std::atomic<bs::UINT64> mNumCooked{0};
+  };
+
+  /**
+   * Global access to the physics mesh registry.
+   */
+  PhysicsMeshRegistry& gPhysicsMeshRegistry();
+}  // namespace REGoth
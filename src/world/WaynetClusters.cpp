@@ -0,0 +1,424 @@
+#include "WaynetClusters.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace REGoth
+{
+  /**
+   * Width and depth of a cell of the grid the waypoints are clustered by. Big enough to
+   * hold a decent number of waypoints, small enough for searches inside a cluster to be
+   * cheap.
+   */
+  static constexpr float CLUSTER_CELL_SIZE = 40.0f;  // Meters
+
+  static const float INFINITE_COST = std::numeric_limits<float>::max();
+
+  static bs::UINT64 cellKeyOf(const bs::Vector3& position)
+  {
+    bs::INT32 x = (bs::INT32)std::floor(position.x / CLUSTER_CELL_SIZE);
+    bs::INT32 z = (bs::INT32)std::floor(position.z / CLUSTER_CELL_SIZE);
+
+    return ((bs::UINT64)(bs::UINT32)x << 32) | (bs::UINT64)(bs::UINT32)z;
+  }
+
+  void WaynetClusters::build(const bs::Vector<bs::Vector3>& positions,
+                             const bs::Vector<bs::UINT32>& edgeOffsets,
+                             const bs::Vector<bs::UINT32>& neighbours,
+                             const bs::Vector<float>& edgeLengths)
+  {
+    const bs::UINT32 numWaypoints = (bs::UINT32)positions.size();
+
+    // Same graph with all connections turned around, needed to go against them
+    bs::Vector<bs::UINT32> reverseOffsets(numWaypoints + 1, 0);
+    bs::Vector<bs::UINT32> reverseNeighbours(neighbours.size());
+    bs::Vector<float> reverseLengths(neighbours.size());
+
+    for (bs::UINT32 to : neighbours)
+    {
+      reverseOffsets[to + 1]++;
+    }
+
+    for (bs::UINT32 i = 0; i < numWaypoints; i++)
+    {
+      reverseOffsets[i + 1] += reverseOffsets[i];
+    }
+
+    bs::Vector<bs::UINT32> fill(reverseOffsets.begin(), reverseOffsets.end() - 1);
+
+    for (bs::UINT32 from = 0; from < numWaypoints; from++)
+    {
+      for (bs::UINT32 e = edgeOffsets[from]; e < edgeOffsets[from + 1]; e++)
+      {
+        bs::UINT32 slot = fill[neighbours[e]]++;
+
+        reverseNeighbours[slot] = from;
+        reverseLengths[slot]    = edgeLengths[e];
+      }
+    }
+
+    buildClusters(positions, edgeOffsets, neighbours, reverseOffsets, reverseNeighbours);
+    buildPortals(positions, edgeOffsets, neighbours, edgeLengths, reverseOffsets,
+                 reverseNeighbours, reverseLengths);
+
+    mSearchNodes.clear();
+    mSearchNodes.resize(mPortalWaypoints.size() + 2);
+    mSearchMark = 0;
+  }
+
+  void WaynetClusters::buildClusters(const bs::Vector<bs::Vector3>& positions,
+                                     const bs::Vector<bs::UINT32>& edgeOffsets,
+                                     const bs::Vector<bs::UINT32>& neighbours,
+                                     const bs::Vector<bs::UINT32>& reverseOffsets,
+                                     const bs::Vector<bs::UINT32>& reverseNeighbours)
+  {
+    const bs::UINT32 numWaypoints = (bs::UINT32)positions.size();
+
+    mClusterOf.assign(numWaypoints, NONE);
+    mLocalIndexOf.assign(numWaypoints, NONE);
+    mClusterMemberOffsets.clear();
+    mClusterMembers.clear();
+    mClusterMembers.reserve(numWaypoints);
+
+    bs::Vector<bs::UINT64> cellOf;
+    cellOf.reserve(numWaypoints);
+
+    for (const bs::Vector3& position : positions)
+    {
+      cellOf.push_back(cellKeyOf(position));
+    }
+
+    // Flood-fill from every waypoint not inside a cluster yet, following connections in
+    // both directions, but never leaving the cell.
+    bs::Vector<bs::UINT32> open;
+
+    for (bs::UINT32 seed = 0; seed < numWaypoints; seed++)
+    {
+      if (mClusterOf[seed] != NONE) continue;
+
+      const bs::UINT32 cluster     = (bs::UINT32)mClusterMemberOffsets.size();
+      const bs::UINT32 firstMember = (bs::UINT32)mClusterMembers.size();
+
+      mClusterMemberOffsets.push_back(firstMember);
+
+      auto addMember = [&](bs::UINT32 waypoint) {
+        mClusterOf[waypoint]    = cluster;
+        mLocalIndexOf[waypoint] = (bs::UINT32)mClusterMembers.size() - firstMember;
+        mClusterMembers.push_back(waypoint);
+        open.push_back(waypoint);
+      };
+
+      addMember(seed);
+
+      while (!open.empty())
+      {
+        bs::UINT32 current = open.back();
+        open.pop_back();
+
+        for (bs::UINT32 e = edgeOffsets[current]; e < edgeOffsets[current + 1]; e++)
+        {
+          bs::UINT32 other = neighbours[e];
+
+          if (mClusterOf[other] == NONE && cellOf[other] == cellOf[current]) addMember(other);
+        }
+
+        for (bs::UINT32 e = reverseOffsets[current]; e < reverseOffsets[current + 1]; e++)
+        {
+          bs::UINT32 other = reverseNeighbours[e];
+
+          if (mClusterOf[other] == NONE && cellOf[other] == cellOf[current]) addMember(other);
+        }
+      }
+    }
+
+    mClusterMemberOffsets.push_back((bs::UINT32)mClusterMembers.size());
+  }
+
+  void WaynetClusters::buildPortals(const bs::Vector<bs::Vector3>& positions,
+                                    const bs::Vector<bs::UINT32>& edgeOffsets,
+                                    const bs::Vector<bs::UINT32>& neighbours,
+                                    const bs::Vector<float>& edgeLengths,
+                                    const bs::Vector<bs::UINT32>& reverseOffsets,
+                                    const bs::Vector<bs::UINT32>& reverseNeighbours,
+                                    const bs::Vector<float>& reverseLengths)
+  {
+    const bs::UINT32 numWaypoints = (bs::UINT32)positions.size();
+
+    mClusterPortalOffsets.clear();
+    mClusterPortals.clear();
+    mPortalWaypoints.clear();
+    mPortalPositions.clear();
+    mPortalCostOffsets.clear();
+    mCostsFromPortal.clear();
+    mCostsToPortal.clear();
+
+    bs::Vector<bs::UINT32> portalOf(numWaypoints, NONE);
+
+    auto hasConnectionIntoOtherCluster = [&](bs::UINT32 waypoint) {
+      for (bs::UINT32 e = edgeOffsets[waypoint]; e < edgeOffsets[waypoint + 1]; e++)
+      {
+        if (mClusterOf[neighbours[e]] != mClusterOf[waypoint]) return true;
+      }
+
+      for (bs::UINT32 e = reverseOffsets[waypoint]; e < reverseOffsets[waypoint + 1]; e++)
+      {
+        if (mClusterOf[reverseNeighbours[e]] != mClusterOf[waypoint]) return true;
+      }
+
+      return false;
+    };
+
+    for (bs::UINT32 cluster = 0; cluster < numClusters(); cluster++)
+    {
+      mClusterPortalOffsets.push_back((bs::UINT32)mClusterPortals.size());
+
+      const bs::UINT32 membersBegin = mClusterMemberOffsets[cluster];
+      const bs::UINT32 membersEnd   = mClusterMemberOffsets[cluster + 1];
+
+      for (bs::UINT32 m = membersBegin; m < membersEnd; m++)
+      {
+        bs::UINT32 waypoint = mClusterMembers[m];
+
+        if (!hasConnectionIntoOtherCluster(waypoint)) continue;
+
+        bs::UINT32 portal  = (bs::UINT32)mPortalWaypoints.size();
+        portalOf[waypoint] = portal;
+
+        mClusterPortals.push_back(portal);
+        mPortalWaypoints.push_back(waypoint);
+        mPortalPositions.push_back(positions[waypoint]);
+
+        // Costs between this portal and every member of the cluster
+        bs::UINT32 costOffset = (bs::UINT32)mCostsFromPortal.size();
+        bs::UINT32 numMembers = membersEnd - membersBegin;
+
+        mPortalCostOffsets.push_back(costOffset);
+        mCostsFromPortal.resize(costOffset + numMembers);
+        mCostsToPortal.resize(costOffset + numMembers);
+
+        computeCostsInsideCluster(waypoint, edgeOffsets, neighbours, edgeLengths,
+                                  &mCostsFromPortal[costOffset]);
+        computeCostsInsideCluster(waypoint, reverseOffsets, reverseNeighbours, reverseLengths,
+                                  &mCostsToPortal[costOffset]);
+      }
+    }
+
+    mClusterPortalOffsets.push_back((bs::UINT32)mClusterPortals.size());
+
+    // Connect the portals: Inside a cluster by the costs computed above, to other clusters
+    // by the actual connections of the waynet.
+    mPortalEdgeOffsets.clear();
+    mPortalNeighbours.clear();
+    mPortalEdgeLengths.clear();
+
+    for (bs::UINT32 portal = 0; portal < numPortals(); portal++)
+    {
+      mPortalEdgeOffsets.push_back((bs::UINT32)mPortalNeighbours.size());
+
+      const bs::UINT32 waypoint = mPortalWaypoints[portal];
+      const bs::UINT32 cluster  = mClusterOf[waypoint];
+
+      for (bs::UINT32 i = mClusterPortalOffsets[cluster]; i < mClusterPortalOffsets[cluster + 1];
+           i++)
+      {
+        bs::UINT32 other = mClusterPortals[i];
+
+        if (other == portal) continue;
+
+        float cost = costFromPortal(portal, mLocalIndexOf[mPortalWaypoints[other]]);
+
+        if (cost == INFINITE_COST) continue;
+
+        mPortalNeighbours.push_back(other);
+        mPortalEdgeLengths.push_back(cost);
+      }
+
+      for (bs::UINT32 e = edgeOffsets[waypoint]; e < edgeOffsets[waypoint + 1]; e++)
+      {
+        bs::UINT32 other = neighbours[e];
+
+        if (mClusterOf[other] == cluster) continue;
+
+        mPortalNeighbours.push_back(portalOf[other]);
+        mPortalEdgeLengths.push_back(edgeLengths[e]);
+      }
+    }
+
+    mPortalEdgeOffsets.push_back((bs::UINT32)mPortalNeighbours.size());
+  }
+
+  void WaynetClusters::computeCostsInsideCluster(bs::UINT32 from,
+                                                 const bs::Vector<bs::UINT32>& edgeOffsets,
+                                                 const bs::Vector<bs::UINT32>& neighbours,
+                                                 const bs::Vector<float>& edgeLengths,
+                                                 float* outCosts)
+  {
+    const bs::UINT32 cluster = mClusterOf[from];
+    const bs::UINT32 numMembers =
+        mClusterMemberOffsets[cluster + 1] - mClusterMemberOffsets[cluster];
+
+    std::fill(outCosts, outCosts + numMembers, INFINITE_COST);
+
+    using OpenEntry = std::pair<float, bs::UINT32>;
+    std::priority_queue<OpenEntry, bs::Vector<OpenEntry>, std::greater<OpenEntry>> open;
+
+    outCosts[mLocalIndexOf[from]] = 0.0f;
+    open.push(OpenEntry(0.0f, from));
+
+    while (!open.empty())
+    {
+      float cost         = open.top().first;
+      bs::UINT32 current = open.top().second;
+      open.pop();
+
+      // Outdated entry, a cheaper one for this waypoint has been handled already
+      if (cost > outCosts[mLocalIndexOf[current]]) continue;
+
+      for (bs::UINT32 e = edgeOffsets[current]; e < edgeOffsets[current + 1]; e++)
+      {
+        bs::UINT32 other = neighbours[e];
+
+        if (mClusterOf[other] != cluster) continue;
+
+        float newCost = cost + edgeLengths[e];
+
+        if (newCost < outCosts[mLocalIndexOf[other]])
+        {
+          outCosts[mLocalIndexOf[other]] = newCost;
+          open.push(OpenEntry(newCost, other));
+        }
+      }
+    }
+  }
+
+  bs::Vector<bs::UINT32> WaynetClusters::findMilestones(bs::UINT32 start, bs::UINT32 goal,
+                                                        const bs::Vector3& goalPosition)
+  {
+    if (start >= mClusterOf.size() || goal >= mClusterOf.size()) return {};
+
+    if (start == goal) return {start};
+
+    const bs::UINT32 startCluster = mClusterOf[start];
+    const bs::UINT32 goalCluster  = mClusterOf[goal];
+
+    if (startCluster == goalCluster) return {start, goal};
+
+    // A* over the portals, with two extra nodes for start and goal. The straight line
+    // distance to the goal is used as heuristic, which never overestimates since all
+    // costs are made from straight connections between waypoints.
+    const bs::UINT32 startNode = numPortals();
+    const bs::UINT32 goalNode  = numPortals() + 1;
+
+    mSearchMark++;
+
+    // Wrapped around, so old marks could be mistaken for current ones
+    if (mSearchMark == 0)
+    {
+      for (SearchNode& node : mSearchNodes)
+      {
+        node.searchMark = 0;
+      }
+
+      mSearchMark = 1;
+    }
+
+    using OpenEntry = std::pair<float, bs::UINT32>;
+    std::priority_queue<OpenEntry, bs::Vector<OpenEntry>, std::greater<OpenEntry>> open;
+
+    auto estimateToGoal = [&](bs::UINT32 node) {
+      if (node >= startNode) return 0.0f;
+
+      return mPortalPositions[node].distance(goalPosition);
+    };
+
+    auto reach = [&](bs::UINT32 node, bs::UINT32 from, float cost) {
+      SearchNode& searchNode = mSearchNodes[node];
+
+      if (searchNode.searchMark == mSearchMark)
+      {
+        if (searchNode.isClosed || cost >= searchNode.costFromStart) return;
+      }
+
+      searchNode.costFromStart = cost;
+      searchNode.previous      = from;
+      searchNode.searchMark    = mSearchMark;
+      searchNode.isClosed      = false;
+
+      open.push(OpenEntry(cost + estimateToGoal(node), node));
+    };
+
+    reach(startNode, NONE, 0.0f);
+
+    bool hasReachedGoal = false;
+
+    while (!open.empty())
+    {
+      bs::UINT32 current = open.top().second;
+      open.pop();
+
+      SearchNode& currentNode = mSearchNodes[current];
+
+      if (currentNode.isClosed) continue;
+
+      currentNode.isClosed = true;
+
+      if (current == goalNode)
+      {
+        hasReachedGoal = true;
+        break;
+      }
+
+      const float currentCost = currentNode.costFromStart;
+
+      if (current == startNode)
+      {
+        const bs::UINT32 local = mLocalIndexOf[start];
+
+        for (bs::UINT32 i = mClusterPortalOffsets[startCluster];
+             i < mClusterPortalOffsets[startCluster + 1]; i++)
+        {
+          bs::UINT32 portal = mClusterPortals[i];
+          float cost        = costToPortal(portal, local);
+
+          if (cost != INFINITE_COST) reach(portal, current, currentCost + cost);
+        }
+
+        continue;
+      }
+
+      for (bs::UINT32 e = mPortalEdgeOffsets[current]; e < mPortalEdgeOffsets[current + 1]; e++)
+      {
+        reach(mPortalNeighbours[e], current, currentCost + mPortalEdgeLengths[e]);
+      }
+
+      if (mClusterOf[mPortalWaypoints[current]] == goalCluster)
+      {
+        float cost = costFromPortal(current, mLocalIndexOf[goal]);
+
+        if (cost != INFINITE_COST) reach(goalNode, current, currentCost + cost);
+      }
+    }
+
+    if (!hasReachedGoal) return {};
+
+    // Put milestones together, starting from the goal
+    bs::Vector<bs::UINT32> milestones;
+
+    for (bs::UINT32 n = goalNode; n != NONE; n = mSearchNodes[n].previous)
+    {
+      bs::UINT32 waypoint = n == goalNode ? goal : n == startNode ? start : mPortalWaypoints[n];
+
+      // Start or goal might be portals themselves
+      if (milestones.empty() || milestones.back() != waypoint)
+      {
+        milestones.push_back(waypoint);
+      }
+    }
+
+    std::reverse(milestones.begin(), milestones.end());
+
+    return milestones;
+  }
+}  // namespace REGoth
@@ -0,0 +1,191 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <Math/BsVector3.h>
+
+namespace REGoth
+{
+  /**
+   * Coarse layer over a waynet for finding long ways without searching through the
+   * whole waynet.
+   *
+   * The waypoints are split into clusters: Each cell of a grid on the XZ-plane is
+   * split further into the groups of waypoints connected to each other inside that
+   * cell. Waypoints with a connection into another cluster are called *portals*.
+   *
+   * When building, the costs of going between any two portals of the same cluster
+   * are computed, as well as between each portal and all waypoints of its cluster.
+   * A search for a long way then only needs to look at the portals, after which the
+   * way is made of *milestones*: The start, every portal the way goes through and the
+   * goal. The actual waypoints between two milestones can be searched for when they
+   * are needed, which only involves the waypoints near them.
+   *
+   * Like the KDTree, this doesn't know about the waypoints themselves, but refers to
+   * them by index. It is built from the same flat adjacency lists the Waynet searches
+   * on. Once built, it cannot be modified. If the waynet changes, it has to be built
+   * again.
+   */
+  class WaynetClusters
+  {
+  public:
+    /**
+     * Index reported when there is no such waypoint, cluster or portal.
+     */
+    static constexpr bs::UINT32 NONE = 0xFFFFFFFF;
+
+    /**
+     * Builds the clusters for the given graph. The neighbours of the waypoint with index
+     * `i` are `neighbours[edgeOffsets[i]]` up to (excluding) `neighbours[edgeOffsets[i + 1]]`,
+     * with the length of each connection stored in `edgeLengths` at the same index.
+     *
+     * Will drop anything already in there and thus can be called multiple times.
+     */
+    void build(const bs::Vector<bs::Vector3>& positions, const bs::Vector<bs::UINT32>& edgeOffsets,
+               const bs::Vector<bs::UINT32>& neighbours, const bs::Vector<float>& edgeLengths);
+
+    /**
+     * Finds the milestones of the shortest way between the given waypoints, going only
+     * over the portals.
+     *
+     * If both waypoints are inside the same cluster, the result is just those two.
+     *
+     * @param  goalPosition  Position of the `goal` waypoint.
+     *
+     * @return Indices of the waypoints making up the milestones, including `start` and
+     *         `goal`. Empty if there is no way.
+     */
+    bs::Vector<bs::UINT32> findMilestones(bs::UINT32 start, bs::UINT32 goal,
+                                          const bs::Vector3& goalPosition);
+
+    /**
+     * @return Whether the clusters have not been built.
+     */
+    bool isEmpty() const
+    {
+      return mClusterOf.empty();
+    }
+
+    /**
+     * @return Cluster the waypoint with the given index is in.
+     */
+    bs::UINT32 clusterOf(bs::UINT32 waypoint) const
+    {
+      return mClusterOf[waypoint];
+    }
+
+    bs::UINT32 numClusters() const
+    {
+      return (bs::UINT32)mClusterMemberOffsets.size() - 1;
+    }
+
+    bs::UINT32 numPortals() const
+    {
+      return (bs::UINT32)mPortalWaypoints.size();
+    }
+
+  private:
+    /**
+     * Sorts the waypoints into clusters and fills mClusterOf, mLocalIndexOf and the
+     * mClusterMember*-vectors.
+     */
+    void buildClusters(const bs::Vector<bs::Vector3>& positions,
+                       const bs::Vector<bs::UINT32>& edgeOffsets,
+                       const bs::Vector<bs::UINT32>& neighbours,
+                       const bs::Vector<bs::UINT32>& reverseOffsets,
+                       const bs::Vector<bs::UINT32>& reverseNeighbours);
+
+    /**
+     * Finds the portals of all clusters, computes the costs between them and the
+     * members of their clusters and connects them into the portal graph.
+     *
+     * The `reverse*`-vectors hold the same graph with all connections turned around.
+     */
+    void buildPortals(const bs::Vector<bs::Vector3>& positions,
+                      const bs::Vector<bs::UINT32>& edgeOffsets,
+                      const bs::Vector<bs::UINT32>& neighbours,
+                      const bs::Vector<float>& edgeLengths,
+                      const bs::Vector<bs::UINT32>& reverseOffsets,
+                      const bs::Vector<bs::UINT32>& reverseNeighbours,
+                      const bs::Vector<float>& reverseLengths);
+
+    /**
+     * Runs Dijkstra from the given waypoint, only going over waypoints of its cluster.
+     * Writes the costs to all members of the cluster into `outCosts`, by their local
+     * index. Unreachable members get infinite cost.
+     */
+    void computeCostsInsideCluster(bs::UINT32 from, const bs::Vector<bs::UINT32>& edgeOffsets,
+                                   const bs::Vector<bs::UINT32>& neighbours,
+                                   const bs::Vector<float>& edgeLengths, float* outCosts);
+
+    /**
+     * @return Cost from the given portal to the member of its cluster with the given local
+     *         index and the other way around.
+     */
+    float costFromPortal(bs::UINT32 portal, bs::UINT32 localIndex) const
+    {
+      return mCostsFromPortal[mPortalCostOffsets[portal] + localIndex];
+    }
+
+    float costToPortal(bs::UINT32 portal, bs::UINT32 localIndex) const
+    {
+      return mCostsToPortal[mPortalCostOffsets[portal] + localIndex];
+    }
+
+    /**
+     * Per-node bookkeeping of findMilestones(). Nodes are the portals, plus one each for
+     * start and goal at the end.
+     */
+    struct SearchNode
+    {
+      float costFromStart;
+      bs::UINT32 previous;
+      bs::UINT32 searchMark;
+      bool isClosed;
+    };
+
+    /**
+     * Cluster of each waypoint and index of the waypoint inside its cluster.
+     */
+    bs::Vector<bs::UINT32> mClusterOf;
+    bs::Vector<bs::UINT32> mLocalIndexOf;
+
+    /**
+     * Members of the cluster with index `c` are `mClusterMembers[mClusterMemberOffsets[c]]`
+     * up to (excluding) `mClusterMembers[mClusterMemberOffsets[c + 1]]`. The same goes for
+     * its portals inside mClusterPortals.
+     */
+    bs::Vector<bs::UINT32> mClusterMemberOffsets;
+    bs::Vector<bs::UINT32> mClusterMembers;
+    bs::Vector<bs::UINT32> mClusterPortalOffsets;
+    bs::Vector<bs::UINT32> mClusterPortals;
+
+    /**
+     * Waypoint and position of each portal.
+     */
+    bs::Vector<bs::UINT32> mPortalWaypoints;
+    bs::Vector<bs::Vector3> mPortalPositions;
+
+    /**
+     * Costs between each portal and all members of its cluster, by the members local
+     * index. The ones of portal `p` start at `mPortalCostOffsets[p]`.
+     */
+    bs::Vector<bs::UINT32> mPortalCostOffsets;
+    bs::Vector<float> mCostsFromPortal;
+    bs::Vector<float> mCostsToPortal;
+
+    /**
+     * Connections between the portals, same layout as the waynets search graph. Contains
+     * the connections between the portals of the same cluster and the actual waynet
+     * connections into other clusters.
+     */
+    bs::Vector<bs::UINT32> mPortalEdgeOffsets;
+    bs::Vector<bs::UINT32> mPortalNeighbours;
+    bs::Vector<float> mPortalEdgeLengths;
+
+    /**
+     * Scratch space, kept so searching doesn't need to allocate. See Waynet for how
+     * the search marks work.
+     */
+    bs::Vector<SearchNode> mSearchNodes;
+    bs::UINT32 mSearchMark = 0;
+  };
+}  // namespace REGoth
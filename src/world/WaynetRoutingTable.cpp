@@ -0,0 +1,238 @@
+#include "WaynetRoutingTable.hpp"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <FileSystem/BsDataStream.h>
+#include <FileSystem/BsFileSystem.h>
+
+namespace REGoth
+{
+  /**
+   * Written at the start of saved tables. Bump the version whenever the layout changes.
+   */
+  static constexpr bs::UINT32 ROUTING_TABLE_MAGIC   = 0x42545257;  // "WRTB"
+  static constexpr bs::UINT32 ROUTING_TABLE_VERSION = 1;
+
+  struct RoutingTableFileHeader
+  {
+    bs::UINT32 magic;
+    bs::UINT32 version;
+    bs::UINT64 graphHash;
+    bs::UINT32 numWaypoints;
+    bs::UINT32 numRuns;
+  };
+
+  void WaynetRoutingTable::build(const bs::Vector<bs::UINT32>& edgeOffsets,
+                                 const bs::Vector<bs::UINT32>& neighbours,
+                                 const bs::Vector<float>& edgeLengths)
+  {
+    clear();
+
+    if (edgeOffsets.empty()) return;
+
+    const bs::UINT32 numWaypoints = (bs::UINT32)edgeOffsets.size() - 1;
+    const float unreached         = std::numeric_limits<float>::max();
+
+    // Scratch space of the search, reused for every row
+    bs::Vector<float> cost(numWaypoints);
+    bs::Vector<bs::UINT32> previous(numWaypoints);
+    bs::Vector<bs::UINT32> firstHop(numWaypoints);
+    bs::Vector<bool> isClosed(numWaypoints);
+
+    using OpenEntry = std::pair<float, bs::UINT32>;
+    std::priority_queue<OpenEntry, bs::Vector<OpenEntry>, std::greater<OpenEntry>> open;
+
+    mRowOffsets.reserve(numWaypoints + 1);
+
+    for (bs::UINT32 from = 0; from < numWaypoints; from++)
+    {
+      // Dijkstra from this waypoint, remembering for every reached waypoint which
+      // neighbour of `from` the way to it starts with.
+      std::fill(cost.begin(), cost.end(), unreached);
+      std::fill(previous.begin(), previous.end(), NO_WAYPOINT);
+      std::fill(firstHop.begin(), firstHop.end(), NO_WAYPOINT);
+      std::fill(isClosed.begin(), isClosed.end(), false);
+
+      cost[from] = 0.0f;
+      open.push(OpenEntry(0.0f, from));
+
+      while (!open.empty())
+      {
+        bs::UINT32 current = open.top().second;
+        open.pop();
+
+        if (isClosed[current]) continue;
+
+        isClosed[current] = true;
+
+        for (bs::UINT32 e = edgeOffsets[current]; e < edgeOffsets[current + 1]; e++)
+        {
+          bs::UINT32 neighbour = neighbours[e];
+          float newCost        = cost[current] + edgeLengths[e];
+          bs::UINT32 hop       = current == from ? neighbour : firstHop[current];
+
+          if (newCost < cost[neighbour])
+          {
+            cost[neighbour]     = newCost;
+            previous[neighbour] = current;
+            firstHop[neighbour] = hop;
+
+            open.push(OpenEntry(newCost, neighbour));
+          }
+          else if (newCost == cost[neighbour] && !isClosed[neighbour] &&
+                   current < previous[neighbour])
+          {
+            // Equally long way: Prefer the lower index, like Waynet::findWay() does
+            previous[neighbour] = current;
+            firstHop[neighbour] = hop;
+          }
+        }
+      }
+
+      // Compress the row into runs. The entry of `from` itself is never looked at, so
+      // it is simply made part of whatever run it falls into.
+      mRowOffsets.push_back((bs::UINT32)mRunStarts.size());
+
+      for (bs::UINT32 to = 0; to < numWaypoints; to++)
+      {
+        if (to == from) continue;
+
+        bool isFirstRunOfRow = mRunStarts.size() == mRowOffsets.back();
+
+        if (isFirstRunOfRow)
+        {
+          mRunStarts.push_back(0);
+          mRunHops.push_back(firstHop[to]);
+        }
+        else if (mRunHops.back() != firstHop[to])
+        {
+          mRunStarts.push_back(to);
+          mRunHops.push_back(firstHop[to]);
+        }
+      }
+    }
+
+    mRowOffsets.push_back((bs::UINT32)mRunStarts.size());
+
+    mRunStarts.shrink_to_fit();
+    mRunHops.shrink_to_fit();
+  }
+
+  bs::UINT32 WaynetRoutingTable::nextHop(bs::UINT32 from, bs::UINT32 to) const
+  {
+    if (from == to) return to;
+
+    if (isEmpty()) return NO_WAYPOINT;
+
+    const bs::UINT32 numWaypoints = (bs::UINT32)mRowOffsets.size() - 1;
+
+    if (from >= numWaypoints || to >= numWaypoints) return NO_WAYPOINT;
+
+    auto rowBegin = mRunStarts.begin() + mRowOffsets[from];
+    auto rowEnd   = mRunStarts.begin() + mRowOffsets[from + 1];
+
+    if (rowBegin == rowEnd) return NO_WAYPOINT;
+
+    // Last run starting at or before the target. The first one starts at 0, so there
+    // always is one.
+    auto run = std::upper_bound(rowBegin, rowEnd, to) - 1;
+
+    return mRunHops[run - mRunStarts.begin()];
+  }
+
+  bs::UINT64 WaynetRoutingTable::hashGraph(const bs::Vector<bs::UINT32>& edgeOffsets,
+                                           const bs::Vector<bs::UINT32>& neighbours,
+                                           const bs::Vector<float>& edgeLengths)
+  {
+    // FNV-1a
+    bs::UINT64 hash = 0xcbf29ce484222325ULL;
+
+    auto hashBytes = [&](const void* data, size_t size) {
+      const bs::UINT8* bytes = (const bs::UINT8*)data;
+
+      for (size_t i = 0; i < size; i++)
+      {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+      }
+    };
+
+    hashBytes(edgeOffsets.data(), edgeOffsets.size() * sizeof(bs::UINT32));
+    hashBytes(neighbours.data(), neighbours.size() * sizeof(bs::UINT32));
+    hashBytes(edgeLengths.data(), edgeLengths.size() * sizeof(float));
+
+    return hash;
+  }
+
+  void WaynetRoutingTable::save(const bs::Path& path, bs::UINT64 graphHash) const
+  {
+    RoutingTableFileHeader header;
+    header.magic        = ROUTING_TABLE_MAGIC;
+    header.version      = ROUTING_TABLE_VERSION;
+    header.graphHash    = graphHash;
+    header.numWaypoints = isEmpty() ? 0 : (bs::UINT32)mRowOffsets.size() - 1;
+    header.numRuns      = (bs::UINT32)mRunStarts.size();
+
+    bs::FileSystem::createDir(path.getParent());
+
+    bs::SPtr<bs::DataStream> stream = bs::FileSystem::createAndOpenFile(path);
+
+    if (!stream) return;
+
+    stream->write(&header, sizeof(header));
+    stream->write(mRowOffsets.data(), mRowOffsets.size() * sizeof(bs::UINT32));
+    stream->write(mRunStarts.data(), mRunStarts.size() * sizeof(bs::UINT32));
+    stream->write(mRunHops.data(), mRunHops.size() * sizeof(bs::UINT32));
+    stream->close();
+  }
+
+  bool WaynetRoutingTable::load(const bs::Path& path, bs::UINT64 graphHash)
+  {
+    clear();
+
+    if (!bs::FileSystem::isFile(path)) return false;
+
+    bs::SPtr<bs::DataStream> stream = bs::FileSystem::openFile(path, true);
+
+    if (!stream) return false;
+
+    RoutingTableFileHeader header;
+
+    if (stream->read(&header, sizeof(header)) != sizeof(header)) return false;
+
+    if (header.magic != ROUTING_TABLE_MAGIC) return false;
+    if (header.version != ROUTING_TABLE_VERSION) return false;
+    if (header.graphHash != graphHash) return false;
+    if (header.numWaypoints == 0) return false;
+
+    mRowOffsets.resize(header.numWaypoints + 1);
+    mRunStarts.resize(header.numRuns);
+    mRunHops.resize(header.numRuns);
+
+    auto readArray = [&](bs::Vector<bs::UINT32>& array) {
+      size_t size = array.size() * sizeof(bs::UINT32);
+
+      return stream->read(array.data(), size) == size;
+    };
+
+    bool isComplete = readArray(mRowOffsets) && readArray(mRunStarts) && readArray(mRunHops);
+
+    stream->close();
+
+    if (!isComplete || mRowOffsets.back() != header.numRuns)
+    {
+      clear();
+      return false;
+    }
+
+    return true;
+  }
+
+  void WaynetRoutingTable::clear()
+  {
+    mRowOffsets.clear();
+    mRunStarts.clear();
+    mRunHops.clear();
+  }
+}  // namespace REGoth
@@ -0,0 +1,110 @@
+#pragma once
+#include <BsPrerequisites.h>
+#include <FileSystem/BsPath.h>
+
+namespace REGoth
+{
+  /**
+   * Precomputed next hops for routing between any two waypoints of a waynet.
+   *
+   * For every pair of waypoints, the table knows which waypoint to go to next to
+   * get from the first one to the second one on the shortest way. Walking the table
+   * hop by hop yields the whole way, without having to search the waynet.
+   *
+   * Like the KDTree, the table doesn't know about the waypoints themselves, but
+   * refers to them by index. It is built from the same flat adjacency lists the
+   * Waynet searches on.
+   *
+   * Storing a hop for every pair would take a lot of memory on the bigger worlds.
+   * However, waypoints close to each other tend to have similar indices, so for
+   * a given waypoint, long ranges of consecutive target indices share the same next
+   * hop. Therefore, each row is stored as a list of runs over the target indices.
+   *
+   * Building the table runs a shortest path search from every waypoint, which takes
+   * a moment on the bigger worlds. That's why it can be saved to and loaded from a
+   * file, tagged with a hash of the graph it was built from. See hashGraph().
+   */
+  class WaynetRoutingTable
+  {
+  public:
+    /**
+     * Reported as next hop if there is no way to the target.
+     */
+    static constexpr bs::UINT32 NO_WAYPOINT = 0xFFFFFFFF;
+
+    /**
+     * Builds the table for the given graph. The neighbours of the waypoint with index `i`
+     * are `neighbours[edgeOffsets[i]]` up to (excluding) `neighbours[edgeOffsets[i + 1]]`,
+     * with the length of each connection stored in `edgeLengths` at the same index.
+     *
+     * Will drop anything already in the table and thus can be called multiple times.
+     */
+    void build(const bs::Vector<bs::UINT32>& edgeOffsets, const bs::Vector<bs::UINT32>& neighbours,
+               const bs::Vector<float>& edgeLengths);
+
+    /**
+     * @return Index of the waypoint to go to next on the way from `from` to `to`.
+     *         `to`, if both are the same. NO_WAYPOINT if `to` cannot be reached.
+     */
+    bs::UINT32 nextHop(bs::UINT32 from, bs::UINT32 to) const;
+
+    /**
+     * Computes a hash over the given graph, see build(), to tell whether a saved
+     * table still matches it.
+     */
+    static bs::UINT64 hashGraph(const bs::Vector<bs::UINT32>& edgeOffsets,
+                                const bs::Vector<bs::UINT32>& neighbours,
+                                const bs::Vector<float>& edgeLengths);
+
+    /**
+     * Saves the table to the given file, overwriting it.
+     *
+     * @param  graphHash  Hash of the graph the table was built from, see hashGraph().
+     */
+    void save(const bs::Path& path, bs::UINT64 graphHash) const;
+
+    /**
+     * Loads a table previously saved via save().
+     *
+     * @param  graphHash  Hash of the graph the table is needed for, see hashGraph().
+     *
+     * @return Whether the table could be loaded. False if the file does not exist, is
+     *         damaged or was built from a different graph. The table is empty then.
+     */
+    bool load(const bs::Path& path, bs::UINT64 graphHash);
+
+    /**
+     * @return Whether the table has not been built or loaded.
+     */
+    bool isEmpty() const
+    {
+      return mRowOffsets.empty();
+    }
+
+    /**
+     * Drops the table.
+     */
+    void clear();
+
+    /**
+     * @return Number of runs stored over all rows, to get an idea of how well the table
+     *         has been compressed.
+     */
+    bs::UINT32 numRuns() const
+    {
+      return (bs::UINT32)mRunStarts.size();
+    }
+
+  private:
+    /**
+     * The runs of the waypoint with index `i` are `mRunStarts[mRowOffsets[i]]` up to
+     * (excluding) `mRunStarts[mRowOffsets[i + 1]]`. Each run covers the target indices
+     * from its start up to the start of the next run of the same row, or the end. The
+     * first run of a row always starts at index 0. `mRunHops` holds the next hop for
+     * all targets inside the run at the same index.
+     */
+    bs::Vector<bs::UINT32> mRowOffsets;
+    bs::Vector<bs::UINT32> mRunStarts;
+    bs::Vector<bs::UINT32> mRunHops;
+  };
+}  // namespace REGoth
@@ -1,9 +1,23 @@
 #pragma once
-#include <map>
+#include <cmath>
+#include <BsPrerequisites.h>
 #include <Math/BsVector3.h>
+#include <Scene/BsGameObjectHandle.h>
 
 namespace REGoth
 {
+  /**
+   * Hashes game object handles by the instance ID of the object they point to.
+   * Can be used to store `bs::GameObjectHandle`s inside a `WorldHashGrid`.
+   */
+  struct GameObjectHandleHash
+  {
+    size_t operator()(const bs::GameObjectHandleBase& handle) const
+    {
+      return std::hash<bs::UINT64>()(handle.getInstanceId());
+    }
+  };
+
   /**
    * Stores a grid of cells, where each cell can contain `bs::SceneObject`s or
    * something else.
@@ -12,6 +26,11 @@ namespace REGoth
    * out what other objects are inside the cell the given position lays in.
    * Additionally, it can search the surrounding cells.
    *
+   * Only cells which contain something are actually stored, so the grid can
+   * span the whole world without wasting memory on empty areas.
+   *
+   * Every value can only be stored once inside the grid.
+   *
    * Use Case - Show object names
    * ============================
    *
@@ -25,11 +44,14 @@ namespace REGoth
    * By searching the cell around the player, we can get the possibly focused
    * items much quicker.
    */
-  template <typename T>
+  template <typename T, typename Hash = std::hash<T>>
   class WorldHashGrid
   {
   public:
-    WorldHashGrid(bs::INT32 cellSize)
+    /**
+     * @param  cellSize  Width and depth of a single cell in meters.
+     */
+    WorldHashGrid(float cellSize)
         : mCellSize(cellSize)
     {
     }
@@ -37,44 +59,193 @@ namespace REGoth
     /**
      * Adds an object at the given position. Note that this takes a 3D vector
      * but it will project it down to the XZ-plane since the Grid is 2D.
+     *
+     * Does nothing if the object is already inside the grid, use move() for that.
      */
-    void add(const bs::Vector3& position, const T& value)
+    void add(const T& value, const bs::Vector3& position)
     {
-      auto cell = positionToCell(position);
+      if (contains(value)) return;
+
+      CellKey cell = positionToCell(position);
 
-      mCells.insert(std::make_pair(cell, value));
+      mCells[cell].push_back(Entry{value, position});
+      mCellOfValue[value] = cell;
     }
 
-    /*void remove(const bs::Vector3& position, const T& value)
+    /**
+     * Removes the given object from the grid. Does nothing if it isn't inside the grid.
+     */
+    void remove(const T& value)
     {
-        mCells.erase();
-    }*/
+      auto it = mCellOfValue.find(value);
 
-  private:
-    struct Cell
+      if (it == mCellOfValue.end()) return;
+
+      removeFromCell(it->second, value);
+
+      mCellOfValue.erase(it);
+    }
+
+    /**
+     * Updates the position of an object already inside the grid. Does nothing if it
+     * isn't inside the grid.
+     */
+    void move(const T& value, const bs::Vector3& position)
     {
-      bs::INT32 x;
-      bs::INT32 y;
+      auto it = mCellOfValue.find(value);
+
+      if (it == mCellOfValue.end()) return;
 
-      bool operator<(const Cell& rhs) const
+      CellKey newCell = positionToCell(position);
+
+      if (newCell == it->second)
       {
-        if (x != v.x) return x < v.x;
+        for (Entry& entry : mCells[newCell])
+        {
+          if (entry.value == value)
+          {
+            entry.position = position;
+            return;
+          }
+        }
+      }
+      else
+      {
+        removeFromCell(it->second, value);
 
-        return y < v.y;
+        mCells[newCell].push_back(Entry{value, position});
+        it->second = newCell;
       }
+    }
+
+    /**
+     * @return Whether the given object is inside the grid.
+     */
+    bool contains(const T& value) const
+    {
+      return mCellOfValue.find(value) != mCellOfValue.end();
+    }
+
+    /**
+     * Removes all objects from the grid.
+     */
+    void clear()
+    {
+      mCells.clear();
+      mCellOfValue.clear();
+    }
+
+    /**
+     * Calls the given function for each object which is within the given radius
+     * around the given position, in no particular order.
+     *
+     * Only the cells touched by the radius are searched. Positions are compared in 3D,
+     * using the positions last passed to add() or move().
+     *
+     * @param  position  Center of the search.
+     * @param  radius    Search radius in meters.
+     * @param  callback  Function called as `callback(value, distanceSq)`, where `distanceSq`
+     *                   is the squared distance of the object to `position`.
+     */
+    template <typename Callback>
+    void forEachInRange(const bs::Vector3& position, float radius, Callback callback) const
+    {
+      const float radiusSq = radius * radius;
+
+      auto visitCell = [&](const bs::Vector<Entry>& entries) {
+        for (const Entry& entry : entries)
+        {
+          float distanceSq = entry.position.squaredDistance(position);
+
+          if (distanceSq < radiusSq)
+          {
+            callback(entry.value, distanceSq);
+          }
+        }
+      };
+
+      bs::INT32 minX = cellCoordinate(position.x - radius);
+      bs::INT32 maxX = cellCoordinate(position.x + radius);
+      bs::INT32 minZ = cellCoordinate(position.z - radius);
+      bs::INT32 maxZ = cellCoordinate(position.z + radius);
+
+      bs::UINT64 numCellsInRange = (bs::UINT64)(maxX - minX + 1) * (bs::UINT64)(maxZ - minZ + 1);
+
+      // For huge ranges it's quicker to just look at every cell containing something
+      if (numCellsInRange > mCells.size())
+      {
+        for (const auto& cell : mCells)
+        {
+          visitCell(cell.second);
+        }
+
+        return;
+      }
+
+      for (bs::INT32 x = minX; x <= maxX; x++)
+      {
+        for (bs::INT32 z = minZ; z <= maxZ; z++)
+        {
+          auto it = mCells.find(makeCellKey(x, z));
+
+          if (it != mCells.end())
+          {
+            visitCell(it->second);
+          }
+        }
+      }
+    }
+
+  private:
+    using CellKey = bs::UINT64;
+
+    struct Entry
+    {
+      T value;
+      bs::Vector3 position;
     };
 
-    Cell positionToCell(const bs::Vector3& position) const
+    bs::INT32 cellCoordinate(float value) const
     {
-      Cell c{};
+      return static_cast<bs::INT32>(std::floor(value / mCellSize));
+    }
 
-      c.x = static_cast<bs::INT32>(position.x / mCellSize);
-      c.y = static_cast<bs::INT32>(position.y / mCellSize);
+    static CellKey makeCellKey(bs::INT32 x, bs::INT32 z)
+    {
+      return ((CellKey)(bs::UINT32)x << 32) | (CellKey)(bs::UINT32)z;
+    }
 
-      return c;
+    CellKey positionToCell(const bs::Vector3& position) const
+    {
+      return makeCellKey(cellCoordinate(position.x), cellCoordinate(position.z));
+    }
+
+    void removeFromCell(CellKey cell, const T& value)
+    {
+      auto it = mCells.find(cell);
+
+      if (it == mCells.end()) return;
+
+      bs::Vector<Entry>& entries = it->second;
+
+      for (size_t i = 0; i < entries.size(); i++)
+      {
+        if (entries[i].value == value)
+        {
+          entries[i] = entries.back();
+          entries.pop_back();
+          break;
+        }
+      }
+
+      if (entries.empty())
+      {
+        mCells.erase(it);
+      }
     }
 
-    bs::INT32 mCellSize;
-    std::multimap<Cell, T> mCells;
-  }
-}  // namespace REGoth
\ No newline at end of file
+    float mCellSize;
+    bs::UnorderedMap<CellKey, bs::Vector<Entry>> mCells;
+    bs::UnorderedMap<T, CellKey, Hash> mCellOfValue;
+  };
+}  // namespace REGoth
@@ -2,20 +2,23 @@
 #include "ImportSingleVob.hpp"
 #include <BsZenLib/ImportPath.hpp>
 #include <BsZenLib/ImportStaticMesh.hpp>
-#include <BsZenLib/ResourceManifest.hpp>
 #include <BsZenLib/ZenResources.hpp>
 #include <Components/BsCMeshCollider.h>
 #include <Physics/BsPhysicsMesh.h>
 #include <Resources/BsResources.h>
 #include <Scene/BsSceneManager.h>
 #include <Scene/BsSceneObject.h>
+#include <Utility/BsTimer.h>
 #include <components/Freepoint.hpp>
 #include <components/GameWorld.hpp>
 #include <components/Waynet.hpp>
 #include <components/Waypoint.hpp>
 #include <exception/Throw.hpp>
 #include <log/logging.hpp>
+#include <original-content/OriginalGameResources.hpp>
 #include <original-content/VirtualFileSystem.hpp>
+#include <world/NavMesh.hpp>
+#include <world/PhysicsMeshRegistry.hpp>
 #include <zenload/zCMesh.h>
 #include <zenload/zenParser.h>
 
@@ -25,17 +28,38 @@ namespace REGoth
   {
     bs::String fileName;
     ZenLoad::oCWorldData vobTree;
+
+    /**
+     * Parser the ZEN was read with. Holds on to the world mesh, which is only packed once
+     * it is actually needed, see packedWorldMesh().
+     */
+    bs::SPtr<ZenLoad::ZenParser> parser;
+
+    bool isWorldMeshPacked = false;
     ZenLoad::PackedMesh worldMesh;
+
+    /**
+     * See hashWorldMesh().
+     */
+    bs::UINT64 worldMeshHash = 0;
+
+    Internals::ZenImportTimings timings;
   };
 
   static bool importZEN(const bs::String& zenFile, OriginalZen& result);
-  static bs::HSceneObject importWorldMesh(const OriginalZen& zen);
+  static const ZenLoad::PackedMesh& packedWorldMesh(OriginalZen& zen);
+  static void releaseParsedWorldMesh(OriginalZen& zen);
+  static bs::HSceneObject importWorldMesh(OriginalZen& zen);
   static void importVobs(bs::HSceneObject sceneRoot, HGameWorld gameWorld, const OriginalZen& zen);
   static void importWaynet(bs::HSceneObject sceneRoot, const OriginalZen& zen);
+  static bs::UINT64 hashWorldMesh(const OriginalZen& zen);
+  static void bakeNavMesh(OriginalZen& zen);
   static void walkVobTree(bs::HSceneObject bsfParent, HGameWorld gameWorld,
                           const ZenLoad::zCVobData& zenParent);
 
-  bs::HSceneObject Internals::constructFromZEN(HGameWorld gameWorld, const bs::String& zenFile)
+  bs::HSceneObject Internals::constructFromZEN(HGameWorld gameWorld, const bs::String& zenFile,
+                                               ZenImportTimings* outTimings,
+                                               bs::UINT64* outWorldMeshHash)
   {
     OriginalZen zen;
 
@@ -50,8 +74,30 @@ namespace REGoth
     bs::HSceneObject worldMesh = importWorldMesh(zen);
     worldMesh->setParent(gameWorld->SO());
 
+    zen.worldMeshHash = hashWorldMesh(zen);
+
+    bakeNavMesh(zen);
+
+    // Everything needing the world geometry is done, no need to keep it during the rest
+    releaseParsedWorldMesh(zen);
+
+    bs::Timer timer;
     importVobs(gameWorld->SO(), gameWorld, zen);
+    zen.timings.vobImportMs = timer.getMilliseconds();
+
+    timer.reset();
     importWaynet(gameWorld->SO(), zen);
+    zen.timings.waynetImportMs = timer.getMilliseconds();
+
+    if (outTimings)
+    {
+      *outTimings = zen.timings;
+    }
+
+    if (outWorldMeshHash)
+    {
+      *outWorldMeshHash = zen.worldMeshHash;
+    }
 
     return worldMesh;
   }
@@ -71,12 +117,25 @@ namespace REGoth
     return importWorldMesh(zen);
   }
 
+  /**
+   * Imports the vobs in two phases: First all resources they use are loaded on the worker
+   * threads, then the scene objects are created, which only finds them in memory.
+   */
   static void importVobs(bs::HSceneObject sceneRoot, HGameWorld gameWorld, const OriginalZen& zen)
   {
+    Internals::loadVobResources(zen.vobTree);
+
     for (const ZenLoad::zCVobData& root : zen.vobTree.rootVobs)
     {
       walkVobTree(sceneRoot, gameWorld, root);
     }
+
+    PhysicsMeshRegistry::Stats stats = gPhysicsMeshRegistry().stats();
+
+    REGOTH_LOG(Info, Uncategorized,
+               "[ConstructFromZEN] Physics meshes so far: {0} memory hits, {1} cache hits, "
+               "{2} cooked",
+               stats.numMemoryHits, stats.numCacheHits, stats.numCooked);
   }
 
   static void walkVobTree(bs::HSceneObject bsfParent, HGameWorld gameWorld,
@@ -98,48 +157,100 @@ namespace REGoth
    */
   static bool importZEN(const bs::String& zenFile, OriginalZen& result)
   {
-    ZenLoad::ZenParser zenParser(zenFile.c_str(), gVirtualFileSystem().getFileIndex());
+    bs::Timer timer;
+
+    result.parser = bs::bs_shared_ptr_new<ZenLoad::ZenParser>(
+        zenFile.c_str(), gVirtualFileSystem().getFileIndex());
 
-    if (zenParser.getFileSize() == 0) return false;
+    if (result.parser->getFileSize() == 0) return false;
 
-    zenParser.readHeader();
+    result.parser->readHeader();
 
     result.fileName = zenFile;
 
-    zenParser.readWorld(result.vobTree);
+    // Note: ZenLib reads the world mesh chunk along with the vob tree, there is no way to
+    //       skip it. Packing it is the expensive part though, which is left for later.
+    result.parser->readWorld(result.vobTree);
 
-    // FIXME: Don't pack the mesh if it was already cached, packing takes a long time...
-    zenParser.getWorldMesh()->packMesh(result.worldMesh, 0.01f);
+    result.timings.parseMs = timer.getMilliseconds();
 
     return true;
   }
 
+  /**
+   * Packs the world mesh out of the parsed ZEN the first time it is needed. Only the caches
+   * built from it need it, so with all of them in place this is never called.
+   */
+  static const ZenLoad::PackedMesh& packedWorldMesh(OriginalZen& zen)
+  {
+    if (zen.isWorldMeshPacked) return zen.worldMesh;
+
+    if (!zen.parser || !zen.parser->getWorldMesh())
+    {
+      REGOTH_THROW(InvalidStateException,
+                   "World mesh of zen " + zen.fileName + " has already been released");
+    }
+
+    bs::Timer timer;
+
+    zen.parser->getWorldMesh()->packMesh(zen.worldMesh, 0.01f);
+    zen.isWorldMeshPacked = true;
+
+    zen.timings.packMs = timer.getMilliseconds();
+
+    REGOTH_LOG(Info, Uncategorized, "[ConstructFromZEN] Packed world mesh of {0} in {1} ms",
+               zen.fileName, zen.timings.packMs);
+
+    return zen.worldMesh;
+  }
+
+  /**
+   * Drops the parser along with the world mesh it has read, as well as the packed one.
+   */
+  static void releaseParsedWorldMesh(OriginalZen& zen)
+  {
+    zen.parser = nullptr;
+
+    zen.worldMesh         = {};
+    zen.isWorldMeshPacked = false;
+  }
+
   /**
    * Create a bs:f scene object holding the world mesh.
    */
-  static bs::HSceneObject importWorldMesh(const OriginalZen& zen)
+  static bs::HSceneObject importWorldMesh(OriginalZen& zen)
   {
+    bs::Timer timer;
+
     bs::String meshFileName = zen.fileName + ".worldmesh";
 
     BsZenLib::Res::HMeshWithMaterials mesh;
-    if (BsZenLib::HasCachedStaticMesh(meshFileName))
+
+    // Only held while importing. Cooking the physics mesh below registers it in the manifest,
+    // which takes the lock again.
     {
-      mesh = BsZenLib::LoadCachedStaticMesh(meshFileName);
+      ResourceManifestWriteLock manifestLock(gResourceManifestMutex());
 
-      // This shouldn't be needed, but sometimes the worldmesh in mesh->getMesh() seems to get lost?
-      if (!mesh.isLoaded())
+      if (BsZenLib::HasCachedStaticMesh(meshFileName))
       {
-        REGOTH_LOG(Warning, Uncategorized,
-                   "Failed to load cached world mesh of zen {0} - recaching it!", zen.fileName);
-        mesh = BsZenLib::ImportAndCacheStaticMesh(meshFileName, zen.worldMesh,
+        mesh = BsZenLib::LoadCachedStaticMesh(meshFileName);
+
+        // This shouldn't be needed, but sometimes the worldmesh in mesh->getMesh() seems to get
+        // lost?
+        if (!mesh.isLoaded())
+        {
+          REGOTH_LOG(Warning, Uncategorized,
+                     "Failed to load cached world mesh of zen {0} - recaching it!", zen.fileName);
+          mesh = BsZenLib::ImportAndCacheStaticMesh(meshFileName, packedWorldMesh(zen),
+                                                    gVirtualFileSystem().getFileIndex());
+        }
+      }
+      else
+      {
+        mesh = BsZenLib::ImportAndCacheStaticMesh(meshFileName, packedWorldMesh(zen),
                                                   gVirtualFileSystem().getFileIndex());
       }
     }
-    else
-    {
-      mesh = BsZenLib::ImportAndCacheStaticMesh(meshFileName, zen.worldMesh,
-                                                gVirtualFileSystem().getFileIndex());
-    }
 
     bs::HMesh actualMesh = mesh->getMesh();
 
@@ -153,28 +264,112 @@ namespace REGoth
     renderable->setMesh(mesh->getMesh());
     renderable->setMaterials(mesh->getMaterials());
 
-    if (!actualMesh->getCachedData())
+    // Packing is timed on its own
+    zen.timings.worldMeshMs = timer.getMilliseconds() - zen.timings.packMs;
+
+    timer.reset();
+
+    // Only cooked the first time this world is loaded. The name of the mesh itself is not
+    // unique for world meshes, so the one of the cache file is used.
+    bs::HPhysicsMesh physicsMesh = gPhysicsMeshRegistry().physicsMeshFor(meshFileName, actualMesh);
+
+    if (!physicsMesh)
     {
       REGOTH_LOG(Error, Uncategorized,
                  "Cannot extract world mesh for physics, no mesh data available!");
     }
     else
     {
-      bs::HPhysicsMesh physicsMesh =
-          bs::PhysicsMesh::create(mesh->getMesh()->getCachedData(), bs::PhysicsMeshType::Triangle);
-
-      bs::Path physicsMeshPath = BsZenLib::GothicPathToCachedStaticMesh(meshFileName + ".physics");
-
-      BsZenLib::AddToResourceManifest(physicsMesh, physicsMeshPath);
-      bs::gResources().save(physicsMesh, physicsMeshPath, true);
-
       bs::HMeshCollider collider = meshSO->addComponent<bs::CMeshCollider>();
       collider->setMesh(physicsMesh);
     }
 
+    zen.timings.physicsMeshMs = timer.getMilliseconds();
+
     return meshSO;
   }
 
+  /**
+   * Hashes the world mesh as read from the ZEN, to tell whether caches built from it are
+   * still up to date. Doesn't need the mesh to be packed.
+   */
+  static bs::UINT64 hashWorldMesh(const OriginalZen& zen)
+  {
+    if (!zen.parser || !zen.parser->getWorldMesh())
+    {
+      REGOTH_THROW(InvalidStateException,
+                   "World mesh of zen " + zen.fileName + " has already been released");
+    }
+
+    const ZenLoad::zCMesh& mesh = *zen.parser->getWorldMesh();
+
+    // FNV-1a
+    bs::UINT64 hash = 0xcbf29ce484222325ULL;
+
+    auto hashBytes = [&](const void* data, size_t size) {
+      const bs::UINT8* bytes = (const bs::UINT8*)data;
+
+      for (size_t i = 0; i < size; i++)
+      {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+      }
+    };
+
+    const auto& vertices = mesh.getVertices();
+    const auto& indices  = mesh.getIndices();
+
+    hashBytes(vertices.data(), vertices.size() * sizeof(vertices[0]));
+    hashBytes(indices.data(), indices.size() * sizeof(indices[0]));
+
+    return hash;
+  }
+
+  /**
+   * Bakes the navmesh from the world mesh and caches it, unless there is a cached one
+   * for the same world mesh already. The GameWorld loads it from there.
+   */
+  static void bakeNavMesh(OriginalZen& zen)
+  {
+    const AI::Pathfinder::UserConfiguration agent;
+
+    bs::Path path = NavMesh::cachePathFor(zen.fileName);
+
+    if (NavMesh::isSavedFor(path, agent, zen.worldMeshHash)) return;
+
+    const ZenLoad::PackedMesh& worldMesh = packedWorldMesh(zen);
+
+    bs::Timer timer;
+
+    bs::Vector<bs::Vector3> vertices;
+    vertices.reserve(worldMesh.vertices.size());
+
+    for (const auto& v : worldMesh.vertices)
+    {
+      // Already scaled to meters while packing
+      vertices.emplace_back(v.Position.x, v.Position.y, v.Position.z);
+    }
+
+    bs::Vector<bs::UINT32> indices;
+
+    for (const auto& subMesh : worldMesh.subMeshes)
+    {
+      // Things like water can be walked through, so they shouldn't be walked on either
+      if (subMesh.material.noCollDet) continue;
+
+      indices.insert(indices.end(), subMesh.indices.begin(), subMesh.indices.end());
+    }
+
+    NavMesh navMesh;
+    navMesh.bake(vertices, indices, agent);
+    navMesh.save(path, zen.worldMeshHash);
+
+    zen.timings.navMeshMs = timer.getMilliseconds();
+
+    REGOTH_LOG(Info, Uncategorized, "[ConstructFromZEN] Baked navmesh of {0} ({1} spans) in {2} ms",
+               zen.fileName, navMesh.numSpans(), zen.timings.navMeshMs);
+  }
+
   static void importWaynet(bs::HSceneObject sceneRoot, const OriginalZen& zen)
   {
     const ZenLoad::zCWayNetData& zenWaynet = zen.vobTree.waynet;
@@ -226,6 +421,9 @@ namespace REGoth
     {
       waynet->addFreepoint(fp);
     }
+
+    // Do this now rather than on the first search, which would stall the first NPC to route
+    waynet->rebuildSearchStructures();
   }
 
 }  // namespace REGoth
@@ -12,16 +12,41 @@ namespace REGoth
 
   namespace Internals
   {
+    /**
+     * Where the time went while constructing a world from a ZEN, in milliseconds.
+     *
+     * Steps served from a cache take next to no time, so this also shows which caches
+     * were missing.
+     */
+    struct ZenImportTimings
+    {
+      bs::UINT64 parseMs        = 0;
+      bs::UINT64 packMs         = 0;
+      bs::UINT64 worldMeshMs    = 0;
+      bs::UINT64 physicsMeshMs  = 0;
+      bs::UINT64 navMeshMs      = 0;
+      bs::UINT64 vobImportMs    = 0;
+      bs::UINT64 waynetImportMs = 0;
+    };
+
     /**
      * This function will load the given zenFile from the virtual file system
      * and fully convert it into a bs::f scene.
      *
-     * @param  gameWorld  World to create the objects in.
-     * @param  zenFile    Uppercase ZEN-file name, e.g. "OLDWORLD.ZEN".
+     * The world mesh is only packed if one of its caches is missing, so loading a world
+     * the second time only needs the vob tree out of the ZEN.
+     *
+     * @param  gameWorld         World to create the objects in.
+     * @param  zenFile           Uppercase ZEN-file name, e.g. "OLDWORLD.ZEN".
+     * @param  outTimings        If not null, receives how long each step took.
+     * @param  outWorldMeshHash  If not null, receives the hash of the world mesh the navmesh
+     *                           has been baked from, see NavMesh::load().
      *
      * @return Root of the created scene.
      */
-    bs::HSceneObject constructFromZEN(HGameWorld gameWorld, const bs::String& zenFile);
+    bs::HSceneObject constructFromZEN(HGameWorld gameWorld, const bs::String& zenFile,
+                                      ZenImportTimings* outTimings = nullptr,
+                                      bs::UINT64* outWorldMeshHash = nullptr);
 
     /**
      * Will load the given ZEN, but only add its world mesh to the scene.
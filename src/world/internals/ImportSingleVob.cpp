@@ -1,19 +1,19 @@
 #include "ImportSingleVob.hpp"
-#include <BsZenLib/ImportPath.hpp>
-#include <BsZenLib/ResourceManifest.hpp>
 #include <Components/BsCMeshCollider.h>
 #include <Components/BsCRenderable.h>
-#include <FileSystem/BsFileSystem.h>
 #include <Math/BsMatrix4.h>
 #include <Mesh/BsMesh.h>
 #include <Physics/BsPhysicsMesh.h>
-#include <Resources/BsResources.h>
 #include <Scene/BsSceneObject.h>
+#include <Utility/BsTimer.h>
 #include <components/Freepoint.hpp>
 #include <components/GameWorld.hpp>
 #include <components/Item.hpp>
 #include <components/Visual.hpp>
+#include <core/ParallelFor.hpp>
 #include <log/logging.hpp>
+#include <original-content/OriginalGameResources.hpp>
+#include <world/PhysicsMeshRegistry.hpp>
 #include <zenload/zTypes.h>
 
 namespace
@@ -53,8 +53,119 @@ namespace REGoth
                                            HGameWorld gameWorld);
   static void addVisualTo(bs::HSceneObject sceneObject, const bs::String& visualName);
   static void addCollisionTo(bs::HSceneObject sceneObject);
+  static bool isImportedAs_zCVob(const ZenLoad::zCVobData& vob);
   static bs::Transform transformFromVob(const ZenLoad::zCVobData& vob);
 
+  namespace
+  {
+    /**
+     * Visuals found by collectVisuals().
+     */
+    struct VisualsInUse
+    {
+      bs::Set<bs::String> staticMeshes;
+      bs::Set<bs::String> morphMeshes;
+
+      /**
+       * Visuals of vobs with collision enabled.
+       */
+      bs::Set<bs::String> colliding;
+    };
+  }  // namespace
+
+  static void collectVisuals(const ZenLoad::zCVobData& zenParent, VisualsInUse& visuals);
+
+  void Internals::loadVobResources(const ZenLoad::oCWorldData& world)
+  {
+    bs::Timer timer;
+
+    VisualsInUse visuals;
+
+    for (const ZenLoad::zCVobData& root : world.rootVobs)
+    {
+      collectVisuals(root, visuals);
+    }
+
+    bs::Vector<bs::String> staticMeshes(visuals.staticMeshes.begin(), visuals.staticMeshes.end());
+    bs::Vector<bs::String> morphMeshes(visuals.morphMeshes.begin(), visuals.morphMeshes.end());
+
+    gOriginalGameResources().preloadMeshes(staticMeshes, morphMeshes);
+
+    // The meshes are in memory now, so getting them again is cheap. Cooking the physics
+    // meshes needs their data, which is why this is a second parallel pass.
+    bs::Vector<bs::HMesh> collidingMeshes;
+
+    for (const bs::String& visual : visuals.colliding)
+    {
+      BsZenLib::Res::HMeshWithMaterials mesh =
+          visuals.staticMeshes.count(visual) ? gOriginalGameResources().staticMesh(visual)
+                                             : gOriginalGameResources().morphMesh(visual);
+
+      if (!mesh || !mesh->getMesh()) continue;
+
+      collidingMeshes.push_back(mesh->getMesh());
+    }
+
+    // The registry keeps them, so importing the vobs will find them there
+    parallelFor("LoadPhysicsMeshes", (bs::UINT32)collidingMeshes.size(), [&](bs::UINT32 i) {
+      gPhysicsMeshRegistry().physicsMeshFor(collidingMeshes[i]);
+    });
+
+    REGOTH_LOG(Info, Uncategorized,
+               "[ImportSingleVob] Loaded {0} meshes and {1} physics meshes for vobs in {2} ms",
+               staticMeshes.size() + morphMeshes.size(), collidingMeshes.size(),
+               timer.getMilliseconds());
+  }
+
+  /**
+   * Collects the visuals of all vobs below the given one, which are imported by
+   * importSingleVob(). Only meshes are collected, as loading those is what takes long.
+   */
+  static void collectVisuals(const ZenLoad::zCVobData& zenParent, VisualsInUse& visuals)
+  {
+    for (const ZenLoad::zCVobData& vob : zenParent.childVobs)
+    {
+      if (!isImportedAs_zCVob(vob)) continue;
+
+      collectVisuals(vob, visuals);
+
+      if (vob.visual.empty()) continue;
+
+      bs::String visual = vob.visual.c_str();
+
+      switch (Visual::guessVisualKind(visual))
+      {
+        case Visual::VisualKind::StaticMesh:
+          visuals.staticMeshes.insert(visual);
+          break;
+
+        case Visual::VisualKind::MorphMesh:
+          visuals.morphMeshes.insert(visual);
+          break;
+
+        default:
+          continue;
+      }
+
+      // See import_zCVob()
+      if (vob.cdDyn)
+      {
+        visuals.colliding.insert(visual);
+      }
+    }
+  }
+
+  /**
+   * @return Whether importSingleVob() handles the given vob via import_zCVob() and thus
+   *         uses its visual. Must match the classes handled in there.
+   */
+  static bool isImportedAs_zCVob(const ZenLoad::zCVobData& vob)
+  {
+    return vob.objectClass == "zCVob" || vob.objectClass == "zCVobLight:zCVob" ||
+           vob.objectClass == "zCVobStartpoint:zCVob" || vob.objectClass == "zCVobSpot:zCVob" ||
+           vob.objectClass == "zCVobSound:zCVob" || vob.objectClass == "zCVobAnimate:zCVob";
+  }
+
   bs::HSceneObject Internals::importSingleVob(const ZenLoad::zCVobData& vob,
                                               bs::HSceneObject bsfParent, HGameWorld gameWorld)
   {
@@ -328,27 +439,8 @@ namespace REGoth
 
     if (!mesh) return;
 
-    auto meshData = mesh->getCachedData();
-
-    if (!meshData) return;
-
-    bs::Path physicsMeshPath = BsZenLib::GothicPathToCachedStaticMesh(mesh->getName() + ".physics");
-
-    bs::HPhysicsMesh physicsMesh;
-    if (bs::FileSystem::exists(physicsMeshPath))
-    {
-      physicsMesh = bs::gResources().load<bs::PhysicsMesh>(physicsMeshPath);
-    }
-    else
-    {
-      REGOTH_LOG(Info, Uncategorized, "[ImportSingleVob] Caching physics mesh for {0}",
-                 mesh->getName());
-
-      physicsMesh = bs::PhysicsMesh::create(meshData, bs::PhysicsMeshType::Triangle);
-
-      BsZenLib::AddToResourceManifest(physicsMesh, physicsMeshPath);
-      bs::gResources().save(physicsMesh, physicsMeshPath, true);
-    }
+    // Usually loaded by loadVobResources() already, so this just finds it in memory
+    bs::HPhysicsMesh physicsMesh = gPhysicsMeshRegistry().physicsMeshFor(mesh);
 
     if (!physicsMesh) return;
 
@@ -8,6 +8,7 @@
 namespace ZenLoad
 {
   struct zCVobData;
+  struct oCWorldData;
 }
 
 namespace REGoth
@@ -17,6 +18,18 @@ namespace REGoth
 
   namespace Internals
   {
+    /**
+     * Loads the visuals of all vobs below the root vobs of the given world, as well as the
+     * physics meshes of the colliding ones, on the worker threads. Blocks until done.
+     *
+     * Loading the resources is what takes long when importing vobs. Afterwards,
+     * importSingleVob() finds everything it needs in memory and only has to create the
+     * scene objects, which must happen on the main thread.
+     *
+     * @param  world  Information from importing the zen-file.
+     */
+    void loadVobResources(const ZenLoad::oCWorldData& world);
+
     /**
      * Imports a single vob and creates a bs:f object as similar as possible.
      *